@@ -6,9 +6,13 @@ Communicates with Qt frontend via JSON over stdin/stdout
 """
 
 import sys
+import os
 import json
+import base64
+import tempfile
 import threading
 import queue
+import wave
 from datetime import datetime
 
 try:
@@ -18,11 +22,24 @@ except ImportError:
     TTS_AVAILABLE = False
     print(json.dumps({"type": "error", "message": "pyttsx3 not installed"}), flush=True)
 
+# PCM per audio message; base64 makes it a third larger, well under the GUI's line limit
+AUDIO_MESSAGE_BYTES = 32 * 1024
+
 class TTSBackend:
     def __init__(self):
         self.engine = None
         self.is_speaking = False
         self.command_queue = queue.Queue()
+        self.output_lock = threading.Lock()
+        
+        # Text waiting to be spoken, in order, with the stops and setting changes
+        # between it; one thread owns the engine, and stops and settings go through it
+        self.speech_queue = queue.Queue()
+        self.spoken = {}  # pyttsx3 utterance name -> text and, for chunks, utterance and index
+        self.spoken_count = 0
+        self.cancelled = set()  # SYNTHESIZE requests the GUI no longer wants
+        self.stops_requested = 0  # STOPs received, counted by the command thread
+        self.stops_applied = 0    # STOPs the speaker thread has acted on
         
         # Default settings
         self.volume = 1.0
@@ -45,78 +62,215 @@ class TTSBackend:
             except Exception as e:
                 self.send_error(f"Failed to initialize TTS engine: {str(e)}")
     
+    def chunk_fields(self, name):
+        """Utterance and index for a SPEAK_CHUNK, empty for a plain SPEAK"""
+        entry = self.spoken.get(name, {})
+        return {key: entry[key] for key in ("utterance", "index") if key in entry}
+    
+    def stop_if_requested(self):
+        """From a speech callback: cut the speech short if a STOP came in meanwhile"""
+        if self.stops_applied < self.stops_requested:
+            self.stops_applied = self.stops_requested
+            self.engine.stop()
+    
     def on_start(self, name):
         """Called when speech starts"""
+        if name not in self.spoken:
+            return  # synthesis to a file, nothing is heard
+        self.stop_if_requested()
         self.is_speaking = True
+        chunk = self.chunk_fields(name)
         self.send_json({
-            "type": "speech_started",
+            "type": "chunk_started" if chunk else "speech_started",
+            **chunk,
             "timestamp": datetime.now().isoformat()
         })
     
     def on_end(self, name, completed):
         """Called when speech ends"""
+        if name not in self.spoken:
+            return
         self.is_speaking = False
+        chunk = self.chunk_fields(name)
+        self.spoken.pop(name, None)
         self.send_json({
-            "type": "speech_finished",
+            "type": "chunk_finished" if chunk else "speech_finished",
+            **chunk,
             "completed": completed,
             "timestamp": datetime.now().isoformat()
         })
     
     def on_word(self, name, location, length):
-        """Called when a word is spoken"""
+        """Called when a word is spoken; location is within this chunk"""
+        if name not in self.spoken:
+            return
+        self.stop_if_requested()
+        text = self.spoken.get(name, {}).get("text", "")
         self.send_json({
             "type": "word_boundary",
-            "word": name,
+            **self.chunk_fields(name),
+            "word": text[location:location + length],
             "position": location,
             "length": length
         })
     
-    def speak(self, text):
-        """Speak the given text"""
+    def speak(self, text, utterance=None, index=0):
+        """Queue text to be spoken, as a whole or as one chunk of an utterance"""
+        if not TTS_AVAILABLE or not self.engine:
+            chunk = {"utterance": utterance, "index": index} if utterance is not None else {}
+            self.send_error("TTS engine not available", **chunk)
+            return
+        
+        self.spoken_count += 1
+        name = f"speech-{self.spoken_count}"
+        self.spoken[name] = {"text": text}
+        if utterance is not None:
+            self.spoken[name].update(utterance=utterance, index=index)
+        self.speech_queue.put(("say", text, name))
+    
+    def synthesize(self, text, request):
+        """Queue text to be synthesized to PCM for the GUI to play and cache"""
         if not TTS_AVAILABLE or not self.engine:
-            self.send_error("TTS engine not available")
+            self.send_json({"type": "synthesis_failed", "request": request,
+                            "message": "TTS engine not available"})
+            return
+        self.speech_queue.put(("synthesize", text, request))
+    
+    def cancel(self, requests):
+        """Drop SYNTHESIZE requests that have not been started"""
+        self.cancelled.update(requests)
+    
+    def speaker_loop(self):
+        """Speak queued text; chunks that are already queued play without a gap"""
+        while True:
+            batch = [self.speech_queue.get()]
+            while True:
+                try:
+                    batch.append(self.speech_queue.get_nowait())
+                except queue.Empty:
+                    break
+            
+            # A stop drops the speech queued before it; synthesis isn't speech and stays
+            stops = [i for i, item in enumerate(batch) if item[0] == "stop"]
+            if stops:
+                last = stops[-1]
+                self.stops_applied = max(self.stops_applied, batch[last][2])
+                for kind, _, name in batch[:last]:
+                    if kind == "say":
+                        self.spoken.pop(name, None)
+                batch = [item for item in batch[:last] if item[0] not in ("say", "stop")] + batch[last + 1:]
+            
+            said = [name for kind, _, name in batch if kind == "say"]
+            try:
+                saying = False
+                for kind, value, name in batch:
+                    if kind == "say":
+                        self.engine.say(value, name)
+                        saying = True
+                    elif kind == "volume":
+                        self.volume = value
+                        self.engine.setProperty('volume', value)
+                        self.send_log(f"Volume set to {value}")
+                    elif kind == "rate":
+                        self.rate = value
+                        self.engine.setProperty('rate', value)
+                        self.send_log(f"Rate set to {value}")
+                    elif kind == "voice":
+                        self.apply_voice(value)
+                    else:
+                        if saying:
+                            self.engine.runAndWait()
+                            saying = False
+                        self.synthesize_now(value, name)
+                if saying:
+                    self.engine.runAndWait()
+                
+                # Cut short by a stop, the rest of the run was never started
+                for name in said:
+                    self.spoken.pop(name, None)
+            except Exception as e:
+                # Names the utterance, so the GUI gives up on it rather than waiting
+                failed = next((name for name in said if name in self.spoken), None)
+                self.send_error(f"Speech error: {str(e)}", **self.chunk_fields(failed))
+    
+    def synthesize_now(self, text, request):
+        """Render text to a WAV file and send it as PCM audio messages"""
+        if request in self.cancelled:
+            self.cancelled.discard(request)
             return
         
+        fd, path = tempfile.mkstemp(suffix=".wav")
+        os.close(fd)
         try:
-            self.engine.say(text)
+            # Volume is applied by the GUI at playback, so the cached audio is at full scale
+            self.engine.setProperty('volume', 1.0)
+            self.engine.save_to_file(text, path, f"synth-{request}")
             self.engine.runAndWait()
+            self.engine.setProperty('volume', self.volume)
+            
+            with wave.open(path, 'rb') as wav:
+                if wav.getsampwidth() != 2:
+                    raise ValueError(f"{8 * wav.getsampwidth()}-bit audio, expected 16-bit")
+                sample_rate = wav.getframerate()
+                channels = wav.getnchannels()
+                pcm = wav.readframes(wav.getnframes())
+            if not pcm:
+                raise ValueError("no audio")
+            
+            for offset in range(0, len(pcm), AUDIO_MESSAGE_BYTES):
+                self.send_json({
+                    "type": "audio",
+                    "request": request,
+                    "sampleRate": sample_rate,
+                    "channels": channels,
+                    "data": base64.b64encode(pcm[offset:offset + AUDIO_MESSAGE_BYTES]).decode("ascii"),
+                    "final": offset + AUDIO_MESSAGE_BYTES >= len(pcm)
+                })
         except Exception as e:
-            self.send_error(f"Speech error: {str(e)}")
+            self.send_json({"type": "synthesis_failed", "request": request, "message": str(e)})
+        finally:
+            try:
+                os.remove(path)
+            except OSError:
+                pass
     
     def stop(self):
-        """Stop current speech"""
+        """Stop current speech and drop what is queued"""
         if not TTS_AVAILABLE or not self.engine:
             return
         
-        try:
-            self.engine.stop()
-            self.is_speaking = False
-        except Exception as e:
-            self.send_error(f"Stop error: {str(e)}")
+        # Carried out by the speaker thread: speech in progress stops at its next
+        # word and still reports its end, under its own name
+        self.stops_requested += 1
+        self.speech_queue.put(("stop", None, self.stops_requested))
     
     def set_volume(self, volume):
         """Set volume (0.0 - 1.0)"""
         if not TTS_AVAILABLE or not self.engine:
             return
         
-        self.volume = max(0.0, min(1.0, volume))
-        self.engine.setProperty('volume', self.volume)
-        self.send_log(f"Volume set to {self.volume}")
+        # Applied by the speaker thread, between synthesis runs
+        self.speech_queue.put(("volume", max(0.0, min(1.0, volume)), None))
     
     def set_rate(self, rate):
         """Set speech rate"""
         if not TTS_AVAILABLE or not self.engine:
             return
         
-        self.rate = int(rate * 150)  # Convert 0.5-2.0 to 75-300 words per minute
-        self.engine.setProperty('rate', self.rate)
-        self.send_log(f"Rate set to {self.rate}")
+        # Applied by the speaker thread, so SYNTHESIZE requests queued before it
+        # render (and are cached) at the rate they were asked for
+        self.speech_queue.put(("rate", int(rate * 150), None))  # 0.5-2.0 -> 75-300 words per minute
     
     def set_voice(self, voice_id):
         """Set voice"""
         if not TTS_AVAILABLE or not self.engine:
             return
         
+        # Applied by the speaker thread, in order with the text queued around it
+        self.speech_queue.put(("voice", voice_id, None))
+    
+    def apply_voice(self, voice_id):
+        """Switch the engine to voice_id; runs on the speaker thread"""
         try:
             voices = self.engine.getProperty('voices')
             if voice_id == "default" and voices:
@@ -150,10 +304,13 @@ class TTSBackend:
             return []
     
     def send_json(self, obj):
-        """Send JSON message to Qt frontend"""
+        """Send JSON message to Qt frontend, one line per message"""
         try:
             json_str = json.dumps(obj)
-            print(json_str, flush=True)
+            # Speech callbacks run on other threads; print() could interleave lines
+            with self.output_lock:
+                sys.stdout.write(json_str + "\n")
+                sys.stdout.flush()
         except Exception as e:
             print(json.dumps({"type": "error", "message": f"JSON encoding error: {str(e)}"}),
                   flush=True, file=sys.stderr)
@@ -166,10 +323,11 @@ class TTSBackend:
             "timestamp": datetime.now().isoformat()
         })
     
-    def send_error(self, message):
-        """Send error message"""
+    def send_error(self, message, **chunk):
+        """Send error message; one about a chunk names its utterance and index"""
         self.send_json({
             "type": "error",
+            **chunk,
             "message": message,
             "timestamp": datetime.now().isoformat()
         })
@@ -181,10 +339,25 @@ class TTSBackend:
         if cmd == "SPEAK":
             text = command.get("text", "")
             if text:
-                # Run in separate thread to avoid blocking
-                thread = threading.Thread(target=self.speak, args=(text,))
-                thread.daemon = True
-                thread.start()
+                self.speak(text)
+        
+        elif cmd == "SPEAK_CHUNK":
+            # One sentence of a longer response; the GUI sends the next while this plays
+            text = command.get("text", "")
+            if text:
+                self.speak(text, int(command.get("utterance", 0)), int(command.get("index", 0)))
+        
+        elif cmd == "SYNTHESIZE":
+            # PCM for the GUI to play and cache; nothing is heard from here
+            text = command.get("text", "")
+            request = int(command.get("request", 0))
+            if text:
+                self.synthesize(text, request)
+            else:
+                self.send_json({"type": "synthesis_failed", "request": request, "message": "empty text"})
+        
+        elif cmd == "CANCEL":
+            self.cancel(int(request) for request in command.get("requests", []))
         
         elif cmd == "STOP":
             self.stop()
@@ -226,6 +399,12 @@ class TTSBackend:
         """Main loop - read commands from stdin"""
         self.send_log("TTS backend started")
         
+        # The engine is initialised; a standby can now be promoted instantly
+        self.send_json({
+            "type": "ready",
+            "engine": self.engine is not None
+        })
+        
         # Start command reader thread
         def read_commands():
             for line in sys.stdin:
@@ -239,6 +418,11 @@ class TTSBackend:
         reader_thread.daemon = True
         reader_thread.start()
         
+        if self.engine:
+            speaker_thread = threading.Thread(target=self.speaker_loop)
+            speaker_thread.daemon = True
+            speaker_thread.start()
+        
         # Process commands
         while True:
             try:
@@ -20,6 +20,11 @@ Rectangle {
     property int volume: 50
     property string source: "Spotify" // Spotify, Radio, Local
     
+    // Media is ducked while the assistant speaks; players take outputVolume, not volume
+    property var ttsEngine: null
+    readonly property real outputVolume: volume / 100 * (ttsEngine ? ttsEngine.mediaGain : 1.0)
+    readonly property bool ducked: ttsEngine ? ttsEngine.mediaGain < 1.0 : false
+    
     ColumnLayout {
         anchors.fill: parent
         anchors.margins: 20
@@ -257,6 +262,12 @@ Rectangle {
                 color: settingsManager.darkMode ? "#999999" : "#666666"
                 Layout.preferredWidth: 40
             }
+            
+            Text {
+                text: "🗣️"
+                font.pixelSize: 16
+                visible: ducked
+            }
         }
         
         // Voice Commands
@@ -60,7 +60,7 @@ Rectangle {
                 anchors.rightMargin: 20
                 
                 Text {
-                    text: "📜 History (" + transcriptionModel.count + ")"
+                    text: "📜 History (" + transcriptionModel.totalCount + ")"
                     font.pixelSize: 22
                     font.bold: true
                     color: settingsManager.darkMode ? "#ffffff" : "#333333"
@@ -181,7 +181,7 @@ Rectangle {
             // Empty state
             Item {
                 anchors.centerIn: parent
-                visible: transcriptionModel.count === 0
+                visible: transcriptionModel.totalCount === 0
                 
                 Column {
                     anchors.centerIn: parent
@@ -222,7 +222,7 @@ Rectangle {
                 
                 Button {
                     text: "Clear All"
-                    enabled: transcriptionModel.count > 0
+                    enabled: transcriptionModel.totalCount > 0
                     onClicked: confirmDialog.open()
                     
                     background: Rectangle {
@@ -240,7 +240,7 @@ Rectangle {
                 
                 Button {
                     text: "Export"
-                    enabled: transcriptionModel.count > 0
+                    enabled: transcriptionModel.totalCount > 0
                     onClicked: fileDialog.open()
                     
                     background: Rectangle {
@@ -270,7 +270,7 @@ Rectangle {
             spacing: 20
             
             Text {
-                text: "Are you sure you want to delete all " + transcriptionModel.count + " transcriptions?\nThis action cannot be undone."
+                text: "Are you sure you want to delete all " + transcriptionModel.totalCount + " transcriptions?\nThis action cannot be undone."
                 wrapMode: Text.WordWrap
                 Layout.preferredWidth: 300
                 color: settingsManager.darkMode ? "#ffffff" : "#333333"
@@ -215,7 +215,7 @@ Item {
                 
                 Text {
                     anchors.centerIn: parent
-                    text: "Transcriptions: " + transcriptionModel.count
+                    text: "Transcriptions: " + transcriptionModel.totalCount
                     font.pixelSize: 14
                     color: Qt.darker(textColor, 1.3)
                 }
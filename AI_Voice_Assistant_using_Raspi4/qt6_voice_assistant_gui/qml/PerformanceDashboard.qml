@@ -210,6 +210,49 @@ Rectangle {
                     }
                 }
                 
+                // Backend Pool
+                Rectangle {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 100 + backendRepeater.count * 50
+                    Layout.margins: 15
+                    color: settingsManager.darkMode ? "#2d2d2d" : "#ffffff"
+                    radius: 10
+                    
+                    Column {
+                        anchors.fill: parent
+                        anchors.margins: 15
+                        spacing: 10
+                        
+                        Text {
+                            text: "🌐 Backend Pool"
+                            font.pixelSize: 16
+                            font.bold: true
+                            color: settingsManager.darkMode ? "#ffffff" : "#333333"
+                        }
+                        
+                        Repeater {
+                            id: backendRepeater
+                            model: networkManager.backendPool.backends
+                            
+                            BackendRow {
+                                backend: modelData
+                            }
+                        }
+                        
+                        Text {
+                            property var stats: networkManager.hedgeStats
+                            
+                            text: networkManager.hedgingEnabled
+                                  ? "🪃 Hedged " + (stats.hedgeRate * 100).toFixed(1) + "% of requests, "
+                                    + (stats.winRate * 100).toFixed(0) + "% of hedges won, "
+                                    + (stats.extraBytes / 1048576).toFixed(1) + " MB extra upload"
+                                  : "🪃 Hedging off"
+                            font.pixelSize: 12
+                            color: settingsManager.darkMode ? "#999999" : "#666666"
+                        }
+                    }
+                }
+                
                 // Performance Targets
                 Rectangle {
                     Layout.fillWidth: true
@@ -362,6 +405,51 @@ Rectangle {
         }
     }
     
+    // Backend Row Component
+    component BackendRow: RowLayout {
+        property var backend: ({})
+        
+        width: parent.width
+        height: 40
+        spacing: 10
+        
+        Rectangle {
+            width: 10
+            height: 10
+            radius: 5
+            color: backend.healthy ? "#34c759" : "#ff3b30"
+        }
+        
+        Text {
+            text: backend.url + (backend.preferred ? "  ★" : "")
+            font.pixelSize: 12
+            font.bold: backend.preferred
+            color: settingsManager.darkMode ? "#ffffff" : "#333333"
+            elide: Text.ElideMiddle
+            Layout.fillWidth: true
+        }
+        
+        StatItem {
+            label: "Latency"
+            value: backend.latencyMs < 0 ? "—" : backend.latencyMs.toFixed(0) + " ms"
+        }
+        
+        StatItem {
+            label: "Per audio s"
+            value: backend.msPerAudioSecond < 0 ? "—" : backend.msPerAudioSecond.toFixed(0) + " ms"
+        }
+        
+        StatItem {
+            label: "Errors"
+            value: (backend.errorRate * 100).toFixed(0) + "%"
+        }
+        
+        StatItem {
+            label: "In flight"
+            value: backend.inFlight.toString()
+        }
+    }
+    
     // Target Row Component
     component TargetRow: RowLayout {
         property string label: ""
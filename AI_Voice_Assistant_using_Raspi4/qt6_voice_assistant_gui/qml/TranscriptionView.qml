@@ -38,7 +38,6 @@ Rectangle {
             
             TextArea {
                 id: transcriptionText
-                text: audioEngine.currentTranscription || "Your transcription will appear here..."
                 wrapMode: Text.WordWrap
                 readOnly: true
                 selectByMouse: true
@@ -51,10 +50,24 @@ Rectangle {
                 
                 placeholderText: "Waiting for speech input..."
                 placeholderTextColor: settingsManager.darkMode ? "#666666" : "#999999"
+                
+                Component.onCompleted: text = audioEngine.currentTranscription
             }
         }
     }
     
+    // Apply only the span that changed; rebinding text would re-lay out
+    // the whole utterance on every partial
+    Connections {
+        target: audioEngine
+        function onTranscriptionEdited(position, removed, inserted) {
+            if (removed > 0)
+                transcriptionText.remove(position, position + removed)
+            if (inserted.length > 0)
+                transcriptionText.insert(position, inserted)
+        }
+    }
+    
     // Empty state
     Column {
         anchors.centerIn: parent
@@ -13,14 +13,17 @@ AudioEngine::AudioEngine(NetworkManager *networkManager, QObject *parent)
     , m_isListening(false)
     , m_isProcessing(false)
     , m_audioLevel(0.0f)
+    , m_committedLength(0)
     , m_backendHealthy(false)
     , m_useStreaming(false)
+    , m_useProgressiveUpload(false)
+    , m_progressiveUploadActive(false)
+    , m_progressiveRequestId(0)
     , m_language("en")
     , m_networkManager(networkManager)
     , m_audioInput(nullptr)
     , m_audioInputDevice(nullptr)
     , m_audioBuffer(new QBuffer(&m_audioData, this))
-    , m_tempAudioFile(nullptr)
     , m_audioLevelTimer(new QTimer(this))
     , m_streamingTimer(new QTimer(this))
 {
@@ -44,6 +47,8 @@ AudioEngine::AudioEngine(NetworkManager *networkManager, QObject *parent)
             this, &AudioEngine::handleTranscriptionResult);
     connect(m_networkManager, &NetworkManager::partialTranscription,
             this, &AudioEngine::handlePartialTranscription);
+    connect(m_networkManager, &NetworkManager::partialTranscriptionDelta,
+            this, &AudioEngine::handlePartialTranscriptionDelta);
     connect(m_networkManager, &NetworkManager::finalTranscription,
             this, &AudioEngine::handleFinalTranscription);
     connect(m_networkManager, &NetworkManager::errorOccurred,
@@ -66,10 +71,6 @@ AudioEngine::~AudioEngine()
 {
     qDebug() << "🎤 AudioEngine destroyed";
     stopAudioCapture();
-    
-    if (m_tempAudioFile) {
-        delete m_tempAudioFile;
-    }
 }
 
 void AudioEngine::setUseStreaming(bool enabled)
@@ -90,6 +91,17 @@ void AudioEngine::setUseStreaming(bool enabled)
     }
 }
 
+void AudioEngine::setUseProgressiveUpload(bool enabled)
+{
+    if (m_useProgressiveUpload != enabled) {
+        m_useProgressiveUpload = enabled;
+        qDebug() << "🎤 Progressive upload" << (enabled ? "enabled" : "disabled");
+        emit useProgressiveUploadChanged();
+        
+        // Takes effect from the next utterance; the current upload (if any) keeps running
+    }
+}
+
 void AudioEngine::setLanguage(const QString &language)
 {
     m_language = language;
@@ -109,6 +121,8 @@ void AudioEngine::startListening()
     }
     
     if (!m_backendHealthy) {
+        // Probe now so a recovered backend is noticed on the next press, not the next poll
+        m_networkManager->checkHealth();
         qWarning() << "❌ Backend is not healthy, cannot start listening";
         emit errorOccurred("Backend Error", "Whisper backend is not available");
         return;
@@ -122,6 +136,12 @@ void AudioEngine::startListening()
     // Clear previous audio data
     m_audioData.clear();
     
+    // Open the upload now so the TCP handshake overlaps with the user speaking
+    if (!m_useStreaming && m_useProgressiveUpload) {
+        m_progressiveRequestId = m_networkManager->beginStreamingTranscription(m_language);
+        m_progressiveUploadActive = true;
+    }
+    
     // Start audio capture
     startAudioCapture();
     
@@ -146,7 +166,7 @@ void AudioEngine::stopListening()
     qDebug() << "🎤 Stopping listening...";
     
     m_isListening = false;
-    setStatus("Ready");
+    setStatus(m_isProcessing ? "Processing" : "Ready");
     
     // Stop audio capture
     stopAudioCapture();
@@ -159,9 +179,21 @@ void AudioEngine::stopListening()
     m_audioLevel = 0.0f;
     emit audioLevelChanged(0.0f);
     
-    // Disconnect WebSocket if streaming
+    // Disconnect WebSocket if streaming; a multiplexed session also carries
+    // remote speech, so only the transcription on it ends
     if (m_useStreaming) {
-        m_networkManager->disconnectWebSocket();
+        if (m_networkManager->isMultiplexed()) {
+            m_networkManager->cancelStream();
+        } else {
+            m_networkManager->disconnectWebSocket();
+        }
+    }
+    
+    // Utterance abandoned without processing, drop the partial upload
+    if (m_progressiveUploadActive) {
+        m_networkManager->cancelRequest(m_progressiveRequestId);
+        m_progressiveUploadActive = false;
+        m_progressiveRequestId = 0;
     }
     
     emit isListeningChanged();
@@ -178,7 +210,8 @@ void AudioEngine::toggleListening()
 
 void AudioEngine::processAudio()
 {
-    if (!m_isListening || m_isProcessing) {
+    // REST utterances pipeline through the job queue; a stream has one session at a time
+    if (!m_isListening || (m_isProcessing && m_useStreaming)) {
         qWarning() << "⚠️ Cannot process audio: listening=" << m_isListening << "processing=" << m_isProcessing;
         return;
     }
@@ -191,16 +224,22 @@ void AudioEngine::processAudio()
     
     qDebug() << "🎤 Processing audio..." << m_audioData.size() << "bytes";
     
+    bool wasProcessing = m_isProcessing;
     m_isProcessing = true;
     m_isListening = false;
     setStatus("Processing");
     
+    // Drain what the device still holds so the tail of the utterance isn't lost
+    readAudioData();
+    
     // Stop audio capture
     stopAudioCapture();
     m_audioLevelTimer->stop();
     
     emit isListeningChanged();
-    emit isProcessingChanged();
+    if (!wasProcessing) {
+        emit isProcessingChanged();
+    }
     
     // Send audio to backend
     sendAudioToBackend();
@@ -214,8 +253,22 @@ void AudioEngine::cancelProcessing()
     
     qDebug() << "🎤 Canceling processing...";
     
+    // Abort the uploads and let the backend drop the inference
+    const QList<quint64> pending = m_pendingRequestIds;
+    m_pendingRequestIds.clear();
+    for (quint64 requestId : pending) {
+        m_networkManager->cancelRequest(requestId);
+    }
+    
+    if (m_useStreaming) {
+        m_networkManager->cancelStream();
+        if (!m_networkManager->isMultiplexed()) {
+            m_networkManager->disconnectWebSocket();
+        }
+    }
+    
     m_isProcessing = false;
-    setStatus("Ready");
+    setStatus(m_isListening ? "Listening" : "Ready");
     
     emit isProcessingChanged();
 }
@@ -342,13 +395,18 @@ void AudioEngine::readAudioData()
     // Append to buffer
     m_audioData.append(newData);
     
+    // Progressive upload: forward every captured block immediately
+    if (m_progressiveUploadActive) {
+        m_networkManager->appendStreamingAudio(newData);
+    }
+    
     // Calculate audio level for visualization
     calculateAudioLevel(newData);
     
     // If streaming mode, send chunk to backend
     if (m_useStreaming && m_networkManager->isConnected()) {
-        // Send the new data as a chunk
-        if (newData.size() >= CHUNK_SIZE) {
+        // Send the new data as a chunk; shared memory takes every block as captured
+        if (newData.size() >= CHUNK_SIZE || m_networkManager->isSharedMemorySession()) {
             m_networkManager->sendAudioChunk(newData);
         }
     }
@@ -436,79 +494,35 @@ void AudioEngine::updateAudioLevel()
     // is now done in calculateAudioLevel() when data arrives
 }
 
-void AudioEngine::saveAudioToFile()
-{
-    // Create temporary WAV file
-    if (m_tempAudioFile) {
-        delete m_tempAudioFile;
-    }
-    
-    m_tempAudioFile = new QTemporaryFile(QDir::tempPath() + "/voice_XXXXXX.wav", this);
-    
-    if (!m_tempAudioFile->open()) {
-        qWarning() << "❌ Failed to create temporary audio file";
-        emit errorOccurred("File Error", "Failed to create temporary audio file");
-        return;
-    }
-    
-    // Write WAV header
-    QDataStream stream(m_tempAudioFile);
-    stream.setByteOrder(QDataStream::LittleEndian);
-    
-    // RIFF header
-    stream.writeRawData("RIFF", 4);
-    quint32 fileSize = 36 + m_audioData.size();
-    stream << fileSize;
-    stream.writeRawData("WAVE", 4);
-    
-    // fmt chunk
-    stream.writeRawData("fmt ", 4);
-    quint32 fmtSize = 16;
-    stream << fmtSize;
-    quint16 audioFormat = 1; // PCM
-    stream << audioFormat;
-    quint16 numChannels = CHANNELS;
-    stream << numChannels;
-    quint32 sampleRate = SAMPLE_RATE;
-    stream << sampleRate;
-    quint32 byteRate = SAMPLE_RATE * CHANNELS * SAMPLE_SIZE / 8;
-    stream << byteRate;
-    quint16 blockAlign = CHANNELS * SAMPLE_SIZE / 8;
-    stream << blockAlign;
-    quint16 bitsPerSample = SAMPLE_SIZE;
-    stream << bitsPerSample;
-    
-    // data chunk
-    stream.writeRawData("data", 4);
-    quint32 dataSize = m_audioData.size();
-    stream << dataSize;
-    stream.writeRawData(m_audioData.constData(), m_audioData.size());
-    
-    m_tempAudioFile->flush();
-    
-    qDebug() << "💾 Audio saved to temporary file:" << m_tempAudioFile->fileName();
-}
-
 void AudioEngine::sendAudioToBackend()
 {
     if (m_useStreaming) {
         // In streaming mode, we've already sent the data via WebSocket
         // Just wait for final transcription
         qDebug() << "📡 Streaming mode: waiting for final transcription...";
+    } else if (m_progressiveUploadActive) {
+        // Most of the audio is already on the backend, only the tail remains
+        qDebug() << "📤 Progressive upload: sending final chunk...";
+        m_networkManager->finishStreamingTranscription();
+        m_progressiveUploadActive = false;
+        m_pendingRequestIds.append(m_progressiveRequestId);
+        m_progressiveRequestId = 0;
     } else {
-        // File upload mode: save to file and send via REST API
-        saveAudioToFile();
-        
-        if (!m_tempAudioFile) {
-            qWarning() << "❌ No audio file to send";
-            m_isProcessing = false;
-            setStatus("Error");
-            emit isProcessingChanged();
-            return;
-        }
-        
-        qDebug() << "📤 Sending audio file to backend...";
-        m_networkManager->transcribeFile(m_tempAudioFile->fileName(), m_language);
+        // REST mode: queue the raw PCM; results come back in utterance order
+        qDebug() << "📤 Queueing audio for transcription...";
+        m_pendingRequestIds.append(m_networkManager->enqueueTranscription(m_audioData, m_language));
+    }
+}
+
+void AudioEngine::finishRequest(quint64 requestId)
+{
+    m_pendingRequestIds.removeOne(requestId);
+    
+    // Later utterances may still be in the queue
+    if (m_isProcessing && m_pendingRequestIds.isEmpty()) {
+        m_isProcessing = false;
+        setStatus(m_isListening ? "Listening" : "Ready");
+        emit isProcessingChanged();
     }
 }
 
@@ -516,36 +530,51 @@ void AudioEngine::sendAudioToBackend()
 // NetworkManager Response Handlers
 // ============================================================================
 
-void AudioEngine::handleTranscriptionResult(const QString &text, double duration, double inferenceTime, double rtf)
+void AudioEngine::handleTranscriptionResult(const QString &text, double duration, double inferenceTime, double rtf, quint64 requestId)
 {
+    // Results for requests we no longer wait on (cancelled, superseded) are stale
+    if (!m_pendingRequestIds.contains(requestId)) {
+        qDebug() << "🗑️ Ignoring stale transcription for request" << requestId;
+        return;
+    }
+    
     qDebug() << "✅ Transcription received:" << text;
     qDebug() << "⏱️ Duration:" << duration << "s, Inference:" << inferenceTime << "s, RTF:" << rtf << "x";
     
-    m_currentTranscription = text;
-    emit currentTranscriptionChanged();
+    setTranscription(0, text, text.size());
     emit transcriptionReceived(text, QDateTime::currentDateTime(), duration, rtf);
     
-    // Processing complete
-    m_isProcessing = false;
-    setStatus("Ready");
-    emit isProcessingChanged();
+    finishRequest(requestId);
 }
 
 void AudioEngine::handlePartialTranscription(const QString &text, double timestamp)
 {
     qDebug() << "📝 Partial transcription:" << text;
     
-    m_currentTranscription = text;
-    emit currentTranscriptionChanged();
+    // Full-text partials may revise anything, so nothing is committed
+    setTranscription(0, text, 0);
     emit partialTranscriptionReceived(text);
 }
 
+void AudioEngine::handlePartialTranscriptionDelta(int stableLength, const QString &tail, double timestamp)
+{
+    if (stableLength > m_currentTranscription.size()) {
+        qWarning() << "⚠️ Partial delta keeps" << stableLength << "characters of"
+                   << m_currentTranscription.size() << "- out of sync, keeping all";
+        stableLength = m_currentTranscription.size();
+    }
+    
+    qDebug() << "📝 Partial transcription delta: keep" << stableLength << "+" << tail;
+    
+    setTranscription(stableLength, tail, stableLength);
+    emit partialTranscriptionReceived(m_currentTranscription);
+}
+
 void AudioEngine::handleFinalTranscription(const QString &text, double timestamp)
 {
     qDebug() << "✅ Final transcription:" << text;
     
-    m_currentTranscription = text;
-    emit currentTranscriptionChanged();
+    setTranscription(0, text, text.size());
     emit transcriptionReceived(text, QDateTime::currentDateTime(), 0.0, 0.0);
     
     // Processing complete
@@ -554,13 +583,71 @@ void AudioEngine::handleFinalTranscription(const QString &text, double timestamp
     emit isProcessingChanged();
 }
 
-void AudioEngine::handleBackendError(const QString &error, const QString &details)
+void AudioEngine::setTranscription(int stableLength, QStringView tail, int committedLength)
+{
+    // Skip whatever the new tail shares with the old one so the edit, and
+    // the relayout in the view, covers only the text that really changed
+    const QStringView oldTail = QStringView(m_currentTranscription).mid(stableLength);
+    qsizetype common = 0;
+    while (common < oldTail.size() && common < tail.size() && oldTail[common] == tail[common]) {
+        ++common;
+    }
+    
+    const int position = int(stableLength + common);
+    const int removed = int(oldTail.size() - common);
+    const QStringView inserted = tail.mid(common);
+    const int oldCommittedLength = m_committedLength;
+    const bool committedChanged = committedLength != oldCommittedLength || position < oldCommittedLength;
+    const bool tentativeChanged = removed > 0 || !inserted.isEmpty() || committedLength != oldCommittedLength;
+    
+    if (removed > 0 || !inserted.isEmpty()) {
+        m_currentTranscription.truncate(position);
+        m_currentTranscription.append(inserted);
+    }
+    m_committedLength = committedLength;
+    
+    if (removed > 0 || !inserted.isEmpty()) {
+        emit transcriptionEdited(position, removed, inserted.toString());
+        emit currentTranscriptionChanged();
+    }
+    if (committedChanged) {
+        emit committedTranscriptionChanged();
+    }
+    if (tentativeChanged) {
+        emit tentativeTranscriptionChanged();
+    }
+}
+
+void AudioEngine::handleBackendError(const QString &error, const QString &details, quint64 requestId)
 {
+    // The upload still being fed died while the user spoke: nothing is lost,
+    // the whole capture goes in one request when the utterance ends
+    if (m_progressiveUploadActive && requestId == m_progressiveRequestId) {
+        qWarning() << "⚠️ Progressive upload failed while listening:" << error << "-" << details
+                   << "- falling back to a single request";
+        m_progressiveUploadActive = false;
+        m_progressiveRequestId = 0;
+        return;
+    }
+    
+    if (requestId != 0 && !m_pendingRequestIds.contains(requestId)) {
+        qDebug() << "🗑️ Ignoring error for stale request" << requestId << "-" << error;
+        return;
+    }
+    
     qWarning() << "❌ Backend error:" << error << "-" << details;
     
     // Forward error
     emit errorOccurred(error, details);
     
+    // One failed utterance doesn't abort the ones queued behind it
+    if (requestId != 0) {
+        m_pendingRequestIds.removeOne(requestId);
+        if (!m_pendingRequestIds.isEmpty()) {
+            return;
+        }
+    }
+    
     // Stop processing if active
     if (m_isProcessing) {
         m_isProcessing = false;
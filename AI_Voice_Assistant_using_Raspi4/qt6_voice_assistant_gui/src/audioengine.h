@@ -8,7 +8,7 @@
 #include <QIODevice>
 #include <QBuffer>
 #include <QFile>
-#include <QTemporaryFile>
+#include <QList>
 
 // Forward declaration
 class NetworkManager;
@@ -21,8 +21,11 @@ class AudioEngine : public QObject
     Q_PROPERTY(bool isProcessing READ isProcessing NOTIFY isProcessingChanged)
     Q_PROPERTY(float audioLevel READ audioLevel NOTIFY audioLevelChanged)
     Q_PROPERTY(QString currentTranscription READ currentTranscription NOTIFY currentTranscriptionChanged)
+    Q_PROPERTY(QString committedTranscription READ committedTranscription NOTIFY committedTranscriptionChanged)
+    Q_PROPERTY(QString tentativeTranscription READ tentativeTranscription NOTIFY tentativeTranscriptionChanged)
     Q_PROPERTY(bool backendHealthy READ backendHealthy NOTIFY backendHealthyChanged)
     Q_PROPERTY(bool useStreaming READ useStreaming WRITE setUseStreaming NOTIFY useStreamingChanged)
+    Q_PROPERTY(bool useProgressiveUpload READ useProgressiveUpload WRITE setUseProgressiveUpload NOTIFY useProgressiveUploadChanged)
     
 public:
     explicit AudioEngine(NetworkManager *networkManager, QObject *parent = nullptr);
@@ -42,11 +45,15 @@ public:
     bool isProcessing() const { return m_isProcessing; }
     float audioLevel() const { return m_audioLevel; }
     QString currentTranscription() const { return m_currentTranscription; }
+    QString committedTranscription() const { return m_currentTranscription.left(m_committedLength); }
+    QString tentativeTranscription() const { return m_currentTranscription.mid(m_committedLength); }
     bool backendHealthy() const { return m_backendHealthy; }
     bool useStreaming() const { return m_useStreaming; }
+    bool useProgressiveUpload() const { return m_useProgressiveUpload; }
     
     // Setters
     void setUseStreaming(bool enabled);
+    void setUseProgressiveUpload(bool enabled);
     
 public slots:
     void startListening();
@@ -62,8 +69,14 @@ signals:
     void isProcessingChanged();
     void audioLevelChanged(float level);
     void currentTranscriptionChanged();
+    void committedTranscriptionChanged();
+    void tentativeTranscriptionChanged();
+    // Replace removed UTF-16 units at position with inserted; views apply
+    // this instead of resetting the whole text
+    void transcriptionEdited(int position, int removed, const QString &inserted);
     void backendHealthyChanged();
     void useStreamingChanged();
+    void useProgressiveUploadChanged();
     void transcriptionReceived(const QString &text, const QDateTime &timestamp, double duration, double rtf);
     void partialTranscriptionReceived(const QString &text);
     void errorOccurred(const QString &error, const QString &details);
@@ -74,10 +87,11 @@ private slots:
     void handleAudioStateChanged(QAudio::State state);
     
     // NetworkManager response handlers
-    void handleTranscriptionResult(const QString &text, double duration, double inferenceTime, double rtf);
+    void handleTranscriptionResult(const QString &text, double duration, double inferenceTime, double rtf, quint64 requestId);
     void handlePartialTranscription(const QString &text, double timestamp);
+    void handlePartialTranscriptionDelta(int stableLength, const QString &tail, double timestamp);
     void handleFinalTranscription(const QString &text, double timestamp);
-    void handleBackendError(const QString &error, const QString &details);
+    void handleBackendError(const QString &error, const QString &details, quint64 requestId);
     void handleBackendHealthChanged();
     void handleWebSocketConnected();
     void handleWebSocketDisconnected();
@@ -87,8 +101,9 @@ private:
     void initializeAudio();
     void startAudioCapture();
     void stopAudioCapture();
-    void saveAudioToFile();
     void sendAudioToBackend();
+    void finishRequest(quint64 requestId);
+    void setTranscription(int stableLength, QStringView tail, int committedLength);
     void calculateAudioLevel(const QByteArray &data);
     
     QString m_statusString;
@@ -96,8 +111,13 @@ private:
     bool m_isProcessing;
     float m_audioLevel;
     QString m_currentTranscription;
+    int m_committedLength; // prefix of m_currentTranscription the backend won't revise
     bool m_backendHealthy;
     bool m_useStreaming;
+    bool m_useProgressiveUpload;
+    bool m_progressiveUploadActive;
+    quint64 m_progressiveRequestId; // upload still receiving audio, 0 if none
+    QList<quint64> m_pendingRequestIds; // submitted utterances awaiting results, oldest first
     QString m_language;
     
     NetworkManager *m_networkManager;
@@ -105,7 +125,6 @@ private:
     QIODevice *m_audioInputDevice;
     QBuffer *m_audioBuffer;
     QByteArray m_audioData;
-    QTemporaryFile *m_tempAudioFile;
     
     QTimer *m_audioLevelTimer;
     QTimer *m_streamingTimer;
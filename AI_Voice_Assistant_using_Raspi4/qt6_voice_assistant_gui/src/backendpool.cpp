@@ -0,0 +1,321 @@
+#include "backendpool.h"
+#include <QVariantMap>
+#include <QTimer>
+#include <QDebug>
+#include <limits>
+
+BackendPool::BackendPool(QObject *parent)
+    : QObject(parent)
+    , m_routingPolicy(FastestFirst)
+{
+}
+
+QStringList BackendPool::urls() const
+{
+    QStringList result;
+    for (const Backend &backend : m_backends) {
+        result << backend.url;
+    }
+    return result;
+}
+
+QStringList BackendPool::normalize(const QStringList &urls)
+{
+    QStringList normalized;
+    for (const QString &url : urls) {
+        QString trimmed = url.trimmed();
+        while (trimmed.endsWith('/')) {
+            trimmed.chop(1);
+        }
+        if (!trimmed.isEmpty()) {
+            normalized << trimmed;
+        }
+    }
+    return normalized;
+}
+
+void BackendPool::setUrls(const QStringList &urls)
+{
+    QList<Backend> backends;
+    
+    for (const QString &normalized : normalize(urls)) {
+        // Keep statistics for backends that stay in the pool
+        int index = indexOf(normalized);
+        if (index >= 0) {
+            backends << m_backends.at(index);
+        } else {
+            Backend backend;
+            backend.url = normalized;
+            backends << backend;
+        }
+    }
+    
+    m_backends = backends;
+    qDebug() << "🌐 Backend pool:" << urls;
+    emit backendsChanged();
+}
+
+BackendPool::BreakerState BackendPool::breakerState(const QString &url) const
+{
+    int index = indexOf(url);
+    return index >= 0 ? m_backends.at(index).breaker : Open;
+}
+
+double BackendPool::msPerAudioSecond(const QString &url) const
+{
+    int index = indexOf(url);
+    return index >= 0 ? m_backends.at(index).msPerAudioSecond : -1.0;
+}
+
+bool BackendPool::hasHealthyBackend() const
+{
+    for (const Backend &backend : m_backends) {
+        if (backend.breaker == Closed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BackendPool::setRoutingPolicy(RoutingPolicy policy)
+{
+    if (m_routingPolicy != policy) {
+        m_routingPolicy = policy;
+        emit routingPolicyChanged();
+        emit backendsChanged();
+    }
+}
+
+// ============================================================================
+// Routing
+// ============================================================================
+
+QString BackendPool::select(const QStringList &exclude) const
+{
+    const Backend *best = nullptr;
+    const Backend *fallback = nullptr;
+    double bestScore = std::numeric_limits<double>::max();
+    
+    for (const Backend &backend : m_backends) {
+        if (exclude.contains(backend.url)) {
+            continue;
+        }
+        
+        // If every backend is down, still try one rather than fail outright
+        if (backend.breaker != Closed) {
+            if (!fallback) {
+                fallback = &backend;
+            }
+            continue;
+        }
+        
+        double score;
+        if (m_routingPolicy == LeastLoaded) {
+            // In-flight count dominates; cost only orders equally loaded backends
+            score = backend.inFlight * 1e9 + expectedCostMs(backend);
+        } else {
+            // Requests ahead of ours on the same backend delay it
+            score = expectedCostMs(backend) * (1 + backend.inFlight);
+        }
+        
+        if (score < bestScore) {
+            bestScore = score;
+            best = &backend;
+        }
+    }
+    
+    if (best) {
+        return best->url;
+    }
+    return fallback ? fallback->url : QString();
+}
+
+double BackendPool::expectedCostMs(const Backend &backend) const
+{
+    // Unmeasured terms count as zero so new backends get tried; the 1 ms floor
+    // keeps the error penalty meaningful before anything has been measured
+    double cost = qMax(0.0, backend.latencyMs) + qMax(0.0, backend.msPerAudioSecond) * REFERENCE_AUDIO_SECONDS;
+    cost = qMax(1.0, cost);
+    return cost * (1.0 + backend.errorRate * ERROR_PENALTY);
+}
+
+// ============================================================================
+// Observations
+// ============================================================================
+
+void BackendPool::requestStarted(const QString &url)
+{
+    int index = indexOf(url);
+    if (index < 0) {
+        return;
+    }
+    
+    Backend &backend = m_backends[index];
+    backend.inFlight++;
+    backend.requests++;
+    emit backendsChanged();
+}
+
+void BackendPool::requestFinished(const QString &url, bool succeeded, qint64 wallMs, qint64 audioMs)
+{
+    int index = indexOf(url);
+    if (index < 0) {
+        return;
+    }
+    
+    Backend &backend = m_backends[index];
+    backend.inFlight = qMax(0, backend.inFlight - 1);
+    backend.errorRate = ewma(backend.errorRate, succeeded ? 0.0 : 1.0);
+    
+    if (succeeded) {
+        closeBreaker(backend);
+        if (audioMs > 0) {
+            double sample = wallMs * 1000.0 / audioMs;
+            backend.msPerAudioSecond = backend.msPerAudioSecond < 0 ? sample : ewma(backend.msPerAudioSecond, sample);
+        }
+    } else {
+        backend.errors++;
+        backend.consecutiveFailures++;
+        
+        // Timeouts and 5xx need a streak; a failed half-open trial reopens at once
+        if (backend.breaker == HalfOpen
+            || (backend.breaker == Closed && backend.consecutiveFailures >= BREAKER_FAILURE_THRESHOLD)) {
+            openBreaker(backend);
+        }
+    }
+    
+    emit backendsChanged();
+}
+
+void BackendPool::requestCancelled(const QString &url)
+{
+    int index = indexOf(url);
+    if (index < 0) {
+        return;
+    }
+    
+    // Says nothing about the backend, only frees its slot
+    Backend &backend = m_backends[index];
+    backend.inFlight = qMax(0, backend.inFlight - 1);
+    emit backendsChanged();
+}
+
+void BackendPool::connectFailed(const QString &url)
+{
+    int index = indexOf(url);
+    if (index < 0) {
+        return;
+    }
+    
+    // Nothing is listening; no point waiting for more failures
+    Backend &backend = m_backends[index];
+    if (backend.breaker != Open) {
+        qWarning() << "❌ Backend unreachable, failing over:" << url;
+        openBreaker(backend);
+        emit backendsChanged();
+    }
+}
+
+void BackendPool::recordProbe(const QString &url, bool healthy, qint64 latencyMs)
+{
+    int index = indexOf(url);
+    if (index < 0) {
+        return;
+    }
+    
+    Backend &backend = m_backends[index];
+    if (healthy) {
+        closeBreaker(backend);
+        backend.latencyMs = backend.latencyMs < 0 ? latencyMs : ewma(backend.latencyMs, latencyMs);
+    } else if (backend.breaker != Open) {
+        openBreaker(backend);
+    }
+    
+    emit backendsChanged();
+}
+
+QVariantList BackendPool::backends() const
+{
+    const QString preferred = select();
+    
+    QVariantList result;
+    for (const Backend &backend : m_backends) {
+        QVariantMap entry;
+        entry["url"] = backend.url;
+        entry["healthy"] = backend.breaker == Closed;
+        entry["breaker"] = backend.breaker == Closed ? "closed" : backend.breaker == Open ? "open" : "half-open";
+        entry["preferred"] = backend.url == preferred;
+        entry["latencyMs"] = backend.latencyMs;
+        entry["msPerAudioSecond"] = backend.msPerAudioSecond;
+        entry["errorRate"] = backend.errorRate;
+        entry["inFlight"] = backend.inFlight;
+        entry["requests"] = backend.requests;
+        entry["errors"] = backend.errors;
+        result << entry;
+    }
+    return result;
+}
+
+// ============================================================================
+// Circuit Breaker
+// ============================================================================
+
+void BackendPool::closeBreaker(Backend &backend)
+{
+    if (backend.breaker != Closed) {
+        qDebug() << "🏥 Backend" << backend.url << "is healthy";
+    }
+    
+    backend.breaker = Closed;
+    backend.consecutiveFailures = 0;
+    backend.cooldownMs = BREAKER_BASE_COOLDOWN_MS;
+}
+
+void BackendPool::openBreaker(Backend &backend)
+{
+    // A failed trial keeps backing off; a fresh failure starts from the base cooldown
+    if (backend.breaker == HalfOpen) {
+        backend.cooldownMs = qMin(backend.cooldownMs * 2, BREAKER_MAX_COOLDOWN_MS);
+    } else if (backend.breaker == Closed) {
+        qDebug() << "🏥 Backend" << backend.url << "is unhealthy, retrying in" << backend.cooldownMs << "ms";
+    }
+    
+    backend.breaker = Open;
+    const int openCount = ++backend.openCount;
+    const QString url = backend.url;
+    
+    QTimer::singleShot(backend.cooldownMs, this, [this, url, openCount]() {
+        int index = indexOf(url);
+        if (index < 0) {
+            return;
+        }
+        
+        Backend &backend = m_backends[index];
+        if (backend.breaker != Open || backend.openCount != openCount) {
+            return;
+        }
+        
+        backend.breaker = HalfOpen;
+        emit backendsChanged();
+        emit probeRequested(url);
+    });
+}
+
+// ============================================================================
+// Utility Methods
+// ============================================================================
+
+int BackendPool::indexOf(const QString &url) const
+{
+    for (int i = 0; i < m_backends.size(); ++i) {
+        if (m_backends.at(i).url == url) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+double BackendPool::ewma(double average, double sample)
+{
+    return EWMA_ALPHA * sample + (1.0 - EWMA_ALPHA) * average;
+}
@@ -0,0 +1,109 @@
+#ifndef BACKENDPOOL_H
+#define BACKENDPOOL_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVariantList>
+
+/**
+ * @brief Set of interchangeable Whisper backends ranked by observed performance
+ *
+ * Each backend keeps exponentially weighted moving averages of its health
+ * probe round trip, its transcription speed (wall-clock time per second of
+ * audio) and its error rate. select() turns those into the expected time to
+ * transcribe a reference utterance and picks the cheapest healthy backend.
+ *
+ * Every backend sits behind a circuit breaker. A connect failure, a failed
+ * probe or several failed requests in a row open it; after a cooldown it goes
+ * half-open and probeRequested() asks for a single trial probe, which either
+ * closes it or reopens it with twice the cooldown.
+ */
+class BackendPool : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList backends READ backends NOTIFY backendsChanged)
+    Q_PROPERTY(QString preferredBackend READ preferredBackend NOTIFY backendsChanged)
+    Q_PROPERTY(RoutingPolicy routingPolicy READ routingPolicy WRITE setRoutingPolicy NOTIFY routingPolicyChanged)
+    
+public:
+    enum RoutingPolicy {
+        FastestFirst,   // lowest expected completion time, in-flight work included
+        LeastLoaded     // fewest requests in flight, ties broken by speed
+    };
+    Q_ENUM(RoutingPolicy)
+    
+    enum BreakerState {
+        Closed,     // healthy, receives traffic
+        Open,       // failing, no traffic until the cooldown expires
+        HalfOpen    // cooldown over, waiting for a trial probe
+    };
+    Q_ENUM(BreakerState)
+    
+    explicit BackendPool(QObject *parent = nullptr);
+    
+    // Membership
+    QStringList urls() const;
+    void setUrls(const QStringList &urls);
+    static QStringList normalize(const QStringList &urls); // trimmed, no trailing '/', blanks dropped
+    int size() const { return m_backends.size(); }
+    bool contains(const QString &url) const { return indexOf(url) >= 0; }
+    bool hasHealthyBackend() const;
+    BreakerState breakerState(const QString &url) const;
+    double msPerAudioSecond(const QString &url) const; // -1 until a transcription succeeded
+    
+    // Routing
+    RoutingPolicy routingPolicy() const { return m_routingPolicy; }
+    void setRoutingPolicy(RoutingPolicy policy);
+    QString select(const QStringList &exclude = QStringList()) const;
+    QString preferredBackend() const { return select(); }
+    
+    // Observations
+    void requestStarted(const QString &url);
+    void requestFinished(const QString &url, bool succeeded, qint64 wallMs, qint64 audioMs);
+    void requestCancelled(const QString &url);
+    void connectFailed(const QString &url);
+    void recordProbe(const QString &url, bool healthy, qint64 latencyMs);
+    
+    // Snapshot for QML: one map per backend
+    QVariantList backends() const;
+    
+signals:
+    void backendsChanged();
+    void routingPolicyChanged();
+    void probeRequested(const QString &url);
+    
+private:
+    struct Backend {
+        QString url;
+        BreakerState breaker = Closed; // optimistic until a probe or request says otherwise
+        int consecutiveFailures = 0;
+        int cooldownMs = BREAKER_BASE_COOLDOWN_MS;
+        int openCount = 0; // identifies the cooldown timer of the current opening
+        double latencyMs = -1.0;      // probe round trip, -1 until measured
+        double msPerAudioSecond = -1.0; // transcription wall time per second of audio
+        double errorRate = 0.0;
+        int inFlight = 0;
+        int requests = 0;
+        int errors = 0;
+    };
+    
+    int indexOf(const QString &url) const;
+    double expectedCostMs(const Backend &backend) const;
+    static double ewma(double average, double sample);
+    void closeBreaker(Backend &backend);
+    void openBreaker(Backend &backend);
+    
+    QList<Backend> m_backends;
+    RoutingPolicy m_routingPolicy;
+    
+    static constexpr double EWMA_ALPHA = 0.3;
+    static constexpr double REFERENCE_AUDIO_SECONDS = 3.0; // typical voice command
+    static constexpr double ERROR_PENALTY = 4.0; // cost multiplier at 100% errors
+    static constexpr int BREAKER_FAILURE_THRESHOLD = 3; // failed requests in a row
+    static constexpr int BREAKER_BASE_COOLDOWN_MS = 500;
+    static constexpr int BREAKER_MAX_COOLDOWN_MS = 30000;
+};
+
+#endif // BACKENDPOOL_H
@@ -0,0 +1,352 @@
+#include "formantsynth.h"
+#include <QVector>
+#include <cmath>
+
+namespace {
+    
+constexpr float TWO_PI = 6.28318530718f;
+constexpr int WORD_GAP_MS = 35;
+constexpr int CLAUSE_PAUSE_MS = 180;
+constexpr int SENTENCE_PAUSE_MS = 320;
+constexpr int BURST_MS = 15;
+constexpr int COEFFICIENT_INTERVAL = 32; // samples between formant updates
+constexpr float TRANSITION = 0.3f;       // share of a phone spent gliding into it
+constexpr float OPEN_QUOTIENT = 0.4f;    // share of a glottal period the glottis is open
+constexpr float NOISE_GAIN = 0.015f;     // frication against the voiced path's resonance gain
+constexpr float PEAK = 0.7f * 32767.0f;
+    
+// Two-pole resonator, unity gain at DC (Klatt 1980)
+struct Resonator {
+    float a = 0, b = 0, c = 0;
+    float y1 = 0, y2 = 0;
+        
+    void set(float hz, float bandwidth, int sampleRate)
+    {
+        const float t = 1.0f / sampleRate;
+        c = -std::exp(-TWO_PI * bandwidth * t);
+        b = 2.0f * std::exp(-TWO_PI / 2 * bandwidth * t) * std::cos(TWO_PI * hz * t);
+        a = 1.0f - b - c;
+    }
+        
+    float step(float x)
+    {
+        const float y = a * x + b * y1 + c * y2;
+        y2 = y1;
+        y1 = y;
+        return y;
+    }
+};
+    
+} // namespace
+
+FormantSynth::FormantSynth(int sampleRate)
+    : m_sampleRate(sampleRate)
+    , m_pitchHz(DEFAULT_PITCH_HZ)
+    , m_rate(1.0f)
+{
+}
+
+float FormantSynth::pitchForVoice(const QString &voice)
+{
+    if (voice.startsWith("female")) {
+        return 210.0f;
+    }
+    if (voice.startsWith("male")) {
+        return 110.0f;
+    }
+    return DEFAULT_PITCH_HZ;
+}
+
+// ============================================================================
+// Letters to Phones
+// ============================================================================
+
+FormantSynth::Phone FormantSynth::pause(int ms, bool sentenceEnd)
+{
+    Phone phone;
+    phone.ms = ms;
+    phone.sentenceEnd = sentenceEnd;
+    return phone;
+}
+
+bool FormantSynth::vowelPhone(const QString &grapheme, Phone &phone)
+{
+    struct Vowel { const char *grapheme; float f1, f2, f3; int ms; };
+    static const Vowel vowels[] = {
+        {"a", 730, 1090, 2440, 110},
+        {"e", 530, 1840, 2480, 90},
+        {"i", 400, 1920, 2560, 85},
+        {"o", 570, 840, 2410, 110},
+        {"u", 440, 1020, 2240, 95},
+        {"y", 400, 1920, 2560, 85},
+        {"ee", 270, 2290, 3010, 140},
+        {"ea", 270, 2290, 3010, 140},
+        {"oo", 300, 870, 2240, 140},
+        {"ou", 640, 1190, 2390, 140},
+        {"ai", 530, 1840, 2480, 140},
+        {"ay", 530, 1840, 2480, 140},
+    };
+    for (const Vowel &vowel : vowels) {
+        if (grapheme == QLatin1String(vowel.grapheme)) {
+            phone = Phone();
+            phone.f1 = vowel.f1;
+            phone.f2 = vowel.f2;
+            phone.f3 = vowel.f3;
+            phone.voicing = 1.0f;
+            phone.ms = vowel.ms;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FormantSynth::consonantPhone(const QString &grapheme, Phone &phone)
+{
+    struct Consonant { const char *grapheme; float f1, f2, f3, voicing, noise, noiseHz; int ms; bool burst; };
+    static const Consonant consonants[] = {
+        // Sonorants: voiced, formants of their own
+        {"l", 360, 1300, 2700, 0.8f, 0, 0, 70, false},
+        {"r", 420, 1300, 1600, 0.8f, 0, 0, 70, false},
+        {"m", 280, 1000, 2200, 0.6f, 0, 0, 75, false},
+        {"n", 280, 1700, 2600, 0.6f, 0, 0, 70, false},
+        {"ng", 280, 2300, 2750, 0.6f, 0, 0, 80, false},
+        {"w", 300, 610, 2200, 0.8f, 0, 0, 60, false},
+        {"wh", 300, 610, 2200, 0.6f, 0.2f, 1200, 70, false},
+        {"j", 280, 2250, 2900, 0.8f, 0, 0, 60, false},
+        // Fricatives: noise in a band, voiced ones over a quiet buzz
+        {"s", 0, 0, 0, 0, 1.0f, 5500, 100, false},
+        {"z", 0, 0, 0, 0.5f, 0.6f, 5500, 90, false},
+        {"sh", 0, 0, 0, 0, 1.0f, 2800, 110, false},
+        {"f", 0, 0, 0, 0, 0.4f, 6500, 90, false},
+        {"ph", 0, 0, 0, 0, 0.4f, 6500, 90, false},
+        {"v", 0, 0, 0, 0.5f, 0.3f, 6500, 80, false},
+        {"th", 0, 0, 0, 0.2f, 0.35f, 6000, 80, false},
+        {"h", 0, 0, 0, 0, 0.5f, 1500, 60, false},
+        // Stops: a closure, then a burst
+        {"p", 0, 0, 0, 0, 0.6f, 1000, 70, true},
+        {"t", 0, 0, 0, 0, 0.8f, 4000, 70, true},
+        {"k", 0, 0, 0, 0, 0.7f, 2000, 75, true},
+        {"ck", 0, 0, 0, 0, 0.7f, 2000, 75, true},
+        {"b", 0, 0, 0, 0.3f, 0.4f, 1000, 60, true},
+        {"d", 0, 0, 0, 0.3f, 0.5f, 4000, 60, true},
+        {"g", 0, 0, 0, 0.3f, 0.5f, 2000, 65, true},
+    };
+    for (const Consonant &consonant : consonants) {
+        if (grapheme == QLatin1String(consonant.grapheme)) {
+            phone = Phone();
+            phone.f1 = consonant.f1;
+            phone.f2 = consonant.f2;
+            phone.f3 = consonant.f3;
+            phone.voicing = consonant.voicing;
+            phone.noise = consonant.noise;
+            phone.noiseHz = consonant.noiseHz;
+            phone.ms = consonant.ms;
+            phone.burst = consonant.burst;
+            return true;
+        }
+    }
+    return false;
+}
+
+QString FormantSynth::expandDigits(const QString &text)
+{
+    static const char *const names[] = {"zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+    
+    // Said digit by digit: "3.5" is "three point five"
+    QString expanded;
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        const int digit = c.digitValue();
+        if (digit >= 0 && digit <= 9) {
+            expanded += QLatin1Char(' ') + QLatin1String(names[digit]) + QLatin1Char(' ');
+        } else if (c == '.' && i > 0 && i + 1 < text.size() && text.at(i - 1).isDigit() && text.at(i + 1).isDigit()) {
+            expanded += QLatin1String(" point ");
+        } else {
+            expanded += c;
+        }
+    }
+    return expanded;
+}
+
+QList<FormantSynth::Phone> FormantSynth::phonemize(const QString &input)
+{
+    static const char *const digraphs[] = {"sh", "ch", "th", "ph", "wh", "ng", "ck", "qu", "ee", "ea", "oo", "ou", "ai", "ay"};
+    const QString text = expandDigits(input).toLower();
+    
+    QList<Phone> phones;
+    auto add = [&phones](const QString &grapheme) {
+        Phone phone;
+        if (vowelPhone(grapheme, phone) || consonantPhone(grapheme, phone)) {
+            phones.append(phone);
+        }
+    };
+    
+    int i = 0;
+    while (i < text.size()) {
+        const QChar c = text.at(i);
+        if (!c.isLetter()) {
+            const bool sentenceEnd = c == '.' || c == '!' || c == '?';
+            if (sentenceEnd || c == ',' || c == ';' || c == ':') {
+                // The pause replaces the gap after the word
+                if (!phones.isEmpty() && phones.last().ms == WORD_GAP_MS) {
+                    phones.removeLast();
+                }
+                phones.append(pause(sentenceEnd ? SENTENCE_PAUSE_MS : CLAUSE_PAUSE_MS, sentenceEnd));
+            } else if (c.isSpace() && !phones.isEmpty() && phones.last().ms != WORD_GAP_MS) {
+                phones.append(pause(WORD_GAP_MS));
+            }
+            ++i;
+            continue;
+        }
+        
+        const bool wordStart = i == 0 || !text.at(i - 1).isLetter();
+        const bool wordEnd = i + 1 >= text.size() || !text.at(i + 1).isLetter();
+        
+        // A final e after three letters or more is silent: "take", but not "the"
+        if (c == 'e' && wordEnd && i >= 3 && text.at(i - 1).isLetter() && text.at(i - 2).isLetter()
+            && text.at(i - 3).isLetter()) {
+            ++i;
+            continue;
+        }
+        
+        const QString pair = text.mid(i, 2);
+        bool digraph = false;
+        for (const char *candidate : digraphs) {
+            digraph = digraph || pair == QLatin1String(candidate);
+        }
+        if (digraph) {
+            if (pair == "ch") {
+                add("t");
+                add("sh");
+            } else if (pair == "qu") {
+                add("k");
+                add("w");
+            } else {
+                add(pair);
+            }
+            i += 2;
+            continue;
+        }
+        
+        const QChar next = i + 1 < text.size() ? text.at(i + 1) : QChar();
+        if (c == 'c') {
+            add(next == 'e' || next == 'i' || next == 'y' ? "s" : "k");
+        } else if (c == 'x') {
+            add("k");
+            add("s");
+        } else if (c == 'q') {
+            add("k");
+        } else if (c == 'y') {
+            add(wordStart ? "j" : "y");
+        } else {
+            add(QString(c));
+        }
+        ++i;
+    }
+    
+    while (!phones.isEmpty() && phones.last().ms == WORD_GAP_MS) {
+        phones.removeLast();
+    }
+    return phones;
+}
+
+// ============================================================================
+// Rendering
+// ============================================================================
+
+QByteArray FormantSynth::render(const QString &text) const
+{
+    const QList<Phone> phones = phonemize(text);
+    bool audible = false;
+    for (const Phone &phone : phones) {
+        audible = audible || phone.voicing > 0 || phone.noise > 0;
+    }
+    if (!audible) {
+        return QByteArray();
+    }
+    
+    QVector<float> samples;
+    Resonator formants[3];
+    Resonator frication;
+    float current[3] = {500, 1500, 2500};
+    const float bandwidths[3] = {60, 90, 150};
+    float voicing = 0;
+    float noise = 0;
+    float phase = 0;
+    float previousPulse = 0;
+    float declination = 1.1f;
+    quint32 seed = 0x2545F491u; // the same text always renders the same PCM
+    
+    // About 5 ms to move between amplitudes, so phones don't click
+    const float smoothing = 1.0f - std::exp(-1.0f / (0.005f * m_sampleRate));
+    
+    for (const Phone &phone : phones) {
+        const int count = qMax(1, qRound(phone.ms * m_sampleRate / (1000.0f * m_rate)));
+        const int burst = phone.burst ? qMin(count, BURST_MS * m_sampleRate / 1000) : 0;
+        const int glide = qMax(1, int(count * TRANSITION));
+        const float from[3] = {current[0], current[1], current[2]};
+        const float target[3] = {phone.f1 > 0 ? phone.f1 : from[0],
+                                 phone.f2 > 0 ? phone.f2 : from[1],
+                                 phone.f3 > 0 ? phone.f3 : from[2]};
+        if (phone.noise > 0) {
+            frication.set(phone.noiseHz, phone.noiseHz / 3, m_sampleRate);
+        }
+        
+        for (int n = 0; n < count; ++n) {
+            if (n % COEFFICIENT_INTERVAL == 0) {
+                const float t = qMin(1.0f, float(n) / glide);
+                for (int i = 0; i < 3; ++i) {
+                    current[i] = from[i] + (target[i] - from[i]) * t;
+                    formants[i].set(current[i], bandwidths[i], m_sampleRate);
+                }
+            }
+            
+            // A stop is its closure (voiced or silent), then the burst
+            const bool closure = n < count - burst;
+            const float targetVoicing = phone.burst && !closure ? 0 : phone.voicing;
+            const float targetNoise = phone.burst && closure ? 0 : phone.noise;
+            voicing += (targetVoicing - voicing) * smoothing;
+            noise += (targetNoise - noise) * smoothing;
+            
+            // Pitch falls through a sentence, as it does in speech
+            declination = qMax(0.85f, declination - 0.08f / m_sampleRate);
+            phase += m_pitchHz * declination / m_sampleRate;
+            if (phase >= 1.0f) {
+                phase -= 1.0f;
+            }
+            const float pulse = phase < OPEN_QUOTIENT ? 0.5f * (1.0f - std::cos(TWO_PI * phase / OPEN_QUOTIENT)) : 0;
+            const float glottal = (pulse - previousPulse) * voicing;
+            previousPulse = pulse;
+            
+            float voiced = glottal;
+            for (Resonator &formant : formants) {
+                voiced = formant.step(voiced);
+            }
+            
+            seed = seed * 1664525u + 1013904223u;
+            const float white = float(seed >> 8) / float(1 << 23) - 1.0f;
+            const float fricative = noise > 0.001f ? frication.step(white) * noise : 0;
+            samples.append(voiced + fricative * NOISE_GAIN);
+        }
+        
+        for (int i = 0; i < 3; ++i) {
+            current[i] = target[i];
+        }
+        if (phone.sentenceEnd) {
+            declination = 1.1f;
+        }
+    }
+    
+    float peak = 0;
+    for (float sample : samples) {
+        peak = qMax(peak, std::fabs(sample));
+    }
+    const float gain = peak > 0 ? PEAK / peak : 0;
+    
+    QByteArray pcm(samples.size() * int(sizeof(qint16)), Qt::Uninitialized);
+    qint16 *out = reinterpret_cast<qint16 *>(pcm.data());
+    for (int i = 0; i < samples.size(); ++i) {
+        out[i] = qint16(qRound(samples[i] * gain));
+    }
+    return pcm;
+}
@@ -0,0 +1,63 @@
+#ifndef FORMANTSYNTH_H
+#define FORMANTSYNTH_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Small rule-based formant synthesizer for in-process speech
+ *
+ * Text is spelled into phones by letter rules (with the common English
+ * digraphs), and each phone is a target for three cascaded formant
+ * resonators driven by a glottal pulse train, plus filtered noise for
+ * fricatives and stop bursts. Formants glide between targets, so words come
+ * out continuous rather than as beeps. It sounds robotic, but it needs no
+ * model files, starts in microseconds and renders a sentence in a few
+ * milliseconds on a Pi, which is what a prompt like "Turn left." needs.
+ *
+ * render() returns 16-bit mono PCM at sampleRate(), peak-normalized. It is
+ * const and reentrant, so one synthesizer can render on a worker thread.
+ */
+class FormantSynth
+{
+public:
+    explicit FormantSynth(int sampleRate = DEFAULT_SAMPLE_RATE);
+    
+    void setPitch(float hz) { m_pitchHz = qBound(60.0f, hz, 400.0f); }
+    void setRate(float rate) { m_rate = qBound(0.5f, rate, 2.0f); }
+    float pitch() const { return m_pitchHz; }
+    float rate() const { return m_rate; }
+    int sampleRate() const { return m_sampleRate; }
+    
+    QByteArray render(const QString &text) const;
+    
+    // Voice names as TTSEngine lists them; anything else gets the default
+    static float pitchForVoice(const QString &voice);
+    
+    static constexpr int DEFAULT_SAMPLE_RATE = 16000;
+    static constexpr float DEFAULT_PITCH_HZ = 130.0f;
+    
+private:
+    struct Phone {
+        float f1 = 0, f2 = 0, f3 = 0; // formant targets, Hz; 0 keeps the previous ones
+        float voicing = 0;            // glottal source amplitude
+        float noise = 0;              // frication amplitude
+        float noiseHz = 0;            // centre of the frication band, 0 for broadband
+        int ms = 0;                   // at rate 1
+        bool burst = false;           // a stop: closure, then the noise as a short burst
+        bool sentenceEnd = false;     // pitch is reset after it
+    };
+    
+    static QList<Phone> phonemize(const QString &text);
+    static QString expandDigits(const QString &text);
+    static bool vowelPhone(const QString &grapheme, Phone &phone);
+    static bool consonantPhone(const QString &grapheme, Phone &phone);
+    static Phone pause(int ms, bool sentenceEnd = false);
+    
+    int m_sampleRate;
+    float m_pitchHz;
+    float m_rate;
+};
+
+#endif // FORMANTSYNTH_H
@@ -0,0 +1,345 @@
+#include "historylog.h"
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+static const char LOG_MAGIC[4] = {'H', 'L', 'O', 'G'};
+static const char INDEX_MAGIC[4] = {'H', 'I', 'D', 'X'};
+static const char REMOVED_MAGIC[4] = {'H', 'D', 'E', 'L'};
+static const quint16 HISTORY_VERSION = 1;
+static const int INDEX_ENTRY_BYTES = 12; // id, offset
+static const int REMOVED_ENTRY_BYTES = 4;
+
+// Opens (creating if need be) a file that starts with the given magic; one
+// with a different header is from another build, and is started afresh
+static bool openWithHeader(QFile &file, const char magic[4])
+{
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+        qWarning() << "⚠️ Cannot open history file" << file.fileName() << file.errorString();
+        return false;
+    }
+    
+    char header[HistoryLog::HEADER_BYTES];
+    const bool valid = file.read(header, HistoryLog::HEADER_BYTES) == HistoryLog::HEADER_BYTES &&
+                       memcmp(header, magic, 4) == 0 &&
+                       qFromLittleEndian<quint16>(header + 4) == HISTORY_VERSION;
+    if (valid) {
+        return true;
+    }
+    
+    if (file.size() > 0) {
+        qWarning() << "⚠️ Discarding unreadable history file" << file.fileName();
+    }
+    memcpy(header, magic, 4);
+    qToLittleEndian<quint16>(HISTORY_VERSION, header + 4);
+    qToLittleEndian<quint16>(0, header + 6);
+    return file.resize(0) && file.seek(0) && file.write(header, HistoryLog::HEADER_BYTES) == HistoryLog::HEADER_BYTES;
+}
+
+HistoryLog::HistoryLog(const QString &directory)
+    : m_directory(directory)
+    , m_open(false)
+    , m_firstId(0)
+    , m_lastId(0)
+    , m_count(0)
+    , m_records(0)
+    , m_end(HEADER_BYTES)
+{
+    // One writer keeps records in order and off the GUI thread
+    m_writer.setMaxThreadCount(1);
+    
+    if (!QDir().mkpath(m_directory)) {
+        qWarning() << "⚠️ History directory unavailable:" << m_directory;
+        return;
+    }
+    m_open = openFiles();
+}
+
+HistoryLog::~HistoryLog()
+{
+    flush();
+}
+
+bool HistoryLog::openFiles()
+{
+    const QDir dir(m_directory);
+    m_log.setFileName(dir.filePath("history.log"));
+    m_index.setFileName(dir.filePath("history.idx"));
+    m_removedFile.setFileName(dir.filePath("history.del"));
+    if (!openWithHeader(m_log, LOG_MAGIC) || !openWithHeader(m_index, INDEX_MAGIC) ||
+        !openWithHeader(m_removedFile, REMOVED_MAGIC)) {
+        return false;
+    }
+    
+    // Deletions: as many as the user made, not as long as the history is
+    const QByteArray removed = m_removedFile.readAll();
+    for (qsizetype i = 0; i + REMOVED_ENTRY_BYTES <= removed.size(); i += REMOVED_ENTRY_BYTES) {
+        m_removed.insert(qFromLittleEndian<qint32>(removed.constData() + i));
+    }
+    
+    // The index, as far as it is consistent with the log
+    const qint64 logSize = m_log.size();
+    const QByteArray index = m_index.readAll();
+    for (qsizetype i = 0; i + INDEX_ENTRY_BYTES <= index.size(); i += INDEX_ENTRY_BYTES) {
+        const IndexEntry entry{qFromLittleEndian<qint32>(index.constData() + i),
+                               qFromLittleEndian<qint64>(index.constData() + i + 4)};
+        const bool ordered = m_entries.isEmpty() ||
+                             (entry.firstId > m_entries.last().firstId && entry.offset > m_entries.last().offset);
+        if (!ordered || entry.offset < HEADER_BYTES || entry.offset >= logSize) {
+            break;
+        }
+        m_entries.append(entry);
+    }
+    
+    if (!recover()) {
+        return false;
+    }
+    
+    m_firstId = m_entries.isEmpty() ? 0 : m_entries.first().firstId;
+    m_count = qMax<qint64>(0, m_records - m_removed.size());
+    qDebug() << "📜 History opened:" << m_records << "record(s)," << m_entries.size() << "index entries,"
+             << m_removed.size() << "deleted";
+    return true;
+}
+
+bool HistoryLog::recover()
+{
+    // Only the records after the last index entry are read; without an index
+    // (first run or a lost file) that is the whole log, once
+    const qint64 logSize = m_log.size();
+    forever {
+        const qint64 start = m_entries.isEmpty() ? HEADER_BYTES : m_entries.last().offset;
+        const qint64 indexed = qMax<qint64>(0, m_entries.size() - 1) * INDEX_INTERVAL; // before start
+        qint64 records = 0;
+        qint64 position = start;
+        int previousId = 0;
+        bool entryMatches = true;
+        QList<IndexEntry> added;
+        
+        while (position + RECORD_HEADER_BYTES <= logSize) {
+            char header[RECORD_HEADER_BYTES];
+            if (!m_log.seek(position) || m_log.read(header, RECORD_HEADER_BYTES) != RECORD_HEADER_BYTES) {
+                break;
+            }
+            const quint32 length = qFromLittleEndian<quint32>(header);
+            const int id = qFromLittleEndian<qint32>(header + 4);
+            if (length < RECORD_HEADER_BYTES - 4 || length > MAX_RECORD_BYTES || position + 4 + length > logSize ||
+                id <= previousId) {
+                break;
+            }
+            if (records == 0 && !m_entries.isEmpty() && id != m_entries.last().firstId) {
+                entryMatches = false;
+                break;
+            }
+            
+            if ((indexed + records) % INDEX_INTERVAL == 0 && (m_entries.isEmpty() || records > 0)) {
+                added.append({id, position});
+            }
+            previousId = id;
+            position += 4 + length;
+            ++records;
+        }
+        
+        // An index entry written ahead of a record the log lost
+        if (!entryMatches || (records == 0 && !m_entries.isEmpty())) {
+            m_entries.removeLast();
+            continue;
+        }
+        
+        m_entries += added;
+        m_records = indexed + records;
+        m_end = position;
+        m_lastId = previousId;
+        break;
+    }
+    
+    if (m_end < logSize) {
+        qWarning() << "⚠️ History log cut short at" << m_end << "of" << logSize << "bytes; dropping the rest";
+        if (!m_log.resize(m_end)) {
+            return false;
+        }
+    }
+    
+    // Rewritten in full: it is a few bytes per INDEX_INTERVAL records
+    QByteArray index(m_entries.size() * INDEX_ENTRY_BYTES, Qt::Uninitialized);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        qToLittleEndian<qint32>(m_entries.at(i).firstId, index.data() + i * INDEX_ENTRY_BYTES);
+        qToLittleEndian<qint64>(m_entries.at(i).offset, index.data() + i * INDEX_ENTRY_BYTES + 4);
+    }
+    return m_index.resize(HEADER_BYTES) && m_index.seek(HEADER_BYTES) && m_index.write(index) == index.size();
+}
+
+void HistoryLog::append(const TranscriptionItem &item)
+{
+    if (!m_open) {
+        return;
+    }
+    
+    m_lastId = item.id;
+    if (m_firstId == 0) {
+        m_firstId = item.id;
+    }
+    ++m_count;
+    m_writer.start([this, item]() {
+        QMutexLocker locker(&m_mutex);
+        writeRecord(item);
+    });
+}
+
+void HistoryLog::remove(int id)
+{
+    if (!m_open) {
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_removed.contains(id)) {
+            return;
+        }
+        m_removed.insert(id);
+    }
+    m_count = qMax<qint64>(0, m_count - 1);
+    
+    m_writer.start([this, id]() {
+        char entry[REMOVED_ENTRY_BYTES];
+        qToLittleEndian<qint32>(id, entry);
+        
+        QMutexLocker locker(&m_mutex);
+        if (!m_removedFile.seek(m_removedFile.size()) ||
+            m_removedFile.write(entry, REMOVED_ENTRY_BYTES) != REMOVED_ENTRY_BYTES) {
+            qWarning() << "⚠️ Failed to record deleted transcription" << id << m_removedFile.errorString();
+        }
+    });
+}
+
+void HistoryLog::clear()
+{
+    if (!m_open) {
+        return;
+    }
+    
+    m_firstId = 0;
+    m_count = 0;
+    {
+        // Now, so a removal made before the files are emptied isn't lost with them
+        QMutexLocker locker(&m_mutex);
+        m_removed.clear();
+    }
+    m_writer.start([this]() {
+        QMutexLocker locker(&m_mutex);
+        clearFiles();
+    });
+}
+
+void HistoryLog::flush()
+{
+    m_writer.waitForDone();
+}
+
+void HistoryLog::post(const std::function<void()> &task)
+{
+    m_writer.start(task);
+}
+
+void HistoryLog::writeRecord(const TranscriptionItem &item)
+{
+    const QByteArray text = item.text.toUtf8().left(MAX_RECORD_BYTES - (RECORD_HEADER_BYTES - 4));
+    QByteArray record(RECORD_HEADER_BYTES, Qt::Uninitialized);
+    qToLittleEndian<quint32>(quint32(RECORD_HEADER_BYTES - 4 + text.size()), record.data());
+    qToLittleEndian<qint32>(item.id, record.data() + 4);
+    qToLittleEndian<qint64>(item.timestamp.toMSecsSinceEpoch(), record.data() + 8);
+    record += text;
+    
+    if (!m_log.seek(m_end) || m_log.write(record) != record.size()) {
+        qWarning() << "⚠️ Failed to append to history" << m_log.fileName() << m_log.errorString();
+        return;
+    }
+    
+    // The record is in the log before the index points at it
+    if (m_records % INDEX_INTERVAL == 0) {
+        char entry[INDEX_ENTRY_BYTES];
+        qToLittleEndian<qint32>(item.id, entry);
+        qToLittleEndian<qint64>(m_end, entry + 4);
+        if (!m_index.seek(m_index.size()) || m_index.write(entry, INDEX_ENTRY_BYTES) != INDEX_ENTRY_BYTES) {
+            qWarning() << "⚠️ Failed to update history index" << m_index.errorString();
+        }
+        m_entries.append({item.id, m_end});
+    }
+    m_end += record.size();
+    ++m_records;
+}
+
+void HistoryLog::clearFiles()
+{
+    if (!m_log.resize(HEADER_BYTES) || !m_index.resize(HEADER_BYTES) || !m_removedFile.resize(HEADER_BYTES)) {
+        qWarning() << "⚠️ Failed to clear history in" << m_directory;
+    }
+    m_entries.clear();
+    m_records = 0;
+    m_end = HEADER_BYTES;
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+QList<TranscriptionItem> HistoryLog::readBefore(int beforeId, int count, int *reachedId)
+{
+    QList<TranscriptionItem> page;
+    *reachedId = beforeId;
+    if (!m_open || count <= 0) {
+        return page;
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    
+    // The block holding the newest record below beforeId, then older blocks
+    const auto after = std::lower_bound(m_entries.cbegin(), m_entries.cend(), beforeId,
+                                        [](const IndexEntry &entry, int id) { return entry.firstId < id; });
+    for (int block = int(after - m_entries.cbegin()) - 1; block >= 0 && page.size() < count; --block) {
+        const QList<TranscriptionItem> records = readBlock(block);
+        for (auto it = records.crbegin(); it != records.crend() && page.size() < count; ++it) {
+            if (it->id >= beforeId) {
+                continue;
+            }
+            *reachedId = it->id;
+            if (!m_removed.contains(it->id)) {
+                page.append(*it);
+            }
+        }
+    }
+    return page;
+}
+
+QList<TranscriptionItem> HistoryLog::readBlock(int block)
+{
+    QList<TranscriptionItem> records;
+    const qint64 start = m_entries.at(block).offset;
+    const qint64 end = block + 1 < m_entries.size() ? m_entries.at(block + 1).offset : m_end;
+    if (!m_log.seek(start)) {
+        return records;
+    }
+    const QByteArray data = m_log.read(end - start);
+    
+    records.reserve(INDEX_INTERVAL);
+    qsizetype position = 0;
+    while (position + RECORD_HEADER_BYTES <= data.size()) {
+        const char *record = data.constData() + position;
+        const qsizetype length = qFromLittleEndian<quint32>(record);
+        if (length < RECORD_HEADER_BYTES - 4 || position + 4 + length > data.size()) {
+            break;
+        }
+        
+        TranscriptionItem item;
+        item.id = qFromLittleEndian<qint32>(record + 4);
+        item.timestamp = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(record + 8));
+        item.text = QString::fromUtf8(record + RECORD_HEADER_BYTES, length - (RECORD_HEADER_BYTES - 4));
+        records.append(item);
+        position += 4 + length;
+    }
+    return records;
+}
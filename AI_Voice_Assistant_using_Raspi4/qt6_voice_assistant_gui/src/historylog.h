@@ -0,0 +1,90 @@
+#ifndef HISTORYLOG_H
+#define HISTORYLOG_H
+
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <functional>
+#include "transcriptionstore.h"
+
+/**
+ * @brief Transcription history on disk, appended to and read a page at a time
+ *
+ * history.log holds one length-prefixed record per transcription, in id
+ * order, and is only ever appended to. history.idx is a sparse index: the id
+ * and offset of every INDEX_INTERVAL-th record. Opening the log reads the
+ * index and the records after its last entry, so it costs the same with a
+ * week of history as with a year. A page older than a given id is found by a
+ * binary search of the index and read one block of records at a time.
+ *
+ * Deletions are appended to history.del and skipped when reading; clear()
+ * empties all three. Writes go to a single writer thread in the order they
+ * were made, and so do reads posted with post(): one there sees every record
+ * appended before it without the caller waiting. readBefore() called
+ * directly sees what has been written so far, all of it after flush(), which
+ * blocks until the writer is done. A record cut short by a crash is dropped
+ * the next time the log is opened.
+ */
+class HistoryLog
+{
+public:
+    explicit HistoryLog(const QString &directory);
+    ~HistoryLog();
+    
+    bool isOpen() const { return m_open; }
+    QString directory() const { return m_directory; }
+    
+    int firstId() const { return m_firstId; } // oldest id stored, 0 when empty
+    int lastId() const { return m_lastId; }   // highest id appended, 0 before any
+    qint64 count() const { return m_count; }  // records not deleted
+    
+    void append(const TranscriptionItem &item); // ids must increase
+    void remove(int id);
+    void clear();
+    void flush();
+    void post(const std::function<void()> &task); // on the writer thread, after the writes so far
+    
+    // Up to count records with ids below beforeId, newest first. *reachedId
+    // is the oldest id looked at, deleted or not: the next page is below it.
+    QList<TranscriptionItem> readBefore(int beforeId, int count, int *reachedId);
+    
+    static constexpr int INDEX_INTERVAL = 256;
+    static constexpr int HEADER_BYTES = 8;
+    static constexpr int RECORD_HEADER_BYTES = 16;      // length, id, timestamp
+    static constexpr int MAX_RECORD_BYTES = 64 * 1024;  // longer is taken as corruption
+    
+private:
+    struct IndexEntry {
+        int firstId;
+        qint64 offset;
+    };
+    
+    bool openFiles();
+    bool recover();
+    void writeRecord(const TranscriptionItem &item);
+    void clearFiles();
+    QList<TranscriptionItem> readBlock(int block);
+    
+    QString m_directory;
+    bool m_open;
+    int m_firstId;
+    int m_lastId;
+    qint64 m_count;
+    
+    // Shared with the writer thread
+    mutable QMutex m_mutex;
+    QFile m_log;
+    QFile m_index;
+    QFile m_removedFile;
+    QList<IndexEntry> m_entries;
+    qint64 m_records;    // written so far
+    qint64 m_end;        // where the next record goes
+    QSet<int> m_removed; // deleted ids, as soon as they are
+    
+    QThreadPool m_writer;
+};
+
+#endif // HISTORYLOG_H
@@ -0,0 +1,527 @@
+#include "httpstreamrequest.h"
+#include <QTcpSocket>
+#include <QSslSocket>
+#include <QLocalSocket>
+#include <QScopedValueRollback>
+#include <QTimer>
+#include <QDebug>
+
+HttpStreamRequest::HttpStreamRequest(const QUrl &url, QObject *parent)
+    : QObject(parent)
+    , m_url(url)
+    , m_method("POST")
+    , m_device(nullptr)
+    , m_socket(nullptr)
+    , m_localSocket(nullptr)
+    , m_state(Idle)
+    , m_chunked(true)
+    , m_finishRequested(false)
+    , m_starting(false)
+    , m_bodyBytesSent(0)
+    , m_connectMs(-1)
+    , m_headParsed(false)
+    , m_statusCode(0)
+    , m_contentLength(-1)
+    , m_chunkedResponse(false)
+    , m_deadlineTimer(nullptr)
+    , m_deadlineExpired(false)
+{
+}
+
+HttpStreamRequest::~HttpStreamRequest()
+{
+    if (m_device) {
+        closeTransport(false);
+    }
+}
+
+void HttpStreamRequest::setRawHeader(const QByteArray &name, const QByteArray &value)
+{
+    m_headers.append(qMakePair(name, value));
+}
+
+void HttpStreamRequest::ignoreSslErrors(const QList<QSslError> &errors)
+{
+    if (QSslSocket *sslSocket = qobject_cast<QSslSocket*>(m_socket)) {
+        sslSocket->ignoreSslErrors(errors);
+    }
+}
+
+QByteArray HttpStreamRequest::responseHeader(const QByteArray &name) const
+{
+    for (const auto &header : m_responseHeaders) {
+        if (header.first.compare(name, Qt::CaseInsensitive) == 0) {
+            return header.second;
+        }
+    }
+    return QByteArray();
+}
+
+bool HttpStreamRequest::splitLocalUrl(const QUrl &url, QString *socketPath, QByteArray *requestPath)
+{
+    if (url.scheme() != "unix") {
+        return false;
+    }
+
+    const QString path = url.path();
+    int end = path.indexOf(".sock/");
+    if (end >= 0) {
+        end += 5;
+    } else if (path.endsWith(".sock")) {
+        end = path.size();
+    } else {
+        return false;
+    }
+
+    *socketPath = path.left(end);
+    *requestPath = QUrl::toPercentEncoding(path.mid(end), "/");
+    if (requestPath->isEmpty()) {
+        *requestPath = "/";
+    }
+    if (url.hasQuery()) {
+        *requestPath += '?' + url.query(QUrl::FullyEncoded).toLatin1();
+    }
+    return true;
+}
+
+QList<QByteArray> HttpStreamRequest::takeUnsentBody()
+{
+    QList<QByteArray> body;
+    body.swap(m_pending);
+    return body;
+}
+
+// ============================================================================
+// Request Lifecycle
+// ============================================================================
+
+void HttpStreamRequest::start()
+{
+    if (m_state != Idle) {
+        return;
+    }
+
+    // A local socket with no server behind it fails inside connectToServer()
+    QScopedValueRollback<bool> starting(m_starting, true);
+
+    if (m_url.scheme() == "unix") {
+        connectLocal();
+        return;
+    }
+
+    const bool secure = m_url.scheme() == "https";
+    const quint16 port = m_url.port(secure ? 443 : 80);
+
+    if (secure) {
+        QSslSocket *sslSocket = new QSslSocket(this);
+        m_socket = sslSocket;
+        if (!m_sslConfiguration.isNull()) {
+            sslSocket->setSslConfiguration(m_sslConfiguration);
+        }
+        connect(sslSocket, &QSslSocket::encrypted, this, &HttpStreamRequest::onConnected);
+        connect(sslSocket, &QSslSocket::sslErrors, this, &HttpStreamRequest::sslErrors);
+    } else {
+        m_socket = new QTcpSocket(this);
+        connect(m_socket, &QTcpSocket::connected, this, &HttpStreamRequest::onConnected);
+    }
+
+    // Audio frames are small; don't let Nagle hold them back
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+    connect(m_socket, &QTcpSocket::readyRead, this, &HttpStreamRequest::onReadyRead);
+    connect(m_socket, &QTcpSocket::disconnected, this, &HttpStreamRequest::onDisconnected);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, &HttpStreamRequest::onSocketError);
+
+    m_device = m_socket;
+    m_state = Connecting;
+    m_timer.start();
+
+    if (secure) {
+        static_cast<QSslSocket*>(m_socket)->connectToHostEncrypted(m_url.host(), port);
+    } else {
+        m_socket->connectToHost(m_url.host(), port);
+    }
+}
+
+void HttpStreamRequest::connectLocal()
+{
+    QString socketPath;
+    QByteArray requestPath;
+    m_timer.start();
+
+    if (!splitLocalUrl(m_url, &socketPath, &requestPath)) {
+        m_state = Connecting;
+        fail(QString("No .sock path in %1").arg(m_url.toString()));
+        return;
+    }
+
+    m_localSocket = new QLocalSocket(this);
+    m_device = m_localSocket;
+
+    connect(m_localSocket, &QLocalSocket::connected, this, &HttpStreamRequest::onConnected);
+    connect(m_localSocket, &QLocalSocket::readyRead, this, &HttpStreamRequest::onReadyRead);
+    connect(m_localSocket, &QLocalSocket::disconnected, this, &HttpStreamRequest::onDisconnected);
+    connect(m_localSocket, &QLocalSocket::errorOccurred, this, &HttpStreamRequest::onSocketError);
+
+    m_state = Connecting;
+    m_localSocket->connectToServer(socketPath);
+}
+
+void HttpStreamRequest::send(const QByteArray &body)
+{
+    if (m_state != Idle) {
+        return;
+    }
+
+    m_chunked = false;
+    m_fixedBody = body;
+    m_finishRequested = true;
+    start();
+}
+
+void HttpStreamRequest::write(const QByteArray &data)
+{
+    if (data.isEmpty() || m_finishRequested) {
+        return;
+    }
+
+    if (m_state == Sending) {
+        sendChunk(data);
+    } else if (m_connectMs < 0) {
+        // Not connected yet, or never will be: kept for takeUnsentBody()
+        m_pending.append(data);
+    }
+}
+
+void HttpStreamRequest::finish()
+{
+    if (m_finishRequested) {
+        return;
+    }
+
+    m_finishRequested = true;
+
+    if (m_state == Sending) {
+        // Zero-length chunk terminates the body
+        m_device->write("0\r\n\r\n");
+        m_state = AwaitingResponse;
+        emit requestSent();
+    }
+}
+
+void HttpStreamRequest::abort()
+{
+    if (m_state == Finished) {
+        return;
+    }
+
+    m_state = Finished;
+    m_pending.clear();
+    closeTransport(false);
+}
+
+void HttpStreamRequest::setDeadline(qint64 ms)
+{
+    if (m_state == Finished) {
+        return;
+    }
+
+    if (!m_deadlineTimer) {
+        m_deadlineTimer = new QTimer(this);
+        m_deadlineTimer->setSingleShot(true);
+        connect(m_deadlineTimer, &QTimer::timeout, this, [this]() {
+            if (m_state == Finished) {
+                return;
+            }
+            m_deadlineExpired = true;
+            fail("Deadline exceeded");
+        });
+    }
+    m_deadlineTimer->start(int(qMax<qint64>(0, ms)));
+}
+
+// ============================================================================
+// Socket Handlers
+// ============================================================================
+
+void HttpStreamRequest::onConnected()
+{
+    if (m_state != Connecting) {
+        return;
+    }
+
+    m_connectMs = m_timer.elapsed();
+    sendRequestHead();
+
+    if (!m_chunked) {
+        sendBody();
+        return;
+    }
+
+    m_state = Sending;
+    flushPending();
+
+    if (m_finishRequested) {
+        m_device->write("0\r\n\r\n");
+        m_state = AwaitingResponse;
+        emit requestSent();
+    }
+}
+
+void HttpStreamRequest::onReadyRead()
+{
+    m_readBuffer.append(m_device->readAll());
+
+    if (!m_headParsed && !parseResponseHead()) {
+        return;
+    }
+
+    if (parseResponseBody()) {
+        complete();
+    }
+}
+
+void HttpStreamRequest::onDisconnected()
+{
+    if (m_state == Finished) {
+        return;
+    }
+
+    // Responses without Content-Length are delimited by connection close
+    if (m_headParsed && m_contentLength < 0 && !m_chunkedResponse) {
+        m_responseBody = m_readBuffer;
+        complete();
+        return;
+    }
+
+    fail("Connection closed before the response was complete");
+}
+
+void HttpStreamRequest::onSocketError()
+{
+    if (m_state == Finished) {
+        return;
+    }
+
+    // A closed peer is reported through onDisconnected()
+    if (m_localSocket) {
+        if (m_localSocket->error() == QLocalSocket::PeerClosedError) {
+            return;
+        }
+    } else if (m_socket->error() == QAbstractSocket::RemoteHostClosedError) {
+        return;
+    }
+
+    fail(m_device->errorString());
+}
+
+void HttpStreamRequest::closeTransport(bool graceful)
+{
+    if (!m_device) {
+        return;
+    }
+
+    disconnect(m_device, nullptr, this, nullptr);
+
+    if (m_localSocket) {
+        if (graceful) {
+            m_localSocket->disconnectFromServer();
+        } else {
+            m_localSocket->abort();
+        }
+    } else if (graceful) {
+        m_socket->disconnectFromHost();
+    } else {
+        m_socket->abort();
+    }
+}
+
+// ============================================================================
+// Request Encoding
+// ============================================================================
+
+void HttpStreamRequest::sendRequestHead()
+{
+    QByteArray path;
+    QByteArray host;
+
+    if (m_localSocket) {
+        QString socketPath;
+        splitLocalUrl(m_url, &socketPath, &path);
+        host = "localhost";
+    } else {
+        path = m_url.path(QUrl::FullyEncoded).toLatin1();
+        if (path.isEmpty()) {
+            path = "/";
+        }
+        if (m_url.hasQuery()) {
+            path += '?' + m_url.query(QUrl::FullyEncoded).toLatin1();
+        }
+
+        host = m_url.host().toLatin1();
+        if (m_url.port() > 0) {
+            host += ':' + QByteArray::number(m_url.port());
+        }
+    }
+
+    QByteArray head;
+    head.reserve(512);
+    head += m_method + ' ' + path + " HTTP/1.1\r\n";
+    head += "Host: " + host + "\r\n";
+    if (m_chunked) {
+        head += "Transfer-Encoding: chunked\r\n";
+    } else if (!m_fixedBody.isEmpty() || m_method != "GET") {
+        head += "Content-Length: " + QByteArray::number(m_fixedBody.size()) + "\r\n";
+    }
+    head += "Connection: close\r\n";
+
+    for (const auto &header : m_headers) {
+        head += header.first + ": " + header.second + "\r\n";
+    }
+    head += "\r\n";
+
+    m_device->write(head);
+}
+
+void HttpStreamRequest::sendBody()
+{
+    m_device->write(m_fixedBody);
+    m_bodyBytesSent = m_fixedBody.size();
+    m_fixedBody.clear();
+    m_state = AwaitingResponse;
+    emit requestSent();
+}
+
+void HttpStreamRequest::sendChunk(const QByteArray &data)
+{
+    m_device->write(QByteArray::number(data.size(), 16) + "\r\n");
+    m_device->write(data);
+    m_device->write("\r\n");
+    m_bodyBytesSent += data.size();
+}
+
+void HttpStreamRequest::flushPending()
+{
+    for (const QByteArray &data : std::as_const(m_pending)) {
+        sendChunk(data);
+    }
+    m_pending.clear();
+}
+
+// ============================================================================
+// Response Parsing
+// ============================================================================
+
+bool HttpStreamRequest::parseResponseHead()
+{
+    int headEnd = m_readBuffer.indexOf("\r\n\r\n");
+    if (headEnd < 0) {
+        return false;
+    }
+
+    const QList<QByteArray> lines = m_readBuffer.left(headEnd).split('\n');
+    m_readBuffer.remove(0, headEnd + 4);
+
+    // Status line: HTTP/1.1 200 OK
+    const QList<QByteArray> statusParts = lines.value(0).trimmed().split(' ');
+    m_statusCode = statusParts.value(1).toInt();
+
+    for (int i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines.at(i).trimmed();
+        int colon = line.indexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+
+        QByteArray name = line.left(colon).trimmed();
+        QByteArray value = line.mid(colon + 1).trimmed();
+        m_responseHeaders.append(qMakePair(name, value));
+
+        if (name.compare("Content-Length", Qt::CaseInsensitive) == 0) {
+            m_contentLength = value.toLongLong();
+        } else if (name.compare("Transfer-Encoding", Qt::CaseInsensitive) == 0) {
+            m_chunkedResponse = value.toLower().contains("chunked");
+        }
+    }
+
+    m_headParsed = true;
+    return true;
+}
+
+bool HttpStreamRequest::parseResponseBody()
+{
+    if (m_chunkedResponse) {
+        forever {
+            int lineEnd = m_readBuffer.indexOf("\r\n");
+            if (lineEnd < 0) {
+                return false;
+            }
+
+            bool ok = false;
+            qint64 chunkSize = m_readBuffer.left(lineEnd).split(';').first().trimmed().toLongLong(&ok, 16);
+            if (!ok) {
+                fail("Malformed chunked response");
+                return false;
+            }
+
+            if (chunkSize == 0) {
+                return true;
+            }
+
+            if (m_readBuffer.size() < lineEnd + 2 + chunkSize + 2) {
+                return false;
+            }
+
+            m_responseBody.append(m_readBuffer.constData() + lineEnd + 2, chunkSize);
+            m_readBuffer.remove(0, lineEnd + 2 + chunkSize + 2);
+        }
+    }
+
+    if (m_contentLength >= 0) {
+        if (m_readBuffer.size() < m_contentLength) {
+            return false;
+        }
+        m_responseBody = m_readBuffer.left(m_contentLength);
+        return true;
+    }
+
+    // Close-delimited body, completed in onDisconnected()
+    return false;
+}
+
+void HttpStreamRequest::complete()
+{
+    if (m_state == Finished) {
+        return;
+    }
+
+    m_state = Finished;
+    m_readBuffer.clear();
+
+    // Session tickets arrive after the handshake; by now they have been read
+    if (QSslSocket *sslSocket = qobject_cast<QSslSocket*>(m_socket)) {
+        m_sslConfiguration = sslSocket->sslConfiguration();
+    }
+    closeTransport(true);
+
+    emit finished();
+}
+
+void HttpStreamRequest::fail(const QString &error)
+{
+    if (m_state == Finished) {
+        return;
+    }
+
+    m_state = Finished;
+    m_errorString = error;
+    closeTransport(false);
+
+    // The caller of start() doesn't know this request's id yet, nor has it
+    // written the body it will want to replay elsewhere
+    if (m_starting) {
+        QMetaObject::invokeMethod(this, [this, error]() { emit errorOccurred(error); }, Qt::QueuedConnection);
+        return;
+    }
+    emit errorOccurred(error);
+}
@@ -0,0 +1,146 @@
+#ifndef HTTPSTREAMREQUEST_H
+#define HTTPSTREAMREQUEST_H
+
+#include <QObject>
+#include <QUrl>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QElapsedTimer>
+#include <QSslConfiguration>
+#include <QSslError>
+
+class QIODevice;
+class QTimer;
+class QTcpSocket;
+class QLocalSocket;
+
+/**
+ * @brief Single HTTP/1.1 POST whose body is produced while the request is in flight
+ *
+ * QNetworkAccessManager buffers sequential upload devices of unknown length
+ * until they reach EOF, so it cannot start sending audio before the user has
+ * stopped speaking. This class speaks just enough HTTP/1.1 to send the body
+ * with chunked transfer encoding and read back a single response.
+ *
+ * unix:// URLs go over a QLocalSocket instead of TCP. The socket path runs up
+ * to the first path segment ending in ".sock" and the rest is the HTTP path,
+ * so unix:///run/whisper.sock/transcribe/raw posts /transcribe/raw to
+ * /run/whisper.sock. Bodies that are known up front can be sent with send(),
+ * which uses Content-Length instead of chunked encoding.
+ */
+class HttpStreamRequest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HttpStreamRequest(const QUrl &url, QObject *parent = nullptr);
+    ~HttpStreamRequest();
+
+    void setRawHeader(const QByteArray &name, const QByteArray &value);
+    void setMethod(const QByteArray &method) { m_method = method; }
+
+    // TLS for https:// URLs; after finished() this is the negotiated configuration
+    void setSslConfiguration(const QSslConfiguration &configuration) { m_sslConfiguration = configuration; }
+    QSslConfiguration sslConfiguration() const { return m_sslConfiguration; }
+    void ignoreSslErrors(const QList<QSslError> &errors);
+
+    // Splits a unix:// URL into socket path and HTTP path
+    static bool splitLocalUrl(const QUrl &url, QString *socketPath, QByteArray *requestPath);
+
+    // Request lifecycle; errors in start() are reported once it has returned
+    void start();
+    void send(const QByteArray &body);
+    void write(const QByteArray &data);
+    void finish();
+    void abort();
+
+    // Fails the request if it hasn't finished within ms from now; may be re-armed
+    void setDeadline(qint64 ms);
+    bool deadlineExpired() const { return m_deadlineExpired; }
+
+    // Response
+    bool isFinished() const { return m_state == Finished; }
+    bool isFinishRequested() const { return m_finishRequested; }
+    int statusCode() const { return m_statusCode; }
+    QByteArray responseBody() const { return m_responseBody; }
+    QByteArray responseHeader(const QByteArray &name) const;
+    QList<QPair<QByteArray, QByteArray>> responseHeaders() const { return m_responseHeaders; }
+    QString errorString() const { return m_errorString; }
+
+    // Statistics
+    qint64 bytesSent() const { return m_bodyBytesSent; }
+    qint64 elapsedMs() const { return m_timer.isValid() ? m_timer.elapsed() : 0; }
+    qint64 connectMs() const { return m_connectMs; } // -1 if the connection never came up
+
+    // Body queued before a connection that failed, for replaying elsewhere
+    QList<QByteArray> takeUnsentBody();
+
+signals:
+    void requestSent();
+    void finished();
+    void errorOccurred(const QString &error);
+    void sslErrors(const QList<QSslError> &errors);
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+    void onSocketError();
+
+private:
+    enum State {
+        Idle,
+        Connecting,
+        Sending,
+        AwaitingResponse,
+        Finished
+    };
+
+    void connectLocal();
+    void closeTransport(bool graceful);
+    void sendRequestHead();
+    void sendBody();
+    void sendChunk(const QByteArray &data);
+    void flushPending();
+    bool parseResponseHead();
+    bool parseResponseBody();
+    void complete();
+    void fail(const QString &error);
+
+    QUrl m_url;
+    QByteArray m_method;
+    QSslConfiguration m_sslConfiguration; // null: Qt's default
+    QIODevice *m_device; // whichever of the two sockets below is in use
+    QTcpSocket *m_socket;
+    QLocalSocket *m_localSocket;
+    State m_state;
+    QList<QPair<QByteArray, QByteArray>> m_headers;
+
+    // Fixed-length body for send(); chunked encoding otherwise
+    bool m_chunked;
+    QByteArray m_fixedBody;
+
+    // Body data written before the socket connected
+    QList<QByteArray> m_pending;
+    bool m_finishRequested;
+    bool m_starting; // inside start(): fail() must not emit yet
+    qint64 m_bodyBytesSent;
+    qint64 m_connectMs;
+
+    // Response parsing state
+    QByteArray m_readBuffer;
+    bool m_headParsed;
+    int m_statusCode;
+    QList<QPair<QByteArray, QByteArray>> m_responseHeaders;
+    qint64 m_contentLength;
+    bool m_chunkedResponse;
+    QByteArray m_responseBody;
+    QString m_errorString;
+
+    QElapsedTimer m_timer;
+    QTimer *m_deadlineTimer; // created by setDeadline()
+    bool m_deadlineExpired;
+};
+
+#endif // HTTPSTREAMREQUEST_H
@@ -0,0 +1,102 @@
+#include "jitterbuffer.h"
+#include <QDebug>
+#include <cmath>
+
+JitterBuffer::JitterBuffer(int bytesPerSecond, double initialJitterMs)
+    : m_bytesPerSecond(qMax(1, bytesPerSecond))
+    , m_bufferedBytes(0)
+    , m_nextSequence(0)
+    , m_highestSequence(-1)
+    , m_finished(false)
+    , m_playing(false)
+    , m_playStartMs(0)
+    , m_releasedBytes(0)
+    , m_jitterMs(qMax(0.0, initialJitterMs))
+    , m_jitterSamples(initialJitterMs < 0 ? 0 : JITTER_SETTLE_FRAMES)
+    , m_lastTransitMs(0.0)
+    , m_hasTransit(false)
+    , m_receivedBytes(0)
+    , m_underruns(0)
+    , m_droppedFrames(0)
+{
+}
+
+qint64 JitterBuffer::unwrap(quint16 sequence) const
+{
+    if (m_highestSequence < 0) {
+        return sequence;
+    }
+    
+    // Nearest to the newest frame, in either direction
+    const qint16 delta = qint16(quint16(sequence - quint16(m_highestSequence)));
+    return m_highestSequence + delta;
+}
+
+void JitterBuffer::push(quint16 sequence, const QByteArray &pcm, qint64 arrivalMs)
+{
+    const qint64 unwrapped = unwrap(sequence);
+    if (m_finished || unwrapped < m_nextSequence || m_frames.contains(unwrapped)) {
+        ++m_droppedFrames;
+        return;
+    }
+    
+    // RFC 3550: J += (|D| - J) / 16, D the change in transit time
+    const double transitMs = arrivalMs - bytesToMs(m_receivedBytes);
+    if (m_hasTransit) {
+        const double difference = std::abs(transitMs - m_lastTransitMs);
+        m_jitterMs += (difference - m_jitterMs) / 16.0;
+        m_jitterSamples = qMin(m_jitterSamples + 1, int(JITTER_SETTLE_FRAMES));
+    }
+    m_lastTransitMs = transitMs;
+    m_hasTransit = true;
+    m_receivedBytes += pcm.size();
+    
+    // Everything released has been heard before this frame came: a gap
+    if (m_playing && arrivalMs > m_playStartMs + qint64(bytesToMs(m_releasedBytes))) {
+        ++m_underruns;
+        m_playing = false;
+        qDebug() << "🕳️ Jitter buffer underrun" << m_underruns << "- rebuffering to" << targetDelayMs() << "ms";
+    }
+    
+    m_highestSequence = qMax(m_highestSequence, unwrapped);
+    m_frames.insert(unwrapped, pcm);
+    m_bufferedBytes += pcm.size();
+}
+
+void JitterBuffer::finish()
+{
+    m_finished = true;
+}
+
+QByteArray JitterBuffer::take(qint64 nowMs)
+{
+    if (!m_playing) {
+        if (m_frames.isEmpty() || (!m_finished && bufferedMs() < targetDelayMs())) {
+            return QByteArray();
+        }
+        m_playing = true;
+        m_playStartMs = nowMs;
+        m_releasedBytes = 0;
+    }
+    
+    QByteArray released;
+    while (!m_frames.isEmpty()) {
+        auto first = m_frames.begin();
+        // A frame is missing; wait for it while there is little behind it
+        if (first.key() != m_nextSequence && !m_finished && bufferedMs() < targetDelayMs()) {
+            break;
+        }
+        released += first.value();
+        m_bufferedBytes -= first.value().size();
+        m_nextSequence = first.key() + 1;
+        m_frames.erase(first);
+    }
+    m_releasedBytes += released.size();
+    return released;
+}
+
+int JitterBuffer::targetDelayMs() const
+{
+    const double base = hasJitterEstimate() ? JITTER_MULTIPLE * m_jitterMs : DEFAULT_DELAY_MS;
+    return qBound(MIN_DELAY_MS, int(std::ceil(base)) + m_underruns * UNDERRUN_STEP_MS, MAX_DELAY_MS);
+}
@@ -0,0 +1,79 @@
+#ifndef JITTERBUFFER_H
+#define JITTERBUFFER_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QtGlobal>
+
+/**
+ * @brief Playout buffer for speech streamed over the network
+ *
+ * Frames of one stream are pushed as they arrive, with their sequence
+ * number and arrival time, and take() hands back what may be played: nothing
+ * until targetDelayMs() of audio is buffered, then everything in sequence
+ * order as it comes in. Releasing the audio starts a playout clock; a frame
+ * that arrives after the clock has run past everything released means the
+ * listener heard a gap. That is counted as an underrun, the target grows,
+ * and the buffer fills up to it again before releasing more, so a slow link
+ * costs one longer pause rather than a stutter on every late frame.
+ *
+ * The target follows the interarrival jitter, estimated as in RFC 3550.
+ * The estimate needs JITTER_SETTLE_FRAMES to mean anything, so a stream
+ * starts at DEFAULT_DELAY_MS unless an earlier one's estimate is passed to
+ * the constructor. Duplicates and frames older than what was released are
+ * dropped; a missing frame is waited for until a target's worth of audio
+ * has piled up behind it.
+ */
+class JitterBuffer
+{
+public:
+    explicit JitterBuffer(int bytesPerSecond = 32000, double initialJitterMs = -1.0);
+    
+    void push(quint16 sequence, const QByteArray &pcm, qint64 arrivalMs);
+    void finish(); // the last frame is in; the rest is released without waiting
+    QByteArray take(qint64 nowMs);
+    
+    bool isFinished() const { return m_finished; }
+    bool isDrained() const { return m_finished && m_frames.isEmpty(); }
+    int bufferedMs() const { return int(bytesToMs(m_bufferedBytes)); }
+    int targetDelayMs() const;
+    double jitterMs() const { return m_jitterMs; }
+    bool hasJitterEstimate() const { return m_jitterSamples >= JITTER_SETTLE_FRAMES; }
+    int underruns() const { return m_underruns; }
+    int droppedFrames() const { return m_droppedFrames; }
+    
+    static constexpr int MIN_DELAY_MS = 40;
+    static constexpr int DEFAULT_DELAY_MS = 80; // until the jitter estimate has settled
+    static constexpr int MAX_DELAY_MS = 400;
+    static constexpr double JITTER_MULTIPLE = 3.0;
+    static constexpr int JITTER_SETTLE_FRAMES = 16;
+    static constexpr int UNDERRUN_STEP_MS = 40; // added to the target by each underrun
+    
+private:
+    qint64 unwrap(quint16 sequence) const;
+    double bytesToMs(qint64 bytes) const { return bytes * 1000.0 / m_bytesPerSecond; }
+    
+    int m_bytesPerSecond;
+    QMap<qint64, QByteArray> m_frames; // by unwrapped sequence
+    qint64 m_bufferedBytes;
+    qint64 m_nextSequence;    // next to release
+    qint64 m_highestSequence; // -1 before the first frame
+    bool m_finished;
+    
+    // Playout clock, from the first release after (re)buffering
+    bool m_playing;
+    qint64 m_playStartMs;
+    qint64 m_releasedBytes;
+    
+    // Jitter: transit time is arrival minus the audio received before the frame
+    double m_jitterMs;
+    int m_jitterSamples;
+    double m_lastTransitMs;
+    bool m_hasTransit;
+    qint64 m_receivedBytes;
+    
+    int m_underruns;
+    int m_droppedFrames;
+};
+
+#endif // JITTERBUFFER_H
@@ -0,0 +1,217 @@
+#include "localnetworkaccessmanager.h"
+#include "httpstreamrequest.h"
+#include "tlsconfig.h"
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QDebug>
+#include <cstring>
+
+LocalNetworkAccessManager::LocalNetworkAccessManager(QObject *parent)
+    : QNetworkAccessManager(parent)
+    , m_tls(nullptr)
+{
+}
+
+QNetworkReply *LocalNetworkAccessManager::createRequest(Operation op, const QNetworkRequest &request,
+                                                        QIODevice *outgoingData)
+{
+    if (request.url().scheme() == "https" && m_tls) {
+        QNetworkRequest secured(request);
+        secured.setSslConfiguration(m_tls->configurationFor(request.url()));
+        return QNetworkAccessManager::createRequest(op, secured, outgoingData);
+    }
+    
+    if (request.url().scheme() != "unix") {
+        return QNetworkAccessManager::createRequest(op, request, outgoingData);
+    }
+    
+    // Request bodies here are small (PCM buffers, JSON, one multipart file)
+    QByteArray body = outgoingData ? outgoingData->readAll() : QByteArray();
+    int timeoutMs = request.transferTimeout() > 0 ? request.transferTimeout() : transferTimeout();
+    
+    return new LocalNetworkReply(op, request, body, timeoutMs, this);
+}
+
+// ============================================================================
+// LocalNetworkReply
+// ============================================================================
+
+LocalNetworkReply::LocalNetworkReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request,
+                                     const QByteArray &body, int transferTimeoutMs, QObject *parent)
+    : QNetworkReply(parent)
+    , m_request(new HttpStreamRequest(request.url(), this))
+    , m_bodySize(body.size())
+    , m_offset(0)
+{
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(op);
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    
+    switch (op) {
+        case QNetworkAccessManager::GetOperation:
+            m_request->setMethod("GET");
+            break;
+        case QNetworkAccessManager::HeadOperation:
+            m_request->setMethod("HEAD");
+            break;
+        case QNetworkAccessManager::PutOperation:
+            m_request->setMethod("PUT");
+            break;
+        case QNetworkAccessManager::DeleteOperation:
+            m_request->setMethod("DELETE");
+            break;
+        case QNetworkAccessManager::CustomOperation:
+            m_request->setMethod(request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray());
+            break;
+        default:
+            m_request->setMethod("POST");
+            break;
+    }
+    
+    // Known headers set through setHeader() are mirrored in the raw list
+    const QList<QByteArray> headers = request.rawHeaderList();
+    for (const QByteArray &name : headers) {
+        m_request->setRawHeader(name, request.rawHeader(name));
+    }
+    
+    connect(m_request, &HttpStreamRequest::requestSent, this, &LocalNetworkReply::onRequestSent);
+    connect(m_request, &HttpStreamRequest::finished, this, &LocalNetworkReply::onRequestFinished);
+    connect(m_request, &HttpStreamRequest::errorOccurred, this, &LocalNetworkReply::onRequestError);
+    
+    if (transferTimeoutMs > 0) {
+        QTimer::singleShot(transferTimeoutMs, this, &LocalNetworkReply::onTransferTimeout);
+    }
+    
+    // Callers connect to the reply after get()/post() return; start from the event loop
+    QTimer::singleShot(0, this, [this, body]() {
+        if (!isFinished()) {
+            m_request->send(body);
+        }
+    });
+}
+
+void LocalNetworkReply::abort()
+{
+    if (isFinished()) {
+        return;
+    }
+    
+    m_request->abort();
+    finishWith(OperationCanceledError, "Operation canceled");
+}
+
+qint64 LocalNetworkReply::bytesAvailable() const
+{
+    return m_content.size() - m_offset + QNetworkReply::bytesAvailable();
+}
+
+qint64 LocalNetworkReply::readData(char *data, qint64 maxSize)
+{
+    if (m_offset >= m_content.size()) {
+        return -1;
+    }
+    
+    qint64 count = qMin(maxSize, qint64(m_content.size()) - m_offset);
+    std::memcpy(data, m_content.constData() + m_offset, count);
+    m_offset += count;
+    return count;
+}
+
+// ============================================================================
+// Request Handlers
+// ============================================================================
+
+void LocalNetworkReply::onRequestSent()
+{
+    emit uploadProgress(m_bodySize, m_bodySize);
+}
+
+void LocalNetworkReply::onRequestFinished()
+{
+    if (isFinished()) {
+        return;
+    }
+    
+    const int statusCode = m_request->statusCode();
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, statusCode);
+    
+    const auto headers = m_request->responseHeaders();
+    for (const auto &header : headers) {
+        setRawHeader(header.first, header.second);
+    }
+    
+    m_content = m_request->responseBody();
+    emit metaDataChanged();
+    
+    if (statusCode >= 400) {
+        finishWith(errorForStatus(statusCode), QString("HTTP %1").arg(statusCode));
+        return;
+    }
+    
+    finishWith(NoError, QString());
+}
+
+void LocalNetworkReply::onRequestError(const QString &error)
+{
+    if (isFinished()) {
+        return;
+    }
+    
+    // No connection means no backend listening on the socket path
+    finishWith(m_request->connectMs() < 0 ? ConnectionRefusedError : RemoteHostClosedError, error);
+}
+
+void LocalNetworkReply::onTransferTimeout()
+{
+    if (isFinished()) {
+        return;
+    }
+    
+    qWarning() << "⏱️ Local request timed out:" << url().toString();
+    m_request->abort();
+    finishWith(TimeoutError, "Transfer timed out");
+}
+
+void LocalNetworkReply::finishWith(NetworkError error, const QString &errorString)
+{
+    if (!m_content.isEmpty()) {
+        emit readyRead();
+        emit downloadProgress(m_content.size(), m_content.size());
+    }
+    
+    if (error != NoError) {
+        setError(error, errorString);
+        emit errorOccurred(error);
+    }
+    
+    setFinished(true);
+    emit finished();
+}
+
+QNetworkReply::NetworkError LocalNetworkReply::errorForStatus(int statusCode)
+{
+    // Same mapping as the HTTP backend of QNetworkAccessManager
+    switch (statusCode) {
+        case 401:
+            return AuthenticationRequiredError;
+        case 403:
+            return ContentAccessDenied;
+        case 404:
+            return ContentNotFoundError;
+        case 405:
+            return ContentOperationNotPermittedError;
+        case 409:
+            return ContentConflictError;
+        case 410:
+            return ContentGoneError;
+        case 500:
+            return InternalServerError;
+        case 501:
+            return OperationNotImplementedError;
+        case 503:
+            return ServiceUnavailableError;
+        default:
+            return statusCode >= 500 ? UnknownServerError : UnknownContentError;
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef LOCALNETWORKACCESSMANAGER_H
+#define LOCALNETWORKACCESSMANAGER_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QByteArray>
+
+class HttpStreamRequest;
+class TlsConfig;
+
+/**
+ * @brief QNetworkAccessManager that also serves unix:// URLs
+ *
+ * When the backend runs on the same board, loopback TCP adds a full TCP/IP
+ * round trip per request for nothing. unix:///path/to/backend.sock/endpoint
+ * URLs are sent over a Unix domain socket with the same HTTP/1.1 framing (see
+ * HttpStreamRequest); every other scheme goes to the stock implementation.
+ * Callers keep using get()/post() and QNetworkReply unchanged.
+ *
+ * https:// requests get the shared TlsConfig's configuration for their host,
+ * so they trust the same certificates and resume the same sessions as the
+ * WebSocket.
+ */
+class LocalNetworkAccessManager : public QNetworkAccessManager
+{
+    Q_OBJECT
+    
+public:
+    explicit LocalNetworkAccessManager(QObject *parent = nullptr);
+    
+    static bool isLocalUrl(const QString &url) { return url.startsWith("unix://"); }
+    
+    // Not owned; must outlive the manager
+    void setTlsConfig(const TlsConfig *tls) { m_tls = tls; }
+    
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request,
+                                 QIODevice *outgoingData = nullptr) override;
+    
+private:
+    const TlsConfig *m_tls;
+};
+
+/**
+ * @brief QNetworkReply for a single HTTP exchange over a Unix domain socket
+ *
+ * Buffers the whole response, like QNetworkReply does for small bodies, and
+ * reports HTTP errors and connect failures with the same NetworkError codes
+ * the TCP path would use so retry and failover logic needs no special case.
+ */
+class LocalNetworkReply : public QNetworkReply
+{
+    Q_OBJECT
+    
+public:
+    LocalNetworkReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request,
+                      const QByteArray &body, int transferTimeoutMs, QObject *parent = nullptr);
+    
+    void abort() override;
+    qint64 bytesAvailable() const override;
+    bool isSequential() const override { return true; }
+    
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    
+private slots:
+    void onRequestSent();
+    void onRequestFinished();
+    void onRequestError(const QString &error);
+    void onTransferTimeout();
+    
+private:
+    void finishWith(NetworkError error, const QString &errorString);
+    static NetworkError errorForStatus(int statusCode);
+    
+    HttpStreamRequest *m_request;
+    qint64 m_bodySize;
+    QByteArray m_content;
+    qint64 m_offset;
+};
+
+#endif // LOCALNETWORKACCESSMANAGER_H
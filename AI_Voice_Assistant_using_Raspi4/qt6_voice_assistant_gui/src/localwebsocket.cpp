@@ -0,0 +1,357 @@
+#include "localwebsocket.h"
+#include "httpstreamrequest.h"
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <QDebug>
+
+LocalWebSocket::LocalWebSocket(QObject *parent)
+    : QObject(parent)
+    , m_socket(new QLocalSocket(this))
+    , m_state(QAbstractSocket::UnconnectedState)
+    , m_handshakeDone(false)
+    , m_fragmentOpcode(Continuation)
+{
+    connect(m_socket, &QLocalSocket::connected, this, &LocalWebSocket::onConnected);
+    connect(m_socket, &QLocalSocket::readyRead, this, &LocalWebSocket::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, &LocalWebSocket::onDisconnected);
+    connect(m_socket, &QLocalSocket::errorOccurred, this, &LocalWebSocket::onSocketError);
+}
+
+LocalWebSocket::~LocalWebSocket()
+{
+    disconnect(m_socket, nullptr, this, nullptr);
+    m_socket->abort();
+}
+
+void LocalWebSocket::open(const QUrl &url)
+{
+    if (m_state != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    
+    QString socketPath;
+    if (!HttpStreamRequest::splitLocalUrl(url, &socketPath, &m_requestPath)) {
+        setError(QAbstractSocket::HostNotFoundError, QString("No .sock path in %1").arg(url.toString()));
+        return;
+    }
+    
+    m_handshakeDone = false;
+    m_readBuffer.clear();
+    m_fragments.clear();
+    m_errorString.clear();
+    
+    m_state = QAbstractSocket::ConnectingState;
+    m_socket->connectToServer(socketPath);
+}
+
+void LocalWebSocket::close()
+{
+    if (m_state != QAbstractSocket::ConnectedState) {
+        abort();
+        return;
+    }
+    
+    // 1000: normal closure; the server answers and closes the socket
+    QByteArray payload(2, 0);
+    qToBigEndian<quint16>(1000, payload.data());
+    sendFrame(Close, payload);
+    m_state = QAbstractSocket::ClosingState;
+    m_socket->disconnectFromServer();
+}
+
+void LocalWebSocket::abort()
+{
+    m_socket->abort();
+    if (!m_handshakeDone) {
+        m_state = QAbstractSocket::UnconnectedState;
+    }
+}
+
+qint64 LocalWebSocket::sendTextMessage(const QString &message)
+{
+    return sendFrame(Text, message.toUtf8());
+}
+
+qint64 LocalWebSocket::sendBinaryMessage(const QByteArray &data)
+{
+    return sendFrame(Binary, data);
+}
+
+void LocalWebSocket::ping(const QByteArray &payload)
+{
+    m_pingTimer.start();
+    sendFrame(Ping, payload.left(125));
+}
+
+// ============================================================================
+// Socket Handlers
+// ============================================================================
+
+void LocalWebSocket::onConnected()
+{
+    quint32 nonce[4];
+    QRandomGenerator::global()->fillRange(nonce);
+    m_key = QByteArray(reinterpret_cast<const char*>(nonce), sizeof(nonce)).toBase64();
+    
+    QByteArray head;
+    head.reserve(256);
+    head += "GET " + m_requestPath + " HTTP/1.1\r\n";
+    head += "Host: localhost\r\n";
+    head += "Upgrade: websocket\r\n";
+    head += "Connection: Upgrade\r\n";
+    head += "Sec-WebSocket-Key: " + m_key + "\r\n";
+    head += "Sec-WebSocket-Version: 13\r\n";
+    head += "\r\n";
+    m_socket->write(head);
+}
+
+void LocalWebSocket::onReadyRead()
+{
+    m_readBuffer.append(m_socket->readAll());
+    
+    if (!m_handshakeDone) {
+        if (!parseHandshake()) {
+            return;
+        }
+        m_handshakeDone = true;
+        m_state = QAbstractSocket::ConnectedState;
+        emit connected();
+    }
+    
+    parseFrames();
+}
+
+void LocalWebSocket::onDisconnected()
+{
+    const bool wasOpen = m_handshakeDone;
+    m_state = QAbstractSocket::UnconnectedState;
+    m_handshakeDone = false;
+    
+    if (wasOpen) {
+        emit disconnected();
+    }
+}
+
+void LocalWebSocket::onSocketError(QLocalSocket::LocalSocketError error)
+{
+    // A closed peer is reported through onDisconnected()
+    if (error == QLocalSocket::PeerClosedError) {
+        return;
+    }
+    
+    QAbstractSocket::SocketError socketError;
+    switch (error) {
+        case QLocalSocket::ServerNotFoundError:
+            socketError = QAbstractSocket::HostNotFoundError;
+            break;
+        case QLocalSocket::ConnectionRefusedError:
+            socketError = QAbstractSocket::ConnectionRefusedError;
+            break;
+        case QLocalSocket::SocketAccessError:
+            socketError = QAbstractSocket::SocketAccessError;
+            break;
+        case QLocalSocket::SocketTimeoutError:
+            socketError = QAbstractSocket::SocketTimeoutError;
+            break;
+        default:
+            socketError = QAbstractSocket::UnknownSocketError;
+            break;
+    }
+    
+    setError(socketError, m_socket->errorString());
+}
+
+// ============================================================================
+// Protocol
+// ============================================================================
+
+bool LocalWebSocket::parseHandshake()
+{
+    int headEnd = m_readBuffer.indexOf("\r\n\r\n");
+    if (headEnd < 0) {
+        return false;
+    }
+    
+    const QList<QByteArray> lines = m_readBuffer.left(headEnd).split('\n');
+    m_readBuffer.remove(0, headEnd + 4);
+    
+    QByteArray accept;
+    for (int i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines.at(i).trimmed();
+        int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().compare("Sec-WebSocket-Accept", Qt::CaseInsensitive) == 0) {
+            accept = line.mid(colon + 1).trimmed();
+        }
+    }
+    
+    const QByteArray expected = QCryptographicHash::hash(m_key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11",
+                                                         QCryptographicHash::Sha1).toBase64();
+    
+    if (lines.value(0).split(' ').value(1) != "101" || accept != expected) {
+        setError(QAbstractSocket::ConnectionRefusedError,
+                 QString("WebSocket handshake rejected: %1").arg(QString::fromLatin1(lines.value(0).trimmed())));
+        m_socket->abort();
+        return false;
+    }
+    
+    return true;
+}
+
+void LocalWebSocket::parseFrames()
+{
+    while (m_readBuffer.size() >= 2) {
+        const uchar *data = reinterpret_cast<const uchar*>(m_readBuffer.constData());
+        const bool fin = data[0] & 0x80;
+        const int opcode = data[0] & 0x0F;
+        const bool masked = data[1] & 0x80;
+        quint64 length = data[1] & 0x7F;
+        qint64 headerSize = 2;
+        
+        if (length == 126) {
+            if (m_readBuffer.size() < 4) {
+                return;
+            }
+            length = qFromBigEndian<quint16>(data + 2);
+            headerSize = 4;
+        } else if (length == 127) {
+            if (m_readBuffer.size() < 10) {
+                return;
+            }
+            length = qFromBigEndian<quint64>(data + 2);
+            headerSize = 10;
+        }
+        
+        if (length > quint64(MAX_MESSAGE_BYTES)) {
+            closeTooBig();
+            return;
+        }
+        
+        if (masked) {
+            headerSize += 4;
+        }
+        if (m_readBuffer.size() < headerSize + qint64(length)) {
+            return;
+        }
+        
+        QByteArray payload = m_readBuffer.mid(headerSize, length);
+        if (masked) {
+            const uchar *mask = data + headerSize - 4;
+            for (qsizetype i = 0; i < payload.size(); ++i) {
+                payload[i] = payload.at(i) ^ mask[i & 3];
+            }
+        }
+        m_readBuffer.remove(0, headerSize + length);
+        
+        handleFrame(opcode, fin, payload);
+        
+        // Closed by either side: whatever follows is not delivered
+        if (m_state != QAbstractSocket::ConnectedState) {
+            m_readBuffer.clear();
+            return;
+        }
+    }
+}
+
+void LocalWebSocket::handleFrame(int opcode, bool fin, const QByteArray &payload)
+{
+    switch (opcode) {
+        case Ping:
+            sendFrame(Pong, payload);
+            return;
+        case Pong:
+            emit pong(quint64(m_pingTimer.isValid() ? m_pingTimer.elapsed() : 0), payload);
+            return;
+        case Close:
+            if (m_state == QAbstractSocket::ConnectedState) {
+                sendFrame(Close, payload.left(2));
+                m_state = QAbstractSocket::ClosingState;
+            }
+            m_socket->disconnectFromServer();
+            return;
+        case Continuation:
+            if (m_fragments.size() + payload.size() > MAX_MESSAGE_BYTES) {
+                closeTooBig();
+                return;
+            }
+            m_fragments.append(payload);
+            break;
+        default:
+            m_fragmentOpcode = opcode;
+            m_fragments = payload;
+            break;
+    }
+    
+    if (!fin) {
+        return;
+    }
+    
+    if (m_fragmentOpcode == Text) {
+        emit utf8MessageReceived(m_fragments);
+    } else if (m_fragmentOpcode == Binary) {
+        emit binaryMessageReceived(m_fragments);
+    }
+    m_fragments.clear();
+}
+
+void LocalWebSocket::closeTooBig()
+{
+    // 1009: message too big (RFC 6455, section 7.4.1)
+    QByteArray payload(2, 0);
+    qToBigEndian<quint16>(1009, payload.data());
+    sendFrame(Close, payload);
+    m_state = QAbstractSocket::ClosingState;
+    m_fragments.clear();
+    m_readBuffer.clear();
+    
+    setError(QAbstractSocket::DatagramTooLargeError, "WebSocket message too large");
+    m_socket->disconnectFromServer();
+}
+
+qint64 LocalWebSocket::sendFrame(Opcode opcode, const QByteArray &payload)
+{
+    if (m_state != QAbstractSocket::ConnectedState) {
+        return -1;
+    }
+    
+    const qsizetype size = payload.size();
+    QByteArray frame;
+    frame.reserve(size + 14);
+    frame.append(char(0x80 | opcode));
+    
+    // Client frames are always masked (RFC 6455, section 5.3)
+    uchar extended[8];
+    if (size < 126) {
+        frame.append(char(0x80 | size));
+    } else if (size <= 0xFFFF) {
+        frame.append(char(0x80 | 126));
+        qToBigEndian<quint16>(size, extended);
+        frame.append(reinterpret_cast<const char*>(extended), 2);
+    } else {
+        frame.append(char(0x80 | 127));
+        qToBigEndian<quint64>(size, extended);
+        frame.append(reinterpret_cast<const char*>(extended), 8);
+    }
+    
+    uchar mask[4];
+    qToBigEndian<quint32>(QRandomGenerator::global()->generate(), mask);
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    
+    const qsizetype offset = frame.size();
+    frame.append(payload);
+    char *masked = frame.data() + offset;
+    for (qsizetype i = 0; i < size; ++i) {
+        masked[i] ^= mask[i & 3];
+    }
+    
+    return m_socket->write(frame) < 0 ? -1 : size;
+}
+
+void LocalWebSocket::setError(QAbstractSocket::SocketError error, const QString &errorString)
+{
+    m_errorString = errorString;
+    if (!m_handshakeDone) {
+        m_state = QAbstractSocket::UnconnectedState;
+    }
+    emit errorOccurred(error);
+}
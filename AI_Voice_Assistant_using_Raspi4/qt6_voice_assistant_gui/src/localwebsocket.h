@@ -0,0 +1,89 @@
+#ifndef LOCALWEBSOCKET_H
+#define LOCALWEBSOCKET_H
+
+#include <QObject>
+#include <QUrl>
+#include <QByteArray>
+#include <QString>
+#include <QElapsedTimer>
+#include <QAbstractSocket>
+#include <QLocalSocket>
+
+/**
+ * @brief WebSocket client over a Unix domain socket
+ *
+ * QWebSocket only connects over TCP. This speaks the same RFC 6455 protocol
+ * (Upgrade handshake, masked client frames, ping/pong, close) over a
+ * QLocalSocket so the /stream session can use a co-located backend's
+ * unix:// socket. Signals and methods mirror the subset of QWebSocket that
+ * NetworkManager uses, except that text messages are delivered as the UTF-8
+ * bytes received rather than decoded to QString.
+ */
+class LocalWebSocket : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit LocalWebSocket(QObject *parent = nullptr);
+    ~LocalWebSocket();
+    
+    void open(const QUrl &url);
+    void close();
+    void abort();
+    
+    qint64 sendTextMessage(const QString &message);
+    qint64 sendBinaryMessage(const QByteArray &data);
+    void ping(const QByteArray &payload = QByteArray());
+    
+    QAbstractSocket::SocketState state() const { return m_state; }
+    QString errorString() const { return m_errorString; }
+    
+signals:
+    void connected();
+    void disconnected();
+    void utf8MessageReceived(const QByteArray &message);
+    void binaryMessageReceived(const QByteArray &message);
+    void errorOccurred(QAbstractSocket::SocketError error);
+    void pong(quint64 elapsedTime, const QByteArray &payload);
+    
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+    void onSocketError(QLocalSocket::LocalSocketError error);
+    
+private:
+    enum Opcode {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2,
+        Close = 0x8,
+        Ping = 0x9,
+        Pong = 0xA
+    };
+    
+    bool parseHandshake();
+    void parseFrames();
+    void handleFrame(int opcode, bool fin, const QByteArray &payload);
+    qint64 sendFrame(Opcode opcode, const QByteArray &payload);
+    void closeTooBig();
+    void setError(QAbstractSocket::SocketError error, const QString &errorString);
+    
+    QLocalSocket *m_socket;
+    QAbstractSocket::SocketState m_state;
+    QByteArray m_requestPath;
+    QByteArray m_key;
+    bool m_handshakeDone;
+    
+    // Incoming frames and fragmented messages
+    QByteArray m_readBuffer;
+    QByteArray m_fragments;
+    int m_fragmentOpcode;
+    
+    QElapsedTimer m_pingTimer;
+    QString m_errorString;
+    
+    static constexpr qint64 MAX_MESSAGE_BYTES = 16 * 1024 * 1024; // one frame, or all fragments of a message
+};
+
+#endif // LOCALWEBSOCKET_H
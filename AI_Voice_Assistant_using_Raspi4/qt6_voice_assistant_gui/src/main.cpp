@@ -2,6 +2,8 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QIcon>
+#include <QStandardPaths>
+#include "networkmanager.h"
 #include "audioengine.h"
 #include "transcriptionmodel.h"
 #include "settingsmanager.h"
@@ -22,11 +24,20 @@ int main(int argc, char *argv[])
     app.setWindowIcon(QIcon(":/resources/voice-assistant.png"));
     
     // Create backend objects
-    AudioEngine audioEngine;
-    TranscriptionModel transcriptionModel;
     SettingsManager settingsManager;
+    NetworkManager networkManager;
+    networkManager.setBackendUrls(settingsManager.backendUrls());
+    networkManager.setSharedMemoryEndpoint(settingsManager.sharedMemoryEndpoint());
+    AudioEngine audioEngine(&networkManager);
+    TranscriptionModel transcriptionModel;
+    transcriptionModel.openHistory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/history");
     
     // Connect signals
+    QObject::connect(&settingsManager, &SettingsManager::backendUrlsChanged,
+                     [&]() { networkManager.setBackendUrls(settingsManager.backendUrls()); });
+    QObject::connect(&settingsManager, &SettingsManager::sharedMemoryEndpointChanged,
+                     [&]() { networkManager.setSharedMemoryEndpoint(settingsManager.sharedMemoryEndpoint()); });
+    
     QObject::connect(&audioEngine, &AudioEngine::transcriptionReceived,
                      &transcriptionModel, &TranscriptionModel::addTranscription);
     
@@ -40,6 +51,7 @@ int main(int argc, char *argv[])
     QQmlApplicationEngine engine;
     
     // Expose C++ objects to QML
+    engine.rootContext()->setContextProperty("networkManager", &networkManager);
     engine.rootContext()->setContextProperty("audioEngine", &audioEngine);
     engine.rootContext()->setContextProperty("transcriptionModel", &transcriptionModel);
     engine.rootContext()->setContextProperty("settingsManager", &settingsManager);
@@ -0,0 +1,96 @@
+#include "nativettsbackend.h"
+#include <QDebug>
+#include <QJsonArray>
+#include <QMutexLocker>
+
+NativeTTSBackend::NativeTTSBackend(QObject *parent)
+    : TTSBackend(parent)
+{
+    // One thread renders requests in order, the way the Python speaker loop does
+    m_renderer.setMaxThreadCount(1);
+}
+
+NativeTTSBackend::~NativeTTSBackend()
+{
+    m_renderer.clear();
+    m_renderer.waitForDone();
+}
+
+void NativeTTSBackend::start()
+{
+    beginStartup();
+    
+    // Nothing to load
+    postReady();
+}
+
+void NativeTTSBackend::shutdown()
+{
+    m_renderer.clear();
+    beginShutdown();
+}
+
+void NativeTTSBackend::send(const QString &command, const QVariantMap &params)
+{
+    if (isShutDown() || refusePlayback(command)) {
+        return;
+    }
+    
+    if (command == "SYNTHESIZE") {
+        synthesize(params["request"].toULongLong(), params["text"].toString());
+    } else if (command == "CANCEL") {
+        QMutexLocker locker(&m_pendingMutex);
+        for (const QVariant &request : params["requests"].toList()) {
+            m_pending.remove(request.toULongLong());
+        }
+    } else if (command == "SET_RATE") {
+        m_synth.setRate(params["rate"].toFloat());
+    } else if (command == "SET_VOICE") {
+        m_synth.setPitch(FormantSynth::pitchForVoice(params["voice"].toString()));
+    } else if (command == "GET_VOICES") {
+        postMessage({{"type", "voices_list"},
+                     {"voices", QJsonArray{"default", "male-en-us", "female-en-us", "male-en-gb", "female-en-gb"}}});
+    }
+}
+
+void NativeTTSBackend::synthesize(quint64 request, const QString &text)
+{
+    if (text.trimmed().isEmpty()) {
+        postMessage({{"type", "synthesis_failed"}, {"request", double(request)}, {"message", "empty text"}});
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        m_pending.insert(request);
+    }
+    
+    const FormantSynth synth = m_synth;
+    m_renderer.start([this, synth, request, text]() {
+        {
+            // Cancelled while it waited
+            QMutexLocker locker(&m_pendingMutex);
+            if (!m_pending.remove(request)) {
+                return;
+            }
+        }
+        
+        TTSAudio audio;
+        audio.sampleRate = synth.sampleRate();
+        audio.channels = 1;
+        audio.pcm = synth.render(text);
+        
+        // Delivered on the backend's thread; dropped if it is gone by then
+        QMetaObject::invokeMethod(this, [this, request, audio]() {
+            if (isShutDown()) {
+                return;
+            }
+            if (audio.isNull()) {
+                emit messageReceived({{"type", "synthesis_failed"}, {"request", double(request)},
+                                      {"message", "nothing to say"}});
+                return;
+            }
+            emit audioSynthesized(request, audio);
+        }, Qt::QueuedConnection);
+    });
+}
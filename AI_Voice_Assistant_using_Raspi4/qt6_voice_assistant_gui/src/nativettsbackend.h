@@ -0,0 +1,47 @@
+#ifndef NATIVETTSBACKEND_H
+#define NATIVETTSBACKEND_H
+
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+#include "formantsynth.h"
+#include "ttsbackend.h"
+
+/**
+ * @brief In-process TTS backend on the FormantSynth
+ *
+ * No interpreter, no pipe and no second copy of a speech engine: the
+ * backend is ready as soon as the event loop runs, and SYNTHESIZE renders
+ * on one pool thread and hands the PCM straight to the engine through
+ * audioSynthesized(), without base64. It plays nothing itself, so the
+ * engine plays everything it says through TTSPlayer.
+ *
+ * Each request renders with the rate and voice set when it was sent.
+ * CANCEL drops requests that haven't started rendering; volume is applied
+ * at playback, so SET_VOLUME has nothing to do here.
+ */
+class NativeTTSBackend : public TTSBackend
+{
+    Q_OBJECT
+    
+public:
+    explicit NativeTTSBackend(QObject *parent = nullptr);
+    ~NativeTTSBackend();
+    
+    void start() override;
+    void shutdown() override;
+    void send(const QString &command, const QVariantMap &params = QVariantMap()) override;
+    void sendLatest(const QString &command, const QVariantMap &params) override { send(command, params); }
+    bool playsAudio() const override { return false; }
+    QString description() const override { return QStringLiteral("native formant synth"); }
+    
+private:
+    void synthesize(quint64 request, const QString &text);
+    
+    FormantSynth m_synth; // the settings new requests render with
+    QThreadPool m_renderer;
+    QMutex m_pendingMutex;
+    QSet<quint64> m_pending; // requests not yet started; CANCEL takes them out
+};
+
+#endif // NATIVETTSBACKEND_H
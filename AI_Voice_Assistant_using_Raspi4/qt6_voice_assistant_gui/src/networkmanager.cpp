@@ -1,4 +1,8 @@
 #include "networkmanager.h"
+#include "httpstreamrequest.h"
+#include "localnetworkaccessmanager.h"
+#include "localwebsocket.h"
+#include "shmaudiotransport.h"
 #include <QNetworkRequest>
 #include <QHttpMultiPart>
 #include <QFile>
@@ -9,21 +13,66 @@
 #include <QUrlQuery>
 #include <QDebug>
 #include <QTimer>
+#include <QUuid>
+#include <QStandardPaths>
+#include <cstring>
+#include <algorithm>
 
 NetworkManager::NetworkManager(QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_networkManager(new LocalNetworkAccessManager(this))
+    , m_backendPool(new BackendPool(this))
     , m_webSocket(new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this))
+    , m_localWebSocket(new LocalWebSocket(this))
+    , m_shmTransport(new ShmAudioTransport(this))
+    , m_streamTransport(TcpWebSocket)
+    , m_streamingUpload(nullptr)
+    , m_streamingUploadId(0)
     , m_backendUrl("http://localhost:8000")
     , m_language("en")
     , m_isConnected(false)
     , m_isHealthy(false)
+    , m_nextRequestId(1)
+    , m_clientId(QUuid::createUuid().toString(QUuid::Id128).left(12))
+    , m_streamCancelled(false)
+    , m_multiplexed(false)
+    , m_upstreamSequence(0)
+    , m_nextSpeechStream(1)
+    , m_runningJobs(0)
+    , m_maxConcurrentJobs(DEFAULT_MAX_CONCURRENT_JOBS)
+    , m_orderedDelivery(true)
+    , m_hedgingEnabled(false)
+    , m_hedgeEligible(0)
+    , m_hedgesSent(0)
+    , m_hedgeWins(0)
+    , m_hedgeBytes(0)
+    , m_deadlineFloorMs(DEFAULT_DEADLINE_FLOOR_MS)
+    , m_healthPollTimer(new QTimer(this))
+    , m_heartbeatTimer(new QTimer(this))
+    , m_healthPollIntervalMs(HEALTH_POLL_MIN_MS)
+    , m_pingPending(false)
 {
     qDebug() << "🌐 NetworkManager initialized with backend URL:" << m_backendUrl;
     
-    // Configure network manager
+    m_backendPool->setUrls({m_backendUrl});
+    m_clock.start();
+    
+    // Request outcomes and heartbeats update the pool; isHealthy follows it
+    connect(m_backendPool, &BackendPool::backendsChanged, this, &NetworkManager::onBackendsChanged);
+    connect(m_backendPool, &BackendPool::probeRequested, this, &NetworkManager::probeBackend);
+    
+    // Configure network manager; transcription attempts override this with their deadline
     m_networkManager->setTransferTimeout(DEFAULT_TIMEOUT_MS);
     
+    // One TLS configuration for REST and WebSocket; session tickets survive restarts
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheDir.isEmpty()) {
+        m_tls.setCacheFile(cacheDir + "/tls-sessions.json");
+    }
+    m_networkManager->setTlsConfig(&m_tls);
+    connect(m_networkManager, &QNetworkAccessManager::finished, this, &NetworkManager::onRequestFinished);
+    connect(m_networkManager, &QNetworkAccessManager::sslErrors, this, &NetworkManager::onSslErrors);
+    
     // Connect WebSocket signals
     connect(m_webSocket, &QWebSocket::connected, 
             this, &NetworkManager::onWebSocketConnected);
@@ -35,11 +84,40 @@ NetworkManager::NetworkManager(QObject *parent)
             this, &NetworkManager::onWebSocketBinaryMessageReceived);
     connect(m_webSocket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
             this, &NetworkManager::onWebSocketError);
+    connect(m_webSocket, &QWebSocket::pong, this, &NetworkManager::onWebSocketPong);
+    connect(m_webSocket, &QWebSocket::sslErrors, this, &NetworkManager::onWebSocketSslErrors);
+    
+    // Same handlers for sessions with a backend on a Unix domain socket
+    connect(m_localWebSocket, &LocalWebSocket::connected, 
+            this, &NetworkManager::onWebSocketConnected);
+    connect(m_localWebSocket, &LocalWebSocket::disconnected, 
+            this, &NetworkManager::onWebSocketDisconnected);
+    connect(m_localWebSocket, &LocalWebSocket::utf8MessageReceived, 
+            this, &NetworkManager::onStreamMessageReceived);
+    connect(m_localWebSocket, &LocalWebSocket::binaryMessageReceived, 
+            this, &NetworkManager::onWebSocketBinaryMessageReceived);
+    connect(m_localWebSocket, &LocalWebSocket::errorOccurred,
+            this, &NetworkManager::onWebSocketError);
+    connect(m_localWebSocket, &LocalWebSocket::pong, this, &NetworkManager::onWebSocketPong);
+    
+    // And for the shared-memory session with a co-located consumer
+    connect(m_shmTransport, &ShmAudioTransport::connected, 
+            this, &NetworkManager::onWebSocketConnected);
+    connect(m_shmTransport, &ShmAudioTransport::disconnected, 
+            this, &NetworkManager::onWebSocketDisconnected);
+    connect(m_shmTransport, &ShmAudioTransport::utf8MessageReceived, 
+            this, &NetworkManager::onStreamMessageReceived);
+    connect(m_shmTransport, &ShmAudioTransport::errorOccurred,
+            this, &NetworkManager::onWebSocketError);
+    connect(m_shmTransport, &ShmAudioTransport::pong, this, &NetworkManager::onWebSocketPong);
     
-    // Start periodic health checks
-    QTimer *healthCheckTimer = new QTimer(this);
-    connect(healthCheckTimer, &QTimer::timeout, this, &NetworkManager::checkHealth);
-    healthCheckTimer->start(HEALTH_CHECK_INTERVAL_MS);
+    // Idle health polling; rescheduled after every probe with a backed-off interval
+    m_healthPollTimer->setSingleShot(true);
+    connect(m_healthPollTimer, &QTimer::timeout, this, &NetworkManager::checkHealth);
+    
+    // Heartbeat while a WebSocket session is open
+    m_heartbeatTimer->setInterval(HEARTBEAT_INTERVAL_MS);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &NetworkManager::onHeartbeatTimeout);
     
     // Initial health check
     QTimer::singleShot(500, this, &NetworkManager::checkHealth);
@@ -49,26 +127,126 @@ NetworkManager::~NetworkManager()
 {
     qDebug() << "🌐 NetworkManager destroyed";
     
-    if (m_webSocket->state() == QAbstractSocket::ConnectedState) {
-        m_webSocket->close();
+    if (webSocketState() == QAbstractSocket::ConnectedState) {
+        withStreamSocket([](auto *socket) { socket->close(); });
     }
 }
 
 void NetworkManager::setBackendUrl(const QString &url)
 {
-    if (m_backendUrl != url) {
-        m_backendUrl = url;
-        qDebug() << "🌐 Backend URL changed to:" << url;
+    // A single URL replaces the whole pool
+    setBackendUrls({url});
+}
+
+void NetworkManager::setBackendUrls(const QStringList &urls)
+{
+    // Compared as the pool stores them, so "http://host/" is no change from "http://host"
+    const QStringList normalized = BackendPool::normalize(urls);
+    if (normalized.isEmpty()) {
+        qWarning() << "⚠️ Ignoring empty backend list";
+        return;
+    }
+    if (normalized == m_backendPool->urls()) {
+        return;
+    }
+    
+    m_backendPool->setUrls(normalized);
+    
+    qDebug() << "🌐 Backend URLs changed to:" << m_backendPool->urls();
+    emit backendUrlsChanged();
+    
+    const QString primary = m_backendPool->urls().first();
+    if (m_backendUrl != primary) {
+        m_backendUrl = primary;
         emit backendUrlChanged();
-        
-        // Reconnect WebSocket if it was connected
-        if (m_isConnected) {
-            disconnectWebSocket();
-            QTimer::singleShot(500, this, &NetworkManager::connectWebSocket);
-        }
-        
-        // Re-check health with new URL
-        checkHealth();
+    }
+    
+    // Reconnect WebSocket if it was connected
+    if (m_isConnected) {
+        disconnectWebSocket();
+        QTimer::singleShot(500, this, &NetworkManager::connectWebSocket);
+    }
+    
+    // Re-check health with new URLs
+    checkHealth();
+}
+
+void NetworkManager::setMaxConcurrentJobs(int count)
+{
+    count = qMax(1, count);
+    if (m_maxConcurrentJobs != count) {
+        m_maxConcurrentJobs = count;
+        emit maxConcurrentJobsChanged();
+        dispatchJobs();
+    }
+}
+
+void NetworkManager::setOrderedDelivery(bool ordered)
+{
+    if (m_orderedDelivery != ordered) {
+        m_orderedDelivery = ordered;
+        emit orderedDeliveryChanged();
+        deliverJobs();
+    }
+}
+
+void NetworkManager::setHedgingEnabled(bool enabled)
+{
+    if (m_hedgingEnabled != enabled) {
+        m_hedgingEnabled = enabled;
+        qDebug() << "🌐 Request hedging" << (enabled ? "enabled" : "disabled");
+        emit hedgingEnabledChanged();
+    }
+}
+
+void NetworkManager::setDeadlineFloorMs(int ms)
+{
+    ms = qBound(0, ms, DEADLINE_MAX_MS);
+    if (m_deadlineFloorMs != ms) {
+        m_deadlineFloorMs = ms;
+        qDebug() << "⏰ Transcription deadline floor:" << ms << "ms";
+        emit deadlineFloorMsChanged();
+    }
+}
+
+void NetworkManager::setTlsSessionResumption(bool enabled)
+{
+    if (m_tls.isResumptionEnabled() != enabled) {
+        m_tls.setResumptionEnabled(enabled);
+        qDebug() << "🔒 TLS session resumption" << (enabled ? "enabled" : "disabled");
+        emit tlsSessionResumptionChanged();
+    }
+}
+
+void NetworkManager::setPinnedCertificateFile(const QString &pemPath)
+{
+    if (m_pinnedCertificateFile == pemPath) {
+        return;
+    }
+    
+    m_pinnedCertificateFile = pemPath;
+    if (pemPath.isEmpty()) {
+        m_tls.clearPinnedCertificates();
+    } else if (!m_tls.loadPinnedCertificates(pemPath)) {
+        emit errorOccurred("TLS Error", QString("No certificates could be read from %1").arg(pemPath));
+    }
+    
+    // Kept-alive connections were verified under the old policy
+    m_networkManager->clearConnectionCache();
+    emit pinnedCertificateFileChanged();
+}
+
+void NetworkManager::setTlsSessionCacheFile(const QString &path)
+{
+    m_tls.setCacheFile(path);
+}
+
+void NetworkManager::setSharedMemoryEndpoint(const QString &controlPath)
+{
+    if (m_sharedMemoryEndpoint != controlPath) {
+        m_sharedMemoryEndpoint = controlPath;
+        qDebug() << "🧠 Shared-memory audio endpoint:" << (controlPath.isEmpty() ? "disabled" : controlPath);
+        emit sharedMemoryEndpointChanged();
     }
 }
 
@@ -76,7 +254,7 @@ void NetworkManager::setBackendUrl(const QString &url)
 // REST API Methods
 // ============================================================================
 
-void NetworkManager::transcribeFile(const QString &filePath, const QString &language)
+quint64 NetworkManager::transcribeFile(const QString &filePath, const QString &language)
 {
     qDebug() << "🎤 Transcribing file:" << filePath << "Language:" << language;
     
@@ -86,7 +264,7 @@ void NetworkManager::transcribeFile(const QString &filePath, const QString &lang
         qWarning() << "❌" << error;
         emit errorOccurred("File Error", error);
         delete file;
-        return;
+        return 0;
     }
     
     // Create multipart request
@@ -123,78 +301,846 @@ void NetworkManager::transcribeFile(const QString &filePath, const QString &lang
     multiPart->append(trimPart);
     
     // Create request
-    QUrl url(m_backendUrl + "/transcribe");
+    quint64 requestId = m_nextRequestId++;
+    
+    // Multipart bodies stream from the file and can't be replayed, so no failover
+    QString backendUrl = m_backendPool->select();
+    QUrl url(backendUrl + "/transcribe");
     QNetworkRequest request(url);
     request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
+    request.setRawHeader("X-Request-Id", requestIdHeader(requestId));
     
     QNetworkReply *reply = m_networkManager->post(request, multiPart);
     multiPart->setParent(reply); // multiPart will be deleted with reply
+    reply->setProperty("requestId", requestId);
+    trackReply(reply, backendUrl);
     
     // Connect reply signals
     connect(reply, &QNetworkReply::finished, this, &NetworkManager::handleTranscribeReply);
     connect(reply, &QNetworkReply::errorOccurred, this, &NetworkManager::handleNetworkError);
     connect(reply, &QNetworkReply::uploadProgress, this, &NetworkManager::handleUploadProgress);
     
-    qDebug() << "📤 Upload started to:" << url.toString();
+    qDebug() << "📤 Upload started to:" << url.toString() << "request" << requestId;
+    return requestId;
 }
 
-void NetworkManager::transcribeBase64(const QByteArray &audioData, const QString &language)
+quint64 NetworkManager::transcribeBase64(const QByteArray &audioData, const QString &language)
 {
     qDebug() << "🎤 Transcribing base64 audio, size:" << audioData.size() << "bytes, Language:" << language;
     
-    // Convert audio data to base64
-    QString base64Audio = QString::fromLatin1(audioData.toBase64());
+    // Encode straight into the request body, no QString/QJsonObject round trip
+    QByteArray jsonData = buildBase64JsonPayload(audioData, language);
+    quint64 requestId = m_nextRequestId++;
     
-    // Create JSON request
-    QJsonObject json;
-    json["audio_base64"] = base64Audio;
-    json["language"] = language;
-    json["task"] = "transcribe";
+    // Create request
+    QNetworkRequest request;
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
+    request.setRawHeader("X-Request-Id", requestIdHeader(requestId));
     
-    QJsonDocument doc(json);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
+    // Container format is unknown here, so no speed sample for the pool
+    QNetworkReply *reply = sendTranscription(requestId, "/transcribe/base64", request, jsonData, 0);
     
-    // Create request
-    QUrl url(m_backendUrl + "/transcribe/base64");
+    qDebug() << "📤 Base64 transcription request sent to:" << reply->url().toString() << "request" << requestId;
+    return requestId;
+}
+
+quint64 NetworkManager::transcribeRaw(const QByteArray &pcmData, const QString &language)
+{
+    qDebug() << "🎤 Transcribing raw PCM, size:" << pcmData.size() << "bytes, Language:" << language;
+    
+    quint64 requestId = m_nextRequestId++;
+    QNetworkReply *reply = postRaw(requestId, pcmData, language);
+    connect(reply, &QNetworkReply::uploadProgress, this, &NetworkManager::handleUploadProgress);
+    
+    qDebug() << "📤 Raw transcription request sent to:" << reply->url().toString() << "request" << requestId;
+    return requestId;
+}
+
+QNetworkReply *NetworkManager::postRaw(quint64 requestId, const QByteArray &pcmData, const QString &language)
+{
+    // Metadata goes in headers so the body is the caller's buffer, shared not copied
+    QNetworkRequest request;
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
+    request.setRawHeader("X-Audio-Format", "pcm_s16le");
+    request.setRawHeader("X-Sample-Rate", "16000");
+    request.setRawHeader("X-Channels", "1");
+    request.setRawHeader("X-Language", language.toUtf8());
+    request.setRawHeader("X-Request-Id", requestIdHeader(requestId));
+    
+    return sendTranscription(requestId, "/transcribe/raw", request, pcmData, pcmData.size() / PCM_BYTES_PER_MS);
+}
+
+QByteArray NetworkManager::buildBase64JsonPayload(const QByteArray &audioData, const QString &language)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    
+    // JSON-escape the language code (normally two ASCII letters)
+    QByteArray languageJson;
+    for (char c : language.toUtf8()) {
+        if (c == '"' || c == '\\') {
+            languageJson += '\\';
+            languageJson += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            languageJson += "\\u00" + QByteArray::number(static_cast<unsigned char>(c), 16).rightJustified(2, '0');
+        } else {
+            languageJson += c;
+        }
+    }
+    
+    static const char head[] = "{\"audio_base64\":\"";
+    const QByteArray tail = "\",\"language\":\"" + languageJson + "\",\"task\":\"transcribe\"}";
+    
+    const qsizetype inputSize = audioData.size();
+    const qsizetype encodedSize = ((inputSize + 2) / 3) * 4;
+    
+    // Single allocation of the exact final size
+    QByteArray payload(qsizetype(sizeof(head) - 1) + encodedSize + tail.size(), Qt::Uninitialized);
+    char *out = payload.data();
+    
+    memcpy(out, head, sizeof(head) - 1);
+    out += sizeof(head) - 1;
+    
+    const uchar *in = reinterpret_cast<const uchar*>(audioData.constData());
+    qsizetype i = 0;
+    for (; i + 2 < inputSize; i += 3) {
+        const quint32 triple = (quint32(in[i]) << 16) | (quint32(in[i + 1]) << 8) | in[i + 2];
+        *out++ = alphabet[(triple >> 18) & 0x3F];
+        *out++ = alphabet[(triple >> 12) & 0x3F];
+        *out++ = alphabet[(triple >> 6) & 0x3F];
+        *out++ = alphabet[triple & 0x3F];
+    }
+    
+    if (i < inputSize) {
+        const bool hasSecond = i + 1 < inputSize;
+        const quint32 triple = (quint32(in[i]) << 16) | (hasSecond ? quint32(in[i + 1]) << 8 : 0);
+        *out++ = alphabet[(triple >> 18) & 0x3F];
+        *out++ = alphabet[(triple >> 12) & 0x3F];
+        *out++ = hasSecond ? alphabet[(triple >> 6) & 0x3F] : '=';
+        *out++ = '=';
+    }
+    
+    memcpy(out, tail.constData(), tail.size());
+    
+    return payload;
+}
+
+void NetworkManager::checkHealth()
+{
+    // Probe every backend; the round trip feeds the pool's latency estimate
+    for (const QString &backendUrl : m_backendPool->urls()) {
+        probeBackend(backendUrl);
+    }
+    
+    // Each quiet poll doubles the next interval; a health change resets it
+    m_healthPollIntervalMs = qMin(m_healthPollIntervalMs * 2, HEALTH_POLL_MAX_MS);
+    
+    // Don't log every health check to reduce spam
+    // qDebug() << "🏥 Health check sent to:" << m_backendPool->urls();
+}
+
+void NetworkManager::probeBackend(const QString &backendUrl)
+{
+    QUrl url(backendUrl + "/health");
+    QNetworkRequest request(url);
+    request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
+    
+    // A probe that takes this long has already failed as far as routing goes
+    request.setTransferTimeout(HEALTH_POLL_MIN_MS);
+    
+    QNetworkReply *reply = m_networkManager->get(request);
+    reply->setProperty("backendUrl", backendUrl);
+    reply->setProperty("probeStartMs", m_clock.elapsed());
+    
+    connect(reply, &QNetworkReply::finished, this, &NetworkManager::handleHealthReply);
+}
+
+void NetworkManager::getModelInfo()
+{
+    qDebug() << "ℹ️ Requesting model info...";
+    
+    QUrl url(m_backendPool->select() + "/model/info");
     QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
     
-    QNetworkReply *reply = m_networkManager->post(request, jsonData);
+    QNetworkReply *reply = m_networkManager->get(request);
+    
+    connect(reply, &QNetworkReply::finished, this, &NetworkManager::handleModelInfoReply);
+    connect(reply, &QNetworkReply::errorOccurred, this, &NetworkManager::handleNetworkError);
+}
+
+// ============================================================================
+// Transcription Job Queue
+// ============================================================================
+
+quint64 NetworkManager::enqueueTranscription(const QByteArray &pcmData, const QString &language)
+{
+    quint64 requestId = m_nextRequestId++;
+    
+    TranscriptionJob job;
+    job.pcmData = pcmData;
+    job.language = language;
+    job.clock.start();
+    
+    m_jobs.insert(requestId, job);
+    m_jobQueue.enqueue(requestId);
+    m_deliveryOrder.append(requestId);
+    
+    qDebug() << "📥 Queued transcription job" << requestId << "(" << pcmData.size() << "bytes,"
+             << m_jobQueue.size() << "waiting," << m_runningJobs << "running)";
+    
+    emit jobQueueChanged();
+    dispatchJobs();
+    
+    return requestId;
+}
+
+void NetworkManager::dispatchJobs()
+{
+    bool changed = false;
+    
+    while (m_runningJobs < m_maxConcurrentJobs && !m_jobQueue.isEmpty()) {
+        quint64 requestId = m_jobQueue.dequeue();
+        auto it = m_jobs.find(requestId);
+        if (it == m_jobs.end()) {
+            continue;
+        }
+        
+        it->dispatchedMs = it->clock.elapsed();
+        ++m_runningJobs;
+        changed = true;
+        
+        postRaw(requestId, it->pcmData, it->language);
+        
+        qDebug() << "📤 Dispatched job" << requestId << "after" << it->dispatchedMs << "ms in queue";
+    }
+    
+    if (changed) {
+        emit jobQueueChanged();
+    }
+}
+
+void NetworkManager::completeJob(quint64 requestId, QNetworkReply *reply)
+{
+    auto it = m_jobs.find(requestId);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    
+    TranscriptionJob &job = it.value();
+    job.finishedMs = job.clock.elapsed();
+    job.completed = true;
+    job.pcmData.clear(); // audio is no longer needed
+    --m_runningJobs;
+    
+    if (reply->error() == QNetworkReply::NoError) {
+        QElapsedTimer parseTimer;
+        parseTimer.start();
+        
+        QJsonDocument jsonDoc = QJsonDocument::fromJson(reply->readAll());
+        if (jsonDoc.isObject()) {
+            QJsonObject jsonObj = jsonDoc.object();
+            job.text = jsonObj["text"].toString();
+            job.duration = jsonObj["duration"].toDouble();
+            job.inferenceTime = jsonObj["inference_time"].toDouble();
+            job.rtf = jsonObj["rtf"].toDouble();
+            job.serverInferenceMs = job.inferenceTime * 1000.0;
+            job.succeeded = true;
+        } else {
+            job.error = "Parse Error";
+            job.errorDetails = "Invalid JSON response from backend";
+        }
+        
+        job.parseUs = parseTimer.nsecsElapsed() / 1000;
+    } else if (deadlineExpired(reply)) {
+        job.error = "Deadline Exceeded";
+        job.errorDetails = QString("No answer from %1 in time").arg(reply->url().toString());
+    } else {
+        job.error = "Transcription Error";
+        job.errorDetails = reply->errorString() + "\n" + QString::fromUtf8(reply->readAll());
+    }
+    
+    qDebug() << "✅ Job" << requestId << (job.succeeded ? "completed" : "failed") << "in" << job.finishedMs << "ms";
+    
+    emit jobQueueChanged();
+    dispatchJobs();
+    deliverJobs();
+}
+
+void NetworkManager::deliverJobs()
+{
+    int index = 0;
+    
+    while (index < m_deliveryOrder.size()) {
+        quint64 requestId = m_deliveryOrder.at(index);
+        auto it = m_jobs.find(requestId);
+        
+        if (it == m_jobs.end() || !it->completed) {
+            // In ordered mode an unfinished job holds back everything behind it
+            if (m_orderedDelivery) {
+                break;
+            }
+            ++index;
+            continue;
+        }
+        
+        TranscriptionJob job = m_jobs.take(requestId);
+        m_deliveryOrder.removeAt(index);
+        QVariantMap timing = job.timing();
+        
+        if (job.succeeded) {
+            emit jobFinished(requestId, job.text, timing);
+            emit transcriptionReceived(job.text, job.duration, job.inferenceTime, job.rtf, requestId);
+        } else {
+            qWarning() << "❌" << job.error << "for job" << requestId << "-" << job.errorDetails;
+            emit jobFailed(requestId, job.error, timing);
+            emit errorOccurred(job.error, job.errorDetails, requestId);
+        }
+        
+        // Slots may have cancelled or queued jobs; rescan from the start
+        index = 0;
+    }
+}
+
+bool NetworkManager::dropJob(quint64 requestId)
+{
+    auto it = m_jobs.find(requestId);
+    if (it == m_jobs.end()) {
+        return false;
+    }
+    
+    if (it->dispatchedMs >= 0 && !it->completed) {
+        --m_runningJobs;
+    }
+    
+    m_jobQueue.removeOne(requestId);
+    m_deliveryOrder.removeOne(requestId);
+    m_jobs.erase(it);
+    
+    emit jobQueueChanged();
+    
+    // The freed slot and the removed head-of-line job may unblock others
+    QTimer::singleShot(0, this, [this]() {
+        dispatchJobs();
+        deliverJobs();
+    });
+    
+    return true;
+}
+
+QVariantMap NetworkManager::TranscriptionJob::timing() const
+{
+    QVariantMap result;
+    result["queueMs"] = dispatchedMs;
+    result["uploadMs"] = (uploadedMs >= 0 && dispatchedMs >= 0) ? uploadedMs - dispatchedMs : -1;
+    result["serverInferenceMs"] = serverInferenceMs;
+    result["roundTripMs"] = (finishedMs >= 0 && dispatchedMs >= 0) ? finishedMs - dispatchedMs : -1;
+    result["parseMs"] = parseUs / 1000.0;
+    result["totalMs"] = clock.elapsed(); // includes time held back for ordered delivery
+    return result;
+}
+
+// ============================================================================
+// Progressive Upload
+// ============================================================================
+
+quint64 NetworkManager::beginStreamingTranscription(const QString &language)
+{
+    if (m_streamingUpload) {
+        qWarning() << "⚠️ Streaming upload already in progress, aborting previous one";
+        abortStreamingTranscription();
+    }
+    
+    quint64 requestId = m_nextRequestId++;
+    
+    // Headers are kept in the pending entry so a failover can resend them
+    PendingRequest pending;
+    pending.path = "/transcribe/stream";
+    pending.request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
+    pending.request.setRawHeader("Content-Type", "application/octet-stream");
+    pending.request.setRawHeader("X-Audio-Format", "pcm_s16le");
+    pending.request.setRawHeader("X-Sample-Rate", "16000");
+    pending.request.setRawHeader("X-Channels", "1");
+    pending.request.setRawHeader("X-Language", language.toUtf8());
+    pending.request.setRawHeader("X-Request-Id", requestIdHeader(requestId));
+    
+    // The length of the audio is unknown until the body is finished; until
+    // then only the cap bounds the request
+    pending.started.start();
+    pending.streamBudgetMs = DEADLINE_MAX_MS;
+    m_pendingRequests.insert(requestId, pending);
+    
+    m_streamingUpload = openStreamingUpload(requestId, m_backendPool->select());
+    m_streamingUploadId = requestId;
+    return requestId;
+}
+
+HttpStreamRequest *NetworkManager::openStreamingUpload(quint64 requestId, const QString &backendUrl,
+                                                       const QList<QByteArray> &body, bool finishRequested)
+{
+    PendingRequest &pending = m_pendingRequests[requestId];
+    
+    QUrl url(backendUrl + pending.path);
+    qDebug() << "📤 Opening progressive upload to:" << url.toString() << "request" << requestId;
+    
+    HttpStreamRequest *upload = new HttpStreamRequest(url, this);
+    upload->setProperty("requestId", requestId);
+    upload->setSslConfiguration(m_tls.configurationFor(url));
+    for (const QByteArray &name : pending.request.rawHeaderList()) {
+        upload->setRawHeader(name, pending.request.rawHeader(name));
+    }
+    
+    // What is left of the request's budget, after any attempts before this one
+    const qint64 remainingMs = streamRemainingMs(pending);
+    upload->setRawHeader("X-Request-Timeout-Ms", QByteArray::number(remainingMs));
+    upload->setDeadline(remainingMs);
+    
+    pending.streamRequest = upload;
+    pending.backendUrl = backendUrl;
+    pending.triedBackends << backendUrl;
+    pending.clock.start();
+    m_backendPool->requestStarted(backendUrl);
+    
+    connect(upload, &HttpStreamRequest::finished,
+            this, &NetworkManager::handleStreamingUploadFinished);
+    connect(upload, &HttpStreamRequest::errorOccurred,
+            this, &NetworkManager::handleStreamingUploadError);
+    connect(upload, &HttpStreamRequest::sslErrors, this, [this, upload](const QList<QSslError> &errors) {
+        if (m_tls.acceptsErrors(errors)) {
+            upload->ignoreSslErrors(errors);
+        }
+    });
+    
+    // Replayed audio is queued before connecting, like audio captured while connecting
+    for (const QByteArray &chunk : body) {
+        upload->write(chunk);
+    }
+    if (finishRequested) {
+        upload->finish();
+    }
+    upload->start();
+    return upload;
+}
+
+void NetworkManager::appendStreamingAudio(const QByteArray &pcm)
+{
+    if (!m_streamingUpload) {
+        return;
+    }
+    
+    m_streamingUpload->write(pcm);
+    m_pendingRequests[m_streamingUploadId].streamedBytes += pcm.size();
+}
+
+void NetworkManager::finishStreamingTranscription()
+{
+    if (!m_streamingUpload) {
+        qWarning() << "❌ No progressive upload in progress";
+        return;
+    }
+    
+    qDebug() << "📤 Finishing progressive upload," << m_streamingUpload->bytesSent() << "bytes already sent";
+    m_streamingUpload->finish();
+    
+    // Now the audio length is known: the budget a buffered request of it would get, from here
+    PendingRequest &pending = m_pendingRequests[m_streamingUploadId];
+    pending.audioMs = pending.streamedBytes / PCM_BYTES_PER_MS;
+    pending.streamBudgetMs = qMin(pending.streamBudgetMs,
+                                  pending.started.elapsed() + deadlineMs(pending.audioMs, pending.backendUrl));
+    m_streamingUpload->setDeadline(streamRemainingMs(pending));
+}
+
+void NetworkManager::abortStreamingTranscription()
+{
+    if (!m_streamingUpload) {
+        return;
+    }
+    
+    qDebug() << "📤 Aborting progressive upload";
+    cancelRequest(m_streamingUploadId);
+}
+
+// ============================================================================
+// Cancellation
+// ============================================================================
+
+void NetworkManager::cancelRequest(quint64 requestId)
+{
+    bool wasJob = dropJob(requestId);
+    
+    auto it = m_pendingRequests.find(requestId);
+    if (it == m_pendingRequests.end()) {
+        // Queued jobs have nothing on the wire yet
+        if (wasJob) {
+            qDebug() << "🛑 Cancelled queued job" << requestId;
+            emit requestCancelled(requestId);
+        }
+        return;
+    }
+    
+    // Forget the request first so anything it emits while aborting is treated as stale
+    PendingRequest pending = it.value();
+    m_pendingRequests.erase(it);
+    
+    qDebug() << "🛑 Cancelling request" << requestId;
+    
+    m_backendPool->requestCancelled(pending.backendUrl);
+    
+    if (pending.reply) {
+        pending.reply->abort();
+    }
+    
+    if (pending.hedgeReply) {
+        pending.hedgeReply->abort();
+        m_backendPool->requestCancelled(pending.hedgeBackendUrl);
+        if (pending.hedgeBackendUrl != pending.backendUrl) {
+            notifyBackendCancelled(requestId, pending.hedgeBackendUrl);
+        }
+    }
+    
+    if (pending.streamRequest) {
+        pending.streamRequest->abort();
+        pending.streamRequest->deleteLater();
+        if (pending.streamRequest == m_streamingUpload) {
+            m_streamingUpload = nullptr;
+            m_streamingUploadId = 0;
+        }
+    }
+    
+    // Closing the connection alone doesn't stop an inference that already started
+    notifyBackendCancelled(requestId, pending.backendUrl);
+    
+    emit requestCancelled(requestId);
+}
+
+void NetworkManager::cancelAllRequests()
+{
+    const QList<quint64> ids = m_pendingRequests.keys();
+    for (quint64 requestId : ids) {
+        cancelRequest(requestId);
+    }
+}
+
+void NetworkManager::cancelStream()
+{
+    if (webSocketState() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+    
+    qDebug() << "🛑 Cancelling streaming session";
+    
+    // Partial/final results already in flight belong to the abandoned utterance
+    m_streamCancelled = true;
+    const QString message = QStringLiteral("{\"type\":\"cancel\"}");
+    withStreamSocket([&message](auto *socket) { return socket->sendTextMessage(message); });
+}
+
+quint64 NetworkManager::trackReply(QNetworkReply *reply, const QString &backendUrl)
+{
+    quint64 requestId = reply->property("requestId").toULongLong();
+    
+    PendingRequest pending;
+    pending.reply = reply;
+    pending.backendUrl = backendUrl;
+    pending.clock.start();
+    m_pendingRequests.insert(requestId, pending);
+    m_backendPool->requestStarted(backendUrl);
+    
+    return requestId;
+}
+
+QNetworkReply *NetworkManager::sendTranscription(quint64 requestId, const QString &path, const QNetworkRequest &request,
+                                                 const QByteArray &body, qint64 audioMs)
+{
+    PendingRequest pending;
+    pending.path = path;
+    pending.request = request;
+    pending.body = body;
+    pending.audioMs = audioMs;
+    pending.started.start();
+    m_pendingRequests.insert(requestId, pending);
+    
+    QNetworkReply *reply = postToBackend(requestId, m_backendPool->select());
+    
+    // Only requests with a known audio length have a comparable latency
+    if (m_hedgingEnabled && audioMs > 0) {
+        ++m_hedgeEligible;
+        qint64 delay = hedgeDelayMs(audioMs);
+        if (delay >= 0) {
+            // Tied to the reply: a finished or failed-over attempt disarms it
+            QTimer::singleShot(delay, reply, [this, requestId]() { sendHedge(requestId); });
+        }
+        emit hedgeStatsChanged();
+    }
+    
+    return reply;
+}
+
+QNetworkReply *NetworkManager::postToBackend(quint64 requestId, const QString &backendUrl)
+{
+    QNetworkReply *reply = postAttempt(requestId, backendUrl);
+    
+    PendingRequest &pending = m_pendingRequests[requestId];
+    pending.reply = reply;
+    pending.backendUrl = backendUrl;
+    pending.triedBackends << backendUrl;
+    pending.clock.start();
+    m_backendPool->requestStarted(backendUrl);
+    
+    // Job upload is done once the last body byte is handed to the socket
+    connect(reply, &QNetworkReply::uploadProgress, this, [this, requestId](qint64 bytesSent, qint64 bytesTotal) {
+        auto job = m_jobs.find(requestId);
+        if (job != m_jobs.end() && bytesTotal > 0 && bytesSent == bytesTotal && job->uploadedMs < 0) {
+            job->uploadedMs = job->clock.elapsed();
+        }
+    });
+    
+    return reply;
+}
+
+bool NetworkManager::canFailover(quint64 requestId) const
+{
+    auto it = m_pendingRequests.constFind(requestId);
+    if (it == m_pendingRequests.constEnd() || it->path.isEmpty()) {
+        return false;
+    }
+    
+    return !m_backendPool->select(it->triedBackends).isEmpty();
+}
+
+bool NetworkManager::failover(quint64 requestId)
+{
+    if (!canFailover(requestId)) {
+        return false;
+    }
+    
+    PendingRequest &pending = m_pendingRequests[requestId];
+    QString next = m_backendPool->select(pending.triedBackends);
+    qDebug() << "🔀 Failing over request" << requestId << "from" << pending.backendUrl << "to" << next;
+    
+    if (pending.streamRequest) {
+        // Nothing reached the failed backend, so the queued body is the whole body so far
+        HttpStreamRequest *failed = pending.streamRequest;
+        const QList<QByteArray> body = failed->takeUnsentBody();
+        const bool finishRequested = failed->isFinishRequested();
+        failed->deleteLater();
+        
+        HttpStreamRequest *upload = openStreamingUpload(requestId, next, body, finishRequested);
+        
+        // Audio still being captured goes to the replacement
+        if (m_streamingUpload == failed) {
+            m_streamingUpload = upload;
+        }
+    } else {
+        postToBackend(requestId, next);
+    }
+    
+    return true;
+}
+
+// ============================================================================
+// Hedging
+// ============================================================================
+
+qint64 NetworkManager::hedgeDelayMs(qint64 audioMs) const
+{
+    double msPerAudioSecond = latencyPercentile(HEDGE_PERCENTILE);
+    if (msPerAudioSecond < 0) {
+        return -1;
+    }
+    
+    return qMax<qint64>(HEDGE_MIN_DELAY_MS, qint64(msPerAudioSecond * audioMs / 1000.0));
+}
+
+void NetworkManager::sendHedge(quint64 requestId)
+{
+    auto it = m_pendingRequests.find(requestId);
+    if (it == m_pendingRequests.end() || !it->reply || it->reply->isFinished() || it->hedgeReply) {
+        return;
+    }
+    
+    // Prefer a different backend; a busy server is the usual cause of the delay
+    QString backendUrl = m_backendPool->select({it->backendUrl});
+    if (backendUrl.isEmpty()) {
+        backendUrl = it->backendUrl;
+    }
+    
+    qDebug() << "🪃 Hedging request" << requestId << "after" << it->clock.elapsed() << "ms, duplicate to" << backendUrl;
+    
+    // Same X-Request-Id: cancelling the loser by id can't hurt a winner that already finished
+    QNetworkReply *hedge = postAttempt(requestId, backendUrl);
+    
+    it->hedgeReply = hedge;
+    it->hedgeBackendUrl = backendUrl;
+    it->hedgeClock.start();
+    m_backendPool->requestStarted(backendUrl);
+    
+    ++m_hedgesSent;
+    m_hedgeBytes += it->body.size();
+    emit hedgeStatsChanged();
+}
+
+void NetworkManager::recordLatencySample(qint64 elapsedMs, qint64 audioMs)
+{
+    if (audioMs <= 0) {
+        return;
+    }
+    
+    m_latencySamples.append(elapsedMs * 1000.0 / audioMs);
+    if (m_latencySamples.size() > HEDGE_WINDOW) {
+        m_latencySamples.removeFirst();
+    }
+}
+
+double NetworkManager::latencyPercentile(double percentile) const
+{
+    if (m_latencySamples.size() < HEDGE_MIN_SAMPLES) {
+        return -1.0;
+    }
+    
+    QList<double> sorted = m_latencySamples;
+    auto nth = sorted.begin() + qMin<qsizetype>(sorted.size() - 1, qsizetype(sorted.size() * percentile));
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+QVariantMap NetworkManager::hedgeStats() const
+{
+    QVariantMap stats;
+    stats["eligible"] = m_hedgeEligible;
+    stats["hedged"] = m_hedgesSent;
+    stats["hedgeWins"] = m_hedgeWins;
+    stats["hedgeRate"] = m_hedgeEligible > 0 ? double(m_hedgesSent) / m_hedgeEligible : 0.0;
+    stats["winRate"] = m_hedgesSent > 0 ? double(m_hedgeWins) / m_hedgesSent : 0.0;
+    stats["extraBytes"] = m_hedgeBytes;
+    
+    // Threshold for one second of audio, -1 while still collecting samples
+    stats["thresholdMsPerAudioSecond"] = hedgeDelayMs(1000);
+    return stats;
+}
+
+// ============================================================================
+// Deadlines
+// ============================================================================
+
+qint64 NetworkManager::deadlineMs(qint64 audioMs, const QString &backendUrl) const
+{
+    // Container formats hide the audio length
+    if (audioMs <= 0) {
+        return DEFAULT_TIMEOUT_MS;
+    }
+    
+    // This backend's own speed, else the client-wide tail, else assume real time
+    double msPerAudioSecond = m_backendPool->msPerAudioSecond(backendUrl);
+    if (msPerAudioSecond < 0) {
+        msPerAudioSecond = latencyPercentile(HEDGE_PERCENTILE);
+    }
+    if (msPerAudioSecond < 0) {
+        msPerAudioSecond = DEADLINE_COLD_MS_PER_AUDIO_SECOND;
+    }
+    
+    qint64 budgetMs = DEADLINE_SLACK_MS + qint64(msPerAudioSecond * audioMs / 1000.0 * DEADLINE_MARGIN);
+    return qBound<qint64>(m_deadlineFloorMs, budgetMs, DEADLINE_MAX_MS);
+}
+
+QNetworkReply *NetworkManager::postAttempt(quint64 requestId, const QString &backendUrl)
+{
+    const PendingRequest &pending = m_pendingRequests[requestId];
+    const qint64 budgetMs = deadlineMs(pending.audioMs, backendUrl);
+    
+    QNetworkRequest request = pending.request;
+    request.setUrl(QUrl(backendUrl + pending.path));
+    
+    // Relative, so the backend can shed stale work without a synchronized clock
+    request.setRawHeader("X-Request-Timeout-Ms", QByteArray::number(budgetMs));
+    
+    // The timer below enforces the deadline; the inactivity timeout must not fire first
+    request.setTransferTimeout(int(budgetMs + DEADLINE_SLACK_MS));
+    
+    QNetworkReply *reply = m_networkManager->post(request, pending.body);
+    reply->setProperty("requestId", requestId);
+    
+    // Tied to the reply: an attempt that finished or was cancelled disarms it
+    QTimer::singleShot(budgetMs, reply, [reply, budgetMs, requestId]() {
+        if (reply->isFinished()) {
+            return;
+        }
+        qWarning() << "⏰ Request" << requestId << "missed its" << budgetMs << "ms deadline on" << reply->url().host();
+        reply->setProperty("deadlineExpired", true);
+        reply->abort();
+    });
     
     // Connect reply signals
     connect(reply, &QNetworkReply::finished, this, &NetworkManager::handleTranscribeReply);
     connect(reply, &QNetworkReply::errorOccurred, this, &NetworkManager::handleNetworkError);
     
-    qDebug() << "📤 Base64 transcription request sent to:" << url.toString();
+    return reply;
+}
+
+bool NetworkManager::deadlineExpired(QNetworkReply *reply)
+{
+    return reply->property("deadlineExpired").toBool();
+}
+
+qint64 NetworkManager::streamRemainingMs(const PendingRequest &pending)
+{
+    return qMax<qint64>(0, pending.streamBudgetMs - pending.started.elapsed());
+}
+
+bool NetworkManager::isBackendFault(QNetworkReply *reply)
+{
+    if (reply->error() == QNetworkReply::NoError) {
+        return false;
+    }
+    
+    // A 4xx is about the request, not the backend's health
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return status == 0 || status >= 500;
+}
+
+bool NetworkManager::isConnectError(QNetworkReply::NetworkError error)
+{
+    // Nothing was processed, so resending elsewhere can't duplicate work
+    switch (error) {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::SslHandshakeFailedError:
+            return true;
+        default:
+            return false;
+    }
 }
 
-void NetworkManager::checkHealth()
+bool NetworkManager::isRetryable(QNetworkReply *reply)
 {
-    QUrl url(m_backendUrl + "/health");
-    QNetworkRequest request(url);
-    request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
-    
-    QNetworkReply *reply = m_networkManager->get(request);
-    
-    connect(reply, &QNetworkReply::finished, this, &NetworkManager::handleHealthReply);
+    if (isConnectError(reply->error()) || deadlineExpired(reply)) {
+        return true;
+    }
     
-    // Don't log every health check to reduce spam
-    // qDebug() << "🏥 Health check sent to:" << url.toString();
+    // 504: the backend shed the request because its deadline passed while queued
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return status == 504;
 }
 
-void NetworkManager::getModelInfo()
+QByteArray NetworkManager::requestIdHeader(quint64 requestId) const
 {
-    qDebug() << "ℹ️ Requesting model info...";
-    
-    QUrl url(m_backendUrl + "/model/info");
+    // Unique across clients sharing one backend
+    return m_clientId.toLatin1() + '-' + QByteArray::number(requestId);
+}
+
+void NetworkManager::notifyBackendCancelled(quint64 requestId, const QString &backendUrl)
+{
+    QUrl url(backendUrl + "/cancel/" + QString::fromLatin1(requestIdHeader(requestId)));
     QNetworkRequest request(url);
     request.setRawHeader("User-Agent", "Qt6VoiceAssistant/2.0");
     
-    QNetworkReply *reply = m_networkManager->get(request);
-    
-    connect(reply, &QNetworkReply::finished, this, &NetworkManager::handleModelInfoReply);
-    connect(reply, &QNetworkReply::errorOccurred, this, &NetworkManager::handleNetworkError);
+    // Fire and forget; a failure here only costs backend CPU
+    QNetworkReply *reply = m_networkManager->post(request, QByteArray());
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
 }
 
 // ============================================================================
@@ -206,46 +1152,186 @@ void NetworkManager::handleTranscribeReply()
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) return;
     
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray response = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(response);
-        
-        if (!jsonDoc.isObject()) {
-            qWarning() << "❌ Invalid JSON response:" << response;
-            emit errorOccurred("Parse Error", "Invalid JSON response from backend");
-            reply->deleteLater();
-            return;
+    quint64 requestId = reply->property("requestId").toULongLong();
+    
+    // Cancelled and failed-over requests still finish; their results are stale
+    auto it = m_pendingRequests.find(requestId);
+    if (it == m_pendingRequests.end() || (it->reply != reply && it->hedgeReply != reply)) {
+        qDebug() << "🗑️ Dropping response for cancelled request" << requestId;
+        reply->deleteLater();
+        return;
+    }
+    
+    const bool isHedge = it->hedgeReply == reply;
+    const bool succeeded = reply->error() == QNetworkReply::NoError;
+    const QString backendUrl = isHedge ? it->hedgeBackendUrl : it->backendUrl;
+    
+    m_backendPool->requestFinished(backendUrl, !isBackendFault(reply),
+                                   isHedge ? it->hedgeClock.elapsed() : it->clock.elapsed(),
+                                   succeeded ? it->audioMs : 0);
+    if (isConnectError(reply->error())) {
+        m_backendPool->connectFailed(backendUrl);
+    }
+    
+    // One failed attempt of a hedged pair leaves the other to answer
+    if (!succeeded && it->hedgeReply && it->reply) {
+        if (!isHedge) {
+            it->reply = it->hedgeReply;
+            it->backendUrl = it->hedgeBackendUrl;
+            it->clock = it->hedgeClock;
+        }
+        it->hedgeReply = nullptr;
+        reply->deleteLater();
+        return;
+    }
+    
+    // A late answer is worthless; transcription is idempotent, so the abandoned
+    // attempt costs the old backend CPU at most
+    if (isRetryable(reply) && failover(requestId)) {
+        reply->deleteLater();
+        return;
+    }
+    
+    PendingRequest pending = m_pendingRequests.take(requestId);
+    
+    // First answer of a hedged pair wins; the other is abandoned
+    if (pending.hedgeReply && pending.reply) {
+        QNetworkReply *loser = isHedge ? pending.reply.data() : pending.hedgeReply.data();
+        QString loserBackend = isHedge ? pending.backendUrl : pending.hedgeBackendUrl;
+        loser->abort();
+        m_backendPool->requestCancelled(loserBackend);
+        if (loserBackend != backendUrl) {
+            notifyBackendCancelled(requestId, loserBackend);
         }
         
-        QJsonObject jsonObj = jsonDoc.object();
-        
-        QString text = jsonObj["text"].toString();
-        double duration = jsonObj["duration"].toDouble();
-        double inferenceTime = jsonObj["inference_time"].toDouble();
-        double rtf = jsonObj["rtf"].toDouble();
-        
-        qDebug() << "✅ Transcription received:" << text.left(100) << "...";
-        qDebug() << "⏱️ Duration:" << duration << "s, Inference:" << inferenceTime << "s, RTF:" << rtf << "x";
-        
-        emit transcriptionReceived(text, duration, inferenceTime, rtf);
+        if (isHedge) {
+            ++m_hedgeWins;
+        }
+        qDebug() << "🪃 Request" << requestId << "won by" << (isHedge ? "hedge" : "original") << "on" << backendUrl;
+        emit hedgeStatsChanged();
+    }
+    
+    if (succeeded) {
+        recordLatencySample(pending.started.elapsed(), pending.audioMs);
         
+        // A fresh answer is as good as a probe
+        scheduleHealthPoll();
+    }
+    
+    if (m_jobs.contains(requestId)) {
+        completeJob(requestId, reply);
+        reply->deleteLater();
+        return;
+    }
+    
+    if (reply->error() == QNetworkReply::NoError) {
+        processTranscriptionResponse(requestId, reply->readAll());
+    } else if (deadlineExpired(reply)) {
+        qWarning() << "❌ Transcription deadline exceeded on" << pending.triedBackends.join(", ");
+        emit errorOccurred("Deadline Exceeded",
+                           QString("No answer from %1 in time").arg(pending.triedBackends.join(", ")), requestId);
     } else {
         QString errorMsg = reply->errorString();
         QString details = QString::fromUtf8(reply->readAll());
         qWarning() << "❌ Transcription failed:" << errorMsg;
         qWarning() << "   Details:" << details;
-        emit errorOccurred("Transcription Error", errorMsg + "\n" + details);
+        emit errorOccurred("Transcription Error", errorMsg + "\n" + details, requestId);
     }
     
     reply->deleteLater();
 }
 
+void NetworkManager::handleStreamingUploadFinished()
+{
+    HttpStreamRequest *request = qobject_cast<HttpStreamRequest*>(sender());
+    if (!request) return;
+    
+    if (request == m_streamingUpload) {
+        m_streamingUpload = nullptr;
+        m_streamingUploadId = 0;
+    }
+    
+    quint64 requestId = request->property("requestId").toULongLong();
+    auto it = m_pendingRequests.find(requestId);
+    if (it == m_pendingRequests.end() || it->streamRequest != request) {
+        request->deleteLater();
+        return;
+    }
+    
+    PendingRequest pending = m_pendingRequests.take(requestId);
+    m_backendPool->requestFinished(pending.backendUrl, request->statusCode() == 200,
+                                   pending.clock.elapsed(), request->bytesSent() / PCM_BYTES_PER_MS);
+    m_tls.rememberSession(QUrl(pending.backendUrl), request->sslConfiguration());
+    
+    qDebug() << "📥 Progressive upload completed in" << request->elapsedMs() << "ms, status:" << request->statusCode();
+    
+    if (request->statusCode() == 200) {
+        processTranscriptionResponse(requestId, request->responseBody());
+    } else {
+        QString details = QString::fromUtf8(request->responseBody());
+        qWarning() << "❌ Progressive transcription failed: HTTP" << request->statusCode();
+        qWarning() << "   Details:" << details;
+        emit errorOccurred("Transcription Error",
+                           QString("HTTP %1\n%2").arg(request->statusCode()).arg(details), requestId);
+    }
+    
+    request->deleteLater();
+}
+
+void NetworkManager::handleStreamingUploadError(const QString &error)
+{
+    HttpStreamRequest *request = qobject_cast<HttpStreamRequest*>(sender());
+    if (!request) return;
+    
+    quint64 requestId = request->property("requestId").toULongLong();
+    auto it = m_pendingRequests.find(requestId);
+    if (it == m_pendingRequests.end() || it->streamRequest != request) {
+        if (request == m_streamingUpload) {
+            m_streamingUpload = nullptr;
+            m_streamingUploadId = 0;
+        }
+        request->deleteLater();
+        return;
+    }
+    
+    m_backendPool->requestFinished(it->backendUrl, false, it->clock.elapsed(), 0);
+    
+    // Never connected: the audio is still queued locally and can go elsewhere;
+    // failover() hands m_streamingUpload on to the replacement. A missed
+    // deadline has no budget left to spend on another backend.
+    if (request->connectMs() < 0 && !request->deadlineExpired()) {
+        m_backendPool->connectFailed(it->backendUrl);
+        if (failover(requestId)) {
+            return;
+        }
+    }
+    PendingRequest pending = m_pendingRequests.take(requestId);
+    
+    if (request == m_streamingUpload) {
+        m_streamingUpload = nullptr;
+        m_streamingUploadId = 0;
+    }
+    
+    if (request->deadlineExpired()) {
+        qWarning() << "❌ Progressive upload deadline exceeded on" << pending.triedBackends.join(", ");
+        emit errorOccurred("Deadline Exceeded",
+                           QString("No answer from %1 in time").arg(pending.triedBackends.join(", ")), requestId);
+    } else {
+        qWarning() << "❌ Progressive upload failed:" << error;
+        emit errorOccurred("Transcription Error", error, requestId);
+    }
+    
+    request->deleteLater();
+}
+
 void NetworkManager::handleHealthReply()
 {
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) return;
     
-    bool wasHealthy = m_isHealthy;
+    const QString backendUrl = reply->property("backendUrl").toString();
+    const qint64 latencyMs = m_clock.elapsed() - reply->property("probeStartMs").toLongLong();
+    bool healthy = false;
     
     if (reply->error() == QNetworkReply::NoError) {
         QByteArray response = reply->readAll();
@@ -256,27 +1342,22 @@ void NetworkManager::handleHealthReply()
             QString status = jsonObj["status"].toString();
             bool modelLoaded = jsonObj["model_loaded"].toBool();
             
-            bool healthy = (status == "healthy" && modelLoaded);
-            updateHealthStatus(healthy);
-            
-            if (healthy && !wasHealthy) {
-                qDebug() << "✅ Backend is healthy and model is loaded";
-            }
-            
-            emit healthCheckResult(healthy, ""); // Model name not in health response
-            
-        } else {
-            updateHealthStatus(false);
-        }
-    } else {
-        updateHealthStatus(false);
-        
-        // Only log errors on state change to reduce spam
-        if (wasHealthy) {
-            qWarning() << "❌ Health check failed:" << reply->errorString();
+            healthy = (status == "healthy" && modelLoaded);
         }
     }
     
+    // The pool logs per-backend transitions and onBackendsChanged() updates isHealthy
+    bool wasHealthy = m_isHealthy;
+    m_backendPool->recordProbe(backendUrl, healthy, latencyMs);
+    
+    if (!m_isHealthy && wasHealthy) {
+        qWarning() << "❌ Health check failed on every backend, last:" << reply->errorString();
+    }
+    
+    emit healthCheckResult(m_isHealthy, ""); // Model name not in health response
+    
+    scheduleHealthPoll();
+    
     reply->deleteLater();
 }
 
@@ -325,11 +1406,39 @@ void NetworkManager::handleNetworkError(QNetworkReply::NetworkError error)
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) return;
     
+    // Aborts triggered by cancelRequest() are not errors
+    quint64 requestId = reply->property("requestId").toULongLong();
+    if (requestId != 0 && !isPendingRequest(requestId)) {
+        return;
+    }
+    
+    // The other attempt of a hedged pair may still answer
+    auto pending = m_pendingRequests.constFind(requestId);
+    if (pending != m_pendingRequests.constEnd() && pending->reply && pending->hedgeReply) {
+        return;
+    }
+    
+    // Another backend will get the request; handleTranscribeReply() resends it
+    if (isRetryable(reply) && canFailover(requestId)) {
+        return;
+    }
+    
+    // Missed deadlines are reported by handleTranscribeReply(), not as a cancel
+    if (deadlineExpired(reply)) {
+        return;
+    }
+    
+    // Job failures are reported in submission order by deliverJobs()
+    if (m_jobs.contains(requestId)) {
+        qWarning() << "❌ Network error on job" << requestId << "-" << reply->errorString();
+        return;
+    }
+    
     QString errorMsg = errorCodeToString(error);
     QString details = reply->errorString();
     
     qWarning() << "❌ Network error:" << errorMsg << "-" << details;
-    emit errorOccurred(errorMsg, details);
+    emit errorOccurred(errorMsg, details, requestId);
 }
 
 void NetworkManager::handleUploadProgress(qint64 bytesSent, qint64 bytesTotal)
@@ -347,35 +1456,75 @@ void NetworkManager::handleUploadProgress(qint64 bytesSent, qint64 bytesTotal)
 
 void NetworkManager::connectWebSocket()
 {
-    if (m_webSocket->state() == QAbstractSocket::ConnectedState ||
-        m_webSocket->state() == QAbstractSocket::ConnectingState) {
+    if (webSocketState() == QAbstractSocket::ConnectedState ||
+        webSocketState() == QAbstractSocket::ConnectingState) {
         qDebug() << "🔌 WebSocket already connected or connecting";
         return;
     }
     
-    QString wsUrl = m_backendUrl;
+    m_webSocketTried.clear();
+    
+    // A co-located consumer reads audio straight out of shared memory
+    if (!m_sharedMemoryEndpoint.isEmpty()) {
+        qDebug() << "🧠 Opening shared-memory session via" << m_sharedMemoryEndpoint;
+        m_streamTransport = SharedMemory;
+        m_webSocketBackend.clear();
+        m_shmTransport->open(m_sharedMemoryEndpoint);
+        return;
+    }
+    
+    openWebSocket(m_backendPool->select());
+}
+
+void NetworkManager::openWebSocket(const QString &backendUrl)
+{
+    m_webSocketBackend = backendUrl;
+    m_webSocketTried << backendUrl;
+    
+    // Co-located backends: same protocol over a Unix domain socket, no TCP stack
+    m_streamTransport = LocalNetworkAccessManager::isLocalUrl(backendUrl) ? UnixWebSocket : TcpWebSocket;
+    
+    QString wsUrl = backendUrl;
     wsUrl.replace("http://", "ws://").replace("https://", "wss://");
-    wsUrl += "/stream";
+    // Ask for delta partials and a multiplexed session; older backends ignore
+    // the query, send full text and never say they multiplex
+    wsUrl += "/stream?partials=delta&mux=1";
     
     qDebug() << "🔌 Connecting WebSocket to:" << wsUrl;
-    m_webSocket->open(QUrl(wsUrl));
+    if (m_streamTransport == UnixWebSocket) {
+        m_localWebSocket->open(QUrl(wsUrl));
+    } else {
+        // QWebSocket doesn't expose its session, so it resumes with the ticket
+        // from REST traffic to the same host (health probes keep that fresh)
+        m_webSocket->setSslConfiguration(m_tls.configurationFor(QUrl(wsUrl)));
+        m_webSocket->open(QUrl(wsUrl));
+    }
+}
+
+QAbstractSocket::SocketState NetworkManager::webSocketState() const
+{
+    return withStreamSocket([](auto *socket) { return socket->state(); });
 }
 
 void NetworkManager::disconnectWebSocket()
 {
-    if (m_webSocket->state() == QAbstractSocket::ConnectedState) {
+    if (webSocketState() == QAbstractSocket::ConnectedState) {
         qDebug() << "🔌 Disconnecting WebSocket...";
-        m_webSocket->close();
+        withStreamSocket([](auto *socket) { socket->close(); });
     }
 }
 
 void NetworkManager::sendAudioChunk(const QByteArray &chunk)
 {
-    if (m_webSocket->state() == QAbstractSocket::ConnectedState) {
-        qint64 bytesSent = m_webSocket->sendBinaryMessage(chunk);
+    if (webSocketState() == QAbstractSocket::ConnectedState) {
+        // Multiplexed, microphone audio is the speech-to-text channel's only stream
+        const QByteArray message = m_multiplexed
+            ? StreamMux::encode(StreamMux::SpeechToText, 0, m_upstreamSequence++, chunk)
+            : chunk;
+        qint64 bytesSent = withStreamSocket([&message](auto *socket) { return socket->sendBinaryMessage(message); });
         
-        if (bytesSent != chunk.size()) {
-            qWarning() << "⚠️ WebSocket: Not all bytes sent!" << bytesSent << "/" << chunk.size();
+        if (bytesSent != message.size()) {
+            qWarning() << "⚠️ WebSocket: Not all bytes sent!" << bytesSent << "/" << message.size();
         }
     } else {
         qWarning() << "❌ WebSocket not connected, cannot send audio chunk";
@@ -385,6 +1534,13 @@ void NetworkManager::sendAudioChunk(const QByteArray &chunk)
 void NetworkManager::onWebSocketConnected()
 {
     qDebug() << "✅ WebSocket connected successfully";
+    m_streamCancelled = false;
+    m_upstreamSequence = 0;
+    
+    // The heartbeat replaces polling while the session is open
+    m_pingPending = false;
+    m_heartbeatTimer->start();
+    scheduleHealthPoll();
     updateConnectionStatus(true);
     emit webSocketConnected();
 }
@@ -392,60 +1548,268 @@ void NetworkManager::onWebSocketConnected()
 void NetworkManager::onWebSocketDisconnected()
 {
     qDebug() << "🔌 WebSocket disconnected";
+    m_heartbeatTimer->stop();
+    m_pingPending = false;
+    setMultiplexed(false);
     updateConnectionStatus(false);
+    scheduleHealthPoll();
     emit webSocketDisconnected();
 }
 
 void NetworkManager::onWebSocketTextMessageReceived(const QString &message)
 {
-    // Parse JSON message
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
-    
-    if (!jsonDoc.isObject()) {
+    // QWebSocket has already decoded to UTF-16; parse that without re-encoding
+    if (!m_messageParser.parse(QStringView(message))) {
         qWarning() << "❌ Invalid WebSocket JSON:" << message;
         return;
     }
     
-    QJsonObject jsonObj = jsonDoc.object();
-    QString type = jsonObj["type"].toString();
-    QString text = jsonObj["text"].toString();
-    double timestamp = jsonObj["timestamp"].toDouble();
+    // Speech control is rare next to partials; it gets a full parse
+    if (m_messageParser.channel() == StreamMux::TextToSpeech) {
+        handleSpeechMessage(QJsonDocument::fromJson(message.toUtf8()).object());
+        return;
+    }
+    
+    handleStreamMessage();
+}
+
+void NetworkManager::onStreamMessageReceived(const QByteArray &message)
+{
+    // Local transports hand over the UTF-8 bytes as received
+    if (!m_messageParser.parse(QByteArrayView(message))) {
+        qWarning() << "❌ Invalid stream message:" << message;
+        return;
+    }
+    
+    if (m_messageParser.channel() == StreamMux::TextToSpeech) {
+        handleSpeechMessage(QJsonDocument::fromJson(message).object());
+        return;
+    }
+    
+    handleStreamMessage();
+}
+
+void NetworkManager::handleStreamMessage()
+{
+    const StreamMessageParser::Type type = m_messageParser.type();
+    const QString &text = m_messageParser.text();
+    const double timestamp = m_messageParser.timestamp();
+    
+    if (type == StreamMessageParser::Cancelled) {
+        qDebug() << "🛑 Backend acknowledged stream cancel";
+        m_streamCancelled = false;
+        return;
+    }
+    
+    if (type == StreamMessageParser::Ready) {
+        // Shared memory carries audio one way only; it never multiplexes
+        setMultiplexed(m_messageParser.muxVersion() >= StreamMux::VERSION && m_streamTransport != SharedMemory);
+        return;
+    }
+    
+    if (m_streamCancelled) {
+        qDebug() << "🗑️ Dropping" << m_messageParser.typeName() << "result from cancelled stream";
+        return;
+    }
     
-    if (type == "partial") {
+    if (type == StreamMessageParser::Partial && m_messageParser.stableLength() >= 0) {
+        qDebug() << "📝 Partial transcription delta: keep" << m_messageParser.stableLength() << "+" << text;
+        emit partialTranscriptionDelta(m_messageParser.stableLength(), text, timestamp);
+    } else if (type == StreamMessageParser::Partial) {
         qDebug() << "📝 Partial transcription:" << text;
         emit partialTranscription(text, timestamp);
-    } else if (type == "final") {
+    } else if (type == StreamMessageParser::Final) {
         qDebug() << "✅ Final transcription:" << text;
         emit finalTranscription(text, timestamp);
     } else {
-        qWarning() << "❓ Unknown WebSocket message type:" << type;
+        qWarning() << "❓ Unknown WebSocket message type:" << m_messageParser.typeName();
     }
 }
 
 void NetworkManager::onWebSocketBinaryMessageReceived(const QByteArray &message)
 {
-    qDebug() << "📦 Received binary WebSocket message, size:" << message.size();
-    // Not expected in our protocol, but handle gracefully
+    StreamMux::Frame frame;
+    if (!m_multiplexed || !StreamMux::decode(message, &frame)) {
+        qDebug() << "📦 Ignoring binary WebSocket message, size:" << message.size();
+        return;
+    }
+    
+    // Frames of a cancelled stream can still be on the way
+    if (frame.channel != StreamMux::TextToSpeech || !m_speechStreams.contains(frame.stream)) {
+        return;
+    }
+    if (frame.isEnd()) {
+        m_speechStreams.remove(frame.stream);
+    }
+    emit speechAudioReceived(frame.stream, frame.sequence, frame.payload, frame.isEnd());
+}
+
+// ============================================================================
+// Speech Channel
+// ============================================================================
+
+quint32 NetworkManager::requestSpeech(const QString &text, const QString &voice, float rate)
+{
+    if (!m_multiplexed || webSocketState() != QAbstractSocket::ConnectedState) {
+        qWarning() << "❌ No multiplexed session, cannot request speech";
+        return 0;
+    }
+    
+    const quint32 stream = m_nextSpeechStream++;
+    if (m_nextSpeechStream == 0) {
+        m_nextSpeechStream = 1;
+    }
+    
+    QJsonObject json;
+    json["type"] = "tts";
+    json["channel"] = int(StreamMux::TextToSpeech);
+    json["stream"] = double(stream);
+    json["text"] = text;
+    json["rate"] = rate;
+    if (!voice.isEmpty()) {
+        json["voice"] = voice;
+    }
+    const QString message = QString::fromUtf8(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    withStreamSocket([&message](auto *socket) { return socket->sendTextMessage(message); });
+    m_speechStreams.insert(stream);
+    
+    qDebug() << "🗣️ Requested speech stream" << stream << "for" << text.left(40);
+    return stream;
+}
+
+void NetworkManager::cancelSpeech(quint32 stream)
+{
+    if (!m_speechStreams.remove(stream)) {
+        return;
+    }
+    
+    QJsonObject json;
+    json["type"] = "tts_cancel";
+    json["channel"] = int(StreamMux::TextToSpeech);
+    json["stream"] = double(stream);
+    const QString message = QString::fromUtf8(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    withStreamSocket([&message](auto *socket) { return socket->sendTextMessage(message); });
+}
+
+void NetworkManager::handleSpeechMessage(const QJsonObject &message)
+{
+    const quint32 stream = quint32(message["stream"].toDouble());
+    if (!m_speechStreams.contains(stream)) {
+        return;
+    }
+    
+    const QString type = message["type"].toString();
+    if (type == "tts_started") {
+        emit speechStreamStarted(stream, message["sampleRate"].toInt(), message["channels"].toInt(1));
+    } else if (type == "tts_failed") {
+        m_speechStreams.remove(stream);
+        qWarning() << "❌ Speech stream" << stream << "failed:" << message["message"].toString();
+        emit speechStreamFailed(stream, message["message"].toString());
+    } else {
+        qWarning() << "❓ Unknown speech message type:" << type;
+    }
+}
+
+void NetworkManager::setMultiplexed(bool multiplexed)
+{
+    if (!multiplexed) {
+        // Nothing more will arrive for streams still open
+        const QSet<quint32> open = m_speechStreams;
+        m_speechStreams.clear();
+        for (quint32 stream : open) {
+            emit speechStreamFailed(stream, "Session closed");
+        }
+    }
+    
+    if (m_multiplexed != multiplexed) {
+        m_multiplexed = multiplexed;
+        qDebug() << (multiplexed ? "🔀 Session multiplexed: speech and transcription share it"
+                                 : "🔀 Session no longer multiplexed");
+        emit multiplexedChanged();
+    }
 }
 
 void NetworkManager::onWebSocketError(QAbstractSocket::SocketError error)
 {
-    QString errorMsg = m_webSocket->errorString();
+    QString errorMsg = withStreamSocket([](auto *socket) { return socket->errorString(); });
     qWarning() << "❌ WebSocket error:" << error << "-" << errorMsg;
     
+    // Connect attempt failed: try the next backend before reporting anything
+    if (!m_isConnected && !m_webSocketBackend.isEmpty()) {
+        m_backendPool->connectFailed(m_webSocketBackend);
+        QString next = m_backendPool->select(m_webSocketTried);
+        if (!next.isEmpty()) {
+            qDebug() << "🔀 WebSocket failing over to" << next;
+            QTimer::singleShot(0, this, [this, next]() { openWebSocket(next); });
+            return;
+        }
+    }
+    
     updateConnectionStatus(false);
     emit webSocketError(errorMsg);
     emit errorOccurred("WebSocket Error", errorMsg);
 }
 
+void NetworkManager::onHeartbeatTimeout()
+{
+    if (!m_pingPending) {
+        m_pingPending = true;
+        m_pingClock.start();
+        withStreamSocket([](auto *socket) { socket->ping(); });
+        return;
+    }
+    
+    if (m_pingClock.elapsed() < HEARTBEAT_TIMEOUT_MS) {
+        return;
+    }
+    
+    // TCP can take minutes to notice a dead peer; a missed pong is enough
+    qWarning() << "💔 No heartbeat from" << m_webSocketBackend << "for" << m_pingClock.elapsed() << "ms";
+    m_heartbeatTimer->stop();
+    m_pingPending = false;
+    m_backendPool->connectFailed(m_webSocketBackend);
+    withStreamSocket([](auto *socket) { socket->abort(); });
+}
+
+void NetworkManager::onWebSocketPong(quint64 elapsedTime, const QByteArray &payload)
+{
+    Q_UNUSED(payload);
+    
+    m_pingPending = false;
+    m_backendPool->recordProbe(m_webSocketBackend, true, qint64(elapsedTime));
+}
+
 void NetworkManager::onWebSocketSslErrors(const QList<QSslError> &errors)
 {
+    if (m_tls.acceptsErrors(errors)) {
+        qDebug() << "🔒 WebSocket certificate is pinned, accepting" << errors.size() << "certificate error(s)";
+        m_webSocket->ignoreSslErrors(errors);
+        return;
+    }
+    
+    // Unpinned: the handshake fails and onWebSocketError() tries the next backend
     for (const QSslError &error : errors) {
         qWarning() << "🔒 WebSocket SSL error:" << error.errorString();
     }
+}
+
+void NetworkManager::onSslErrors(QNetworkReply *reply, const QList<QSslError> &errors)
+{
+    if (m_tls.acceptsErrors(errors)) {
+        qDebug() << "🔒 Certificate of" << reply->url().host() << "is pinned, accepting" << errors.size() << "certificate error(s)";
+        reply->ignoreSslErrors(errors);
+        return;
+    }
     
-    // For development, you might want to ignore SSL errors
-    // m_webSocket->ignoreSslErrors();
+    for (const QSslError &error : errors) {
+        qWarning() << "🔒 SSL error on" << reply->url().host() << ":" << error.errorString();
+    }
+}
+
+void NetworkManager::onRequestFinished(QNetworkReply *reply)
+{
+    // Tickets arrive after the handshake; a finished reply has read them
+    m_tls.rememberSession(reply->url(), reply->sslConfiguration());
 }
 
 // ============================================================================
@@ -465,7 +1829,54 @@ void NetworkManager::updateHealthStatus(bool healthy)
     if (m_isHealthy != healthy) {
         m_isHealthy = healthy;
         emit isHealthyChanged();
+        
+        if (healthy) {
+            qDebug() << "✅ Backend is healthy and model is loaded";
+        }
+        
+        // Stay attentive right after a change
+        m_healthPollIntervalMs = HEALTH_POLL_MIN_MS;
+        scheduleHealthPoll();
+    }
+}
+
+void NetworkManager::onBackendsChanged()
+{
+    updateHealthStatus(m_backendPool->hasHealthyBackend());
+}
+
+void NetworkManager::scheduleHealthPoll()
+{
+    // Heartbeats cover the backend of an open session; half-open probes cover failed ones
+    if (m_heartbeatTimer->isActive() && m_backendPool->size() == 1) {
+        m_healthPollTimer->stop();
+        return;
+    }
+    
+    m_healthPollTimer->start(m_healthPollIntervalMs);
+}
+
+void NetworkManager::processTranscriptionResponse(quint64 requestId, const QByteArray &response)
+{
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(response);
+    
+    if (!jsonDoc.isObject()) {
+        qWarning() << "❌ Invalid JSON response:" << response;
+        emit errorOccurred("Parse Error", "Invalid JSON response from backend", requestId);
+        return;
     }
+    
+    QJsonObject jsonObj = jsonDoc.object();
+    
+    QString text = jsonObj["text"].toString();
+    double duration = jsonObj["duration"].toDouble();
+    double inferenceTime = jsonObj["inference_time"].toDouble();
+    double rtf = jsonObj["rtf"].toDouble();
+    
+    qDebug() << "✅ Transcription received:" << text.left(100) << "...";
+    qDebug() << "⏱️ Duration:" << duration << "s, Inference:" << inferenceTime << "s, RTF:" << rtf << "x";
+    
+    emit transcriptionReceived(text, duration, inferenceTime, rtf, requestId);
 }
 
 QString NetworkManager::errorCodeToString(QNetworkReply::NetworkError error) const
@@ -8,13 +8,43 @@
 #include <QByteArray>
 #include <QString>
 #include <QJsonObject>
+#include <QHash>
+#include <QPointer>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <QStringList>
+#include <QSet>
+#include "backendpool.h"
+#include "streammessageparser.h"
+#include "streammux.h"
+#include "tlsconfig.h"
+
+class HttpStreamRequest;
+class LocalNetworkAccessManager;
+class LocalWebSocket;
+class ShmAudioTransport;
 
 class NetworkManager : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QString backendUrl READ backendUrl WRITE setBackendUrl NOTIFY backendUrlChanged)
+    Q_PROPERTY(QStringList backendUrls READ backendUrls WRITE setBackendUrls NOTIFY backendUrlsChanged)
+    Q_PROPERTY(BackendPool* backendPool READ backendPool CONSTANT)
     Q_PROPERTY(bool isConnected READ isConnected NOTIFY isConnectedChanged)
     Q_PROPERTY(bool isHealthy READ isHealthy NOTIFY isHealthyChanged)
+    Q_PROPERTY(int maxConcurrentJobs READ maxConcurrentJobs WRITE setMaxConcurrentJobs NOTIFY maxConcurrentJobsChanged)
+    Q_PROPERTY(bool orderedDelivery READ orderedDelivery WRITE setOrderedDelivery NOTIFY orderedDeliveryChanged)
+    Q_PROPERTY(int queuedJobs READ queuedJobs NOTIFY jobQueueChanged)
+    Q_PROPERTY(int runningJobs READ runningJobs NOTIFY jobQueueChanged)
+    Q_PROPERTY(bool hedgingEnabled READ hedgingEnabled WRITE setHedgingEnabled NOTIFY hedgingEnabledChanged)
+    Q_PROPERTY(QVariantMap hedgeStats READ hedgeStats NOTIFY hedgeStatsChanged)
+    Q_PROPERTY(bool tlsSessionResumption READ tlsSessionResumption WRITE setTlsSessionResumption NOTIFY tlsSessionResumptionChanged)
+    Q_PROPERTY(QString pinnedCertificateFile READ pinnedCertificateFile WRITE setPinnedCertificateFile NOTIFY pinnedCertificateFileChanged)
+    Q_PROPERTY(int deadlineFloorMs READ deadlineFloorMs WRITE setDeadlineFloorMs NOTIFY deadlineFloorMsChanged)
+    Q_PROPERTY(QString sharedMemoryEndpoint READ sharedMemoryEndpoint WRITE setSharedMemoryEndpoint NOTIFY sharedMemoryEndpointChanged)
+    Q_PROPERTY(bool multiplexed READ isMultiplexed NOTIFY multiplexedChanged)
     
 public:
     explicit NetworkManager(QObject *parent = nullptr);
@@ -22,47 +52,115 @@ public:
     
     // Getters
     QString backendUrl() const { return m_backendUrl; }
+    QStringList backendUrls() const { return m_backendPool->urls(); }
+    BackendPool *backendPool() const { return m_backendPool; }
     bool isConnected() const { return m_isConnected; }
     bool isHealthy() const { return m_isHealthy; }
+    int maxConcurrentJobs() const { return m_maxConcurrentJobs; }
+    bool orderedDelivery() const { return m_orderedDelivery; }
+    int queuedJobs() const { return m_jobQueue.size(); }
+    int runningJobs() const { return m_runningJobs; }
+    bool hedgingEnabled() const { return m_hedgingEnabled; }
+    QVariantMap hedgeStats() const;
+    int deadlineFloorMs() const { return m_deadlineFloorMs; }
+    bool tlsSessionResumption() const { return m_tls.isResumptionEnabled(); }
+    QString pinnedCertificateFile() const { return m_pinnedCertificateFile; }
+    QString sharedMemoryEndpoint() const { return m_sharedMemoryEndpoint; }
+    bool isSharedMemorySession() const { return m_streamTransport == SharedMemory; }
+    bool isMultiplexed() const { return m_multiplexed; }
     
     // Setters
     void setBackendUrl(const QString &url);
-
+    void setBackendUrls(const QStringList &urls);
+    void setMaxConcurrentJobs(int count);
+    void setOrderedDelivery(bool ordered);
+    void setHedgingEnabled(bool enabled);
+    void setDeadlineFloorMs(int ms);
+    void setTlsSessionResumption(bool enabled);
+    void setPinnedCertificateFile(const QString &pemPath); // empty: trust the system CAs
+    void setTlsSessionCacheFile(const QString &path); // empty: keep tickets in memory only
+    void setSharedMemoryEndpoint(const QString &controlPath);
+    
+    // Request encoding (public for benchmarks)
+    static QByteArray buildBase64JsonPayload(const QByteArray &audioData, const QString &language);
+    
 public slots:
-    // REST API methods
-    void transcribeFile(const QString &filePath, const QString &language = "en");
-    void transcribeBase64(const QByteArray &audioData, const QString &language = "en");
+    // REST API methods (return a request ID usable with cancelRequest())
+    quint64 transcribeFile(const QString &filePath, const QString &language = "en");
+    quint64 transcribeBase64(const QByteArray &audioData, const QString &language = "en");
+    quint64 transcribeRaw(const QByteArray &pcmData, const QString &language = "en");
     void checkHealth();
     void getModelInfo();
     
+    // Job queue: raw PCM uploads, at most maxConcurrentJobs in flight
+    quint64 enqueueTranscription(const QByteArray &pcmData, const QString &language = "en");
+    
+    // Progressive upload: POST /transcribe/stream with chunked PCM body
+    quint64 beginStreamingTranscription(const QString &language = "en");
+    void appendStreamingAudio(const QByteArray &pcm);
+    void finishStreamingTranscription();
+    void abortStreamingTranscription();
+    
+    // Cancellation: aborts the upload and tells the backend to drop the work
+    void cancelRequest(quint64 requestId);
+    void cancelAllRequests();
+    void cancelStream();
+    
     // WebSocket methods
     void connectWebSocket();
     void disconnectWebSocket();
     void sendAudioChunk(const QByteArray &chunk);
     
+    // Speech synthesis on the multiplexed session; 0 when there is none
+    quint32 requestSpeech(const QString &text, const QString &voice = QString(), float rate = 1.0f);
+    void cancelSpeech(quint32 stream);
+    
     // Utility
     void setLanguage(const QString &language) { m_language = language; }
-
+    
 signals:
     // REST API signals
-    void transcriptionReceived(const QString &text, double duration, double inferenceTime, double rtf);
+    void transcriptionReceived(const QString &text, double duration, double inferenceTime, double rtf, quint64 requestId = 0);
+    void requestCancelled(quint64 requestId);
+    void jobFinished(quint64 requestId, const QString &text, const QVariantMap &timing);
+    void jobFailed(quint64 requestId, const QString &error, const QVariantMap &timing);
+    void jobQueueChanged();
+    void maxConcurrentJobsChanged();
+    void orderedDeliveryChanged();
+    void hedgingEnabledChanged();
+    void hedgeStatsChanged();
+    void deadlineFloorMsChanged();
+    void tlsSessionResumptionChanged();
+    void pinnedCertificateFileChanged();
+    void sharedMemoryEndpointChanged();
     void healthCheckResult(bool healthy, const QString &modelName);
     void modelInfoReceived(const QJsonObject &info);
-    void errorOccurred(const QString &error, const QString &details);
+    void errorOccurred(const QString &error, const QString &details, quint64 requestId = 0);
     void backendUrlChanged();
+    void backendUrlsChanged();
     void isConnectedChanged();
     void isHealthyChanged();
     
     // WebSocket signals
     void partialTranscription(const QString &text, double timestamp);
+    // Keep the first stableLength UTF-16 units of the previous hypothesis
+    // (they are committed) and replace the rest with tail
+    void partialTranscriptionDelta(int stableLength, const QString &tail, double timestamp);
     void finalTranscription(const QString &text, double timestamp);
     void webSocketConnected();
     void webSocketDisconnected();
     void webSocketError(const QString &error);
+    void multiplexedChanged();
+    
+    // Speech streamed down the multiplexed session; a stream ends with end
+    // set or with speechStreamFailed(), and not at all once cancelled
+    void speechStreamStarted(quint32 stream, int sampleRate, int channels);
+    void speechAudioReceived(quint32 stream, quint16 sequence, const QByteArray &pcm, bool end);
+    void speechStreamFailed(quint32 stream, const QString &error);
     
     // Progress signals
     void uploadProgress(qint64 bytesSent, qint64 bytesTotal);
-
+    
 private slots:
     // REST API handlers
     void handleTranscribeReply();
@@ -70,30 +168,217 @@ private slots:
     void handleModelInfoReply();
     void handleNetworkError(QNetworkReply::NetworkError error);
     void handleUploadProgress(qint64 bytesSent, qint64 bytesTotal);
+    void onRequestFinished(QNetworkReply *reply);
+    void onSslErrors(QNetworkReply *reply, const QList<QSslError> &errors);
+    void handleStreamingUploadFinished();
+    void handleStreamingUploadError(const QString &error);
     
     // WebSocket handlers
     void onWebSocketConnected();
     void onWebSocketDisconnected();
     void onWebSocketTextMessageReceived(const QString &message);
+    void onStreamMessageReceived(const QByteArray &message);
     void onWebSocketBinaryMessageReceived(const QByteArray &message);
     void onWebSocketError(QAbstractSocket::SocketError error);
     void onWebSocketSslErrors(const QList<QSslError> &errors);
-
+    void onWebSocketPong(quint64 elapsedTime, const QByteArray &payload);
+    void onHeartbeatTimeout();
+    
+    // Health
+    void onBackendsChanged();
+    void probeBackend(const QString &backendUrl);
+    
 private:
     void updateConnectionStatus(bool connected);
     void updateHealthStatus(bool healthy);
+    void processTranscriptionResponse(quint64 requestId, const QByteArray &response);
     QString errorCodeToString(QNetworkReply::NetworkError error) const;
+    QNetworkReply *postRaw(quint64 requestId, const QByteArray &pcmData, const QString &language);
+    
+    // Backend routing and failover
+    QNetworkReply *sendTranscription(quint64 requestId, const QString &path, const QNetworkRequest &request,
+                                     const QByteArray &body, qint64 audioMs);
+    QNetworkReply *postToBackend(quint64 requestId, const QString &backendUrl);
+    HttpStreamRequest *openStreamingUpload(quint64 requestId, const QString &backendUrl,
+                                           const QList<QByteArray> &body = {}, bool finishRequested = false);
+    bool canFailover(quint64 requestId) const;
+    bool failover(quint64 requestId);
+    void openWebSocket(const QString &backendUrl);
+    QAbstractSocket::SocketState webSocketState() const;
+    void handleStreamMessage();
+    void handleSpeechMessage(const QJsonObject &message);
+    void setMultiplexed(bool multiplexed);
+    
+    // Calls function with whichever client carries the streaming session
+    template <typename Function>
+    auto withStreamSocket(Function function) const
+    {
+        switch (m_streamTransport) {
+            case UnixWebSocket:
+                return function(m_localWebSocket);
+            case SharedMemory:
+                return function(m_shmTransport);
+            default:
+                return function(m_webSocket);
+        }
+    }
+    static bool isConnectError(QNetworkReply::NetworkError error);
+    static bool isBackendFault(QNetworkReply *reply);
+    static bool isRetryable(QNetworkReply *reply);
+    void scheduleHealthPoll();
+    
+    // Hedging
+    qint64 hedgeDelayMs(qint64 audioMs) const;
+    void sendHedge(quint64 requestId);
+    void recordLatencySample(qint64 elapsedMs, qint64 audioMs);
+    double latencyPercentile(double percentile) const;
     
-    QNetworkAccessManager *m_networkManager;
+    // Deadlines: every attempt gets a budget and is abandoned when it runs out
+    qint64 deadlineMs(qint64 audioMs, const QString &backendUrl) const;
+    QNetworkReply *postAttempt(quint64 requestId, const QString &backendUrl);
+    static bool deadlineExpired(QNetworkReply *reply);
+    
+    // Job queue
+    void dispatchJobs();
+    void completeJob(quint64 requestId, QNetworkReply *reply);
+    void deliverJobs();
+    bool dropJob(quint64 requestId);
+    
+    // Request tracking
+    quint64 trackReply(QNetworkReply *reply, const QString &backendUrl);
+    QByteArray requestIdHeader(quint64 requestId) const;
+    bool isPendingRequest(quint64 requestId) const { return m_pendingRequests.contains(requestId); }
+    void notifyBackendCancelled(quint64 requestId, const QString &backendUrl);
+    
+    TlsConfig m_tls; // shared by REST, progressive uploads and the WebSocket
+    QString m_pinnedCertificateFile;
+    LocalNetworkAccessManager *m_networkManager;
+    BackendPool *m_backendPool;
     QWebSocket *m_webSocket;
-    QString m_backendUrl;
+    LocalWebSocket *m_localWebSocket; // used instead for unix:// backends
+    ShmAudioTransport *m_shmTransport; // used instead when sharedMemoryEndpoint is set
+    QString m_sharedMemoryEndpoint;
+    
+    enum StreamTransport {
+        TcpWebSocket,
+        UnixWebSocket,
+        SharedMemory
+    };
+    StreamTransport m_streamTransport;
+    HttpStreamRequest *m_streamingUpload;
+    quint64 m_streamingUploadId;
+    QString m_backendUrl; // first entry of the pool
+    QString m_webSocketBackend;
+    QStringList m_webSocketTried; // backends that refused the current connect attempt
     QString m_language;
     bool m_isConnected;
     bool m_isHealthy;
     
+    // In-flight transcription requests, keyed by request ID
+    struct PendingRequest {
+        QPointer<QNetworkReply> reply;
+        QPointer<HttpStreamRequest> streamRequest;
+        QString backendUrl;
+        QElapsedTimer clock; // since the current attempt was sent
+        
+        // Replay data; failover is only possible when path is set
+        QString path;
+        QNetworkRequest request;
+        QByteArray body;
+        qint64 audioMs = 0;
+        QStringList triedBackends;
+        QElapsedTimer started; // first attempt, survives failover and hedging
+        
+        // Progressive uploads: audio written so far, and the deadline from started
+        qint64 streamedBytes = 0;
+        qint64 streamBudgetMs = 0;
+        
+        // Duplicate sent when the first attempt is slower than usual
+        QPointer<QNetworkReply> hedgeReply;
+        QString hedgeBackendUrl;
+        QElapsedTimer hedgeClock;
+    };
+    QHash<quint64, PendingRequest> m_pendingRequests;
+    static qint64 streamRemainingMs(const PendingRequest &pending);
+    quint64 m_nextRequestId;
+    QString m_clientId;
+    QElapsedTimer m_clock; // timestamps health probes
+    
+    // Health: heartbeats while a session is open, backed-off polling when idle
+    QTimer *m_healthPollTimer;
+    QTimer *m_heartbeatTimer;
+    int m_healthPollIntervalMs;
+    bool m_pingPending;
+    QElapsedTimer m_pingClock;
+    
+    // Set by cancelStream(); results arriving before the next session are dropped
+    bool m_streamCancelled;
+    StreamMessageParser m_messageParser; // reused for every streaming message
+    
+    // Multiplexed session (StreamMux): set once the backend's ready says so
+    bool m_multiplexed;
+    quint16 m_upstreamSequence;
+    quint32 m_nextSpeechStream;
+    QSet<quint32> m_speechStreams; // requested, not yet ended, failed or cancelled
+    
+    // Queued transcription jobs; times are ms since enqueue, -1 if not reached
+    struct TranscriptionJob {
+        QByteArray pcmData;
+        QString language;
+        QElapsedTimer clock;
+        qint64 dispatchedMs = -1;
+        qint64 uploadedMs = -1;
+        qint64 finishedMs = -1;
+        qint64 parseUs = 0;
+        double serverInferenceMs = 0.0;
+        
+        // Result, held until it's this job's turn to be delivered
+        bool completed = false;
+        bool succeeded = false;
+        QString text;
+        double duration = 0.0;
+        double inferenceTime = 0.0;
+        double rtf = 0.0;
+        QString error;
+        QString errorDetails;
+        
+        QVariantMap timing() const;
+    };
+    QHash<quint64, TranscriptionJob> m_jobs;
+    QQueue<quint64> m_jobQueue;        // waiting for a slot
+    QList<quint64> m_deliveryOrder;    // submission order, undelivered
+    int m_runningJobs;
+    int m_maxConcurrentJobs;
+    bool m_orderedDelivery;
+    
+    // Hedged requests; latency samples are ms per second of audio, newest last
+    bool m_hedgingEnabled;
+    QList<double> m_latencySamples;
+    int m_hedgeEligible;
+    int m_hedgesSent;
+    int m_hedgeWins;
+    qint64 m_hedgeBytes;
+    
+    // Shortest budget any transcription attempt gets
+    int m_deadlineFloorMs;
+    
     // Configuration
-    static constexpr int DEFAULT_TIMEOUT_MS = 30000; // 30 seconds
-    static constexpr int HEALTH_CHECK_INTERVAL_MS = 10000; // 10 seconds
+    static constexpr int DEFAULT_TIMEOUT_MS = 30000; // 30 seconds, requests without a deadline
+    static constexpr int HEALTH_POLL_MIN_MS = 2000; // after a health change
+    static constexpr int HEALTH_POLL_MAX_MS = 60000; // idle and stable
+    static constexpr int HEARTBEAT_INTERVAL_MS = 250;
+    static constexpr int HEARTBEAT_TIMEOUT_MS = 750; // missed pong => backend down
+    static constexpr int DEFAULT_MAX_CONCURRENT_JOBS = 2;
+    static constexpr int PCM_BYTES_PER_MS = 32; // 16 kHz mono s16le
+    static constexpr int HEDGE_WINDOW = 100; // latency samples kept
+    static constexpr int HEDGE_MIN_SAMPLES = 10; // no hedging before the percentile means something
+    static constexpr double HEDGE_PERCENTILE = 0.9;
+    static constexpr int HEDGE_MIN_DELAY_MS = 100;
+    static constexpr int DEFAULT_DEADLINE_FLOOR_MS = 3000; // a voice command older than this is worthless
+    static constexpr int DEADLINE_MAX_MS = 300000;
+    static constexpr int DEADLINE_SLACK_MS = 500; // upload, queueing and response, on top of inference
+    static constexpr double DEADLINE_MARGIN = 2.0; // times the expected inference time
+    static constexpr double DEADLINE_COLD_MS_PER_AUDIO_SECOND = 1000.0; // real time, before any sample
 };
 
 #endif // NETWORKMANAGER_H
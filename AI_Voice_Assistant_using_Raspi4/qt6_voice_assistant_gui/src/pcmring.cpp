@@ -0,0 +1,383 @@
+#include "pcmring.h"
+#include <QDebug>
+#include <cstring>
+#include <new>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef Q_OS_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+// ============================================================================
+// Shared Layout
+// ============================================================================
+
+// Positions are byte counters that only grow; offset = position % capacity.
+// Producer and consumer fields live on separate cache lines.
+struct PcmRing::Header {
+    quint32 magic;
+    quint32 version;
+    quint64 capacity;
+    
+    alignas(64) std::atomic<quint64> writePos;
+    std::atomic<quint64> nextSequence;
+    std::atomic<quint64> droppedFrames;
+    
+    alignas(64) std::atomic<quint64> readPos;
+    
+    alignas(64) std::atomic<quint32> dataSeq; // futex word, bumped on every write
+    std::atomic<quint32> consumerWaiting;
+    std::atomic<quint32> closed;
+};
+
+struct PcmRing::FrameHeader {
+    quint32 size;
+    quint32 flags;
+    qint64 captureNs;
+    quint64 sequence;
+};
+
+static_assert(std::atomic<quint64>::is_always_lock_free, "PcmRing needs lock-free 64-bit atomics");
+static_assert(std::atomic<quint32>::is_always_lock_free, "PcmRing needs lock-free 32-bit atomics");
+
+namespace {
+
+constexpr quint32 FRAME_PADDING = 1; // rest of the buffer is unused, continue at offset 0
+
+void futexWait(std::atomic<quint32> *word, quint32 expected, int timeoutMs)
+{
+#ifdef Q_OS_LINUX
+    // Not FUTEX_PRIVATE: the word is shared between processes
+    timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<quint32*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    Q_UNUSED(expected);
+    Q_UNUSED(timeoutMs);
+    usleep(1000);
+#endif
+}
+
+void futexWake(std::atomic<quint32> *word)
+{
+#ifdef Q_OS_LINUX
+    syscall(SYS_futex, reinterpret_cast<quint32*>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    Q_UNUSED(word);
+#endif
+}
+
+}
+
+PcmRing::PcmRing()
+    : m_header(nullptr)
+    , m_data(nullptr)
+    , m_mappedSize(0)
+    , m_owner(false)
+    , m_peekedSize(0)
+{
+}
+
+PcmRing::~PcmRing()
+{
+    close();
+}
+
+// ============================================================================
+// Segment Lifecycle
+// ============================================================================
+
+bool PcmRing::create(const QString &name, qint64 capacityBytes)
+{
+    close();
+    
+    const QByteArray shmName = name.toLocal8Bit();
+    capacityBytes = (capacityBytes + 7) & ~qint64(7);
+    
+    // A stale segment from a crashed run would have the wrong layout
+    shm_unlink(shmName.constData());
+    
+    int fd = shm_open(shmName.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        m_errorString = QString("shm_open(%1) failed: %2").arg(name, QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    
+    const qint64 size = sizeof(Header) + capacityBytes;
+    if (ftruncate(fd, size) != 0) {
+        m_errorString = QString("ftruncate failed: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        ::close(fd);
+        shm_unlink(shmName.constData());
+        return false;
+    }
+    
+    m_owner = true;
+    m_name = name;
+    if (!map(fd, size, true, capacityBytes)) {
+        shm_unlink(shmName.constData());
+        m_owner = false;
+        return false;
+    }
+    
+    qDebug() << "🧠 PCM ring created:" << name << capacityBytes << "bytes";
+    return true;
+}
+
+bool PcmRing::attach(const QString &name)
+{
+    close();
+    
+    int fd = shm_open(name.toLocal8Bit().constData(), O_RDWR, 0);
+    if (fd < 0) {
+        m_errorString = QString("shm_open(%1) failed: %2").arg(name, QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || qint64(info.st_size) <= qint64(sizeof(Header))) {
+        m_errorString = QString("%1 is not a PCM ring").arg(name);
+        ::close(fd);
+        return false;
+    }
+    
+    m_name = name;
+    return map(fd, info.st_size, false, 0);
+}
+
+bool PcmRing::map(int fd, qint64 size, bool initialize, qint64 capacityBytes)
+{
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    
+    if (address == MAP_FAILED) {
+        m_errorString = QString("mmap failed: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    
+    Header *header = static_cast<Header*>(address);
+    
+    if (initialize) {
+        new (header) Header();
+        header->magic = MAGIC;
+        header->version = VERSION;
+        header->capacity = capacityBytes;
+        header->writePos.store(0);
+        header->nextSequence.store(0);
+        header->droppedFrames.store(0);
+        header->readPos.store(0);
+        header->dataSeq.store(0);
+        header->consumerWaiting.store(0);
+        header->closed.store(0);
+    } else if (header->magic != MAGIC || header->version != VERSION
+               || qint64(sizeof(Header) + header->capacity) != size) {
+        m_errorString = QString("%1 has an incompatible layout").arg(m_name);
+        munmap(address, size);
+        return false;
+    }
+    
+    m_header = header;
+    m_data = static_cast<char*>(address) + sizeof(Header);
+    m_mappedSize = size;
+    m_peekedSize = 0;
+    return true;
+}
+
+void PcmRing::close()
+{
+    if (!m_header) {
+        return;
+    }
+    
+    if (m_owner) {
+        markClosed();
+    }
+    
+    munmap(m_header, m_mappedSize);
+    m_header = nullptr;
+    m_data = nullptr;
+    m_mappedSize = 0;
+    
+    // The consumer keeps its mapping; the name just stops resolving
+    if (m_owner) {
+        shm_unlink(m_name.toLocal8Bit().constData());
+        m_owner = false;
+    }
+}
+
+qint64 PcmRing::capacity() const
+{
+    return m_header ? qint64(m_header->capacity) : 0;
+}
+
+quint64 PcmRing::droppedFrames() const
+{
+    return m_header ? m_header->droppedFrames.load(std::memory_order_relaxed) : 0;
+}
+
+qint64 PcmRing::monotonicNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return qint64(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+qint64 PcmRing::alignedSize(qint64 payloadSize)
+{
+    return (qint64(sizeof(FrameHeader)) + payloadSize + 7) & ~qint64(7);
+}
+
+// ============================================================================
+// Producer
+// ============================================================================
+
+bool PcmRing::write(const char *data, qint64 size, qint64 captureNs)
+{
+    if (!m_header || size <= 0) {
+        return false;
+    }
+    
+    const qint64 capacity = m_header->capacity;
+    const qint64 recordSize = alignedSize(size);
+    if (recordSize > capacity / 2) {
+        m_header->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    quint64 writePos = m_header->writePos.load(std::memory_order_relaxed);
+    const quint64 readPos = m_header->readPos.load(std::memory_order_acquire);
+    
+    const qint64 offset = writePos % capacity;
+    const qint64 contiguous = capacity - offset;
+    const qint64 skip = contiguous < recordSize ? contiguous : 0;
+    
+    if (qint64(writePos - readPos) + skip + recordSize > capacity) {
+        // Consumer is behind; losing a block beats stalling capture
+        m_header->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    if (skip > 0) {
+        // Tails shorter than a frame header are skipped implicitly by both sides
+        if (skip >= qint64(sizeof(FrameHeader))) {
+            FrameHeader *padding = reinterpret_cast<FrameHeader*>(m_data + offset);
+            padding->size = 0;
+            padding->flags = FRAME_PADDING;
+        }
+        writePos += skip;
+    }
+    
+    FrameHeader *frame = reinterpret_cast<FrameHeader*>(m_data + writePos % capacity);
+    frame->size = quint32(size);
+    frame->flags = 0;
+    frame->captureNs = captureNs;
+    frame->sequence = m_header->nextSequence.fetch_add(1, std::memory_order_relaxed);
+    std::memcpy(frame + 1, data, size);
+    
+    m_header->writePos.store(writePos + recordSize, std::memory_order_seq_cst);
+    m_header->dataSeq.fetch_add(1, std::memory_order_seq_cst);
+    
+    if (m_header->consumerWaiting.load(std::memory_order_seq_cst)) {
+        futexWake(&m_header->dataSeq);
+    }
+    return true;
+}
+
+void PcmRing::markClosed()
+{
+    if (!m_header) {
+        return;
+    }
+    
+    m_header->closed.store(1, std::memory_order_seq_cst);
+    m_header->dataSeq.fetch_add(1, std::memory_order_seq_cst);
+    futexWake(&m_header->dataSeq);
+}
+
+// ============================================================================
+// Consumer
+// ============================================================================
+
+bool PcmRing::hasData() const
+{
+    return m_header->readPos.load(std::memory_order_relaxed)
+        != m_header->writePos.load(std::memory_order_seq_cst);
+}
+
+bool PcmRing::isClosed() const
+{
+    return !m_header || m_header->closed.load(std::memory_order_acquire);
+}
+
+bool PcmRing::peek(Frame *frame)
+{
+    if (!m_header) {
+        return false;
+    }
+    
+    const qint64 capacity = m_header->capacity;
+    
+    forever {
+        const quint64 readPos = m_header->readPos.load(std::memory_order_relaxed);
+        const quint64 writePos = m_header->writePos.load(std::memory_order_acquire);
+        if (readPos == writePos) {
+            return false;
+        }
+        
+        const qint64 offset = readPos % capacity;
+        const qint64 contiguous = capacity - offset;
+        const FrameHeader *header = reinterpret_cast<const FrameHeader*>(m_data + offset);
+        
+        if (contiguous < qint64(sizeof(FrameHeader)) || (header->flags & FRAME_PADDING)) {
+            m_header->readPos.store(readPos + contiguous, std::memory_order_release);
+            continue;
+        }
+        
+        frame->data = reinterpret_cast<const char*>(header + 1);
+        frame->size = header->size;
+        frame->captureNs = header->captureNs;
+        frame->sequence = header->sequence;
+        m_peekedSize = alignedSize(header->size);
+        return true;
+    }
+}
+
+void PcmRing::release()
+{
+    if (!m_header || m_peekedSize == 0) {
+        return;
+    }
+    
+    // Hands the space back to the producer; the peeked pointer is invalid from here
+    const quint64 readPos = m_header->readPos.load(std::memory_order_relaxed);
+    m_header->readPos.store(readPos + m_peekedSize, std::memory_order_release);
+    m_peekedSize = 0;
+}
+
+bool PcmRing::wait(int timeoutMs)
+{
+    if (!m_header) {
+        return false;
+    }
+    
+    const quint32 seq = m_header->dataSeq.load(std::memory_order_acquire);
+    if (hasData() || isClosed()) {
+        return true;
+    }
+    
+    // Announce before re-checking, so a write in between either is seen here
+    // or bumps dataSeq and makes the futex wait return at once
+    m_header->consumerWaiting.store(1, std::memory_order_seq_cst);
+    if (!hasData() && !isClosed()) {
+        futexWait(&m_header->dataSeq, seq, timeoutMs);
+    }
+    m_header->consumerWaiting.store(0, std::memory_order_relaxed);
+    
+    return hasData() || isClosed();
+}
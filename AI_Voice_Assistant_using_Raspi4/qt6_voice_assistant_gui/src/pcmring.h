@@ -0,0 +1,82 @@
+#ifndef PCMRING_H
+#define PCMRING_H
+
+#include <QtGlobal>
+#include <QString>
+#include <atomic>
+
+/**
+ * @brief Single-producer, single-consumer frame ring in POSIX shared memory
+ *
+ * The producer (AudioEngine, through ShmAudioTransport) creates the segment
+ * and appends captured PCM blocks as frames; a co-located consumer attaches
+ * by name and reads them in place, without the two kernel copies a socket
+ * costs. Each frame carries its capture time (monotonic clock) and a
+ * sequence number so the consumer can measure latency and detect drops.
+ *
+ * Frames never wrap: if one doesn't fit before the end of the buffer the
+ * producer skips to the start, so peek() always returns contiguous memory.
+ * A full ring drops the new frame rather than blocking the audio thread.
+ *
+ * The consumer sleeps on a futex in the shared header; the producer only
+ * makes the wake syscall when the consumer has announced that it's waiting.
+ */
+class PcmRing
+{
+public:
+    struct Frame {
+        const char *data = nullptr;
+        qint64 size = 0;
+        qint64 captureNs = 0;
+        quint64 sequence = 0;
+    };
+    
+    PcmRing();
+    ~PcmRing();
+    
+    PcmRing(const PcmRing &) = delete;
+    PcmRing &operator=(const PcmRing &) = delete;
+    
+    // Producer side: creates (and on close() unlinks) the segment
+    bool create(const QString &name, qint64 capacityBytes);
+    bool write(const char *data, qint64 size, qint64 captureNs);
+    void markClosed();
+    
+    // Consumer side: attaches to an existing segment
+    bool attach(const QString &name);
+    bool peek(Frame *frame);
+    void release();
+    bool wait(int timeoutMs);
+    bool isClosed() const;
+    
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+    QString name() const { return m_name; }
+    qint64 capacity() const;
+    quint64 droppedFrames() const;
+    QString errorString() const { return m_errorString; }
+    
+    // Same clock on both sides of the ring
+    static qint64 monotonicNs();
+    
+private:
+    struct Header;
+    struct FrameHeader;
+    
+    bool map(int fd, qint64 size, bool initialize, qint64 capacityBytes);
+    bool hasData() const;
+    static qint64 alignedSize(qint64 payloadSize);
+    
+    Header *m_header;
+    char *m_data;
+    qint64 m_mappedSize;
+    QString m_name;
+    bool m_owner;
+    qint64 m_peekedSize;
+    QString m_errorString;
+    
+    static constexpr quint32 MAGIC = 0x50434d52; // "PCMR"
+    static constexpr quint32 VERSION = 1;
+};
+
+#endif // PCMRING_H
@@ -0,0 +1,233 @@
+#include "remotettsbackend.h"
+#include "networkmanager.h"
+#include <QDebug>
+#include <QJsonArray>
+#include <algorithm>
+#include <utility>
+
+RemoteTTSBackend::RemoteTTSBackend(NetworkManager *network, QObject *parent)
+    : TTSBackend(parent)
+    , m_network(network)
+    , m_rate(1.0f)
+    , m_jitterMs(-1.0)
+    , m_underruns(0)
+    , m_started(false)
+{
+    m_clock.start();
+    
+    m_waitTimer.setSingleShot(true);
+    connect(&m_waitTimer, &QTimer::timeout, this, &RemoteTTSBackend::expireWaiting);
+    
+    if (m_network) {
+        connect(m_network, &NetworkManager::multiplexedChanged, this, &RemoteTTSBackend::handleMultiplexedChanged);
+        connect(m_network, &NetworkManager::speechStreamStarted, this, &RemoteTTSBackend::handleStreamStarted);
+        connect(m_network, &NetworkManager::speechAudioReceived, this, &RemoteTTSBackend::handleAudio);
+        connect(m_network, &NetworkManager::speechStreamFailed, this, &RemoteTTSBackend::handleStreamFailed);
+    }
+}
+
+RemoteTTSBackend::~RemoteTTSBackend()
+{
+    if (m_network) {
+        for (auto it = m_streams.cbegin(); it != m_streams.cend(); ++it) {
+            m_network->cancelSpeech(it.key());
+        }
+    }
+}
+
+void RemoteTTSBackend::start()
+{
+    beginStartup();
+    m_started = true;
+    
+    // The session may be multiplexed already; looked at once start() has returned
+    QMetaObject::invokeMethod(this, &RemoteTTSBackend::handleMultiplexedChanged, Qt::QueuedConnection);
+}
+
+void RemoteTTSBackend::shutdown()
+{
+    m_waiting.clear();
+    m_waitTimer.stop();
+    if (m_network) {
+        for (auto it = m_streams.cbegin(); it != m_streams.cend(); ++it) {
+            m_network->cancelSpeech(it.key());
+        }
+    }
+    m_streams.clear();
+    beginShutdown();
+}
+
+void RemoteTTSBackend::send(const QString &command, const QVariantMap &params)
+{
+    if (isShutDown() || refusePlayback(command)) {
+        return;
+    }
+    
+    if (command == "SYNTHESIZE") {
+        if (isReady()) {
+            synthesize(params["request"].toULongLong(), params["text"].toString());
+        } else {
+            m_waiting.append({params, m_clock.elapsed()});
+            if (!m_waitTimer.isActive()) {
+                m_waitTimer.start(SESSION_WAIT_MS);
+            }
+        }
+    } else if (command == "CANCEL") {
+        const QVariantList requests = params["requests"].toList();
+        m_waiting.erase(std::remove_if(m_waiting.begin(), m_waiting.end(), [&requests](const Waiting &waiting) {
+            return requests.contains(waiting.params["request"]);
+        }), m_waiting.end());
+        for (auto it = m_streams.begin(); it != m_streams.end();) {
+            if (requests.contains(QVariant(it->request))) {
+                if (m_network) {
+                    m_network->cancelSpeech(it.key());
+                }
+                it = m_streams.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    } else if (command == "SET_RATE") {
+        m_rate = params["rate"].toFloat();
+    } else if (command == "SET_VOICE") {
+        m_voice = params["voice"].toString();
+    } else if (command == "GET_VOICES") {
+        postMessage({{"type", "voices_list"}, {"voices", QJsonArray{"default"}}});
+    }
+}
+
+void RemoteTTSBackend::handleMultiplexedChanged()
+{
+    if (!m_started || isShutDown() || !m_network) {
+        return;
+    }
+    
+    if (m_network->isMultiplexed() && !isReady()) {
+        markReady();
+        m_waitTimer.stop();
+        const QList<Waiting> waiting = std::exchange(m_waiting, {});
+        for (const Waiting &entry : waiting) {
+            synthesize(entry.params["request"].toULongLong(), entry.params["text"].toString());
+        }
+    } else if (!m_network->isMultiplexed() && isReady()) {
+        // Streams in flight have failed already; a closed session is no crash,
+        // and the engine's next backend waits for the next one
+        qDebug() << "🔊 Remote TTS session closed";
+        beginShutdown();
+    }
+}
+
+void RemoteTTSBackend::expireWaiting()
+{
+    // No session came up in time; the engine moves on rather than waiting forever
+    const qint64 now = m_clock.elapsed();
+    while (!m_waiting.isEmpty() && now - m_waiting.first().queuedMs >= SESSION_WAIT_MS) {
+        const Waiting expired = m_waiting.takeFirst();
+        fail(expired.params["request"].toULongLong(), "no multiplexed session");
+    }
+    if (!m_waiting.isEmpty()) {
+        m_waitTimer.start(int(SESSION_WAIT_MS - (now - m_waiting.first().queuedMs)));
+    }
+}
+
+void RemoteTTSBackend::synthesize(quint64 request, const QString &text)
+{
+    if (text.trimmed().isEmpty()) {
+        fail(request, "empty text");
+        return;
+    }
+    
+    const quint32 stream = m_network ? m_network->requestSpeech(text, m_voice, m_rate) : 0;
+    if (stream == 0) {
+        fail(request, "no multiplexed session");
+        return;
+    }
+    
+    Stream entry;
+    entry.request = request;
+    m_streams.insert(stream, entry);
+}
+
+void RemoteTTSBackend::handleStreamStarted(quint32 stream, int sampleRate, int channels)
+{
+    auto it = m_streams.find(stream);
+    if (it == m_streams.end()) {
+        return;
+    }
+    
+    it->sampleRate = sampleRate;
+    it->channels = qMax(1, channels);
+    it->buffer = JitterBuffer(sampleRate * it->channels * 2, m_jitterMs);
+}
+
+void RemoteTTSBackend::handleAudio(quint32 stream, quint16 sequence, const QByteArray &pcm, bool end)
+{
+    auto it = m_streams.find(stream);
+    if (it == m_streams.end()) {
+        return;
+    }
+    
+    if (it->sampleRate <= 0) {
+        const quint64 request = it->request;
+        m_streams.erase(it);
+        m_network->cancelSpeech(stream);
+        fail(request, "speech arrived without its format");
+        return;
+    }
+    
+    it->bytes += pcm.size();
+    it->buffer.push(sequence, pcm, m_clock.elapsed());
+    if (end) {
+        it->buffer.finish();
+    }
+    release(stream);
+}
+
+void RemoteTTSBackend::release(quint32 stream)
+{
+    auto it = m_streams.find(stream);
+    TTSAudio block;
+    block.sampleRate = it->sampleRate;
+    block.channels = it->channels;
+    block.pcm = it->buffer.take(m_clock.elapsed());
+    
+    const bool final = it->buffer.isDrained();
+    if (block.pcm.isEmpty() && !final) {
+        return;
+    }
+    
+    const quint64 request = it->request;
+    if (final) {
+        // What this stream learnt about the network starts the next one
+        const Stream done = m_streams.take(stream);
+        if (done.buffer.hasJitterEstimate()) {
+            m_jitterMs = done.buffer.jitterMs();
+        }
+        m_underruns += done.buffer.underruns();
+        qDebug() << "🗣️ Speech stream" << stream << "done:" << done.bytes << "bytes, jitter"
+                 << done.buffer.jitterMs() << "ms, target" << done.buffer.targetDelayMs() << "ms,"
+                 << done.buffer.underruns() << "underrun(s)";
+        if (done.bytes == 0) {
+            fail(request, "nothing to say");
+            return;
+        }
+    }
+    emit audioStreamed(request, block, final);
+}
+
+void RemoteTTSBackend::handleStreamFailed(quint32 stream, const QString &error)
+{
+    auto it = m_streams.find(stream);
+    if (it == m_streams.end()) {
+        return;
+    }
+    
+    const quint64 request = it->request;
+    m_streams.erase(it);
+    fail(request, error);
+}
+
+void RemoteTTSBackend::fail(quint64 request, const QString &error)
+{
+    postMessage({{"type", "synthesis_failed"}, {"request", double(request)}, {"message", error}});
+}
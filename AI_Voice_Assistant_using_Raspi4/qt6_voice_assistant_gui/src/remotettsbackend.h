@@ -0,0 +1,87 @@
+#ifndef REMOTETTSBACKEND_H
+#define REMOTETTSBACKEND_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include "jitterbuffer.h"
+#include "ttsbackend.h"
+
+class NetworkManager;
+
+/**
+ * @brief TTS backend on the server, over the transcription session
+ *
+ * Synthesis requests go up the multiplexed /stream WebSocket that already
+ * carries the microphone (see StreamMux), and the speech comes back down it
+ * in frames, so a remote voice costs no second connection, handshake or
+ * congestion window. Each stream goes through a JitterBuffer and is handed
+ * to the engine with audioStreamed() as the buffer releases it; the engine
+ * starts playing the first block rather than waiting for the sentence.
+ *
+ * The backend is ready while the session is multiplexed. Requests sent
+ * before that wait up to SESSION_WAIT_MS and then fail. When the session
+ * closes, streams in flight fail and the backend exits cleanly; the engine
+ * starts another, which is ready again with the next session.
+ * The jitter estimate carries over from one stream to the next.
+ */
+class RemoteTTSBackend : public TTSBackend
+{
+    Q_OBJECT
+    
+public:
+    explicit RemoteTTSBackend(NetworkManager *network, QObject *parent = nullptr);
+    ~RemoteTTSBackend();
+    
+    void start() override;
+    void shutdown() override;
+    void send(const QString &command, const QVariantMap &params = QVariantMap()) override;
+    void sendLatest(const QString &command, const QVariantMap &params) override { send(command, params); }
+    bool playsAudio() const override { return false; }
+    QString description() const override { return QStringLiteral("remote over the stream session"); }
+    
+    int underruns() const { return m_underruns; } // over all streams so far
+    double jitterMs() const { return m_jitterMs; } // -1 before a stream settled it
+    
+private slots:
+    void handleMultiplexedChanged();
+    void handleStreamStarted(quint32 stream, int sampleRate, int channels);
+    void handleAudio(quint32 stream, quint16 sequence, const QByteArray &pcm, bool end);
+    void handleStreamFailed(quint32 stream, const QString &error);
+    void expireWaiting();
+    
+private:
+    struct Stream {
+        quint64 request = 0;
+        int sampleRate = 0;
+        int channels = 0;
+        qint64 bytes = 0;
+        JitterBuffer buffer;
+    };
+    
+    struct Waiting {
+        QVariantMap params;
+        qint64 queuedMs = 0;
+    };
+    
+    void synthesize(quint64 request, const QString &text);
+    void release(quint32 stream);
+    void fail(quint64 request, const QString &error);
+    
+    QPointer<NetworkManager> m_network;
+    QHash<quint32, Stream> m_streams; // by the session's stream id
+    QList<Waiting> m_waiting;         // SYNTHESIZE sent before the session was ready, oldest first
+    QTimer m_waitTimer;               // fails the oldest waiting request when it runs out of time
+    QString m_voice;
+    float m_rate;
+    QElapsedTimer m_clock; // arrival times for the jitter buffers
+    double m_jitterMs;
+    int m_underruns;
+    bool m_started;
+    
+    static constexpr int SESSION_WAIT_MS = 3000;
+};
+
+#endif // REMOTETTSBACKEND_H
@@ -56,6 +56,22 @@ void SettingsManager::setMaxRecordingSeconds(int seconds)
     }
 }
 
+void SettingsManager::setBackendUrls(const QStringList &urls)
+{
+    if (m_backendUrls != urls) {
+        m_backendUrls = urls;
+        emit backendUrlsChanged();
+    }
+}
+
+void SettingsManager::setSharedMemoryEndpoint(const QString &controlPath)
+{
+    if (m_sharedMemoryEndpoint != controlPath) {
+        m_sharedMemoryEndpoint = controlPath;
+        emit sharedMemoryEndpointChanged();
+    }
+}
+
 void SettingsManager::resetToDefaults()
 {
     setLanguage("English");
@@ -64,6 +80,8 @@ void SettingsManager::resetToDefaults()
     setDarkMode(false);
     setSilenceThreshold(0.01f);
     setMaxRecordingSeconds(60);
+    setBackendUrls({"http://localhost:8000"});
+    setSharedMemoryEndpoint(QString());
     
     saveSettings();
 }
@@ -76,6 +94,8 @@ void SettingsManager::saveSettings()
     m_settings->setValue("darkMode", m_darkMode);
     m_settings->setValue("silenceThreshold", m_silenceThreshold);
     m_settings->setValue("maxRecordingSeconds", m_maxRecordingSeconds);
+    m_settings->setValue("backendUrls", m_backendUrls);
+    m_settings->setValue("sharedMemoryEndpoint", m_sharedMemoryEndpoint);
     
     m_settings->sync();
     emit settingsSaved();
@@ -91,6 +111,8 @@ void SettingsManager::loadSettings()
     m_darkMode = m_settings->value("darkMode", false).toBool();
     m_silenceThreshold = m_settings->value("silenceThreshold", 0.01f).toFloat();
     m_maxRecordingSeconds = m_settings->value("maxRecordingSeconds", 60).toInt();
+    m_backendUrls = m_settings->value("backendUrls", QStringList{"http://localhost:8000"}).toStringList();
+    m_sharedMemoryEndpoint = m_settings->value("sharedMemoryEndpoint", QString()).toString();
     
     qDebug() << "Settings loaded";
 }
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QSettings>
+#include <QStringList>
 
 class SettingsManager : public QObject
 {
@@ -13,6 +14,8 @@ class SettingsManager : public QObject
     Q_PROPERTY(bool darkMode READ darkMode WRITE setDarkMode NOTIFY darkModeChanged)
     Q_PROPERTY(float silenceThreshold READ silenceThreshold WRITE setSilenceThreshold NOTIFY silenceThresholdChanged)
     Q_PROPERTY(int maxRecordingSeconds READ maxRecordingSeconds WRITE setMaxRecordingSeconds NOTIFY maxRecordingSecondsChanged)
+    Q_PROPERTY(QStringList backendUrls READ backendUrls WRITE setBackendUrls NOTIFY backendUrlsChanged)
+    Q_PROPERTY(QString sharedMemoryEndpoint READ sharedMemoryEndpoint WRITE setSharedMemoryEndpoint NOTIFY sharedMemoryEndpointChanged)
     
 public:
     explicit SettingsManager(QObject *parent = nullptr);
@@ -24,6 +27,8 @@ public:
     bool darkMode() const { return m_darkMode; }
     float silenceThreshold() const { return m_silenceThreshold; }
     int maxRecordingSeconds() const { return m_maxRecordingSeconds; }
+    QStringList backendUrls() const { return m_backendUrls; }
+    QString sharedMemoryEndpoint() const { return m_sharedMemoryEndpoint; }
     
     // Setters
     void setLanguage(const QString &language);
@@ -32,6 +37,8 @@ public:
     void setDarkMode(bool enabled);
     void setSilenceThreshold(float threshold);
     void setMaxRecordingSeconds(int seconds);
+    void setBackendUrls(const QStringList &urls);
+    void setSharedMemoryEndpoint(const QString &controlPath);
     
 public slots:
     void resetToDefaults();
@@ -48,6 +55,8 @@ signals:
     void darkModeChanged();
     void silenceThresholdChanged();
     void maxRecordingSecondsChanged();
+    void backendUrlsChanged();
+    void sharedMemoryEndpointChanged();
     void settingsSaved();
     
 private:
@@ -59,6 +68,8 @@ private:
     bool m_darkMode;
     float m_silenceThreshold;
     int m_maxRecordingSeconds;
+    QStringList m_backendUrls; // edge backend first, then remote fallbacks
+    QString m_sharedMemoryEndpoint; // control socket of a co-located consumer, empty to stream over WebSocket
 };
 
 #endif // SETTINGSMANAGER_H
@@ -0,0 +1,195 @@
+#include "shmaudiotransport.h"
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+ShmAudioTransport::ShmAudioTransport(QObject *parent)
+    : QObject(parent)
+    , m_control(new QLocalSocket(this))
+    , m_dropRun(0)
+    , m_state(QAbstractSocket::UnconnectedState)
+{
+    connect(m_control, &QLocalSocket::connected, this, &ShmAudioTransport::onConnected);
+    connect(m_control, &QLocalSocket::readyRead, this, &ShmAudioTransport::onReadyRead);
+    connect(m_control, &QLocalSocket::disconnected, this, &ShmAudioTransport::onDisconnected);
+    connect(m_control, &QLocalSocket::errorOccurred, this, &ShmAudioTransport::onSocketError);
+}
+
+ShmAudioTransport::~ShmAudioTransport()
+{
+    disconnect(m_control, nullptr, this, nullptr);
+    m_control->abort();
+}
+
+void ShmAudioTransport::open(const QString &controlPath)
+{
+    if (m_state != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    
+    // One segment per session; a consumer from an old session can't see new audio
+    static int sessionCounter = 0;
+    const QString name = QString("/voice-assistant-%1-%2")
+                         .arg(QCoreApplication::applicationPid())
+                         .arg(++sessionCounter);
+    
+    if (!m_ring.create(name, RING_CAPACITY_BYTES)) {
+        setError(QAbstractSocket::SocketResourceError, m_ring.errorString());
+        return;
+    }
+    m_dropRun = 0;
+    
+    m_lineBuffer.clear();
+    m_errorString.clear();
+    m_state = QAbstractSocket::ConnectingState;
+    m_control->connectToServer(controlPath);
+}
+
+void ShmAudioTransport::close()
+{
+    if (m_state == QAbstractSocket::ConnectedState) {
+        sendTextMessage(QStringLiteral("{\"type\":\"end\"}"));
+        m_state = QAbstractSocket::ClosingState;
+    }
+    
+    m_ring.markClosed();
+    m_control->disconnectFromServer();
+}
+
+void ShmAudioTransport::abort()
+{
+    m_control->abort();
+    m_ring.close();
+    m_state = QAbstractSocket::UnconnectedState;
+}
+
+qint64 ShmAudioTransport::sendTextMessage(const QString &message)
+{
+    if (m_control->state() != QLocalSocket::ConnectedState) {
+        return -1;
+    }
+    
+    QByteArray line = message.toUtf8();
+    line += '\n';
+    return m_control->write(line) < 0 ? -1 : message.size();
+}
+
+qint64 ShmAudioTransport::sendBinaryMessage(const QByteArray &data)
+{
+    if (m_state != QAbstractSocket::ConnectedState) {
+        return -1;
+    }
+    
+    // Straight into shared memory; no syscall unless the consumer is asleep
+    // A stalled consumer is logged when it starts and when it ends, not per frame
+    if (!m_ring.write(data.constData(), data.size(), PcmRing::monotonicNs())) {
+        if (m_dropRun++ == 0) {
+            qWarning() << "⚠️ PCM ring full, dropping audio until the consumer catches up";
+        }
+        return -1;
+    }
+    if (m_dropRun > 0) {
+        qWarning() << "⚠️ PCM ring has room again after" << m_dropRun << "dropped frame(s) ("
+                   << m_ring.droppedFrames() << "total)";
+        m_dropRun = 0;
+    }
+    return data.size();
+}
+
+void ShmAudioTransport::ping(const QByteArray &payload)
+{
+    Q_UNUSED(payload);
+    
+    m_pingTimer.start();
+    sendTextMessage(QStringLiteral("{\"type\":\"ping\"}"));
+}
+
+// ============================================================================
+// Control Channel
+// ============================================================================
+
+void ShmAudioTransport::onConnected()
+{
+    QJsonObject start;
+    start["type"] = "start";
+    start["shm"] = m_ring.name();
+    start["capacity"] = m_ring.capacity();
+    start["sample_rate"] = 16000;
+    start["format"] = "s16le";
+    
+    m_control->write(QJsonDocument(start).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void ShmAudioTransport::onReadyRead()
+{
+    m_lineBuffer.append(m_control->readAll());
+    
+    int lineEnd;
+    while ((lineEnd = m_lineBuffer.indexOf('\n')) >= 0) {
+        const QByteArray line = m_lineBuffer.left(lineEnd).trimmed();
+        m_lineBuffer.remove(0, lineEnd + 1);
+        
+        if (!line.isEmpty()) {
+            handleLine(line);
+        }
+    }
+}
+
+void ShmAudioTransport::handleLine(const QByteArray &line)
+{
+    // Session control is handled here; everything else is a result
+    if (line.contains("\"ready\"") || line.contains("\"pong\"")) {
+        const QString type = QJsonDocument::fromJson(line).object().value("type").toString();
+        
+        if (type == "ready" && m_state == QAbstractSocket::ConnectingState) {
+            qDebug() << "🧠 Shared-memory session ready:" << m_ring.name();
+            m_state = QAbstractSocket::ConnectedState;
+            emit connected();
+            return;
+        }
+        if (type == "pong") {
+            emit pong(quint64(m_pingTimer.isValid() ? m_pingTimer.elapsed() : 0), QByteArray());
+            return;
+        }
+    }
+    
+    emit utf8MessageReceived(line);
+}
+
+void ShmAudioTransport::onDisconnected()
+{
+    const bool wasOpen = m_state == QAbstractSocket::ConnectedState
+                      || m_state == QAbstractSocket::ClosingState;
+    
+    m_ring.close();
+    m_state = QAbstractSocket::UnconnectedState;
+    
+    if (wasOpen) {
+        emit disconnected();
+    }
+}
+
+void ShmAudioTransport::onSocketError(QLocalSocket::LocalSocketError error)
+{
+    // A closed peer is reported through onDisconnected()
+    if (error == QLocalSocket::PeerClosedError) {
+        return;
+    }
+    
+    setError(error == QLocalSocket::ServerNotFoundError ? QAbstractSocket::HostNotFoundError
+             : error == QLocalSocket::ConnectionRefusedError ? QAbstractSocket::ConnectionRefusedError
+             : QAbstractSocket::UnknownSocketError,
+             m_control->errorString());
+}
+
+void ShmAudioTransport::setError(QAbstractSocket::SocketError error, const QString &errorString)
+{
+    m_errorString = errorString;
+    
+    if (m_state != QAbstractSocket::ConnectedState) {
+        m_ring.close();
+        m_state = QAbstractSocket::UnconnectedState;
+    }
+    emit errorOccurred(error);
+}
@@ -0,0 +1,77 @@
+#ifndef SHMAUDIOTRANSPORT_H
+#define SHMAUDIOTRANSPORT_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QAbstractSocket>
+#include <QLocalSocket>
+#include "pcmring.h"
+
+/**
+ * @brief Streaming session with a co-located consumer over shared memory
+ *
+ * Audio goes into a PcmRing that the consumer reads in place; results and
+ * control messages travel over a QLocalSocket as newline-delimited JSON with
+ * the same {type,text,timestamp} schema as the /stream WebSocket.
+ *
+ * Control protocol, one JSON object per line:
+ *   client -> {"type":"start","shm":name,"capacity":bytes,"sample_rate":16000,"format":"s16le"}
+ *   server -> {"type":"ready"}
+ *   client -> {"type":"ping"} / {"type":"cancel"} / {"type":"end"}
+ *   server -> {"type":"pong"} / {"type":"cancelled"} / {"type":"partial"|"final",...}
+ *
+ * Signals and methods mirror the subset of QWebSocket that NetworkManager
+ * uses, so it can stand in for the WebSocket session. Text messages are
+ * delivered as UTF-8 lines, as LocalWebSocket does.
+ */
+class ShmAudioTransport : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit ShmAudioTransport(QObject *parent = nullptr);
+    ~ShmAudioTransport();
+    
+    void open(const QString &controlPath);
+    void close();
+    void abort();
+    
+    qint64 sendTextMessage(const QString &message);
+    qint64 sendBinaryMessage(const QByteArray &data);
+    void ping(const QByteArray &payload = QByteArray());
+    
+    QAbstractSocket::SocketState state() const { return m_state; }
+    QString errorString() const { return m_errorString; }
+    quint64 droppedFrames() const { return m_ring.droppedFrames(); }
+    
+signals:
+    void connected();
+    void disconnected();
+    void utf8MessageReceived(const QByteArray &message);
+    void errorOccurred(QAbstractSocket::SocketError error);
+    void pong(quint64 elapsedTime, const QByteArray &payload);
+    
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+    void onSocketError(QLocalSocket::LocalSocketError error);
+    
+private:
+    void handleLine(const QByteArray &line);
+    void setError(QAbstractSocket::SocketError error, const QString &errorString);
+    
+    QLocalSocket *m_control;
+    PcmRing m_ring;
+    quint64 m_dropRun; // frames dropped since the ring last had room
+    QAbstractSocket::SocketState m_state;
+    QByteArray m_lineBuffer;
+    QElapsedTimer m_pingTimer;
+    QString m_errorString;
+    
+    static constexpr qint64 RING_CAPACITY_BYTES = 128 * 1024; // ~4 s of 16 kHz s16le
+};
+
+#endif // SHMAUDIOTRANSPORT_H
@@ -0,0 +1,87 @@
+#include "speechchunker.h"
+#include <QTextBoundaryFinder>
+
+static bool isClauseBreak(QChar c)
+{
+    return c == ',' || c == ';' || c == ':' || c == QChar(0x2014) || c == QChar(0x2013) ||
+           c == QChar(0x3001) || c == QChar(0xFF0C);
+}
+
+QList<SpeechChunker::Chunk> SpeechChunker::split(const QString &text)
+{
+    QList<Chunk> chunks;
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Sentence, text);
+    
+    int start = 0;
+    int end;
+    while ((end = finder.toNextBoundary()) != -1) {
+        if (end <= start) {
+            continue;
+        }
+        const int limit = chunks.isEmpty() ? FIRST_CHUNK_CHARS : MAX_CHUNK_CHARS;
+        if (end - start > limit) {
+            splitLong(text, start, end, limit, chunks);
+        } else {
+            append(text, start, end, chunks);
+        }
+        start = end;
+    }
+    return chunks;
+}
+
+void SpeechChunker::splitLong(const QString &text, int start, int end, int limit, QList<Chunk> &chunks)
+{
+    while (end - start > limit) {
+        int cut = -1;
+        
+        // Latest clause break that fits, so chunks stay as long as allowed
+        for (int i = start + limit - 1; i >= start + MIN_CLAUSE_CHARS && cut < 0; --i) {
+            if (isClauseBreak(text[i]) && (i + 1 == end || text[i + 1].isSpace())) {
+                cut = i + 1;
+            }
+        }
+        
+        // Otherwise between words, and as a last resort anywhere
+        for (int i = start + limit; i > start && cut < 0; --i) {
+            if (text[i].isSpace()) {
+                cut = i;
+            }
+        }
+        if (cut < 0) {
+            cut = start + limit;
+        }
+        
+        append(text, start, cut, chunks);
+        start = cut;
+        limit = MAX_CHUNK_CHARS;
+    }
+    append(text, start, end, chunks);
+}
+
+void SpeechChunker::append(const QString &text, int start, int end, QList<Chunk> &chunks)
+{
+    while (start < end && text[start].isSpace()) {
+        ++start;
+    }
+    while (end > start && text[end - 1].isSpace()) {
+        --end;
+    }
+    if (start == end) {
+        return;
+    }
+    
+    // Nothing to say on its own ("...", a stray dash): keep it with what came before
+    bool speakable = false;
+    for (int i = start; i < end && !speakable; ++i) {
+        speakable = text[i].isLetterOrNumber();
+    }
+    if (!speakable) {
+        if (!chunks.isEmpty()) {
+            Chunk &previous = chunks.last();
+            previous.text = text.mid(previous.offset, end - previous.offset);
+        }
+        return;
+    }
+    
+    chunks.append({text.mid(start, end - start), start});
+}
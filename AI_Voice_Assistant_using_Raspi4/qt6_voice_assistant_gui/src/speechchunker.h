@@ -0,0 +1,37 @@
+#ifndef SPEECHCHUNKER_H
+#define SPEECHCHUNKER_H
+
+#include <QString>
+#include <QList>
+
+/**
+ * @brief Splits a response into chunks that can be synthesized one by one
+ *
+ * Sentences are found with QTextBoundaryFinder, so "3.5 km" and CJK full
+ * stops are handled the way Qt's text layout handles them. A sentence longer
+ * than MAX_CHUNK_CHARS is split further at clause punctuation and, failing
+ * that, between words. The first chunk is the one the listener waits for,
+ * so a first sentence longer than FIRST_CHUNK_CHARS is cut at its first
+ * clause break as well. Each chunk remembers where it starts in the
+ * original text, so word positions reported per chunk can be mapped back.
+ */
+class SpeechChunker
+{
+public:
+    struct Chunk {
+        QString text;
+        int offset; // of text in the original string
+    };
+    
+    static QList<Chunk> split(const QString &text);
+    
+    static constexpr int FIRST_CHUNK_CHARS = 60;
+    static constexpr int MAX_CHUNK_CHARS = 200;
+    static constexpr int MIN_CLAUSE_CHARS = 12; // shorter clauses stay with the next one
+    
+private:
+    static void splitLong(const QString &text, int start, int end, int limit, QList<Chunk> &chunks);
+    static void append(const QString &text, int start, int end, QList<Chunk> &chunks);
+};
+
+#endif // SPEECHCHUNKER_H
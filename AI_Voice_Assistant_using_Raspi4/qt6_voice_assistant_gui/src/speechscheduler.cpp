@@ -0,0 +1,149 @@
+#include "speechscheduler.h"
+
+SpeechScheduler::SpeechScheduler()
+    : m_nextId(0)
+    , m_merged(0)
+    , m_dropped(0)
+{
+    m_clock.start();
+}
+
+quint64 SpeechScheduler::enqueue(const QString &text, Priority priority, qint64 deadlineMs, bool front)
+{
+    const qint64 now = nowMs();
+    const qint64 deadline = deadlineMs < 0 ? -1 : now + deadlineMs;
+    
+    // The same prompt twice is said once, as urgently and for as long as either asked
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        for (int i = 0; i < m_queues[p].size(); ++i) {
+            if (!sameText(m_queues[p][i].text, text)) {
+                continue;
+            }
+            Utterance merged = m_queues[p].takeAt(i);
+            merged.deadlineMs = (merged.deadlineMs < 0 || deadline < 0) ? -1 : qMax(merged.deadlineMs, deadline);
+            ++m_merged;
+            if (priority > merged.priority) {
+                merged.priority = priority;
+                front ? m_queues[priority].prepend(merged) : m_queues[priority].append(merged);
+            } else if (front && priority == merged.priority) {
+                m_queues[p].prepend(merged);
+            } else {
+                m_queues[p].insert(i, merged);
+            }
+            return merged.id;
+        }
+    }
+    
+    Utterance utterance;
+    utterance.id = ++m_nextId;
+    utterance.text = text;
+    utterance.priority = priority;
+    utterance.enqueuedMs = now;
+    utterance.deadlineMs = deadline;
+    if (front) {
+        m_queues[priority].prepend(utterance);
+    } else {
+        m_queues[priority].append(utterance);
+    }
+    return utterance.id;
+}
+
+void SpeechScheduler::requeue(const Utterance &utterance)
+{
+    // Ahead of its class: it was already being spoken
+    m_queues[utterance.priority].prepend(utterance);
+}
+
+bool SpeechScheduler::takeNext(Utterance &next, QList<Utterance> *dropped)
+{
+    const qint64 now = nowMs();
+    for (int p = PRIORITY_COUNT - 1; p >= 0; --p) {
+        while (!m_queues[p].isEmpty()) {
+            Utterance utterance = m_queues[p].takeFirst();
+            if (utterance.deadlineMs >= 0 && now > utterance.deadlineMs) {
+                ++m_dropped;
+                if (dropped) {
+                    dropped->append(utterance);
+                }
+                continue;
+            }
+            
+            if (!utterance.started) {
+                utterance.started = true;
+                LatencyStats &stats = m_latency[p];
+                const qint64 latency = now - utterance.enqueuedMs;
+                ++stats.count;
+                stats.totalMs += latency;
+                stats.max = qMax(stats.max, latency);
+            }
+            next = utterance;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SpeechScheduler::clear()
+{
+    for (QList<Utterance> &queue : m_queues) {
+        queue.clear();
+    }
+}
+
+void SpeechScheduler::clear(Priority priority)
+{
+    m_queues[priority].clear();
+}
+
+bool SpeechScheduler::isEmpty() const
+{
+    return pendingCount() == 0;
+}
+
+int SpeechScheduler::pendingCount() const
+{
+    int count = 0;
+    for (const QList<Utterance> &queue : m_queues) {
+        count += queue.size();
+    }
+    return count;
+}
+
+int SpeechScheduler::pendingCount(Priority priority) const
+{
+    return m_queues[priority].size();
+}
+
+int SpeechScheduler::highestPending() const
+{
+    for (int p = PRIORITY_COUNT - 1; p >= 0; --p) {
+        if (!m_queues[p].isEmpty()) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+bool SpeechScheduler::sameText(const QString &a, const QString &b)
+{
+    return a.simplified().compare(b.simplified(), Qt::CaseInsensitive) == 0;
+}
+
+qint64 SpeechScheduler::defaultDeadlineMs(Priority priority)
+{
+    switch (priority) {
+    case SafetyAlert:
+        return SAFETY_DEADLINE_MS;
+    case Navigation:
+        return NAVIGATION_DEADLINE_MS;
+    case Conversational:
+        break;
+    }
+    return CONVERSATIONAL_DEADLINE_MS;
+}
+
+qint64 SpeechScheduler::averageLatencyMs(Priority priority) const
+{
+    const LatencyStats &stats = m_latency[priority];
+    return stats.count > 0 ? stats.totalMs / qint64(stats.count) : 0;
+}
@@ -0,0 +1,90 @@
+#ifndef SPEECHSCHEDULER_H
+#define SPEECHSCHEDULER_H
+
+#include <QString>
+#include <QList>
+#include <QElapsedTimer>
+
+/**
+ * @brief Orders pending speech by priority class, with deadlines and merging
+ *
+ * There is one FIFO queue per class, and a higher class is always taken
+ * first, so a safety alert never waits behind a navigation prompt and
+ * neither waits behind conversation. An utterance that is still queued when
+ * its deadline passes is dropped instead of being spoken late. Queuing a
+ * text that is already queued (ignoring case and spacing) merges the two:
+ * the merged utterance keeps the earlier enqueue time, the higher class and
+ * the later deadline. A preempted utterance is requeued at the head of its
+ * class with the offset it should resume from.
+ *
+ * Queue latency, from enqueue to the first time an utterance is taken, is
+ * kept per class.
+ */
+class SpeechScheduler
+{
+public:
+    enum Priority {
+        Conversational = 0,
+        Navigation = 1,
+        SafetyAlert = 2
+    };
+    static constexpr int PRIORITY_COUNT = 3;
+    
+    struct Utterance {
+        quint64 id = 0;
+        QString text;
+        Priority priority = Conversational;
+        qint64 enqueuedMs = 0;  // on the scheduler's clock
+        qint64 deadlineMs = -1; // on the scheduler's clock, -1 for none
+        int resumeOffset = 0;   // where a preempted utterance picks up
+        bool started = false;   // taken before; its latency is counted
+    };
+    
+    SpeechScheduler();
+    
+    // Queues text, or merges it into the same text already queued; returns the id either way.
+    // front puts it ahead of its class, for a reply that replaces the one being said.
+    quint64 enqueue(const QString &text, Priority priority, qint64 deadlineMs = -1, bool front = false);
+    void requeue(const Utterance &utterance);
+    
+    // Highest class first, FIFO within it; utterances past their deadline go to dropped
+    bool takeNext(Utterance &next, QList<Utterance> *dropped = nullptr);
+    
+    void clear();
+    void clear(Priority priority);
+    bool isEmpty() const;
+    int pendingCount() const;
+    int pendingCount(Priority priority) const;
+    int highestPending() const; // -1 when empty
+    
+    qint64 nowMs() const { return m_clock.elapsed(); }
+    static bool sameText(const QString &a, const QString &b);
+    static qint64 defaultDeadlineMs(Priority priority);
+    
+    // Statistics
+    qint64 averageLatencyMs(Priority priority) const;
+    qint64 maxLatencyMs(Priority priority) const { return m_latency[priority].max; }
+    quint64 startedCount(Priority priority) const { return m_latency[priority].count; }
+    quint64 mergedCount() const { return m_merged; }
+    quint64 droppedCount() const { return m_dropped; }
+    
+    static constexpr qint64 SAFETY_DEADLINE_MS = 10000;        // a hazard warning is stale soon after
+    static constexpr qint64 NAVIGATION_DEADLINE_MS = 15000;    // about a junction's approach
+    static constexpr qint64 CONVERSATIONAL_DEADLINE_MS = 60000;
+    
+private:
+    struct LatencyStats {
+        quint64 count = 0;
+        qint64 totalMs = 0;
+        qint64 max = 0;
+    };
+    
+    QList<Utterance> m_queues[PRIORITY_COUNT];
+    LatencyStats m_latency[PRIORITY_COUNT];
+    QElapsedTimer m_clock;
+    quint64 m_nextId;
+    quint64 m_merged;
+    quint64 m_dropped;
+};
+
+#endif // SPEECHSCHEDULER_H
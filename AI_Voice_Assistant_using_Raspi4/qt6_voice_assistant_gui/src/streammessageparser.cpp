@@ -0,0 +1,435 @@
+#include "streammessageparser.h"
+#include <QLatin1String>
+#include <charconv>
+#include <limits>
+#include <type_traits>
+
+namespace {
+    
+inline char16_t unitAt(QStringView input, qsizetype index)
+{
+    return input[index].unicode();
+}
+    
+inline char16_t unitAt(QByteArrayView input, qsizetype index)
+{
+    return uchar(input[index]);
+}
+    
+struct TypeName {
+    const char *name;
+    StreamMessageParser::Type type;
+};
+    
+constexpr TypeName TYPE_NAMES[] = {
+    {"partial", StreamMessageParser::Partial},
+    {"final", StreamMessageParser::Final},
+    {"cancelled", StreamMessageParser::Cancelled},
+    {"ready", StreamMessageParser::Ready},
+    {"pong", StreamMessageParser::Pong},
+    {"error", StreamMessageParser::Error},
+};
+    
+constexpr int MAX_NESTING = 32;
+constexpr int MAX_NUMBER_LENGTH = 64;
+    
+int hexValue(char16_t c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+    
+}
+
+// ============================================================================
+// Reader: cursor over UTF-16 or UTF-8 input
+// ============================================================================
+
+template <typename View>
+class StreamMessageParser::Reader
+{
+public:
+    explicit Reader(View input) : m_input(input), m_pos(0) {}
+    
+    bool atEnd() const { return m_pos >= m_input.size(); }
+    char16_t peek() const { return atEnd() ? 0 : unitAt(m_input, m_pos); }
+    
+    void skipWhitespace()
+    {
+        while (!atEnd()) {
+            const char16_t c = unitAt(m_input, m_pos);
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                return;
+            }
+            ++m_pos;
+        }
+    }
+    
+    bool consume(char16_t expected)
+    {
+        skipWhitespace();
+        if (peek() != expected) {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+    
+    // Finds the extent of a string without decoding it
+    bool scanString(qsizetype *begin, qsizetype *end, bool *escaped)
+    {
+        if (!consume('"')) {
+            return false;
+        }
+        
+        *begin = m_pos;
+        *escaped = false;
+        while (!atEnd()) {
+            const char16_t c = unitAt(m_input, m_pos);
+            if (c == '"') {
+                *end = m_pos++;
+                return true;
+            }
+            if (c == '\\') {
+                *escaped = true;
+                m_pos += 2;
+                continue;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            ++m_pos;
+        }
+        return false;
+    }
+    
+    bool equalsAscii(qsizetype begin, qsizetype end, const char *ascii) const
+    {
+        qsizetype i = begin;
+        for (; *ascii; ++ascii, ++i) {
+            if (i >= end || unitAt(m_input, i) != char16_t(uchar(*ascii))) {
+                return false;
+            }
+        }
+        return i == end;
+    }
+    
+    // Appends the decoded contents of a scanned string to out
+    bool decodeString(qsizetype begin, qsizetype end, QString *out) const
+    {
+        qsizetype i = begin;
+        while (i < end) {
+            const char16_t c = unitAt(m_input, i);
+            
+            if (c == '\\') {
+                if (i + 1 >= end) {
+                    return false;
+                }
+                const char16_t escape = unitAt(m_input, i + 1);
+                i += 2;
+                switch (escape) {
+                    case '"': out->append(QLatin1Char('"')); break;
+                    case '\\': out->append(QLatin1Char('\\')); break;
+                    case '/': out->append(QLatin1Char('/')); break;
+                    case 'b': out->append(QLatin1Char('\b')); break;
+                    case 'f': out->append(QLatin1Char('\f')); break;
+                    case 'n': out->append(QLatin1Char('\n')); break;
+                    case 'r': out->append(QLatin1Char('\r')); break;
+                    case 't': out->append(QLatin1Char('\t')); break;
+                    case 'u': {
+                        // Surrogate pairs arrive as two escapes and combine by themselves
+                        if (i + 4 > end) {
+                            return false;
+                        }
+                        int code = 0;
+                        for (int k = 0; k < 4; ++k) {
+                            const int digit = hexValue(unitAt(m_input, i + k));
+                            if (digit < 0) {
+                                return false;
+                            }
+                            code = code * 16 + digit;
+                        }
+                        out->append(QChar(char16_t(code)));
+                        i += 4;
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+                continue;
+            }
+            
+            // Copy the run up to the next escape in one go
+            qsizetype runEnd = i;
+            while (runEnd < end && unitAt(m_input, runEnd) != '\\') {
+                ++runEnd;
+            }
+            appendRun(i, runEnd, out);
+            i = runEnd;
+        }
+        return true;
+    }
+    
+    bool parseNumber(double *value)
+    {
+        skipWhitespace();
+        
+        char buffer[MAX_NUMBER_LENGTH];
+        int length = 0;
+        while (!atEnd()) {
+            const char16_t c = unitAt(m_input, m_pos);
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+                break;
+            }
+            if (length == MAX_NUMBER_LENGTH) {
+                return false;
+            }
+            buffer[length++] = char(c);
+            ++m_pos;
+        }
+        
+        // from_chars is locale-independent, unlike strtod()
+        const std::from_chars_result result = std::from_chars(buffer, buffer + length, *value);
+        return length > 0 && result.ec == std::errc() && result.ptr == buffer + length;
+    }
+    
+    bool skipValue(int depth = 0)
+    {
+        if (depth > MAX_NESTING) {
+            return false;
+        }
+        
+        skipWhitespace();
+        const char16_t c = peek();
+        qsizetype begin, end;
+        bool escaped;
+        
+        if (c == '"') {
+            return scanString(&begin, &end, &escaped);
+        }
+        
+        if (c == '{' || c == '[') {
+            const char16_t close = c == '{' ? '}' : ']';
+            ++m_pos;
+            if (consume(close)) {
+                return true;
+            }
+            forever {
+                if (c == '{' && (!scanString(&begin, &end, &escaped) || !consume(':'))) {
+                    return false;
+                }
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+                if (consume(',')) {
+                    continue;
+                }
+                return consume(close);
+            }
+        }
+        
+        // Number or literal (true, false, null)
+        const qsizetype start = m_pos;
+        while (!atEnd()) {
+            const char16_t d = unitAt(m_input, m_pos);
+            if (!((d >= '0' && d <= '9') || (d >= 'a' && d <= 'z') || d == '-' || d == '+' || d == '.' || d == 'E')) {
+                break;
+            }
+            ++m_pos;
+        }
+        return m_pos > start;
+    }
+    
+private:
+    void appendRun(qsizetype begin, qsizetype end, QString *out) const
+    {
+        if constexpr (std::is_same_v<View, QStringView>) {
+            out->append(m_input.sliced(begin, end - begin));
+        } else {
+            appendUtf8(begin, end, out);
+        }
+    }
+    
+    void appendUtf8(qsizetype begin, qsizetype end, QString *out) const
+    {
+        qsizetype i = begin;
+        while (i < end) {
+            // ASCII runs are the common case
+            qsizetype asciiEnd = i;
+            while (asciiEnd < end && uchar(m_input[asciiEnd]) < 0x80) {
+                ++asciiEnd;
+            }
+            if (asciiEnd > i) {
+                out->append(QLatin1String(m_input.data() + i, asciiEnd - i));
+                i = asciiEnd;
+                continue;
+            }
+            
+            const uchar lead = uchar(m_input[i]);
+            const int length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+            char32_t code = length == 4 ? lead & 0x07 : length == 3 ? lead & 0x0F : lead & 0x1F;
+            bool valid = length > 1 && i + length <= end;
+            for (int k = 1; valid && k < length; ++k) {
+                const uchar next = uchar(m_input[i + k]);
+                valid = (next & 0xC0) == 0x80;
+                code = (code << 6) | (next & 0x3F);
+            }
+            
+            if (!valid || code > 0x10FFFF) {
+                out->append(QChar(QChar::ReplacementCharacter));
+                ++i;
+            } else if (code >= 0x10000) {
+                out->append(QChar(QChar::highSurrogate(code)));
+                out->append(QChar(QChar::lowSurrogate(code)));
+                i += length;
+            } else {
+                out->append(QChar(char16_t(code)));
+                i += length;
+            }
+        }
+    }
+    
+    View m_input;
+    qsizetype m_pos;
+};
+
+// ============================================================================
+// StreamMessageParser
+// ============================================================================
+
+StreamMessageParser::StreamMessageParser()
+    : m_type(Unknown)
+    , m_timestamp(0.0)
+    , m_hasTimestamp(false)
+    , m_stableLength(-1)
+    , m_channel(-1)
+    , m_muxVersion(0)
+{
+    // Partials rarely exceed this; the buffer grows once if they do
+    m_text.reserve(256);
+}
+
+bool StreamMessageParser::parse(QStringView message)
+{
+    return parseObject(message);
+}
+
+bool StreamMessageParser::parse(QByteArrayView utf8)
+{
+    return parseObject(utf8);
+}
+
+QString StreamMessageParser::typeName() const
+{
+    for (const TypeName &entry : TYPE_NAMES) {
+        if (entry.type == m_type) {
+            return QString::fromLatin1(entry.name);
+        }
+    }
+    return m_unknownType;
+}
+
+template <typename View>
+bool StreamMessageParser::parseObject(View input)
+{
+    Reader<View> reader(input);
+    
+    m_type = Unknown;
+    m_text.resize(0);
+    m_unknownType.resize(0);
+    m_timestamp = 0.0;
+    m_hasTimestamp = false;
+    m_stableLength = -1;
+    m_channel = -1;
+    m_muxVersion = 0;
+    
+    if (!reader.consume('{')) {
+        return false;
+    }
+    
+    if (!reader.consume('}')) {
+        forever {
+            qsizetype keyBegin, keyEnd, valueBegin, valueEnd;
+            bool keyEscaped, valueEscaped;
+            
+            if (!reader.scanString(&keyBegin, &keyEnd, &keyEscaped) || !reader.consume(':')) {
+                return false;
+            }
+            reader.skipWhitespace();
+            
+            if (!keyEscaped && reader.equalsAscii(keyBegin, keyEnd, "type") && reader.peek() == '"') {
+                if (!reader.scanString(&valueBegin, &valueEnd, &valueEscaped)) {
+                    return false;
+                }
+                m_type = Unknown;
+                for (const TypeName &entry : TYPE_NAMES) {
+                    if (!valueEscaped && reader.equalsAscii(valueBegin, valueEnd, entry.name)) {
+                        m_type = entry.type;
+                        break;
+                    }
+                }
+                if (m_type == Unknown) {
+                    m_unknownType.resize(0);
+                    reader.decodeString(valueBegin, valueEnd, &m_unknownType);
+                }
+            } else if (!keyEscaped && reader.equalsAscii(keyBegin, keyEnd, "text") && reader.peek() == '"') {
+                if (!reader.scanString(&valueBegin, &valueEnd, &valueEscaped)) {
+                    return false;
+                }
+                m_text.resize(0);
+                if (!reader.decodeString(valueBegin, valueEnd, &m_text)) {
+                    return false;
+                }
+            } else if (!keyEscaped && reader.equalsAscii(keyBegin, keyEnd, "timestamp")
+                       && (reader.peek() == '-' || (reader.peek() >= '0' && reader.peek() <= '9'))) {
+                if (!reader.parseNumber(&m_timestamp)) {
+                    return false;
+                }
+                m_hasTimestamp = true;
+            } else if (!keyEscaped && reader.equalsAscii(keyBegin, keyEnd, "stable")
+                       && reader.peek() >= '0' && reader.peek() <= '9') {
+                double stable;
+                if (!reader.parseNumber(&stable) || stable > std::numeric_limits<int>::max()
+                    || stable != int(stable)) {
+                    return false;
+                }
+                m_stableLength = int(stable);
+            } else if (!keyEscaped && (reader.equalsAscii(keyBegin, keyEnd, "channel")
+                                       || reader.equalsAscii(keyBegin, keyEnd, "mux"))
+                       && reader.peek() >= '0' && reader.peek() <= '9') {
+                // Small numbers of the multiplexed session (see StreamMux)
+                const bool channel = reader.equalsAscii(keyBegin, keyEnd, "channel");
+                double value;
+                if (!reader.parseNumber(&value) || value > 255 || value != int(value)) {
+                    return false;
+                }
+                if (channel) {
+                    m_channel = int(value);
+                } else {
+                    m_muxVersion = int(value);
+                }
+            } else if (!reader.skipValue()) {
+                return false;
+            }
+            
+            if (reader.consume(',')) {
+                continue;
+            }
+            if (reader.consume('}')) {
+                break;
+            }
+            return false;
+        }
+    }
+    
+    reader.skipWhitespace();
+    return reader.atEnd();
+}
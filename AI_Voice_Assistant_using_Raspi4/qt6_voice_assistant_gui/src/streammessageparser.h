@@ -0,0 +1,68 @@
+#ifndef STREAMMESSAGEPARSER_H
+#define STREAMMESSAGEPARSER_H
+
+#include <QString>
+#include <QStringView>
+#include <QByteArrayView>
+
+/**
+ * @brief Parser for streaming transcription messages ({type,text,timestamp})
+ *
+ * Partial results arrive many times a second and are handled on the GUI
+ * thread. Instead of building a QJsonDocument for each one, this reads the
+ * three known fields in a single pass over the message, either as UTF-16
+ * (QWebSocket hands over QString) or as the raw UTF-8 bytes the local
+ * transports receive. The type is matched against a fixed set of names and
+ * the text is decoded into a buffer that is reused between messages, so a
+ * steady stream of partials doesn't allocate.
+ *
+ * Delta partials also carry "stable", the length of the committed prefix
+ * (see NetworkManager::partialTranscriptionDelta). On a multiplexed session
+ * "ready" carries "mux" and messages for another stream carry "channel"
+ * (see StreamMux); those are read too, so NetworkManager can route them.
+ * Other members (statistics and the like) are skipped, whatever their JSON
+ * type. Input that isn't a JSON object makes parse() fail.
+ */
+class StreamMessageParser
+{
+public:
+    enum Type {
+        Unknown,
+        Partial,
+        Final,
+        Cancelled,
+        Ready,
+        Pong,
+        Error
+    };
+    
+    StreamMessageParser();
+    
+    bool parse(QStringView message);
+    bool parse(QByteArrayView utf8);
+    
+    // Valid until the next parse()
+    Type type() const { return m_type; }
+    const QString &text() const { return m_text; }
+    double timestamp() const { return m_timestamp; }
+    bool hasTimestamp() const { return m_hasTimestamp; }
+    int stableLength() const { return m_stableLength; } // -1 if absent
+    int channel() const { return m_channel; }           // -1 if absent: transcription
+    int muxVersion() const { return m_muxVersion; }     // on ready; 0 if absent
+    QString typeName() const;
+    
+private:
+    template <typename View> class Reader;
+    template <typename View> bool parseObject(View input);
+    
+    Type m_type;
+    QString m_text;
+    double m_timestamp;
+    bool m_hasTimestamp;
+    int m_stableLength;
+    int m_channel;
+    int m_muxVersion;
+    QString m_unknownType; // only filled for types outside the table
+};
+
+#endif // STREAMMESSAGEPARSER_H
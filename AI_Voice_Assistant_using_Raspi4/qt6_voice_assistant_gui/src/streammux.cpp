@@ -0,0 +1,33 @@
+#include "streammux.h"
+#include <QtEndian>
+#include <cstring>
+
+QByteArray StreamMux::encode(Channel channel, quint32 stream, quint16 sequence, const QByteArray &payload,
+                             quint8 flags)
+{
+    QByteArray message(HEADER_BYTES + payload.size(), Qt::Uninitialized);
+    uchar *header = reinterpret_cast<uchar *>(message.data());
+    header[0] = channel;
+    header[1] = flags;
+    qToBigEndian<quint16>(sequence, header + 2);
+    qToBigEndian<quint32>(stream, header + 4);
+    if (!payload.isEmpty()) {
+        memcpy(header + HEADER_BYTES, payload.constData(), payload.size());
+    }
+    return message;
+}
+
+bool StreamMux::decode(const QByteArray &message, Frame *frame)
+{
+    if (message.size() < HEADER_BYTES) {
+        return false;
+    }
+    
+    const uchar *header = reinterpret_cast<const uchar *>(message.constData());
+    frame->channel = Channel(header[0]);
+    frame->flags = header[1];
+    frame->sequence = qFromBigEndian<quint16>(header + 2);
+    frame->stream = qFromBigEndian<quint32>(header + 4);
+    frame->payload = message.sliced(HEADER_BYTES);
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef STREAMMUX_H
+#define STREAMMUX_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * @brief Framing for the multiplexed /stream session
+ *
+ * A client that opens /stream with ?mux=1 and gets {"type":"ready","mux":1}
+ * back carries several streams over the one WebSocket: microphone audio up
+ * on the SpeechToText channel and synthesized speech down on TextToSpeech.
+ * Binary messages then start with an 8-byte header:
+ *
+ *   u8 channel | u8 flags | u16 sequence | u32 stream | payload
+ *
+ * in network byte order. The sequence counts the frames of one stream and
+ * wraps; End marks a stream's last frame, which may be empty. Text messages
+ * stay JSON; those for a channel other than transcription carry "channel".
+ * A backend that doesn't answer with mux keeps the old protocol, raw PCM
+ * frames and no speech channel.
+ */
+class StreamMux
+{
+public:
+    enum Channel : quint8 {
+        Control = 0,
+        SpeechToText = 1,
+        TextToSpeech = 2
+    };
+    
+    enum Flag : quint8 {
+        End = 0x01
+    };
+    
+    struct Frame {
+        Channel channel = Control;
+        quint8 flags = 0;
+        quint16 sequence = 0;
+        quint32 stream = 0;
+        QByteArray payload;
+        
+        bool isEnd() const { return flags & End; }
+    };
+    
+    static QByteArray encode(Channel channel, quint32 stream, quint16 sequence, const QByteArray &payload,
+                             quint8 flags = 0);
+    static bool decode(const QByteArray &message, Frame *frame);
+    
+    static constexpr int VERSION = 1;
+    static constexpr int HEADER_BYTES = 8;
+};
+
+#endif // STREAMMUX_H
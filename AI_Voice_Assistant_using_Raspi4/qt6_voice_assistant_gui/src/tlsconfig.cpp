@@ -0,0 +1,259 @@
+#include "tlsconfig.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QDebug>
+#include <algorithm>
+
+TlsConfig::TlsConfig()
+    : m_resumptionEnabled(true)
+    , m_pinning(false)
+{
+    rebuild();
+}
+
+void TlsConfig::rebuild()
+{
+    // From scratch: setting CA certificates turns off on-demand loading of the system store
+    m_base = QSslConfiguration::defaultConfiguration();
+    if (m_pinning) {
+        m_base.setCaCertificates(m_pinnedCertificates);
+    }
+    
+    // Persistence is what lets the negotiated session be read back as a ticket
+    m_base.setSslOption(QSsl::SslOptionDisableSessionTickets, !m_resumptionEnabled);
+    m_base.setSslOption(QSsl::SslOptionDisableSessionPersistence, !m_resumptionEnabled);
+}
+
+QSslConfiguration TlsConfig::configurationFor(const QUrl &url) const
+{
+    QSslConfiguration configuration = m_base;
+    
+    if (const Session *session = usableSession(url)) {
+        configuration.setSessionTicket(session->ticket);
+    }
+    return configuration;
+}
+
+bool TlsConfig::isSecure(const QUrl &url)
+{
+    return url.scheme() == "https" || url.scheme() == "wss";
+}
+
+QString TlsConfig::hostKey(const QUrl &url)
+{
+    // https:// and wss:// to the same host:port reach the same TLS server
+    return url.host().toLower() + ':' + QString::number(url.port(isSecure(url) ? 443 : 80));
+}
+
+const TlsConfig::Session *TlsConfig::usableSession(const QUrl &url) const
+{
+    if (!m_resumptionEnabled) {
+        return nullptr;
+    }
+    
+    auto it = m_sessions.constFind(hostKey(url));
+    if (it == m_sessions.constEnd() || it->policy != m_policy ||
+        it->expiresAtMs <= QDateTime::currentMSecsSinceEpoch()) {
+        return nullptr;
+    }
+    return &it.value();
+}
+
+// ============================================================================
+// Session Resumption
+// ============================================================================
+
+void TlsConfig::setResumptionEnabled(bool enabled)
+{
+    m_resumptionEnabled = enabled;
+    rebuild();
+}
+
+bool TlsConfig::rememberSession(const QUrl &url, const QSslConfiguration &negotiated)
+{
+    const QByteArray ticket = negotiated.sessionTicket();
+    if (!m_resumptionEnabled || !isSecure(url) || ticket.isEmpty()) {
+        return false;
+    }
+    
+    // Connections kept alive report the same ticket on every reply
+    Session &session = m_sessions[hostKey(url)];
+    if (session.ticket == ticket && session.policy == m_policy) {
+        return false;
+    }
+    
+    const int lifetimeS = negotiated.sessionTicketLifeTimeHint() > 0
+        ? negotiated.sessionTicketLifeTimeHint() : DEFAULT_TICKET_LIFETIME_S;
+    session.ticket = ticket;
+    session.policy = m_policy;
+    session.expiresAtMs = QDateTime::currentMSecsSinceEpoch() + lifetimeS * 1000LL;
+    
+    qDebug() << "🔒 TLS session ticket for" << hostKey(url) << "valid for" << lifetimeS << "s";
+    
+    if (!m_cacheFile.isEmpty()) {
+        save();
+    }
+    return true;
+}
+
+QByteArray TlsConfig::sessionTicket(const QUrl &url) const
+{
+    const Session *session = usableSession(url);
+    return session ? session->ticket : QByteArray();
+}
+
+void TlsConfig::clearSessions()
+{
+    m_sessions.clear();
+    if (!m_cacheFile.isEmpty()) {
+        save();
+    }
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+
+void TlsConfig::setCacheFile(const QString &path)
+{
+    m_cacheFile = path;
+    if (!path.isEmpty()) {
+        load();
+    }
+}
+
+void TlsConfig::load()
+{
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    
+    const QJsonObject sessions = QJsonDocument::fromJson(file.readAll()).object();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int loaded = 0;
+    
+    for (auto it = sessions.constBegin(); it != sessions.constEnd(); ++it) {
+        const QJsonObject entry = it.value().toObject();
+        Session session;
+        session.ticket = QByteArray::fromBase64(entry["ticket"].toString().toLatin1());
+        session.policy = entry["policy"].toString().toLatin1();
+        session.expiresAtMs = qint64(entry["expires"].toDouble());
+        
+        // Tickets learnt since startup are newer than the file
+        if (session.ticket.isEmpty() || session.expiresAtMs <= now || m_sessions.contains(it.key())) {
+            continue;
+        }
+        m_sessions.insert(it.key(), session);
+        ++loaded;
+    }
+    
+    qDebug() << "🔒 Loaded" << loaded << "TLS session ticket(s) from" << m_cacheFile;
+}
+
+bool TlsConfig::save() const
+{
+    QJsonObject sessions;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    
+    for (auto it = m_sessions.constBegin(); it != m_sessions.constEnd(); ++it) {
+        if (it->expiresAtMs <= now) {
+            continue;
+        }
+        QJsonObject entry;
+        entry["ticket"] = QString::fromLatin1(it->ticket.toBase64());
+        entry["policy"] = QString::fromLatin1(it->policy);
+        entry["expires"] = double(it->expiresAtMs);
+        sessions[it.key()] = entry;
+    }
+    
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath());
+    
+    // A ticket carries the session's master secret: owner-only, like a key file
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "⚠️ Cannot write TLS session cache" << m_cacheFile << ":" << file.errorString();
+        return false;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    file.write(QJsonDocument(sessions).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+// ============================================================================
+// Pinning
+// ============================================================================
+
+void TlsConfig::setPinnedCertificates(const QList<QSslCertificate> &certificates)
+{
+    m_pinning = true;
+    m_pinnedCertificates = certificates;
+    rebuild();
+    updatePolicy();
+    
+    qDebug() << "🔒 Pinned" << certificates.size() << "backend certificate(s)";
+}
+
+bool TlsConfig::loadPinnedCertificates(const QString &pemPath)
+{
+    const QList<QSslCertificate> certificates = QSslCertificate::fromPath(pemPath, QSsl::Pem);
+    
+    // Pins that can't be read trust nothing rather than falling back to the system CAs
+    setPinnedCertificates(certificates);
+    if (certificates.isEmpty()) {
+        qWarning() << "❌ No certificates in" << pemPath << "- every TLS backend will be rejected";
+        return false;
+    }
+    return true;
+}
+
+void TlsConfig::clearPinnedCertificates()
+{
+    m_pinning = false;
+    m_pinnedCertificates.clear();
+    rebuild();
+    updatePolicy();
+}
+
+bool TlsConfig::acceptsErrors(const QList<QSslError> &errors) const
+{
+    if (!m_pinning || errors.isEmpty()) {
+        return false;
+    }
+    
+    // Every error must name a pinned certificate; one about anything else is fatal
+    for (const QSslError &error : errors) {
+        if (error.certificate().isNull() || !m_pinnedCertificates.contains(error.certificate())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TlsConfig::updatePolicy()
+{
+    if (!m_pinning) {
+        m_policy.clear();
+        return;
+    }
+    
+    QList<QByteArray> digests;
+    for (const QSslCertificate &certificate : m_pinnedCertificates) {
+        digests << certificate.digest(QCryptographicHash::Sha256);
+    }
+    std::sort(digests.begin(), digests.end());
+    
+    // Non-empty even with no pins, so "trust nothing" differs from the system CAs
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData("pinned");
+    for (const QByteArray &digest : digests) {
+        hash.addData(digest);
+    }
+    m_policy = hash.result().toHex();
+}
@@ -0,0 +1,86 @@
+#ifndef TLSCONFIG_H
+#define TLSCONFIG_H
+
+#include <QSslConfiguration>
+#include <QSslCertificate>
+#include <QSslError>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QUrl>
+
+/**
+ * @brief One TLS configuration for every connection to the backends
+ *
+ * REST calls, progressive uploads and the /stream WebSocket all start from
+ * the same QSslConfiguration, so they trust the same certificates and can
+ * resume the same sessions. A full handshake costs the Pi's Cortex-A72 tens
+ * of milliseconds of key exchange and signature checks plus a round trip; a
+ * resumed one skips both. Session tickets are remembered per host:port from
+ * finished exchanges and offered on the next connection to that host. With a
+ * cache file they are also persisted, so the first request after a restart
+ * resumes too.
+ *
+ * Pinned certificates replace the system CAs as the only trust anchors, and
+ * certificate errors are accepted only when every one of them is about a
+ * pinned certificate (a self-signed backend reached by IP, say). Without pins
+ * the system CAs apply and every error is fatal. A ticket is only offered
+ * under the trust policy it was obtained with, so changing the pins never
+ * lets an old session skip the new checks.
+ */
+class TlsConfig
+{
+public:
+    TlsConfig();
+    
+    // Shared configuration plus the remembered ticket for url's host, if any
+    QSslConfiguration configurationFor(const QUrl &url) const;
+    static bool isSecure(const QUrl &url);
+    
+    // Session resumption
+    bool isResumptionEnabled() const { return m_resumptionEnabled; }
+    void setResumptionEnabled(bool enabled);
+    bool rememberSession(const QUrl &url, const QSslConfiguration &negotiated);
+    QByteArray sessionTicket(const QUrl &url) const;
+    void clearSessions();
+    
+    // Persistence; an empty path keeps tickets in memory only
+    QString cacheFile() const { return m_cacheFile; }
+    void setCacheFile(const QString &path);
+    bool save() const;
+    
+    // Pinning
+    bool isPinning() const { return m_pinning; }
+    QList<QSslCertificate> pinnedCertificates() const { return m_pinnedCertificates; }
+    void setPinnedCertificates(const QList<QSslCertificate> &certificates);
+    bool loadPinnedCertificates(const QString &pemPath);
+    void clearPinnedCertificates();
+    bool acceptsErrors(const QList<QSslError> &errors) const;
+    
+private:
+    struct Session {
+        QByteArray ticket;
+        QByteArray policy;   // trust policy the session was verified under
+        qint64 expiresAtMs = 0; // wall clock, so it survives restarts
+    };
+
+    static QString hostKey(const QUrl &url);
+    const Session *usableSession(const QUrl &url) const;
+    void rebuild();
+    void load();
+    void updatePolicy();
+
+    QSslConfiguration m_base;
+    bool m_resumptionEnabled;
+    QHash<QString, Session> m_sessions; // keyed by host:port
+    QString m_cacheFile;
+
+    bool m_pinning;
+    QList<QSslCertificate> m_pinnedCertificates;
+    QByteArray m_policy; // empty for the system CAs, else a digest of the pins
+
+    static constexpr int DEFAULT_TICKET_LIFETIME_S = 3600; // when the server gives no hint
+};
+
+#endif // TLSCONFIG_H
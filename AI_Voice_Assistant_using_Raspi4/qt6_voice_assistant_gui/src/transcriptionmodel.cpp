@@ -6,6 +6,11 @@
 TranscriptionModel::TranscriptionModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_nextId(1)
+    , m_oldestLoadedId(1)
+    , m_fetching(false)
+    , m_generation(0)
+    , m_capacity(0)
+    , m_evictionBatch(DEFAULT_EVICTION_BATCH)
 {
 }
 
@@ -19,7 +24,7 @@ int TranscriptionModel::rowCount(const QModelIndex &parent) const
 
 QVariant TranscriptionModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_transcriptions.count())
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_transcriptions.count())
         return QVariant();
     
     const TranscriptionItem &item = m_transcriptions.at(index.row());
@@ -48,11 +53,113 @@ QHash<int, QByteArray> TranscriptionModel::roleNames() const
     return roles;
 }
 
+bool TranscriptionModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !m_history || m_fetching)
+        return false;
+    if (m_capacity > 0 && m_transcriptions.count() >= m_capacity)
+        return false;
+    
+    return m_history->firstId() > 0 && m_oldestLoadedId > m_history->firstId();
+}
+
+void TranscriptionModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    
+    int limit = PAGE_SIZE;
+    if (m_capacity > 0) {
+        limit = qMin(limit, m_capacity - m_transcriptions.count());
+    }
+    
+    // Read behind what this session is still writing, so it sees all of it
+    HistoryLog *history = m_history.data();
+    const int before = m_oldestLoadedId;
+    const quint64 generation = m_generation;
+    setFetching(true);
+    history->post([this, history, before, limit, generation]() {
+        int reached = before;
+        const QList<TranscriptionItem> page = history->readBefore(before, limit, &reached);
+        QMetaObject::invokeMethod(this, [this, page, before, reached, generation]() {
+            insertPage(page, before, reached, generation);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TranscriptionModel::insertPage(QList<TranscriptionItem> page, int before, int reached, quint64 generation)
+{
+    // Cleared or replaced since: a fetch of the new history may be running
+    if (generation != m_generation)
+        return;
+    setFetching(false);
+    
+    // Evicted from meanwhile, the page no longer joins on; the view asks again
+    if (before != m_oldestLoadedId)
+        return;
+    if (m_capacity > 0 && m_transcriptions.count() + page.size() > m_capacity) {
+        page.resize(qMax(0, m_capacity - m_transcriptions.count()));
+        if (page.isEmpty())
+            return;
+        reached = page.last().id;
+    }
+    
+    // Nothing below the bound after all: stop asking
+    m_oldestLoadedId = reached < before ? reached : m_history->firstId();
+    if (page.isEmpty())
+        return;
+    
+    const int count = m_transcriptions.count();
+    beginInsertRows(QModelIndex(), count, count + int(page.size()) - 1);
+    m_transcriptions.appendOlder(page);
+    endInsertRows();
+    emit countChanged();
+    
+    qDebug() << "📜 Loaded" << page.size() << "older transcription(s) from history";
+}
+
+void TranscriptionModel::setFetching(bool fetching)
+{
+    if (m_fetching != fetching) {
+        m_fetching = fetching;
+        emit fetchingChanged();
+    }
+}
+
+int TranscriptionModel::totalCount() const
+{
+    return m_history ? int(m_history->count()) : m_transcriptions.count();
+}
+
+bool TranscriptionModel::openHistory(const QString &directory)
+{
+    QScopedPointer<HistoryLog> history(new HistoryLog(directory));
+    if (!history->isOpen())
+        return false;
+    
+    // The one replaced, if any, finishes its writes as it goes
+    beginResetModel();
+    m_history.swap(history);
+    m_transcriptions.clear();
+    m_nextId = m_history->lastId() + 1;
+    m_oldestLoadedId = m_nextId;
+    ++m_generation;
+    setFetching(false);
+    endResetModel();
+    emit countChanged();
+    return true;
+}
+
 void TranscriptionModel::addTranscription(const QString &text, const QDateTime &timestamp)
 {
     if (text.trimmed().isEmpty())
         return;
     
+    // Full: make room for a batch, not just this one
+    if (m_capacity > 0 && m_transcriptions.count() >= m_capacity) {
+        evictOldest(m_transcriptions.count() - m_capacity + qMin(m_evictionBatch, m_capacity));
+    }
+    
     beginInsertRows(QModelIndex(), 0, 0);
     
     TranscriptionItem item;
@@ -61,6 +168,9 @@ void TranscriptionModel::addTranscription(const QString &text, const QDateTime &
     item.id = m_nextId++;
     
     m_transcriptions.prepend(item);
+    if (m_history) {
+        m_history->append(item);
+    }
     
     endInsertRows();
     emit countChanged();
@@ -70,47 +180,138 @@ void TranscriptionModel::addTranscription(const QString &text, const QDateTime &
 
 void TranscriptionModel::removeTranscription(int id)
 {
-    for (int i = 0; i < m_transcriptions.count(); ++i) {
-        if (m_transcriptions[i].id == id) {
-            beginRemoveRows(QModelIndex(), i, i);
-            m_transcriptions.removeAt(i);
-            endRemoveRows();
-            emit countChanged();
-            break;
-        }
+    const int row = m_transcriptions.rowOf(id);
+    if (row < 0)
+        return;
+    
+    beginRemoveRows(QModelIndex(), row, row);
+    m_transcriptions.removeAt(row);
+    if (m_history) {
+        m_history->remove(id);
+    }
+    endRemoveRows();
+    emit countChanged();
+}
+
+void TranscriptionModel::setCapacity(int capacity)
+{
+    capacity = qMax(0, capacity);
+    if (m_capacity == capacity)
+        return;
+    
+    m_capacity = capacity;
+    if (m_capacity > 0 && m_transcriptions.count() > m_capacity) {
+        evictOldest(m_transcriptions.count() - m_capacity);
     }
+    emit capacityChanged();
+}
+
+void TranscriptionModel::setEvictionBatch(int batch)
+{
+    batch = qMax(1, batch);
+    if (m_evictionBatch == batch)
+        return;
+    
+    m_evictionBatch = batch;
+    emit evictionBatchChanged();
+}
+
+void TranscriptionModel::evictOldest(int n)
+{
+    n = qMin(n, m_transcriptions.count());
+    if (n <= 0)
+        return;
+    
+    // The oldest are the last rows
+    const int count = m_transcriptions.count();
+    beginRemoveRows(QModelIndex(), count - n, count - 1);
+    m_transcriptions.removeOldest(n);
+    // Still on disk, to be paged back in
+    m_oldestLoadedId = m_transcriptions.isEmpty() ? m_nextId : m_transcriptions.at(count - n - 1).id;
+    endRemoveRows();
+    emit countChanged();
+    emit transcriptionsEvicted(n);
+    
+    qDebug() << "🗑️ Evicted" << n << "oldest transcription(s), capacity" << m_capacity;
 }
 
 void TranscriptionModel::clear()
 {
-    if (m_transcriptions.isEmpty())
+    if (m_transcriptions.isEmpty() && totalCount() == 0)
         return;
     
     beginResetModel();
     m_transcriptions.clear();
+    if (m_history) {
+        m_history->clear();
+    }
+    m_oldestLoadedId = m_nextId;
+    ++m_generation;
+    setFetching(false);
     endResetModel();
     emit countChanged();
 }
 
 void TranscriptionModel::exportToFile(const QString &filePath)
+{
+    if (!m_history) {
+        int row = 0;
+        const QPair<bool, QString> result = writeExport(filePath, [this, &row]() -> QList<TranscriptionItem> {
+            if (row >= m_transcriptions.count())
+                return {};
+            return {m_transcriptions.at(row++)};
+        });
+        emit exportCompleted(result.first, result.second);
+        return;
+    }
+    
+    // All of it, not just what has been scrolled to: read a page at a time on
+    // the log's thread, behind what this session is still writing
+    HistoryLog *history = m_history.data();
+    const int newest = m_nextId;
+    history->post([this, history, filePath, newest]() {
+        int before = newest;
+        bool done = false;
+        const QPair<bool, QString> result = writeExport(filePath, [history, &before, &done]() -> QList<TranscriptionItem> {
+            while (!done) {
+                int reached = before;
+                const QList<TranscriptionItem> page = history->readBefore(before, EXPORT_PAGE_SIZE, &reached);
+                done = reached >= before;
+                before = reached;
+                if (!page.isEmpty())
+                    return page;
+            }
+            return {};
+        });
+        QMetaObject::invokeMethod(this, [this, result]() {
+            emit exportCompleted(result.first, result.second);
+        }, Qt::QueuedConnection);
+    });
+}
+
+QPair<bool, QString> TranscriptionModel::writeExport(const QString &filePath,
+                                                     const std::function<QList<TranscriptionItem>()> &nextPage)
 {
     QFile file(filePath);
     
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        emit exportCompleted(false, "Failed to open file for writing");
-        return;
+        return {false, "Failed to open file for writing"};
     }
     
     QTextStream out(&file);
     out << "Voice Assistant Transcription History\n";
     out << "======================================\n\n";
     
-    for (const TranscriptionItem &item : m_transcriptions) {
-        out << "[" << item.timestamp.toString("yyyy-MM-dd hh:mm:ss") << "] ";
-        out << item.text << "\n\n";
+    qint64 exported = 0;
+    for (QList<TranscriptionItem> page = nextPage(); !page.isEmpty(); page = nextPage()) {
+        for (const TranscriptionItem &item : std::as_const(page)) {
+            out << "[" << item.timestamp.toString("yyyy-MM-dd hh:mm:ss") << "] ";
+            out << item.text << "\n\n";
+        }
+        exported += page.size();
     }
     
     file.close();
-    emit exportCompleted(true, "Successfully exported " + QString::number(m_transcriptions.count()) + " transcriptions");
+    return {true, "Successfully exported " + QString::number(exported) + " transcriptions"};
 }
 
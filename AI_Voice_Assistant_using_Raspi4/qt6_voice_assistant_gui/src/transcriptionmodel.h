@@ -3,18 +3,38 @@
 
 #include <QAbstractListModel>
 #include <QDateTime>
-#include <QVector>
-
-struct TranscriptionItem {
-    QString text;
-    QDateTime timestamp;
-    int id;
-};
+#include <QPair>
+#include <QScopedPointer>
+#include <functional>
+#include "historylog.h"
+#include "transcriptionstore.h"
 
+/**
+ * @brief Transcription history, newest first, for HistoryView
+ *
+ * Kept in a TranscriptionStore, so a new transcription and a removal by id
+ * don't move the rest of the history however long the drive has been.
+ *
+ * With a capacity set, the oldest transcriptions are evicted once it is
+ * reached: evictionBatch of them at a time, in one rowsRemoved(), so a view
+ * relayouts once per batch rather than on every new result.
+ *
+ * With a HistoryLog open, every transcription is also written to disk and
+ * the model starts empty: older ones are paged in PAGE_SIZE at a time as the
+ * view scrolls down to them (canFetchMore/fetchMore). Startup reads none of
+ * the history, and memory holds what has been looked at, up to capacity.
+ * Pages are read on the log's writer thread, behind the records still being
+ * written, and inserted from the event loop when they arrive (fetching is
+ * true meanwhile); an export is read and written there too.
+ */
 class TranscriptionModel : public QAbstractListModel
 {
     Q_OBJECT
     Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY countChanged)
+    Q_PROPERTY(bool fetching READ isFetching NOTIFY fetchingChanged)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(int evictionBatch READ evictionBatch WRITE setEvictionBatch NOTIFY evictionBatchChanged)
     
 public:
     enum TranscriptionRoles {
@@ -30,8 +50,23 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    
+    int count() const { return m_transcriptions.count(); } // loaded
+    int totalCount() const;                                 // loaded or on disk
+    bool isFetching() const { return m_fetching; }          // a page is on its way
+    int capacity() const { return m_capacity; } // 0 for no limit
+    int evictionBatch() const { return m_evictionBatch; }
+    int rowOf(int id) const { return m_transcriptions.rowOf(id); }
     
-    int count() const { return m_transcriptions.count(); }
+    void setCapacity(int capacity);
+    void setEvictionBatch(int batch);
+    bool openHistory(const QString &directory); // replaces what the model holds
+    
+    static constexpr int DEFAULT_EVICTION_BATCH = 64;
+    static constexpr int PAGE_SIZE = 100;
+    static constexpr int EXPORT_PAGE_SIZE = 1000;
     
 public slots:
     void addTranscription(const QString &text, const QDateTime &timestamp);
@@ -41,11 +76,28 @@ public slots:
     
 signals:
     void countChanged();
+    void fetchingChanged();
+    void capacityChanged();
+    void evictionBatchChanged();
+    void transcriptionsEvicted(int count);
     void exportCompleted(bool success, const QString &message);
     
 private:
-    QVector<TranscriptionItem> m_transcriptions;
+    void evictOldest(int n);
+    void insertPage(QList<TranscriptionItem> page, int before, int reached, quint64 generation);
+    void setFetching(bool fetching);
+    // Empties the file and writes pages from nextPage() until it returns none
+    static QPair<bool, QString> writeExport(const QString &filePath,
+                                            const std::function<QList<TranscriptionItem>()> &nextPage);
+    
+    TranscriptionStore m_transcriptions;
+    QScopedPointer<HistoryLog> m_history;
     int m_nextId;
+    int m_oldestLoadedId; // every id from here to m_nextId is loaded, unless deleted
+    bool m_fetching;
+    quint64 m_generation; // bumped by clear() and openHistory(); older pages are dropped
+    int m_capacity;
+    int m_evictionBatch;
 };
 
 #endif // TRANSCRIPTIONMODEL_H
@@ -0,0 +1,177 @@
+#include "transcriptionstore.h"
+#include <algorithm>
+
+TranscriptionStore::TranscriptionStore()
+    : m_count(0)
+    , m_nextSerial(0)
+    , m_validStarts(0)
+    , m_base(0)
+{
+}
+
+const TranscriptionItem &TranscriptionStore::at(int row) const
+{
+    const int position = m_count - 1 - row;
+    const int chunk = chunkAt(position);
+    return m_chunks.at(chunk).items.at(int(m_base + position - m_starts.at(chunk)));
+}
+
+int TranscriptionStore::rowOf(int id) const
+{
+    const auto found = m_chunkOfId.constFind(id);
+    if (found == m_chunkOfId.constEnd()) {
+        return -1;
+    }
+    
+    // Ids only grow, so a chunk is sorted by them
+    const int chunk = chunkIndex(found.value());
+    const QList<TranscriptionItem> &items = m_chunks.at(chunk).items;
+    const auto item = std::lower_bound(items.cbegin(), items.cend(), id, [](const TranscriptionItem &item, int id) {
+        return item.id < id;
+    });
+    validateStarts(chunk + 1);
+    const qint64 position = m_starts.at(chunk) - m_base + (item - items.cbegin());
+    return int(m_count - 1 - position);
+}
+
+void TranscriptionStore::prepend(const TranscriptionItem &item)
+{
+    if (m_chunks.isEmpty() || m_chunks.last().items.size() == CHUNK_SIZE) {
+        const bool startKnown = m_validStarts == m_chunks.size();
+        const qint64 start = m_chunks.isEmpty() ? m_base : m_starts.last() + m_chunks.last().items.size();
+        
+        Chunk chunk;
+        chunk.serial = m_nextSerial++;
+        chunk.items.reserve(CHUNK_SIZE);
+        m_chunks.append(chunk);
+        m_starts.append(startKnown ? start : 0);
+        if (startKnown) {
+            ++m_validStarts;
+        }
+    }
+    
+    m_chunks.last().items.append(item);
+    m_chunkOfId.insert(item.id, m_chunks.last().serial);
+    ++m_count;
+}
+
+void TranscriptionStore::appendOlder(const QList<TranscriptionItem> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+    if (m_chunks.isEmpty()) {
+        for (auto it = items.crbegin(); it != items.crend(); ++it) {
+            prepend(*it);
+        }
+        return;
+    }
+    
+    // New chunks ahead of the oldest, with the serials just below its own
+    const int n = int(items.size());
+    const int added = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const qint64 firstSerial = m_chunks.first().serial - added;
+    QList<Chunk> older;
+    older.reserve(added + m_chunks.size());
+    for (int c = 0; c < added; ++c) {
+        Chunk chunk;
+        chunk.serial = firstSerial + c;
+        chunk.items.reserve(CHUNK_SIZE);
+        for (int i = n - 1 - c * CHUNK_SIZE; i >= 0 && chunk.items.size() < CHUNK_SIZE; --i) {
+            chunk.items.append(items.at(i));
+            m_chunkOfId.insert(items.at(i).id, chunk.serial);
+        }
+        older.append(chunk);
+    }
+    older += m_chunks;
+    m_chunks = older;
+    
+    QList<qint64> starts(added, 0);
+    starts += m_starts;
+    m_starts = starts;
+    m_validStarts = 0;
+    m_base -= n;
+    m_count += n;
+}
+
+void TranscriptionStore::removeAt(int row)
+{
+    const int position = m_count - 1 - row;
+    const int chunk = chunkAt(position);
+    QList<TranscriptionItem> &items = m_chunks[chunk].items;
+    const int slot = int(m_base + position - m_starts.at(chunk));
+    
+    m_chunkOfId.remove(items.at(slot).id);
+    items.removeAt(slot);
+    --m_count;
+    
+    // Chunks after this one start one earlier now
+    m_validStarts = qMin(m_validStarts, chunk + 1);
+    dropEmptyFrontChunks();
+}
+
+void TranscriptionStore::removeOldest(int n)
+{
+    n = qMin(n, m_count);
+    while (n > 0) {
+        Chunk &front = m_chunks.first();
+        const int taken = qMin(n, int(front.items.size()));
+        for (int i = 0; i < taken; ++i) {
+            m_chunkOfId.remove(front.items.at(i).id);
+        }
+        
+        if (taken == front.items.size()) {
+            m_chunks.removeFirst();
+            m_starts.removeFirst();
+            m_validStarts = qMax(0, m_validStarts - 1);
+        } else {
+            front.items.remove(0, taken);
+            m_starts.first() += taken;
+        }
+        m_base += taken;
+        m_count -= taken;
+        n -= taken;
+    }
+    dropEmptyFrontChunks();
+}
+
+void TranscriptionStore::clear()
+{
+    m_chunks.clear();
+    m_chunkOfId.clear();
+    m_starts.clear();
+    m_validStarts = 0;
+    m_base = 0;
+    m_count = 0;
+}
+
+int TranscriptionStore::chunkAt(int position) const
+{
+    validateStarts(m_chunks.size());
+    
+    // The last chunk starting at or before it; empty chunks share their start
+    // with the next one, so this skips them
+    const auto next = std::upper_bound(m_starts.cbegin(), m_starts.cend(), m_base + position);
+    return int(next - m_starts.cbegin()) - 1;
+}
+
+void TranscriptionStore::validateStarts(int upTo) const
+{
+    if (m_validStarts == 0 && upTo > 0) {
+        m_starts[0] = m_base;
+        m_validStarts = 1;
+    }
+    for (; m_validStarts < upTo; ++m_validStarts) {
+        m_starts[m_validStarts] = m_starts.at(m_validStarts - 1) + m_chunks.at(m_validStarts - 1).items.size();
+    }
+}
+
+void TranscriptionStore::dropEmptyFrontChunks()
+{
+    // A chunk emptied by removals goes once it is the oldest, as if evicted
+    while (!m_chunks.isEmpty() && m_chunks.first().items.isEmpty()) {
+        m_chunks.removeFirst();
+        m_starts.removeFirst();
+        m_validStarts = qMax(0, m_validStarts - 1);
+    }
+}
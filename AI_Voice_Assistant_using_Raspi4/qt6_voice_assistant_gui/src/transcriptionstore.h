@@ -0,0 +1,73 @@
+#ifndef TRANSCRIPTIONSTORE_H
+#define TRANSCRIPTIONSTORE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+struct TranscriptionItem {
+    QString text;
+    QDateTime timestamp;
+    int id;
+};
+
+/**
+ * @brief Storage behind TranscriptionModel: newest first, by row or by id
+ *
+ * Items are kept oldest first in fixed-size chunks, and row 0 is the last
+ * item of the last chunk, so a new transcription is an append and never
+ * moves the ones before it. Ids only grow, so each chunk is sorted by id;
+ * a hash from id to chunk finds an item without a scan. Evicting the oldest
+ * items drops whole chunks from the front, and older ones paged in from
+ * disk are whole chunks added there.
+ *
+ * Where each chunk starts is cached. Appends and evictions keep that cache
+ * up to date; removing an item from the middle invalidates it from that
+ * chunk on, and it is rebuilt, once per chunk, on the next lookup.
+ */
+class TranscriptionStore
+{
+public:
+    TranscriptionStore();
+    
+    int count() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    
+    const TranscriptionItem &at(int row) const; // row 0 is the newest
+    int rowOf(int id) const;                    // -1 if not stored
+    bool contains(int id) const { return m_chunkOfId.contains(id); }
+    
+    void prepend(const TranscriptionItem &item); // ids must increase
+    void appendOlder(const QList<TranscriptionItem> &items); // newest first, older than any stored
+    void removeAt(int row);
+    void removeOldest(int n);
+    void clear();
+    
+    static constexpr int CHUNK_SIZE = 256;
+    
+private:
+    struct Chunk {
+        qint64 serial;                 // stable across evictions, for the id index
+        QList<TranscriptionItem> items; // oldest first
+    };
+    
+    int chunkIndex(qint64 serial) const { return int(serial - m_chunks.first().serial); }
+    int chunkAt(int position) const;
+    void validateStarts(int upTo) const;
+    void dropEmptyFrontChunks();
+    
+    QList<Chunk> m_chunks;           // oldest first
+    QHash<int, qint64> m_chunkOfId;  // id -> chunk serial
+    int m_count;
+    qint64 m_nextSerial;
+    
+    // Position of each chunk's first item, counted from the first item ever
+    // stored; entries from m_validStarts on are stale. m_base is the oldest
+    // stored item's, so evicting from the front moves no other entry.
+    mutable QList<qint64> m_starts;
+    mutable int m_validStarts;
+    qint64 m_base;
+};
+
+#endif // TRANSCRIPTIONSTORE_H
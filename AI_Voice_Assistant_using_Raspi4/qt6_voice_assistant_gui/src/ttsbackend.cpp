@@ -0,0 +1,77 @@
+#include "ttsbackend.h"
+#include <QDebug>
+
+TTSBackend::TTSBackend(QObject *parent)
+    : QObject(parent)
+    , m_ready(false)
+    , m_exited(false)
+    , m_shutDown(false)
+    , m_startupMs(-1)
+{
+}
+
+void TTSBackend::beginStartup()
+{
+    m_clock.start();
+}
+
+void TTSBackend::markReady()
+{
+    if (m_ready) {
+        return;
+    }
+    
+    m_ready = true;
+    m_startupMs = m_clock.elapsed();
+    qDebug() << "🔊 TTS backend" << description() << "ready after" << m_startupMs << "ms";
+    emit ready();
+}
+
+void TTSBackend::reportExit(int exitCode)
+{
+    if (m_exited) {
+        return;
+    }
+    
+    m_exited = true;
+    emit exited(exitCode, m_ready);
+}
+
+void TTSBackend::postReady()
+{
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_shutDown) {
+            markReady();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TTSBackend::postMessage(const QJsonObject &message)
+{
+    QMetaObject::invokeMethod(this, [this, message]() {
+        if (!m_shutDown) {
+            emit messageReceived(message);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TTSBackend::beginShutdown(int exitCode)
+{
+    m_shutDown = true;
+    QMetaObject::invokeMethod(this, [this, exitCode]() { reportExit(exitCode); }, Qt::QueuedConnection);
+}
+
+bool TTSBackend::refusePlayback(const QString &command)
+{
+    // The engine plays for a backend that doesn't; this is a caller bug
+    if (command == "SPEAK" || command == "SPEAK_CHUNK") {
+        postMessage({{"type", "error"},
+                     {"message", QString("%1 is not supported (%2); use SYNTHESIZE")
+                                     .arg(command, description())}});
+        return true;
+    }
+    
+    // Volume, stopping and pausing are the engine's, at playback
+    return command == "SET_VOLUME" || command == "STOP" || command == "PAUSE" ||
+           command == "RESUME" || command == "QUIT";
+}
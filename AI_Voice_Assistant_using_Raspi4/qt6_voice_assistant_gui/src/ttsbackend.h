@@ -0,0 +1,80 @@
+#ifndef TTSBACKEND_H
+#define TTSBACKEND_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <QVariantMap>
+#include "ttscache.h"
+
+/**
+ * @brief A speech synthesis backend as TTSEngine sees it
+ *
+ * Every backend takes the same commands (SPEAK_CHUNK, SYNTHESIZE, CANCEL,
+ * STOP, SET_RATE, ...) and answers with the same messages as tts_backend.py,
+ * so the engine doesn't care whether the synthesis runs in another process,
+ * in this one or on a server. PCM may come back as base64 "audio" messages,
+ * whole through audioSynthesized(), or in blocks as it arrives through
+ * audioStreamed(), the last one with final set, so playback can start
+ * before the rest of the sentence is there.
+ *
+ * A backend is ready once it can synthesize. start() never blocks, and
+ * commands sent before the backend is ready are not lost. exited() is
+ * raised once, whether the backend quit, crashed or never started.
+ */
+class TTSBackend : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit TTSBackend(QObject *parent = nullptr);
+    
+    virtual void start() = 0;
+    
+    // Asks the backend to quit without waiting for it; the destructor waits
+    virtual void shutdown() = 0;
+    
+    virtual void send(const QString &command, const QVariantMap &params = QVariantMap()) = 0;
+    virtual void sendLatest(const QString &command, const QVariantMap &params) = 0;
+    
+    // Whether SPEAK_CHUNK is heard from the backend itself; if not, the engine plays SYNTHESIZE output
+    virtual bool playsAudio() const = 0;
+    virtual QString description() const = 0;
+    
+    bool isReady() const { return m_ready; }
+    bool hasExited() const { return m_exited; }
+    qint64 startupMs() const { return m_startupMs; } // -1 until ready
+    
+signals:
+    void ready();
+    void messageReceived(const QJsonObject &message);
+    void audioSynthesized(quint64 request, const TTSAudio &audio);
+    void audioStreamed(quint64 request, const TTSAudio &block, bool final);
+    void errorOutput(const QString &text);
+    void exited(int exitCode, bool everReady);
+    
+protected:
+    void beginStartup();
+    void markReady();
+    void reportExit(int exitCode);
+    
+    // For backends in this process, which answer from the event loop, never
+    // from inside start() or send(), so the engine isn't re-entered
+    void postReady();
+    void postMessage(const QJsonObject &message);
+    void beginShutdown(int exitCode = 0); // nothing is posted after this; exited() follows
+    bool isShutDown() const { return m_shutDown; }
+    
+    // For backends that play nothing: true if the command was about playback
+    bool refusePlayback(const QString &command);
+    
+private:
+    QElapsedTimer m_clock;
+    bool m_ready;
+    bool m_exited;
+    bool m_shutDown;
+    qint64 m_startupMs;
+};
+
+#endif // TTSBACKEND_H
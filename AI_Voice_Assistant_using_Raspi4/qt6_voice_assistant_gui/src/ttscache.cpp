@@ -0,0 +1,261 @@
+#include "ttscache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+static const char CACHE_MAGIC[4] = {'T', 'T', 'S', 'C'};
+static const quint16 CACHE_VERSION = 1;
+static const char CACHE_SUFFIX[] = ".pcm";
+
+qint64 TTSAudio::durationMs() const
+{
+    if (isNull()) {
+        return 0;
+    }
+    return qint64(pcm.size()) / (2 * channels) * 1000 / sampleRate;
+}
+
+TTSCache::TTSCache(const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_diskBytes(0)
+    , m_diskBudget(DEFAULT_DISK_BUDGET)
+    , m_memoryHits(0)
+    , m_diskHits(0)
+    , m_misses(0)
+{
+    m_memory.setMaxCost(DEFAULT_MEMORY_BUDGET);
+    
+    // One writer keeps file writes in order and off the GUI thread
+    m_writer.setMaxThreadCount(1);
+    
+    if (!m_directory.isEmpty()) {
+        if (!QDir().mkpath(m_directory)) {
+            qWarning() << "⚠️ TTS cache directory unavailable:" << m_directory;
+            m_directory.clear();
+        } else {
+            scanDisk();
+        }
+    }
+}
+
+TTSCache::~TTSCache()
+{
+    flush();
+}
+
+QString TTSCache::normalize(const QString &text)
+{
+    // Case is kept: "US" and "us" are spoken differently
+    return text.normalized(QString::NormalizationForm_C).simplified();
+}
+
+QString TTSCache::key(const QString &text, const QString &voice, float rate)
+{
+    // Rates closer than the slider's step sound the same
+    const QByteArray identity = normalize(text).toUtf8() + '\n' + voice.toUtf8() + '\n' +
+                                QByteArray::number(qRound(rate * 100));
+    return QString::fromLatin1(QCryptographicHash::hash(identity, QCryptographicHash::Sha1).toHex());
+}
+
+TTSAudio TTSCache::lookup(const QString &key)
+{
+    if (const TTSAudio *cached = m_memory.object(key)) {
+        ++m_memoryHits;
+        emit statsChanged();
+        return *cached;
+    }
+    
+    TTSAudio audio = readFile(key);
+    if (audio.isNull()) {
+        ++m_misses;
+    } else {
+        ++m_diskHits;
+        m_memory.insert(key, new TTSAudio(audio), audio.pcm.size());
+    }
+    emit statsChanged();
+    return audio;
+}
+
+bool TTSCache::contains(const QString &key) const
+{
+    return m_memory.contains(key) || (!m_directory.isEmpty() && QFile::exists(filePath(key)));
+}
+
+void TTSCache::insert(const QString &key, const TTSAudio &audio)
+{
+    if (audio.isNull()) {
+        return;
+    }
+    
+    m_memory.insert(key, new TTSAudio(audio), audio.pcm.size());
+    if (!m_directory.isEmpty()) {
+        m_writer.start([this, key, audio]() {
+            writeFile(key, audio);
+        });
+    }
+    emit statsChanged();
+}
+
+void TTSCache::clear()
+{
+    flush();
+    m_memory.clear();
+    
+    if (!m_directory.isEmpty()) {
+        QMutexLocker locker(&m_diskMutex);
+        const QStringList files = QDir(m_directory).entryList({QString("*") + CACHE_SUFFIX}, QDir::Files);
+        for (const QString &name : files) {
+            QFile::remove(QDir(m_directory).filePath(name));
+        }
+        m_diskBytes = 0;
+    }
+    emit statsChanged();
+}
+
+void TTSCache::flush()
+{
+    m_writer.waitForDone();
+}
+
+void TTSCache::setMemoryBudget(qint64 bytes)
+{
+    m_memory.setMaxCost(bytes);
+    emit statsChanged();
+}
+
+void TTSCache::setDiskBudget(qint64 bytes)
+{
+    m_diskBudget = bytes;
+    if (!m_directory.isEmpty()) {
+        m_writer.start([this]() {
+            QMutexLocker locker(&m_diskMutex);
+            trimDisk();
+        });
+    }
+}
+
+double TTSCache::hitRate() const
+{
+    const quint64 lookups = hits() + m_misses;
+    return lookups > 0 ? double(hits()) / lookups : 0.0;
+}
+
+// ============================================================================
+// Disk Tier
+// ============================================================================
+
+QString TTSCache::filePath(const QString &key) const
+{
+    return QDir(m_directory).filePath(key + CACHE_SUFFIX);
+}
+
+TTSAudio TTSCache::readFile(const QString &key)
+{
+    TTSAudio audio;
+    if (m_directory.isEmpty()) {
+        return audio;
+    }
+    
+    QSharedPointer<QFile> file(new QFile(filePath(key)));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return audio;
+    }
+    
+    const qint64 size = file->size();
+    const uchar *data = size > HEADER_BYTES ? file->map(0, size) : nullptr;
+    const quint32 pcmBytes = data ? qFromLittleEndian<quint32>(data + 12) : 0;
+    if (!data || memcmp(data, CACHE_MAGIC, 4) != 0 ||
+        qFromLittleEndian<quint16>(data + 4) != CACHE_VERSION || pcmBytes != size - HEADER_BYTES) {
+        // Left by an older build or a crash mid-write: drop it
+        qWarning() << "⚠️ Discarding unreadable TTS cache file" << file->fileName();
+        file->close();
+        QMutexLocker locker(&m_diskMutex);
+        if (file->remove()) {
+            m_diskBytes -= size;
+        }
+        return audio;
+    }
+    
+    audio.channels = qFromLittleEndian<quint16>(data + 6);
+    audio.sampleRate = qFromLittleEndian<quint32>(data + 8);
+    audio.pcm = QByteArray::fromRawData(reinterpret_cast<const char *>(data + HEADER_BYTES), pcmBytes);
+    audio.mapping = file;
+    
+    // Recency for trimming; the mapping stays valid even if the file is trimmed later
+    file->setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    return audio;
+}
+
+void TTSCache::writeFile(const QString &key, const TTSAudio &audio)
+{
+    uchar header[HEADER_BYTES];
+    memcpy(header, CACHE_MAGIC, 4);
+    qToLittleEndian<quint16>(CACHE_VERSION, header + 4);
+    qToLittleEndian<quint16>(quint16(audio.channels), header + 6);
+    qToLittleEndian<quint32>(quint32(audio.sampleRate), header + 8);
+    qToLittleEndian<quint32>(quint32(audio.pcm.size()), header + 12);
+    
+    QMutexLocker locker(&m_diskMutex);
+    const QString path = filePath(key);
+    const qint64 previousSize = QFileInfo(path).size();
+    
+    // Written aside and renamed, so a reader never maps a partial file
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(reinterpret_cast<const char *>(header), HEADER_BYTES) != HEADER_BYTES ||
+        file.write(audio.pcm) != audio.pcm.size() || !file.commit()) {
+        qWarning() << "⚠️ Failed to write TTS cache file" << path << file.errorString();
+        return;
+    }
+    
+    m_diskBytes += HEADER_BYTES + audio.pcm.size() - previousSize;
+    trimDisk();
+    emit statsChanged();
+}
+
+void TTSCache::trimDisk()
+{
+    if (m_diskBytes <= m_diskBudget) {
+        return;
+    }
+    
+    // Oldest modification time first; hits refresh it
+    QDir dir(m_directory);
+    const QFileInfoList files = dir.entryInfoList({QString("*") + CACHE_SUFFIX}, QDir::Files,
+                                                  QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const QFileInfo &info : files) {
+        total += info.size();
+    }
+    
+    int removed = 0;
+    for (const QFileInfo &info : files) {
+        if (total <= m_diskBudget) {
+            break;
+        }
+        if (QFile::remove(info.filePath())) {
+            total -= info.size();
+            ++removed;
+        }
+    }
+    m_diskBytes = total;
+    qDebug() << "🗑️ Trimmed" << removed << "TTS cache file(s), disk tier now" << total << "bytes";
+}
+
+void TTSCache::scanDisk()
+{
+    qint64 total = 0;
+    const QFileInfoList files = QDir(m_directory).entryInfoList({QString("*") + CACHE_SUFFIX}, QDir::Files);
+    for (const QFileInfo &info : files) {
+        total += info.size();
+    }
+    m_diskBytes = total;
+    qDebug() << "💾 TTS cache:" << files.size() << "phrase(s)," << total << "bytes on disk";
+}
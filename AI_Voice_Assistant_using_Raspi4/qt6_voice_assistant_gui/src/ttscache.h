@@ -0,0 +1,102 @@
+#ifndef TTSCACHE_H
+#define TTSCACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QCache>
+#include <QFile>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+
+/**
+ * @brief Synthesized speech: 16-bit little-endian PCM and its format
+ *
+ * Audio read from the disk tier points into a read-only mapping of the cache
+ * file; the mapping lives as long as any copy of the TTSAudio does.
+ */
+struct TTSAudio {
+    int sampleRate = 0;
+    int channels = 0;
+    QByteArray pcm;
+    QSharedPointer<QFile> mapping; // set when pcm is mapped from disk
+    
+    bool isNull() const { return pcm.isEmpty() || sampleRate <= 0 || channels <= 0; }
+    qint64 durationMs() const;
+};
+
+/**
+ * @brief Two-tier cache of synthesized speech
+ *
+ * Entries are keyed by the normalized text, voice and rate, so a prompt
+ * spoken again with the same settings plays without going to the backend.
+ * The memory tier is an LRU bounded by PCM bytes. Every entry is also
+ * written to the disk tier (a file per entry under directory()), which
+ * survives restarts and is read back through a memory mapping, so a disk hit
+ * costs page faults rather than a copy. Files are written on the thread
+ * pool; the disk tier is trimmed to its budget by least recent use, which
+ * hits record in the file's modification time.
+ */
+class TTSCache : public QObject
+{
+    Q_OBJECT
+    
+public:
+    // An empty directory keeps the cache in memory only
+    explicit TTSCache(const QString &directory = QString(), QObject *parent = nullptr);
+    ~TTSCache();
+    
+    static QString key(const QString &text, const QString &voice, float rate);
+    static QString normalize(const QString &text);
+    
+    TTSAudio lookup(const QString &key);
+    bool contains(const QString &key) const;
+    void insert(const QString &key, const TTSAudio &audio);
+    void clear();
+    
+    // Waits for pending disk writes, e.g. before reading the directory
+    void flush();
+    
+    void setMemoryBudget(qint64 bytes);
+    void setDiskBudget(qint64 bytes);
+    QString directory() const { return m_directory; }
+    
+    // Statistics
+    quint64 hits() const { return m_memoryHits + m_diskHits; }
+    quint64 memoryHits() const { return m_memoryHits; }
+    quint64 diskHits() const { return m_diskHits; }
+    quint64 misses() const { return m_misses; }
+    double hitRate() const;
+    qint64 memoryBytes() const { return m_memory.totalCost(); }
+    qint64 diskBytes() const { return m_diskBytes; }
+    
+    static constexpr qint64 DEFAULT_MEMORY_BUDGET = 8 * 1024 * 1024;  // ~3 min of 22 kHz mono
+    static constexpr qint64 DEFAULT_DISK_BUDGET = 64 * 1024 * 1024;
+    static constexpr int HEADER_BYTES = 16;
+    
+signals:
+    void statsChanged();
+    
+private:
+    QString filePath(const QString &key) const;
+    TTSAudio readFile(const QString &key);
+    void writeFile(const QString &key, const TTSAudio &audio);
+    void trimDisk();
+    void scanDisk();
+    
+    QString m_directory;
+    QCache<QString, TTSAudio> m_memory; // cost is PCM bytes
+    
+    QMutex m_diskMutex; // file writes and trimming run on the thread pool
+    std::atomic<qint64> m_diskBytes;
+    std::atomic<qint64> m_diskBudget;
+    QThreadPool m_writer;
+    
+    quint64 m_memoryHits;
+    quint64 m_diskHits;
+    quint64 m_misses;
+};
+
+#endif // TTSCACHE_H
@@ -0,0 +1,137 @@
+#include "ttschannel.h"
+#include <QJsonDocument>
+#include <QDebug>
+
+TTSChannel::TTSChannel(QIODevice *device, QObject *parent)
+    : QObject(parent)
+    , m_device(device)
+    , m_writeScheduled(false)
+    , m_discardingLine(false)
+{
+    connect(m_device, &QIODevice::readyRead, this, &TTSChannel::readLines);
+    connect(m_device, &QIODevice::bytesWritten, this, &TTSChannel::writePending);
+}
+
+QByteArray TTSChannel::encode(const QString &command, const QVariantMap &params)
+{
+    QJsonObject obj = QJsonObject::fromVariantMap(params);
+    obj["command"] = command;
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+void TTSChannel::send(const QString &command, const QVariantMap &params)
+{
+    m_queue.append({QString(), encode(command, params)});
+    scheduleWrite();
+}
+
+void TTSChannel::sendLatest(const QString &command, const QVariantMap &params)
+{
+    // Replace a queued command of the same name, unless a barrier follows it
+    for (int i = m_queue.size() - 1; i >= 0 && !m_queue[i].coalesceKey.isEmpty(); --i) {
+        if (m_queue[i].coalesceKey == command) {
+            m_queue[i].line = encode(command, params);
+            return;
+        }
+    }
+    
+    m_queue.append({command, encode(command, params)});
+    scheduleWrite();
+}
+
+void TTSChannel::clear()
+{
+    m_queue.clear();
+    m_readBuffer.clear();
+    m_discardingLine = false;
+}
+
+void TTSChannel::scheduleWrite()
+{
+    // Commands issued in the same event loop pass go out in one write
+    if (!m_writeScheduled) {
+        m_writeScheduled = true;
+        QMetaObject::invokeMethod(this, &TTSChannel::writePending, Qt::QueuedConnection);
+    }
+}
+
+void TTSChannel::writePending()
+{
+    m_writeScheduled = false;
+    
+    // Until the device has drained, new commands wait here where they can still be merged
+    if (m_device->bytesToWrite() > 0) {
+        return;
+    }
+    flush();
+}
+
+void TTSChannel::flush()
+{
+    if (m_queue.isEmpty() || !m_device->isWritable()) {
+        return;
+    }
+    
+    QByteArray batch;
+    for (const Frame &frame : m_queue) {
+        batch += frame.line;
+    }
+    m_queue.clear();
+    
+    if (m_device->write(batch) != batch.size()) {
+        qWarning() << "⚠️ TTS channel write failed:" << m_device->errorString();
+    }
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+void TTSChannel::readLines()
+{
+    // Taken out of the member first: a handler may clear() the channel mid-loop
+    QByteArray data = m_readBuffer + m_device->readAll();
+    m_readBuffer.clear();
+    
+    qsizetype start = 0;
+    qsizetype newline;
+    while ((newline = data.indexOf('\n', start)) >= 0) {
+        if (m_discardingLine) {
+            m_discardingLine = false;
+        } else {
+            parseLine(data.mid(start, newline - start));
+        }
+        start = newline + 1;
+    }
+    
+    if (m_discardingLine) {
+        return;
+    }
+    if (data.size() - start > MAX_LINE_BYTES) {
+        m_discardingLine = true;
+        emit protocolError(QString("TTS message longer than %1 bytes skipped").arg(MAX_LINE_BYTES));
+        return;
+    }
+    m_readBuffer = data.mid(start);
+}
+
+void TTSChannel::parseLine(const QByteArray &line)
+{
+    if (line.trimmed().isEmpty()) {
+        return;
+    }
+    
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+    if (!doc.isObject()) {
+        emit protocolError(QString("Invalid TTS message: %1").arg(
+            error.error != QJsonParseError::NoError ? error.errorString() : QString("not an object")));
+        return;
+    }
+    
+    emit messageReceived(doc.object());
+}
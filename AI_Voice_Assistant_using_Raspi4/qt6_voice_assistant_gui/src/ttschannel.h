@@ -0,0 +1,76 @@
+#ifndef TTSCHANNEL_H
+#define TTSCHANNEL_H
+
+#include <QObject>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * @brief Newline-delimited JSON channel to the TTS backend process
+ *
+ * Commands are queued and handed to the device from the event loop, never
+ * with a blocking wait, so a TTS backend that stops reading can't stall the
+ * GUI thread. While the device still has bytes to write, further commands
+ * stay in the queue. There, sendLatest() replaces a queued command of the
+ * same name, so a slider dragged across fifty volume steps sends one
+ * SET_VOLUME with the final value. A command sent with send() is a barrier:
+ * a parameter change queued after it is never merged into one queued before
+ * it, so each utterance starts with the parameters it was asked for.
+ *
+ * Incoming bytes are split on newlines as they arrive. One read may hold any
+ * number of messages, and a message may be split across reads. A line that
+ * isn't a JSON object, or grows past MAX_LINE_BYTES, is reported and
+ * skipped without losing the lines around it.
+ */
+class TTSChannel : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit TTSChannel(QIODevice *device, QObject *parent = nullptr);
+    
+    void send(const QString &command, const QVariantMap &params = QVariantMap());
+    void sendLatest(const QString &command, const QVariantMap &params);
+    
+    // Forget queued commands and any partial line, e.g. when the process restarts
+    void clear();
+    
+    int pendingCount() const { return m_queue.size(); }
+    
+    static constexpr int MAX_LINE_BYTES = 4 * 1024 * 1024;
+    
+public slots:
+    // Hand every queued command to the device now, even if it is still writing
+    void flush();
+    
+signals:
+    void messageReceived(const QJsonObject &message);
+    void protocolError(const QString &error);
+    
+private slots:
+    void writePending();
+    void readLines();
+    
+private:
+    struct Frame {
+        QString coalesceKey; // empty for barriers
+        QByteArray line;
+    };
+    
+    static QByteArray encode(const QString &command, const QVariantMap &params);
+    void scheduleWrite();
+    void parseLine(const QByteArray &line);
+    
+    QIODevice *m_device;
+    QList<Frame> m_queue;
+    bool m_writeScheduled;
+    
+    QByteArray m_readBuffer;
+    bool m_discardingLine; // the rest of an oversized line is skipped
+};
+
+#endif // TTSCHANNEL_H
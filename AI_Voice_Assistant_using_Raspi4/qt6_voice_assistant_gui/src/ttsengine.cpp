@@ -1,37 +1,101 @@
 #include "ttsengine.h"
+#include "ttsworker.h"
+#include "nativettsbackend.h"
+#include "remotettsbackend.h"
+#include "ttsplayer.h"
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMetaEnum>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <algorithm>
 
 TTSEngine::TTSEngine(QObject *parent)
+    : TTSEngine(ProcessBackend, parent)
+{
+}
+
+TTSEngine::TTSEngine(Backend backend, QObject *parent)
+    : TTSEngine(backend, "python3", {"/usr/share/voice-assistant/backend/tts_backend.py"}, nullptr, parent)
+{
+}
+
+TTSEngine::TTSEngine(const QString &program, const QStringList &arguments, QObject *parent)
+    : TTSEngine(ProcessBackend, program, arguments, nullptr, parent)
+{
+}
+
+TTSEngine::TTSEngine(NetworkManager *network, QObject *parent)
+    : TTSEngine(RemoteBackend, QString(), QStringList(), network, parent)
+{
+}
+
+TTSEngine::TTSEngine(Backend backend, const QString &program, const QStringList &arguments, NetworkManager *network,
+                     QObject *parent)
     : QObject(parent)
     , m_isSpeaking(false)
     , m_volume(1.0f)
     , m_rate(1.0f)
     , m_voice("default")
     , m_enabled(true)
-    , m_ttsProcess(new QProcess(this))
-    , m_isProcessing(false)
+    , m_backend(backend)
+    , m_program(program)
+    , m_arguments(arguments)
+    , m_network(network)
+    , m_worker(nullptr)
+    , m_standby(nullptr)
+    , m_respawnDelayMs(0)
+    , m_failingOver(false)
+    , m_lastFailoverMs(-1)
+    , m_chunksSent(0)
+    , m_chunksDone(0)
+    , m_utteranceId(0)
+    , m_firstAudioSeen(false)
+    , m_lastTimeToFirstAudioMs(-1)
+    , m_cache(new TTSCache(cacheDirectory(backend), this))
+    , m_player(new TTSPlayer(this))
+    , m_localPlayback(TTSPlayer::outputAvailable())
+    , m_utteranceLocal(false)
+    , m_chunksQueued(0)
+    , m_playingChunk(-1)
+    , m_wordsSpoken(0)
+    , m_chunkDurationMs(0)
+    , m_nextRequestId(0)
 {
-    // Setup TTS process
-    connect(m_ttsProcess, &QProcess::readyReadStandardOutput,
-            this, &TTSEngine::handleTTSOutput);
-    connect(m_ttsProcess, &QProcess::readyReadStandardError,
-            this, &TTSEngine::handleTTSError);
-    connect(m_ttsProcess, QOverload<int>::of(&QProcess::finished),
-            this, &TTSEngine::handleTTSFinished);
+    m_respawnTimer.setSingleShot(true);
+    connect(&m_respawnTimer, &QTimer::timeout, this, &TTSEngine::spawnStandby);
     
-    // Start TTS backend
-    startTTSProcess();
+    connect(m_cache, &TTSCache::statsChanged, this, &TTSEngine::cacheStatsChanged);
+    connect(m_player, &TTSPlayer::segmentStarted, this, &TTSEngine::handleSegmentStarted);
+    connect(m_player, &TTSPlayer::segmentProgress, this, &TTSEngine::handleSegmentProgress);
+    connect(m_player, &TTSPlayer::segmentFinished, this, &TTSEngine::handleSegmentFinished);
+    connect(m_player, &TTSPlayer::mediaGainChanged, this, &TTSEngine::mediaGainChanged);
+    
+    // Prompts the assistant says most; synthesized while nothing else is
+    m_prefetchPhrases = QStringList{
+        "Listening.",
+        "Okay.",
+        "Done.",
+        "Sorry, I didn't catch that.",
+        "I can't reach the server right now."
+    };
+    
+    // Start TTS backend and a standby beside it; neither waits for the process
+    m_worker = startWorker(0);
+    if (keepsStandby()) {
+        m_standby = startWorker(0);
+    }
+    prefetch();
 }
 
 TTSEngine::~TTSEngine()
 {
-    if (m_ttsProcess->state() == QProcess::Running) {
-        sendCommandToTTS("QUIT", QVariantMap());
-        m_ttsProcess->waitForFinished(2000);
-        m_ttsProcess->kill();
+    // Both are asked to quit first so their shutdowns overlap
+    m_worker->shutdown();
+    if (m_standby) {
+        m_standby->shutdown();
     }
 }
 
@@ -41,9 +105,11 @@ void TTSEngine::setVolume(float volume)
         m_volume = qBound(0.0f, volume, 1.0f);
         emit volumeChanged();
         
+        m_player->setVolume(m_volume);
+        
         QVariantMap params;
         params["volume"] = m_volume;
-        sendCommandToTTS("SET_VOLUME", params);
+        sendSettingToTTS("SET_VOLUME", params);
     }
 }
 
@@ -55,7 +121,7 @@ void TTSEngine::setRate(float rate)
         
         QVariantMap params;
         params["rate"] = m_rate;
-        sendCommandToTTS("SET_RATE", params);
+        sendSettingToTTS("SET_RATE", params);
     }
 }
 
@@ -67,7 +133,7 @@ void TTSEngine::setVoice(const QString &voice)
         
         QVariantMap params;
         params["voice"] = m_voice;
-        sendCommandToTTS("SET_VOICE", params);
+        sendSettingToTTS("SET_VOICE", params);
     }
 }
 
@@ -84,69 +150,116 @@ void TTSEngine::setEnabled(bool enabled)
     }
 }
 
-void TTSEngine::speak(const QString &text)
+void TTSEngine::setLocalPlayback(bool enabled)
 {
-    if (!m_enabled || text.trimmed().isEmpty())
-        return;
-    
-    if (m_isSpeaking) {
+    if (m_localPlayback != enabled) {
+        // Switched first, so whatever stop() starts next plays the new way
+        m_localPlayback = enabled;
         stop();
+        emit localPlaybackChanged();
+        prefetch();
     }
-    
-    m_currentText = text;
-    m_isSpeaking = true;
-    emit currentTextChanged();
-    emit isSpeakingChanged();
-    emit speechStarted(text);
-    
-    QVariantMap params;
-    params["text"] = text;
-    sendCommandToTTS("SPEAK", params);
 }
 
-void TTSEngine::speakAsync(const QString &text)
+void TTSEngine::setPrefetchPhrases(const QStringList &phrases)
 {
-    if (!m_enabled || text.trimmed().isEmpty())
-        return;
-    
-    m_speechQueue.enqueue(text);
-    
-    if (!m_isProcessing) {
-        processQueue();
+    if (m_prefetchPhrases != phrases) {
+        m_prefetchPhrases = phrases;
+        emit prefetchPhrasesChanged();
+        prefetch();
     }
 }
 
+void TTSEngine::setPlaybackBufferMs(int ms)
+{
+    if (m_player->bufferMs() != ms) {
+        m_player->setBufferMs(ms);
+        emit playbackBufferMsChanged();
+    }
+}
+
+int TTSEngine::playbackBufferMs() const
+{
+    return m_player->bufferMs();
+}
+
+int TTSEngine::stopLatencyMs() const
+{
+    return m_player->stopLatencyMs();
+}
+
+float TTSEngine::mediaGain() const
+{
+    return m_player->mediaGain();
+}
+
+void TTSEngine::speak(const QString &text)
+{
+    // A new reply replaces the one being said, but never a prompt or an alert
+    schedule(text, Conversational, -1, true);
+}
+
+void TTSEngine::speakAsync(const QString &text)
+{
+    schedule(text, Conversational, -1, false);
+}
+
+void TTSEngine::announce(const QString &text, int priority, int deadlineMs)
+{
+    schedule(text, Priority(qBound(int(Conversational), priority, int(SafetyAlert))), deadlineMs, false);
+}
+
 void TTSEngine::stop()
 {
     if (!m_isSpeaking)
         return;
     
-    sendCommandToTTS("STOP", QVariantMap());
+    silenceCurrent();
+    endUtterance();
     
-    m_isSpeaking = false;
-    m_currentText.clear();
-    emit isSpeakingChanged();
-    emit currentTextChanged();
-    emit speechFinished();
+    // Chatter is dropped with it; prompts and alerts already queued are still due
+    m_scheduler.clear(SpeechScheduler::Conversational);
+    processQueue();
 }
 
 void TTSEngine::pause()
 {
-    if (m_isSpeaking) {
+    if (m_isSpeaking && m_utteranceLocal) {
+        m_player->pause();
+    } else if (m_isSpeaking) {
         sendCommandToTTS("PAUSE", QVariantMap());
     }
 }
 
 void TTSEngine::resume()
 {
-    if (m_isSpeaking) {
+    if (m_isSpeaking && m_utteranceLocal) {
+        m_player->resume();
+    } else if (m_isSpeaking) {
         sendCommandToTTS("RESUME", QVariantMap());
     }
 }
 
 void TTSEngine::clearQueue()
 {
-    m_speechQueue.clear();
+    m_scheduler.clear();
+    emit queuedCountChanged();
+}
+
+QVariantMap TTSEngine::queueLatencyMs() const
+{
+    static const char *const names[SpeechScheduler::PRIORITY_COUNT] = {"conversational", "navigation", "safety"};
+    
+    QVariantMap latency;
+    for (int p = 0; p < SpeechScheduler::PRIORITY_COUNT; ++p) {
+        const SpeechScheduler::Priority priority = SpeechScheduler::Priority(p);
+        QVariantMap stats;
+        stats["average"] = m_scheduler.averageLatencyMs(priority);
+        stats["max"] = m_scheduler.maxLatencyMs(priority);
+        stats["count"] = m_scheduler.startedCount(priority);
+        latency[names[p]] = stats;
+    }
+    return latency;
 }
 
 QStringList TTSEngine::getAvailableVoices()
@@ -161,127 +274,645 @@ QStringList TTSEngine::getAvailableVoices()
     };
 }
 
-void TTSEngine::handleTTSOutput()
+void TTSEngine::handleTTSMessage(const QJsonObject &obj)
 {
-    QByteArray data = m_ttsProcess->readAllStandardOutput();
-    QString output = QString::fromUtf8(data).trimmed();
-    
-    if (output.isEmpty())
-        return;
-    
-    qDebug() << "TTS output:" << output;
+    QString type = obj["type"].toString();
     
-    // Parse JSON response
-    QJsonDocument doc = QJsonDocument::fromJson(output.toUtf8());
-    if (!doc.isObject())
+    // Chunk events name their utterance; anything from before a stop is stale
+    const bool chunked = obj.contains("utterance");
+    const int index = obj["index"].toInt();
+    if (chunked && (quint64(obj["utterance"].toDouble()) != m_utteranceId ||
+                    index < 0 || index >= m_chunks.size())) {
         return;
-    
-    QJsonObject obj = doc.object();
-    QString type = obj["type"].toString();
+    }
     
     if (type == "speech_started") {
         // TTS confirmed speech started
     }
+    else if (type == "chunk_started") {
+        chunkStarted(index);
+    }
+    else if (type == "chunk_finished") {
+        chunkFinished();
+    }
+    else if (type == "audio" || type == "synthesis_failed") {
+        handleSynthesisMessage(obj);
+    }
     else if (type == "speech_finished") {
-        m_isSpeaking = false;
-        m_currentText.clear();
-        emit isSpeakingChanged();
-        emit currentTextChanged();
-        emit speechFinished();
-        
-        // Process next in queue
-        if (!m_speechQueue.isEmpty()) {
-            processQueue();
-        }
+        finishUtterance();
     }
     else if (type == "word_boundary") {
         QString word = obj["word"].toString();
         int position = obj["position"].toInt();
+        if (chunked) {
+            position += m_chunks[index].offset;
+        }
         emit wordSpoken(word, position);
     }
     else if (type == "error") {
         QString errorMsg = obj["message"].toString();
         emit speechError(errorMsg);
         
-        m_isSpeaking = false;
-        emit isSpeakingChanged();
+        // Only an error naming the utterance ends it; a bad setting or command doesn't
+        if (chunked) {
+            finishUtterance();
+        }
     }
 }
 
-void TTSEngine::handleTTSError()
+void TTSEngine::handleTTSError(const QString &error)
 {
-    QString error = QString::fromUtf8(m_ttsProcess->readAllStandardError());
     qWarning() << "TTS error:" << error;
     emit speechError(error);
 }
 
-void TTSEngine::handleTTSFinished(int exitCode)
+// ============================================================================
+// Backend Workers
+// ============================================================================
+
+TTSBackend *TTSEngine::startWorker(int delayMs)
+{
+    TTSBackend *worker = nullptr;
+    if (m_backend == NativeBackend) {
+        worker = new NativeTTSBackend(this);
+    } else if (m_backend == RemoteBackend) {
+        worker = new RemoteTTSBackend(m_network, this);
+    } else {
+        worker = new TTSWorker(m_program, m_arguments, this);
+    }
+    
+    connect(worker, &TTSBackend::ready, this, [this, worker]() {
+        handleWorkerReady(worker);
+    });
+    connect(worker, &TTSBackend::exited, this, [this, worker](int exitCode, bool everReady) {
+        handleWorkerExited(worker, exitCode, everReady);
+    });
+    
+    // Only the active backend speaks for the engine
+    connect(worker, &TTSBackend::messageReceived, this, [this, worker](const QJsonObject &message) {
+        if (worker == m_worker) {
+            handleTTSMessage(message);
+        }
+    });
+    connect(worker, &TTSBackend::audioSynthesized, this, [this, worker](quint64 request, const TTSAudio &audio) {
+        if (worker == m_worker) {
+            handleSynthesizedAudio(request, audio);
+        }
+    });
+    connect(worker, &TTSBackend::audioStreamed, this, [this, worker](quint64 request, const TTSAudio &block, bool final) {
+        if (worker == m_worker) {
+            handleStreamedAudio(request, block, final);
+        }
+    });
+    connect(worker, &TTSBackend::errorOutput, this, [this, worker](const QString &text) {
+        if (worker == m_worker) {
+            handleTTSError(text);
+        } else {
+            qWarning() << "TTS standby error:" << text;
+        }
+    });
+    
+    // Commands sent before the backend has started wait for it
+    QTimer::singleShot(delayMs, worker, [worker]() {
+        worker->start();
+    });
+    sendSettings(worker);
+    return worker;
+}
+
+void TTSEngine::sendSettings(TTSBackend *worker)
+{
+    // A new backend starts from its defaults
+    QVariantMap volume, rate, voice;
+    volume["volume"] = m_volume;
+    rate["rate"] = m_rate;
+    voice["voice"] = m_voice;
+    worker->sendLatest("SET_VOLUME", volume);
+    worker->sendLatest("SET_RATE", rate);
+    worker->sendLatest("SET_VOICE", voice);
+}
+
+void TTSEngine::handleWorkerReady(TTSBackend *worker)
+{
+    m_respawnDelayMs = 0;
+    
+    if (worker == m_standby) {
+        emit standbyReadyChanged();
+    } else if (worker == m_worker && m_failingOver) {
+        // No standby was ready; this is the end of a cold start
+        m_failingOver = false;
+        m_lastFailoverMs = m_failoverClock.elapsed();
+        qWarning() << "🔊 TTS backend replaced by a cold start after" << m_lastFailoverMs << "ms";
+        emit failoverCompleted(m_lastFailoverMs);
+    }
+}
+
+void TTSEngine::handleWorkerExited(TTSBackend *worker, int exitCode, bool everReady)
 {
     qDebug() << "TTS process finished with exit code:" << exitCode;
     
-    if (exitCode != 0) {
-        emit speechError("TTS backend crashed");
+    // One that never got ready is likely to fail again; back off before the next
+    if (!everReady) {
+        m_respawnDelayMs = qBound(MIN_RESPAWN_DELAY_MS, m_respawnDelayMs * 2, MAX_RESPAWN_DELAY_MS);
     }
     
-    // Restart TTS backend
-    QTimer::singleShot(1000, this, &TTSEngine::startTTSProcess);
+    if (worker == m_standby) {
+        m_standby = nullptr;
+        worker->deleteLater();
+        emit standbyReadyChanged();
+    } else if (worker == m_worker) {
+        if (exitCode != 0) {
+            emit speechError("TTS backend crashed");
+        }
+        promoteStandby();
+        worker->deleteLater();
+    }
+    
+    if (keepsStandby() && !m_standby && !m_respawnTimer.isActive()) {
+        m_respawnTimer.start(m_respawnDelayMs);
+    }
+}
+
+void TTSEngine::promoteStandby()
+{
+    m_failoverClock.start();
+    
+    // Whatever the old backend was saying or synthesizing is lost
+    abandonUtterance();
+    m_synthesis.clear();
+    if (m_isSpeaking) {
+        endUtterance();
+    }
+    
+    if (m_standby) {
+        m_worker = m_standby;
+        m_standby = nullptr;
+        sendSettings(m_worker);
+        emit standbyReadyChanged();
+    } else {
+        // Standby still pending or failed; commands queue in a cold start
+        m_worker = startWorker(m_respawnDelayMs);
+    }
+    
+    m_failingOver = !m_worker->isReady();
+    if (!m_failingOver) {
+        m_lastFailoverMs = m_failoverClock.elapsed();
+        qDebug() << "🔊 TTS standby" << m_worker->description() << "promoted in" << m_lastFailoverMs << "ms";
+        emit failoverCompleted(m_lastFailoverMs);
+    }
+    
+    processQueue();
+    prefetch();
+}
+
+void TTSEngine::spawnStandby()
+{
+    if (!m_standby) {
+        m_standby = startWorker(0);
+    }
+}
+
+QString TTSEngine::cacheDirectory(Backend backend)
+{
+    // The same text, voice and rate sound different from each backend
+    const QString name = QString::fromLatin1(QMetaEnum::fromType<Backend>().valueToKey(backend)).toLower();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/tts/" + name;
+}
+
+bool TTSEngine::standbyReady() const
+{
+    return m_standby && m_standby->isReady();
+}
+
+bool TTSEngine::playsLocally() const
+{
+    return m_localPlayback || !m_worker->playsAudio();
+}
+
+// ============================================================================
+// Sentence Pipeline
+// ============================================================================
+
+void TTSEngine::startUtterance(const QString &text, int offset)
+{
+    abandonUtterance();
+    
+    // Resumed from offset, with chunk offsets still into the whole text
+    m_chunks = SpeechChunker::split(text.mid(offset));
+    for (SpeechChunker::Chunk &chunk : m_chunks) {
+        chunk.offset += offset;
+    }
+    m_utteranceLocal = playsLocally();
+    m_utteranceClock.start();
+    sendNextChunks();
+}
+
+void TTSEngine::sendNextChunks()
+{
+    // The backend holds the chunk playing and the next; the rest wait here, where stop() is free
+    while (m_chunksSent < m_chunks.size() && m_chunksSent - m_chunksDone < PIPELINE_DEPTH) {
+        if (m_utteranceLocal) {
+            requestChunkAudio(m_chunksSent++);
+            continue;
+        }
+        
+        QVariantMap params;
+        params["utterance"] = m_utteranceId;
+        params["index"] = m_chunksSent;
+        params["text"] = m_chunks[m_chunksSent].text;
+        params["last"] = m_chunksSent == m_chunks.size() - 1;
+        sendCommandToTTS("SPEAK_CHUNK", params);
+        ++m_chunksSent;
+    }
+}
+
+void TTSEngine::chunkStarted(int index)
+{
+    if (index == 0 && !m_firstAudioSeen) {
+        m_firstAudioSeen = true;
+        m_lastTimeToFirstAudioMs = m_utteranceClock.elapsed();
+        qDebug() << "🔊 First audio after" << m_lastTimeToFirstAudioMs << "ms of"
+                 << m_chunks.size() << "chunk(s)";
+        emit firstAudioStarted(m_lastTimeToFirstAudioMs);
+    }
+}
+
+void TTSEngine::chunkFinished()
+{
+    ++m_chunksDone;
+    if (m_chunksDone < m_chunks.size()) {
+        sendNextChunks();
+    } else {
+        finishUtterance();
+    }
+}
+
+void TTSEngine::finishUtterance()
+{
+    abandonUtterance();
+    endUtterance();
+    
+    // Process next in queue
+    processQueue();
+}
+
+void TTSEngine::endUtterance()
+{
+    // However it ended (finished, failed, stopped, superseded or preempted), it is heard the same way
+    m_isSpeaking = false;
+    m_currentText.clear();
+    emit isSpeakingChanged();
+    emit currentTextChanged();
+    emit speechFinished();
+}
+
+void TTSEngine::abandonUtterance()
+{
+    // Chunks still waiting at the backend are dropped there; prefetches carry on
+    QVariantList cancelled;
+    for (auto it = m_synthesis.begin(); it != m_synthesis.end();) {
+        if (it->index >= 0) {
+            cancelled << it.key();
+            it = m_synthesis.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!cancelled.isEmpty()) {
+        QVariantMap params;
+        params["requests"] = cancelled;
+        sendCommandToTTS("CANCEL", params);
+    }
+    m_player->stop();
+    m_chunkAudio.clear();
+    m_streamedMs.clear();
+    m_chunksQueued = 0;
+    m_playingChunk = -1;
+    m_chunkWords.clear();
+    
+    ++m_utteranceId;
+    m_chunks.clear();
+    m_chunksSent = 0;
+    m_chunksDone = 0;
+    m_firstAudioSeen = false;
+}
+
+// ============================================================================
+// Priority Scheduling
+// ============================================================================
+
+void TTSEngine::schedule(const QString &text, Priority priority, int deadlineMs, bool replace)
+{
+    if (!m_enabled || text.trimmed().isEmpty())
+        return;
+    
+    // Already being said at least as urgently
+    if (m_isSpeaking && m_current.priority >= SpeechScheduler::Priority(priority) &&
+        SpeechScheduler::sameText(m_current.text, text)) {
+        qDebug() << "🔁 Merged with the utterance playing:" << text.left(40);
+        return;
+    }
+    
+    const SpeechScheduler::Priority level = SpeechScheduler::Priority(priority);
+    const bool supersede = replace && m_isSpeaking && m_current.priority == level;
+    if (supersede) {
+        // Superseded rather than preempted: it isn't resumed
+        silenceCurrent();
+        endUtterance();
+    }
+    
+    m_scheduler.enqueue(text, level, deadlineMs < 0 ? SpeechScheduler::defaultDeadlineMs(level) : deadlineMs, supersede);
+    emit queuedCountChanged();
+    
+    if (!m_isSpeaking) {
+        processQueue();
+    } else if (m_scheduler.highestPending() > m_current.priority) {
+        preemptCurrent();
+    }
+}
+
+void TTSEngine::preemptCurrent()
+{
+    // Resumed from the sentence it was in, not from the start
+    SpeechScheduler::Utterance interrupted = m_current;
+    interrupted.resumeOffset = m_chunksDone < m_chunks.size() ? m_chunks[m_chunksDone].offset
+                                                              : interrupted.text.size();
+    silenceCurrent();
+    
+    if (!interrupted.text.mid(interrupted.resumeOffset).trimmed().isEmpty()) {
+        m_scheduler.requeue(interrupted);
+    }
+    qDebug() << "⏸️ Preempted" << interrupted.text.left(40) << "at" << interrupted.resumeOffset;
+    emit speechPreempted(interrupted.text);
+    
+    endUtterance();
+    processQueue();
+}
+
+void TTSEngine::silenceCurrent()
+{
+    // Played here, the backend has nothing to stop; queued synthesis is cancelled with the utterance
+    if (!m_utteranceLocal) {
+        sendCommandToTTS("STOP", QVariantMap());
+    }
+    abandonUtterance();
 }
 
 void TTSEngine::processQueue()
 {
-    if (m_speechQueue.isEmpty() || m_isProcessing)
+    if (m_isSpeaking || !m_enabled)
         return;
     
-    m_isProcessing = true;
-    QString text = m_speechQueue.dequeue();
+    QList<SpeechScheduler::Utterance> dropped;
+    SpeechScheduler::Utterance next;
+    const bool found = m_scheduler.takeNext(next, &dropped);
+    for (const SpeechScheduler::Utterance &stale : dropped) {
+        qWarning() << "⌛ Dropped stale utterance after" << m_scheduler.nowMs() - stale.enqueuedMs
+                   << "ms:" << stale.text.left(40);
+        emit speechDropped(stale.text);
+    }
+    emit queuedCountChanged();
+    if (!found) {
+        return;
+    }
     
-    m_currentText = text;
+    m_current = next;
+    m_currentText = next.text;
     m_isSpeaking = true;
     emit currentTextChanged();
     emit isSpeakingChanged();
-    emit speechStarted(text);
+    emit currentPriorityChanged();
+    emit queueLatencyChanged();
+    emit speechStarted(next.text);
+    
+    startUtterance(next.text, next.resumeOffset);
+}
+
+// ============================================================================
+// Synthesis Cache and Local Playback
+// ============================================================================
+
+void TTSEngine::requestChunkAudio(int index)
+{
+    const QString &text = m_chunks[index].text;
+    const QString key = TTSCache::key(text, m_voice, m_rate);
+    
+    TTSAudio audio = m_cache->lookup(key);
+    if (audio.isNull()) {
+        synthesize(key, text, index);
+        return;
+    }
+    m_chunkAudio.insert(index, audio);
+    playReadyChunks();
+}
+
+void TTSEngine::synthesize(const QString &key, const QString &text, int index)
+{
+    const quint64 request = ++m_nextRequestId;
+    m_synthesis.insert(request, {key, index, TTSAudio()});
     
     QVariantMap params;
+    params["request"] = request;
     params["text"] = text;
-    sendCommandToTTS("SPEAK", params);
+    sendCommandToTTS("SYNTHESIZE", params);
 }
 
-void TTSEngine::startTTSProcess()
+void TTSEngine::handleSynthesisMessage(const QJsonObject &message)
 {
-    // Start Python TTS backend
-    QString pythonScript = "/usr/share/voice-assistant/backend/tts_backend.py";
+    // Requests of an abandoned utterance were cancelled; their stragglers are ignored
+    const quint64 request = quint64(message["request"].toDouble());
+    auto it = m_synthesis.find(request);
+    if (it == m_synthesis.end()) {
+        return;
+    }
     
-    QStringList arguments;
-    arguments << pythonScript;
+    if (message["type"].toString() == "synthesis_failed") {
+        const Synthesis failed = m_synthesis.take(request);
+        qWarning() << "TTS synthesis failed:" << message["message"].toString();
+        if (failed.index >= 0) {
+            emit speechError(message["message"].toString());
+            finishUtterance();
+        }
+        return;
+    }
     
-    m_ttsProcess->start("python3", arguments);
+    // PCM arrives base64-encoded, split over several messages
+    it->audio.sampleRate = message["sampleRate"].toInt();
+    it->audio.channels = message["channels"].toInt();
+    it->audio.pcm += QByteArray::fromBase64(message["data"].toString().toLatin1());
+    if (message["final"].toBool()) {
+        handleSynthesizedAudio(request, it->audio);
+    }
+}
+
+void TTSEngine::handleSynthesizedAudio(quint64 request, const TTSAudio &audio)
+{
+    if (!m_synthesis.contains(request)) {
+        return;
+    }
     
-    if (!m_ttsProcess->waitForStarted(3000)) {
-        qWarning() << "Failed to start TTS backend";
-        emit speechError("Failed to start TTS backend");
-    } else {
-        qDebug() << "TTS backend started successfully";
+    const Synthesis done = m_synthesis.take(request);
+    m_cache->insert(done.key, audio);
+    if (done.index >= 0) {
+        m_chunkAudio.insert(done.index, audio);
+        playReadyChunks();
     }
 }
 
-void TTSEngine::sendCommandToTTS(const QString &command, const QVariantMap &params)
+void TTSEngine::handleStreamedAudio(quint64 request, const TTSAudio &block, bool final)
+{
+    auto it = m_synthesis.find(request);
+    if (it == m_synthesis.end()) {
+        return;
+    }
+    
+    it->streamed = true;
+    it->audio.sampleRate = block.sampleRate;
+    it->audio.channels = block.channels;
+    it->audio.pcm += block.pcm;
+    const int index = it->index;
+    if (it->playing) {
+        m_player->append(index, block);
+    }
+    
+    if (final) {
+        const Synthesis done = m_synthesis.take(request);
+        m_cache->insert(done.key, done.audio);
+        if (done.playing) {
+            m_player->close(index);
+            // Known now rather than estimated
+            m_streamedMs.insert(index, done.audio.durationMs());
+            if (index == m_playingChunk) {
+                m_chunkDurationMs = done.audio.durationMs();
+            }
+        } else if (index >= 0) {
+            m_chunkAudio.insert(index, done.audio);
+        }
+    }
+    if (index >= 0) {
+        playReadyChunks();
+    }
+}
+
+void TTSEngine::playReadyChunks()
+{
+    // Chunks can be ready out of order (a cache hit behind a miss); they play in order
+    forever {
+        if (m_chunkAudio.contains(m_chunksQueued)) {
+            m_player->enqueue(m_chunksQueued, m_chunkAudio.take(m_chunksQueued));
+            ++m_chunksQueued;
+            continue;
+        }
+        
+        // Still streaming in: it starts with what has arrived and grows as it plays
+        auto streaming = std::find_if(m_synthesis.begin(), m_synthesis.end(), [this](const Synthesis &synthesis) {
+            return synthesis.index == m_chunksQueued && synthesis.streamed && !synthesis.audio.pcm.isEmpty();
+        });
+        if (streaming == m_synthesis.end()) {
+            return;
+        }
+        m_player->enqueue(m_chunksQueued, streaming->audio, true);
+        streaming->playing = true;
+        ++m_chunksQueued;
+    }
+}
+
+void TTSEngine::handleSegmentStarted(int index, qint64 durationMs)
 {
-    if (m_ttsProcess->state() != QProcess::Running) {
-        qWarning() << "TTS process not running, cannot send command:" << command;
+    if (index < 0 || index >= m_chunks.size()) {
         return;
     }
     
-    QJsonObject obj;
-    obj["command"] = command;
+    m_playingChunk = index;
+    if (durationMs < 0) {
+        durationMs = m_streamedMs.value(index, estimatedDurationMs(m_chunks[index].text));
+    }
+    m_chunkDurationMs = durationMs;
+    m_wordsSpoken = 0;
+    m_chunkWords.clear();
+    QRegularExpressionMatchIterator words = QRegularExpression("\\S+").globalMatch(m_chunks[index].text);
+    while (words.hasNext()) {
+        const QRegularExpressionMatch word = words.next();
+        m_chunkWords.append({word.captured(), int(word.capturedStart())});
+    }
     
-    for (auto it = params.begin(); it != params.end(); ++it) {
-        obj[it.key()] = QJsonValue::fromVariant(it.value());
+    chunkStarted(index);
+    emitWordsUntil(0);
+}
+
+qint64 TTSEngine::estimatedDurationMs(const QString &text) const
+{
+    return qint64(text.size() * ESTIMATED_MS_PER_CHAR / qMax(0.1f, m_rate));
+}
+
+void TTSEngine::handleSegmentProgress(int index, qint64 positionMs)
+{
+    if (index == m_playingChunk) {
+        emitWordsUntil(positionMs);
+    }
+}
+
+void TTSEngine::handleSegmentFinished(int index)
+{
+    if (index < 0 || index >= m_chunks.size()) {
+        return;
+    }
+    if (index == m_playingChunk) {
+        emitWordsUntil(m_chunkDurationMs);
+    }
+    chunkFinished();
+}
+
+void TTSEngine::emitWordsUntil(qint64 positionMs)
+{
+    // A word is taken to start where its first character falls in the chunk's audio
+    const SpeechChunker::Chunk &chunk = m_chunks[m_playingChunk];
+    while (m_wordsSpoken < m_chunkWords.size()) {
+        const QPair<QString, int> &word = m_chunkWords[m_wordsSpoken];
+        if (m_chunkDurationMs * word.second / chunk.text.size() > positionMs) {
+            break;
+        }
+        ++m_wordsSpoken;
+        emit wordSpoken(word.first, chunk.offset + word.second);
+    }
+}
+
+void TTSEngine::prefetch()
+{
+    if (!playsLocally()) {
+        return;
     }
     
-    QJsonDocument doc(obj);
-    QString jsonStr = doc.toJson(QJsonDocument::Compact);
+    QStringList pending;
+    for (const Synthesis &synthesis : std::as_const(m_synthesis)) {
+        pending << synthesis.key;
+    }
     
-    m_ttsProcess->write(jsonStr.toUtf8() + "\n");
-    m_ttsProcess->waitForBytesWritten();
+    // Split the way speak() would, so the keys are the ones it will look up
+    int requested = 0;
+    for (const QString &phrase : std::as_const(m_prefetchPhrases)) {
+        for (const SpeechChunker::Chunk &chunk : SpeechChunker::split(phrase)) {
+            const QString key = TTSCache::key(chunk.text, m_voice, m_rate);
+            if (!m_cache->contains(key) && !pending.contains(key)) {
+                synthesize(key, chunk.text, -1);
+                pending << key;
+                ++requested;
+            }
+        }
+    }
+    if (requested > 0) {
+        qDebug() << "💾 Prefetching" << requested << "phrase chunk(s) into the TTS cache";
+    }
+}
+
+void TTSEngine::sendCommandToTTS(const QString &command, const QVariantMap &params)
+{
+    // Queued by the active backend, even while it is still starting
+    m_worker->send(command, params);
 }
 
+void TTSEngine::sendSettingToTTS(const QString &command, const QVariantMap &params)
+{
+    // Only the latest value matters; a standby is sent all settings when it is promoted
+    m_worker->sendLatest(command, params);
+}
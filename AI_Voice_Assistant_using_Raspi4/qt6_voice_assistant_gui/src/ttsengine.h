@@ -2,15 +2,78 @@
 #define TTSENGINE_H
 
 #include <QObject>
-#include <QProcess>
 #include <QString>
-#include <QQueue>
+#include <QVariantMap>
+#include <QStringList>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHash>
+#include "speechchunker.h"
+#include "speechscheduler.h"
+#include "ttscache.h"
+
+class NetworkManager;
+class TTSBackend;
+class TTSPlayer;
 
 /**
  * @brief Text-to-Speech Engine for voice responses
  * 
  * Integrates with pyttsx3, gTTS, or Festival for voice synthesis
  * Provides queue management for multiple speech requests
+ *
+ * The backend runs as a child process and talks newline-delimited JSON
+ * through a TTSChannel. Only shutdown waits on the process: commands are
+ * queued, and volume, rate and voice changes are coalesced so that dragging
+ * a slider sends only the latest value.
+ *
+ * A second backend is kept started and initialised as a standby. When the
+ * active one exits, the standby takes over at once and a new standby is
+ * spawned in the background, so a crash costs an utterance rather than the
+ * seconds a cold Python start and engine init take. The gap between the
+ * exit and a ready backend is reported through failoverCompleted(). Only the
+ * process backend has a standby: the native one is ready at once, and a
+ * second remote one would only wait on the same session.
+ *
+ * Responses are split into sentences (SpeechChunker) and sent as a pipeline
+ * of SPEAK_CHUNK commands, PIPELINE_DEPTH at a time, so the backend starts
+ * on the first sentence at once and has the next one ready while the current
+ * one plays. Word positions are reported relative to the whole response.
+ * The time from speak() to the first chunk's audio is reported through
+ * firstAudioStarted().
+ *
+ * With localPlayback on (the default when there is an audio output), the
+ * backend only synthesizes: each chunk comes back as PCM, is stored in a
+ * TTSCache keyed by text, voice and rate (one cache directory per kind of
+ * backend, since each sounds different), and is played here by TTSPlayer.
+ * A chunk that is already cached plays without going to the backend at all,
+ * and the prefetchPhrases are synthesized into the cache at startup so
+ * common prompts are instant from the first time they are said. Word
+ * positions are then estimated from the playback position, in proportion to
+ * the characters before each word.
+ *
+ * Played here, stop() and barge-in are bounded by the output buffer
+ * (playbackBufferMs) and a short fade rather than by the backend, pause()
+ * works, and mediaGain tells other media how far to duck while the
+ * assistant speaks. The player's referenceAudio() is the echo reference.
+ *
+ * Synthesis goes through a TTSBackend chosen at construction: by default
+ * tts_backend.py in a child process (TTSWorker), or NativeBackend, a
+ * formant synthesizer in this process that needs no interpreter and is
+ * ready at once. The native backend only synthesizes, so everything it says
+ * is played here whatever localPlayback is set to. So does RemoteBackend,
+ * synthesis on the server at the other end of NetworkManager's multiplexed
+ * session; its speech streams in, and a chunk starts playing with its first
+ * block and grows while it plays (RemoteTTSBackend, TTSPlayer).
+ *
+ * Speech is scheduled by priority class (SpeechScheduler): a safety alert
+ * preempts a navigation prompt, which preempts conversation, and what was
+ * preempted resumes from the sentence it was in once the higher class is
+ * done. speak() replaces a reply being said but queues behind a prompt or
+ * an alert; announce() queues at any class. Utterances that wait past their
+ * deadline are dropped, the same text queued twice is said once, and queue
+ * latency is reported per class.
  */
 class TTSEngine : public QObject
 {
@@ -21,9 +84,43 @@ class TTSEngine : public QObject
     Q_PROPERTY(float rate READ rate WRITE setRate NOTIFY rateChanged)
     Q_PROPERTY(QString voice READ voice WRITE setVoice NOTIFY voiceChanged)
     Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool standbyReady READ standbyReady NOTIFY standbyReadyChanged)
+    Q_PROPERTY(qint64 lastFailoverMs READ lastFailoverMs NOTIFY failoverCompleted)
+    Q_PROPERTY(qint64 lastTimeToFirstAudioMs READ lastTimeToFirstAudioMs NOTIFY firstAudioStarted)
+    Q_PROPERTY(bool localPlayback READ localPlayback WRITE setLocalPlayback NOTIFY localPlaybackChanged)
+    Q_PROPERTY(QStringList prefetchPhrases READ prefetchPhrases WRITE setPrefetchPhrases NOTIFY prefetchPhrasesChanged)
+    Q_PROPERTY(double cacheHitRate READ cacheHitRate NOTIFY cacheStatsChanged)
+    Q_PROPERTY(qint64 cacheMemoryBytes READ cacheMemoryBytes NOTIFY cacheStatsChanged)
+    Q_PROPERTY(qint64 cacheDiskBytes READ cacheDiskBytes NOTIFY cacheStatsChanged)
+    Q_PROPERTY(int playbackBufferMs READ playbackBufferMs WRITE setPlaybackBufferMs NOTIFY playbackBufferMsChanged)
+    Q_PROPERTY(int stopLatencyMs READ stopLatencyMs NOTIFY playbackBufferMsChanged)
+    Q_PROPERTY(float mediaGain READ mediaGain NOTIFY mediaGainChanged)
+    Q_PROPERTY(int currentPriority READ currentPriority NOTIFY currentPriorityChanged)
+    Q_PROPERTY(int queuedCount READ queuedCount NOTIFY queuedCountChanged)
+    Q_PROPERTY(QVariantMap queueLatencyMs READ queueLatencyMs NOTIFY queueLatencyChanged)
+    Q_PROPERTY(Backend backend READ backend CONSTANT)
     
 public:
+    enum Priority {
+        Conversational = SpeechScheduler::Conversational,
+        Navigation = SpeechScheduler::Navigation,
+        SafetyAlert = SpeechScheduler::SafetyAlert
+    };
+    Q_ENUM(Priority)
+    
+    enum Backend {
+        ProcessBackend, // tts_backend.py, or the command line given
+        NativeBackend,  // FormantSynth, in process
+        RemoteBackend   // on the server, streamed over the network's session
+    };
+    Q_ENUM(Backend)
+    
     explicit TTSEngine(QObject *parent = nullptr);
+    explicit TTSEngine(Backend backend, QObject *parent = nullptr);
+    // Backend command line, e.g. a stand-in for tests
+    TTSEngine(const QString &program, const QStringList &arguments, QObject *parent = nullptr);
+    // RemoteBackend, over this network's /stream session
+    explicit TTSEngine(NetworkManager *network, QObject *parent = nullptr);
     ~TTSEngine();
     
     // Getters
@@ -33,16 +130,39 @@ public:
     float rate() const { return m_rate; }
     QString voice() const { return m_voice; }
     bool enabled() const { return m_enabled; }
+    bool standbyReady() const;
+    bool backendReady() const { return m_worker->isReady(); } // the active one
+    qint64 lastFailoverMs() const { return m_lastFailoverMs; } // -1 before the first
+    qint64 lastTimeToFirstAudioMs() const { return m_lastTimeToFirstAudioMs; } // -1 before the first
+    bool localPlayback() const { return m_localPlayback; }
+    QStringList prefetchPhrases() const { return m_prefetchPhrases; }
+    double cacheHitRate() const { return m_cache->hitRate(); }
+    qint64 cacheMemoryBytes() const { return m_cache->memoryBytes(); }
+    qint64 cacheDiskBytes() const { return m_cache->diskBytes(); }
+    TTSCache *cache() const { return m_cache; }
+    int playbackBufferMs() const;
+    int stopLatencyMs() const;
+    float mediaGain() const;
+    TTSPlayer *player() const { return m_player; }
+    int currentPriority() const { return m_current.priority; }
+    int queuedCount() const { return m_scheduler.pendingCount(); }
+    QVariantMap queueLatencyMs() const; // average, max and count per class
+    const SpeechScheduler &scheduler() const { return m_scheduler; }
+    Backend backend() const { return m_backend; }
     
     // Setters
     void setVolume(float volume);
     void setRate(float rate);
     void setVoice(const QString &voice);
     void setEnabled(bool enabled);
+    void setLocalPlayback(bool enabled);
+    void setPrefetchPhrases(const QStringList &phrases);
+    void setPlaybackBufferMs(int ms);
     
 public slots:
     void speak(const QString &text);
     void speakAsync(const QString &text); // Non-blocking
+    void announce(const QString &text, int priority, int deadlineMs = -1); // -1: the class default
     void stop();
     void pause();
     void resume();
@@ -60,16 +180,62 @@ signals:
     void speechFinished();
     void speechError(const QString &error);
     void wordSpoken(const QString &word, int position);
+    void standbyReadyChanged();
+    void failoverCompleted(qint64 gapMs);
+    void firstAudioStarted(qint64 latencyMs);
+    void localPlaybackChanged();
+    void prefetchPhrasesChanged();
+    void cacheStatsChanged();
+    void playbackBufferMsChanged();
+    void mediaGainChanged();
+    void currentPriorityChanged();
+    void queuedCountChanged();
+    void queueLatencyChanged();
+    void speechPreempted(const QString &text);
+    void speechDropped(const QString &text);
     
 private slots:
-    void handleTTSOutput();
-    void handleTTSError();
-    void handleTTSFinished(int exitCode);
+    void handleTTSMessage(const QJsonObject &message);
+    void handleTTSError(const QString &error);
+    void spawnStandby();
     void processQueue();
+    void handleSegmentStarted(int index, qint64 durationMs);
+    void handleSegmentProgress(int index, qint64 positionMs);
+    void handleSegmentFinished(int index);
     
 private:
-    void startTTSProcess();
+    TTSEngine(Backend backend, const QString &program, const QStringList &arguments, NetworkManager *network,
+              QObject *parent);
+    
+    TTSBackend *startWorker(int delayMs);
+    void handleWorkerReady(TTSBackend *worker);
+    void handleWorkerExited(TTSBackend *worker, int exitCode, bool everReady);
+    void promoteStandby();
+    bool keepsStandby() const { return m_backend == ProcessBackend; }
+    static QString cacheDirectory(Backend backend);
+    void sendSettings(TTSBackend *worker);
+    bool playsLocally() const;
+    void schedule(const QString &text, Priority priority, int deadlineMs, bool replace);
+    void preemptCurrent();
+    void silenceCurrent();
+    void startUtterance(const QString &text, int offset);
+    void sendNextChunks();
+    void chunkStarted(int index);
+    void chunkFinished();
+    void requestChunkAudio(int index);
+    void playReadyChunks();
+    void emitWordsUntil(qint64 positionMs);
+    void synthesize(const QString &key, const QString &text, int index);
+    void handleSynthesisMessage(const QJsonObject &message);
+    void handleSynthesizedAudio(quint64 request, const TTSAudio &audio);
+    void handleStreamedAudio(quint64 request, const TTSAudio &block, bool final);
+    qint64 estimatedDurationMs(const QString &text) const;
+    void prefetch();
+    void finishUtterance();
+    void endUtterance();
+    void abandonUtterance();
     void sendCommandToTTS(const QString &command, const QVariantMap &params);
+    void sendSettingToTTS(const QString &command, const QVariantMap &params);
     
     bool m_isSpeaking;
     QString m_currentText;
@@ -78,9 +244,61 @@ private:
     QString m_voice;
     bool m_enabled;
     
-    QProcess *m_ttsProcess;
-    QQueue<QString> m_speechQueue;
-    bool m_isProcessing;
+    Backend m_backend;
+    QString m_program;
+    QStringList m_arguments;
+    NetworkManager *m_network; // RemoteBackend only
+    TTSBackend *m_worker;  // active, never null
+    TTSBackend *m_standby; // ProcessBackend only; null while a replacement is pending
+    QTimer m_respawnTimer;
+    int m_respawnDelayMs;
+    
+    QElapsedTimer m_failoverClock;
+    bool m_failingOver;
+    qint64 m_lastFailoverMs;
+    
+    SpeechScheduler m_scheduler;
+    SpeechScheduler::Utterance m_current; // valid while m_isSpeaking
+    
+    // Utterance being spoken, as chunks; events for other ids are stale
+    QList<SpeechChunker::Chunk> m_chunks;
+    int m_chunksSent;
+    int m_chunksDone;
+    quint64 m_utteranceId;
+    QElapsedTimer m_utteranceClock;
+    bool m_firstAudioSeen;
+    qint64 m_lastTimeToFirstAudioMs;
+    
+    // Local playback: chunks are synthesized to PCM, cached and played here
+    TTSCache *m_cache;
+    TTSPlayer *m_player;
+    bool m_localPlayback;
+    bool m_utteranceLocal; // how the current utterance is being spoken
+    QStringList m_prefetchPhrases;
+    QHash<int, TTSAudio> m_chunkAudio; // ready but not yet handed to the player
+    int m_chunksQueued;                // chunks handed to the player, in order
+    QHash<int, qint64> m_streamedMs;   // length of streamed chunks, once the last block is in
+    
+    // Words of the chunk playing, with their positions in it, for estimated boundaries
+    QList<QPair<QString, int>> m_chunkWords;
+    int m_playingChunk;
+    int m_wordsSpoken;
+    qint64 m_chunkDurationMs;
+    
+    struct Synthesis {
+        QString key;
+        int index;         // chunk of the current utterance, -1 for a prefetch
+        TTSAudio audio;    // filled as audio messages or streamed blocks arrive
+        bool streamed = false;  // comes in blocks (audioStreamed) that can play as they arrive
+        bool playing = false;   // handed to the player open; later blocks are appended
+    };
+    QHash<quint64, Synthesis> m_synthesis; // by request id
+    quint64 m_nextRequestId;
+    
+    static constexpr int MIN_RESPAWN_DELAY_MS = 1000;  // after a backend that never got ready
+    static constexpr int MAX_RESPAWN_DELAY_MS = 30000;
+    static constexpr int PIPELINE_DEPTH = 2; // chunks at the backend: the one playing and the next
+    static constexpr int ESTIMATED_MS_PER_CHAR = 65; // at rate 1, for speech still streaming in
 };
 
 #endif // TTSENGINE_H
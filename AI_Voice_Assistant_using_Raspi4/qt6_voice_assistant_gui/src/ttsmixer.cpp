@@ -0,0 +1,195 @@
+#include "ttsmixer.h"
+#include <cstring>
+
+static inline qint16 saturate(float sample)
+{
+    return qint16(qRound(qBound(-32768.0f, sample, 32767.0f)));
+}
+
+TTSMixer::TTSMixer(int sampleRate, int channels)
+    : m_sampleRate(sampleRate)
+    , m_channels(channels)
+    , m_gain(1.0f)
+    , m_renderedFrames(0)
+    , m_fadePosition(0)
+    , m_fadeRemaining(0)
+    , m_fadeLength(0)
+    , m_mediaGain(1.0f)
+    , m_duckHoldMs(0)
+{
+}
+
+void TTSMixer::reset(int sampleRate, int channels)
+{
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    m_renderedFrames = 0;
+    m_voices.clear();
+    m_events.clear();
+    m_fadePcm.clear();
+    m_fadeRemaining = 0;
+}
+
+void TTSMixer::enqueue(int tag, const TTSAudio &audio, bool open)
+{
+    const TTSAudio converted = convert(audio, m_sampleRate, m_channels);
+    m_voices.append({tag, converted.pcm, 0, open});
+}
+
+void TTSMixer::append(int tag, const TTSAudio &audio)
+{
+    // Gone if it was stopped in the meantime
+    Voice *voice = findVoice(tag);
+    if (voice && voice->open) {
+        voice->pcm += convert(audio, m_sampleRate, m_channels).pcm;
+    }
+}
+
+void TTSMixer::close(int tag)
+{
+    if (Voice *voice = findVoice(tag)) {
+        voice->open = false;
+    }
+}
+
+TTSMixer::Voice *TTSMixer::findVoice(int tag)
+{
+    for (Voice &voice : m_voices) {
+        if (voice.tag == tag) {
+            return &voice;
+        }
+    }
+    return nullptr;
+}
+
+void TTSMixer::stop()
+{
+    // Only what has been heard needs a fade; a segment not yet started just goes
+    if (!m_voices.isEmpty() && m_voices.first().position > 0) {
+        const Voice &playing = m_voices.first();
+        m_fadePcm = playing.pcm;
+        m_fadePosition = playing.position;
+        m_fadeLength = qMin<qint64>(qint64(m_sampleRate) * FADE_MS / 1000, framesOf(m_fadePcm) - m_fadePosition);
+        m_fadeRemaining = m_fadeLength;
+    }
+    m_voices.clear();
+    m_events.clear();
+}
+
+qint64 TTSMixer::render(qint16 *out, qint64 frames)
+{
+    memset(out, 0, frames * m_channels * sizeof(qint16));
+    
+    // Segments back to back from the start of the block
+    qint64 voiceFrames = 0;
+    while (voiceFrames < frames && !m_voices.isEmpty()) {
+        Voice &voice = m_voices.first();
+        const qint64 length = framesOf(voice.pcm);
+        // Streaming in: what follows waits for the rest of it
+        if (voice.open && voice.position == length) {
+            break;
+        }
+        if (voice.position == 0) {
+            m_events.append({voice.tag, false, m_renderedFrames + voiceFrames, voice.open ? -1 : length});
+        }
+        
+        const qint64 count = qMin(frames - voiceFrames, length - voice.position);
+        const qint16 *source = reinterpret_cast<const qint16 *>(voice.pcm.constData()) + voice.position * m_channels;
+        qint16 *target = out + voiceFrames * m_channels;
+        for (qint64 i = 0; i < count * m_channels; ++i) {
+            target[i] = saturate(source[i] * m_gain);
+        }
+        voice.position += count;
+        voiceFrames += count;
+        
+        if (voice.position == length) {
+            m_events.append({voice.tag, true, m_renderedFrames + voiceFrames, length});
+            m_voices.removeFirst();
+        }
+    }
+    
+    // A stopped segment fading out underneath
+    const qint64 fadeFrames = qMin(frames, m_fadeRemaining);
+    const qint16 *fade = reinterpret_cast<const qint16 *>(m_fadePcm.constData()) + m_fadePosition * m_channels;
+    for (qint64 frame = 0; frame < fadeFrames; ++frame) {
+        const float gain = m_gain * float(m_fadeRemaining - frame) / m_fadeLength;
+        for (int channel = 0; channel < m_channels; ++channel) {
+            const qint64 i = frame * m_channels + channel;
+            out[i] = saturate(out[i] + fade[i] * gain);
+        }
+    }
+    m_fadePosition += fadeFrames;
+    m_fadeRemaining -= fadeFrames;
+    if (m_fadeRemaining == 0) {
+        m_fadePcm.clear();
+    }
+    
+    const qint64 rendered = qMax(voiceFrames, fadeFrames);
+    m_renderedFrames += rendered;
+    return rendered;
+}
+
+QList<TTSMixer::Event> TTSMixer::takeEvents()
+{
+    QList<Event> events;
+    events.swap(m_events);
+    return events;
+}
+
+void TTSMixer::updateDucking(qint64 elapsedMs)
+{
+    // Down while speech is queued or playing, and for a moment after
+    if (isSpeaking()) {
+        m_duckHoldMs = DUCK_HOLD_MS;
+    } else {
+        m_duckHoldMs = qMax<qint64>(0, m_duckHoldMs - elapsedMs);
+    }
+    
+    const float range = 1.0f - DUCK_GAIN;
+    if (m_duckHoldMs > 0) {
+        m_mediaGain = qMax(DUCK_GAIN, m_mediaGain - range * elapsedMs / DUCK_ATTACK_MS);
+    } else {
+        m_mediaGain = qMin(1.0f, m_mediaGain + range * elapsedMs / DUCK_RELEASE_MS);
+    }
+}
+
+TTSAudio TTSMixer::convert(const TTSAudio &audio, int sampleRate, int channels)
+{
+    if (audio.isNull() || (audio.sampleRate == sampleRate && audio.channels == channels)) {
+        return audio;
+    }
+    
+    // Linear interpolation is enough for speech; mono is spread, more channels are averaged
+    const qint16 *source = reinterpret_cast<const qint16 *>(audio.pcm.constData());
+    const qint64 sourceFrames = audio.pcm.size() / (2 * audio.channels);
+    const qint64 frames = sourceFrames * sampleRate / audio.sampleRate;
+    
+    TTSAudio converted;
+    converted.sampleRate = sampleRate;
+    converted.channels = channels;
+    converted.pcm.resize(frames * channels * 2);
+    qint16 *target = reinterpret_cast<qint16 *>(converted.pcm.data());
+    
+    auto sampleAt = [&](qint64 frame, int channel) -> float {
+        frame = qMin(frame, sourceFrames - 1);
+        if (channels == 1 && audio.channels > 1) {
+            float sum = 0;
+            for (int c = 0; c < audio.channels; ++c) {
+                sum += source[frame * audio.channels + c];
+            }
+            return sum / audio.channels;
+        }
+        return source[frame * audio.channels + qMin(channel, audio.channels - 1)];
+    };
+    
+    for (qint64 frame = 0; frame < frames; ++frame) {
+        const double position = double(frame) * audio.sampleRate / sampleRate;
+        const qint64 before = qint64(position);
+        const float weight = float(position - before);
+        for (int channel = 0; channel < channels; ++channel) {
+            const float sample = sampleAt(before, channel) * (1.0f - weight) + sampleAt(before + 1, channel) * weight;
+            target[frame * channels + channel] = saturate(sample);
+        }
+    }
+    return converted;
+}
@@ -0,0 +1,101 @@
+#ifndef TTSMIXER_H
+#define TTSMIXER_H
+
+#include <QByteArray>
+#include <QList>
+#include "ttscache.h"
+
+/**
+ * @brief Mixes synthesized speech into one 16-bit output stream
+ *
+ * Segments play back to back in the order they are queued, converted to the
+ * output rate and channel count when they are queued. Everything is counted
+ * in output frames: render() records the frame at which each segment starts
+ * and ends, and TTSPlayer compares those with the frames the sink has
+ * consumed, which is what makes word timing and stop latency exact to the
+ * sample rather than to a timer tick.
+ *
+ * A segment can be queued open and grow with append() while it plays, for
+ * speech that streams in; render() waits at the end of what has arrived
+ * rather than moving on, and the segment only finishes once it is closed.
+ * Its start event then has no length (frames is -1).
+ *
+ * stop() doesn't cut the segment playing: its next FADE_MS are faded out and
+ * mixed with whatever is queued after the stop, so a barge-in or a new
+ * response crossfades instead of clicking. The mixer also computes the gain
+ * other media should be ducked to while speech plays (mediaGain()), with a
+ * short attack, a hold across the gaps between sentences and a slower
+ * release.
+ */
+class TTSMixer
+{
+public:
+    struct Event {
+        int tag;
+        bool finished; // false: the segment's first frame, true: one past its last
+        qint64 frame;  // in the output stream
+        qint64 frames; // length of the segment, -1 at the start of one still open
+    };
+    
+    explicit TTSMixer(int sampleRate = 48000, int channels = 2);
+    
+    // Drops everything and starts a new stream in this format
+    void reset(int sampleRate, int channels);
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+    
+    void enqueue(int tag, const TTSAudio &audio, bool open = false);
+    void append(int tag, const TTSAudio &audio); // to an open segment
+    void close(int tag);
+    void stop(); // fades out the segment playing and drops the rest, without events
+    void setGain(float gain) { m_gain = gain; }
+    
+    bool isSpeaking() const { return !m_voices.isEmpty(); }
+    bool isActive() const { return isSpeaking() || m_fadeRemaining > 0; }
+    
+    // Mixes up to frames into out; fewer when there is nothing more to play
+    qint64 render(qint16 *out, qint64 frames);
+    qint64 renderedFrames() const { return m_renderedFrames; }
+    QList<Event> takeEvents();
+    
+    void updateDucking(qint64 elapsedMs);
+    float mediaGain() const { return m_mediaGain; }
+    
+    static TTSAudio convert(const TTSAudio &audio, int sampleRate, int channels);
+    
+    static constexpr int FADE_MS = 15;
+    static constexpr float DUCK_GAIN = 0.25f;
+    static constexpr int DUCK_ATTACK_MS = 80;
+    static constexpr int DUCK_HOLD_MS = 300;  // media stays down between sentences
+    static constexpr int DUCK_RELEASE_MS = 500;
+    
+private:
+    struct Voice {
+        int tag;
+        QByteArray pcm; // in the output format
+        qint64 position; // frames played
+        bool open;       // more may be appended
+    };
+    
+    qint64 framesOf(const QByteArray &pcm) const { return pcm.size() / (2 * m_channels); }
+    Voice *findVoice(int tag);
+    
+    int m_sampleRate;
+    int m_channels;
+    float m_gain;
+    qint64 m_renderedFrames;
+    
+    QList<Voice> m_voices; // playing first
+    QList<Event> m_events;
+    
+    // Rest of a stopped segment, faded to silence over m_fadeLength frames
+    QByteArray m_fadePcm;
+    qint64 m_fadePosition;
+    qint64 m_fadeRemaining;
+    qint64 m_fadeLength;
+    
+    float m_mediaGain;
+    qint64 m_duckHoldMs;
+};
+
+#endif // TTSMIXER_H
@@ -0,0 +1,222 @@
+#include "ttsplayer.h"
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QDebug>
+#include <QMediaDevices>
+
+TTSPlayer::TTSPlayer(QObject *parent)
+    : QObject(parent)
+    , m_sink(nullptr)
+    , m_output(nullptr)
+    , m_bufferMs(DEFAULT_BUFFER_MS)
+    , m_paused(false)
+    , m_playingTag(-1)
+    , m_playingStartFrame(0)
+    , m_generation(0)
+{
+    m_feedTimer.setTimerType(Qt::PreciseTimer);
+    m_feedTimer.setInterval(qMax(1, m_bufferMs / 4));
+    connect(&m_feedTimer, &QTimer::timeout, this, &TTSPlayer::feed);
+    
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(IDLE_CLOSE_MS);
+    connect(&m_idleTimer, &QTimer::timeout, this, &TTSPlayer::closeIdleSink);
+}
+
+TTSPlayer::~TTSPlayer()
+{
+    closeSink();
+}
+
+bool TTSPlayer::outputAvailable()
+{
+    return !QMediaDevices::defaultAudioOutput().isNull();
+}
+
+void TTSPlayer::enqueue(int tag, const TTSAudio &audio, bool open)
+{
+    if (!m_sink && !openSink()) {
+        // Nothing can play; let the engine move on rather than wait forever
+        const quint64 generation = m_generation;
+        QTimer::singleShot(0, this, [this, tag, generation]() {
+            if (generation == m_generation) {
+                emit segmentFinished(tag);
+            }
+        });
+        return;
+    }
+    
+    m_mixer.enqueue(tag, audio, open);
+    m_idleTimer.stop();
+    if (!m_feedTimer.isActive()) {
+        m_tickClock.start();
+        m_feedTimer.start();
+    }
+    
+    // Written at once rather than on the next tick, but not from inside the caller
+    QMetaObject::invokeMethod(this, &TTSPlayer::feed, Qt::QueuedConnection);
+}
+
+void TTSPlayer::append(int tag, const TTSAudio &audio)
+{
+    // The feed timer runs while the segment is open; the new audio goes out on its next tick
+    m_mixer.append(tag, audio);
+}
+
+void TTSPlayer::close(int tag)
+{
+    m_mixer.close(tag);
+}
+
+void TTSPlayer::stop()
+{
+    ++m_generation;
+    m_mixer.stop();
+    m_pending.clear();
+    m_playingTag = -1;
+    
+    // A fade and a paused sink don't mix: what was paused is dropped
+    if (m_paused && m_sink) {
+        m_sink->reset();
+        m_sink->resume();
+        m_paused = false;
+    }
+}
+
+void TTSPlayer::pause()
+{
+    if (m_sink && !m_paused) {
+        m_sink->suspend();
+        m_paused = true;
+    }
+}
+
+void TTSPlayer::resume()
+{
+    if (m_sink && m_paused) {
+        m_sink->resume();
+        m_paused = false;
+    }
+}
+
+void TTSPlayer::setBufferMs(int ms)
+{
+    m_bufferMs = qMax(MIN_BUFFER_MS, ms);
+    m_feedTimer.setInterval(qMax(1, m_bufferMs / 4));
+    
+    // The sink's buffer size only applies when it is started
+    if (m_sink && !m_mixer.isActive()) {
+        closeSink();
+    }
+}
+
+void TTSPlayer::feed()
+{
+    const quint64 generation = m_generation;
+    const qint64 elapsedMs = m_tickClock.restart();
+    
+    // Keep the sink's small buffer topped up, no further ahead
+    if (m_sink && !m_paused && m_mixer.isActive()) {
+        const int frameBytes = m_format.bytesPerFrame();
+        const qint64 room = m_sink->bytesFree() / frameBytes;
+        if (room > 0) {
+            QByteArray block(room * frameBytes, Qt::Uninitialized);
+            const qint64 rendered = m_mixer.render(reinterpret_cast<qint16 *>(block.data()), room);
+            block.resize(rendered * frameBytes);
+            if (rendered > 0) {
+                m_output->write(block);
+                emit referenceAudio(block, m_format);
+            }
+        }
+        m_pending += m_mixer.takeEvents();
+    }
+    
+    const float mediaGain = m_mixer.mediaGain();
+    m_mixer.updateDucking(elapsedMs);
+    if (m_mixer.mediaGain() != mediaGain) {
+        emit mediaGainChanged(m_mixer.mediaGain());
+    }
+    
+    // Segment events as the sink plays through them
+    const qint64 played = playedFrames();
+    while (!m_pending.isEmpty() && m_pending.first().frame <= played) {
+        const TTSMixer::Event event = m_pending.takeFirst();
+        if (!event.finished) {
+            m_playingTag = event.tag;
+            m_playingStartFrame = event.frame;
+            emit segmentStarted(event.tag, event.frames < 0 ? -1 : framesToMs(event.frames));
+        } else {
+            if (event.tag == m_playingTag) {
+                m_playingTag = -1;
+            }
+            emit segmentFinished(event.tag);
+        }
+        if (generation != m_generation) {
+            return;
+        }
+    }
+    if (m_playingTag >= 0) {
+        emit segmentProgress(m_playingTag, framesToMs(played - m_playingStartFrame));
+    }
+    
+    // Idle once everything has been heard and media is back up
+    if (!m_mixer.isActive() && m_pending.isEmpty() && m_mixer.mediaGain() >= 1.0f) {
+        m_feedTimer.stop();
+        m_idleTimer.start();
+    }
+}
+
+void TTSPlayer::closeIdleSink()
+{
+    if (!m_mixer.isActive() && m_pending.isEmpty()) {
+        closeSink();
+    }
+}
+
+qint64 TTSPlayer::playedFrames() const
+{
+    if (!m_sink) {
+        return m_mixer.renderedFrames();
+    }
+    
+    // Rendered frames the sink hasn't consumed yet are still in its buffer
+    const qint64 buffered = (m_sink->bufferSize() - m_sink->bytesFree()) / m_format.bytesPerFrame();
+    return m_mixer.renderedFrames() - qMax<qint64>(0, buffered);
+}
+
+bool TTSPlayer::openSink()
+{
+    const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    QAudioFormat format = device.preferredFormat();
+    format.setSampleFormat(QAudioFormat::Int16);
+    if (device.isNull() || !device.isFormatSupported(format)) {
+        qWarning() << "⚠️ No 16-bit audio output for TTS";
+        return false;
+    }
+    
+    m_format = format;
+    m_mixer.reset(format.sampleRate(), format.channelCount());
+    m_sink = new QAudioSink(device, format, this);
+    m_sink->setBufferSize(format.bytesForDuration(qint64(m_bufferMs) * 1000));
+    m_output = m_sink->start();
+    m_paused = false;
+    if (!m_output) {
+        qWarning() << "⚠️ TTS audio output failed to start:" << m_sink->error();
+        closeSink();
+        return false;
+    }
+    
+    qDebug() << "🔈 TTS output" << device.description() << format.sampleRate() << "Hz,"
+             << m_sink->bufferSize() << "byte buffer";
+    return true;
+}
+
+void TTSPlayer::closeSink()
+{
+    if (m_sink) {
+        m_sink->stop();
+        delete m_sink;
+        m_sink = nullptr;
+        m_output = nullptr;
+    }
+}
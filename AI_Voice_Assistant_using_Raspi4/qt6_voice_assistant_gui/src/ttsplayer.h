@@ -0,0 +1,98 @@
+#ifndef TTSPLAYER_H
+#define TTSPLAYER_H
+
+#include <QObject>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+#include "ttscache.h"
+#include "ttsmixer.h"
+
+class QAudioSink;
+class QIODevice;
+
+/**
+ * @brief Plays synthesized speech through a low-latency QAudioSink
+ *
+ * Segments are queued with a tag (TTSEngine uses the chunk index) and mixed
+ * by a TTSMixer into the sink's preferred format. The sink's buffer is kept
+ * at bufferMs and topped up every quarter of it, so a stop, a barge-in or a
+ * new response is heard within stopLatencyMs(): the buffer plus the mixer's
+ * fade. What the sink has consumed is the frames rendered minus the frames
+ * still in its buffer; segmentStarted(), segmentProgress() and
+ * segmentFinished() follow that, not the moment audio was written.
+ *
+ * Speech that streams in is queued open, grown with append() and closed
+ * when the last block is in (see TTSMixer); until then its segmentStarted()
+ * has a duration of -1.
+ *
+ * Every block written to the sink is also emitted as referenceAudio(), the
+ * far-end signal an echo canceller subtracts from the microphone, and
+ * mediaGainChanged() carries the gain other media should be ducked to.
+ */
+class TTSPlayer : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit TTSPlayer(QObject *parent = nullptr);
+    ~TTSPlayer();
+    
+    static bool outputAvailable();
+    
+    void enqueue(int tag, const TTSAudio &audio, bool open = false);
+    void append(int tag, const TTSAudio &audio);
+    void close(int tag);
+    void stop(); // fades out what is playing; nothing queued reports any more
+    void pause();
+    void resume();
+    
+    bool isPlaying() const { return m_mixer.isSpeaking(); }
+    void setVolume(float volume) { m_mixer.setGain(volume); }
+    float mediaGain() const { return m_mixer.mediaGain(); }
+    
+    void setBufferMs(int ms);
+    int bufferMs() const { return m_bufferMs; }
+    int stopLatencyMs() const { return m_bufferMs + TTSMixer::FADE_MS; }
+    
+    static constexpr int DEFAULT_BUFFER_MS = 40;
+    static constexpr int MIN_BUFFER_MS = 10;
+    static constexpr int IDLE_CLOSE_MS = 5000; // the sink is released after this long with nothing to play
+    
+signals:
+    void segmentStarted(int tag, qint64 durationMs);
+    void segmentProgress(int tag, qint64 positionMs);
+    void segmentFinished(int tag);
+    void mediaGainChanged(float gain);
+    void referenceAudio(const QByteArray &pcm, const QAudioFormat &format);
+    
+private slots:
+    void feed();
+    void closeIdleSink();
+    
+private:
+    bool openSink();
+    void closeSink();
+    qint64 playedFrames() const;
+    qint64 framesToMs(qint64 frames) const { return frames * 1000 / m_format.sampleRate(); }
+    
+    TTSMixer m_mixer;
+    QAudioSink *m_sink;
+    QIODevice *m_output;
+    QAudioFormat m_format;
+    int m_bufferMs;
+    bool m_paused;
+    
+    // Mixer events waiting for the sink to play up to their frame
+    QList<TTSMixer::Event> m_pending;
+    int m_playingTag;
+    qint64 m_playingStartFrame;
+    quint64 m_generation; // bumped by stop(), so a handler's stop() ends a feed()
+    
+    QTimer m_feedTimer;
+    QTimer m_idleTimer;
+    QElapsedTimer m_tickClock;
+};
+
+#endif // TTSPLAYER_H
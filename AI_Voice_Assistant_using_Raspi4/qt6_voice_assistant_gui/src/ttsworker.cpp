@@ -0,0 +1,124 @@
+#include "ttsworker.h"
+#include "ttschannel.h"
+#include <QDebug>
+
+TTSWorker::TTSWorker(const QString &program, const QStringList &arguments, QObject *parent)
+    : TTSBackend(parent)
+    , m_program(program)
+    , m_arguments(arguments)
+    , m_process(new QProcess(this))
+    , m_channel(new TTSChannel(m_process, this))
+{
+    m_startupTimer.setSingleShot(true);
+    m_startupTimer.setInterval(STARTUP_TIMEOUT_MS);
+    
+    // The channel reads stdout; stderr is plain text
+    connect(m_channel, &TTSChannel::messageReceived, this, &TTSWorker::handleMessage);
+    connect(m_channel, &TTSChannel::protocolError, this, [](const QString &error) {
+        qWarning() << "TTS protocol error:" << error;
+    });
+    connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+        emit errorOutput(QString::fromUtf8(m_process->readAllStandardError()));
+    });
+    connect(m_process, &QProcess::started, m_channel, &TTSChannel::flush);
+    connect(m_process, &QProcess::finished, this, &TTSWorker::handleFinished);
+    connect(m_process, &QProcess::errorOccurred, this, &TTSWorker::handleProcessError);
+    connect(&m_startupTimer, &QTimer::timeout, this, &TTSWorker::handleStartupTimeout);
+}
+
+TTSWorker::~TTSWorker()
+{
+    if (m_process->state() != QProcess::NotRunning) {
+        // Shutdown is the one place that waits for the backend
+        disconnect(m_process, nullptr, this, nullptr);
+        shutdown();
+        if (m_process->state() == QProcess::Running) {
+            m_process->waitForFinished(2000);
+        }
+        m_process->kill();
+        m_process->waitForFinished(500);
+    }
+}
+
+void TTSWorker::start()
+{
+    beginStartup();
+    m_startupTimer.start();
+    
+    // Reported through started() or errorOccurred(); commands queue until then
+    m_process->start(m_program, m_arguments);
+}
+
+void TTSWorker::shutdown()
+{
+    if (m_process->state() == QProcess::Running) {
+        m_channel->send("QUIT");
+        m_channel->flush();
+        m_process->closeWriteChannel();
+    }
+}
+
+void TTSWorker::send(const QString &command, const QVariantMap &params)
+{
+    m_channel->send(command, params);
+}
+
+void TTSWorker::sendLatest(const QString &command, const QVariantMap &params)
+{
+    m_channel->sendLatest(command, params);
+}
+
+QString TTSWorker::description() const
+{
+    return QString("process %1").arg(processId());
+}
+
+void TTSWorker::handleMessage(const QJsonObject &message)
+{
+    if (message["type"].toString() == "ready") {
+        m_startupTimer.stop();
+        if (!message["engine"].toBool(true)) {
+            // Up but unable to speak: a failed start, retried with backoff like any other
+            qWarning() << "TTS backend started without a speech engine, killing it";
+            m_process->kill();
+            return;
+        }
+        markReady();
+        return;
+    }
+    
+    emit messageReceived(message);
+}
+
+void TTSWorker::handleFinished(int exitCode, QProcess::ExitStatus status)
+{
+    finish(status == QProcess::CrashExit ? -1 : exitCode);
+}
+
+void TTSWorker::handleProcessError(QProcess::ProcessError error)
+{
+    // Other errors are followed by finished()
+    if (error == QProcess::FailedToStart) {
+        qWarning() << "Failed to start TTS backend:" << m_process->errorString();
+        
+        // Can be raised inside start(); the owner hears about it from the event loop
+        QMetaObject::invokeMethod(this, [this]() { finish(-1); }, Qt::QueuedConnection);
+    }
+}
+
+void TTSWorker::handleStartupTimeout()
+{
+    qWarning() << "TTS backend not ready after" << STARTUP_TIMEOUT_MS << "ms, killing it";
+    m_process->kill();
+}
+
+void TTSWorker::finish(int exitCode)
+{
+    if (hasExited()) {
+        return;
+    }
+    
+    m_startupTimer.stop();
+    m_channel->clear();
+    reportExit(exitCode);
+}
@@ -0,0 +1,58 @@
+#ifndef TTSWORKER_H
+#define TTSWORKER_H
+
+#include <QProcess>
+#include <QStringList>
+#include <QTimer>
+#include "ttsbackend.h"
+
+class TTSChannel;
+
+/**
+ * @brief One TTS backend process and the channel to it
+ *
+ * A worker is ready once the backend has loaded its speech engine and says
+ * so with a {"type":"ready"} message. That can take seconds for a cold
+ * Python start, which is why TTSEngine keeps a second worker warming up
+ * beside the active one. Starting never blocks: start() returns at once and
+ * commands sent before the worker is ready wait in its channel. A backend
+ * that isn't ready within STARTUP_TIMEOUT_MS is killed and reported like
+ * any other exit.
+ */
+class TTSWorker : public TTSBackend
+{
+    Q_OBJECT
+    
+public:
+    TTSWorker(const QString &program, const QStringList &arguments, QObject *parent = nullptr);
+    ~TTSWorker();
+    
+    void start() override;
+    void shutdown() override;
+    void send(const QString &command, const QVariantMap &params = QVariantMap()) override;
+    void sendLatest(const QString &command, const QVariantMap &params) override;
+    bool playsAudio() const override { return true; }
+    QString description() const override;
+    
+    TTSChannel *channel() const { return m_channel; }
+    qint64 processId() const { return m_process->processId(); }
+    
+    static constexpr int STARTUP_TIMEOUT_MS = 20000;
+    
+private slots:
+    void handleMessage(const QJsonObject &message);
+    void handleFinished(int exitCode, QProcess::ExitStatus status);
+    void handleProcessError(QProcess::ProcessError error);
+    void handleStartupTimeout();
+    
+private:
+    void finish(int exitCode);
+    
+    QString m_program;
+    QStringList m_arguments;
+    QProcess *m_process;
+    TTSChannel *m_channel;
+    QTimer m_startupTimer;
+};
+
+#endif // TTSWORKER_H
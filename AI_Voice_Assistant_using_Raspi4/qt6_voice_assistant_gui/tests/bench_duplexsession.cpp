@@ -0,0 +1,99 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <memory>
+#include "../src/networkmanager.h"
+#include "standinbackend.h"
+
+/**
+ * Time from asking for speech to its first audio: on the /stream session
+ * that is already carrying the microphone, against a connection opened for
+ * the request the way a separate TTS endpoint would need one
+ *
+ * Both talk to a StandInBackend over loopback, so the fresh connection pays
+ * only the local TCP and WebSocket handshakes; over Wi-Fi or a TLS link each
+ * round trip it adds is that much longer. The median of RUNS is reported.
+ */
+class BenchDuplexSession : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkFirstSpeechAudio_data();
+    void benchmarkFirstSpeechAudio();
+
+private:
+    static qint64 firstAudioMs(NetworkManager *network, QElapsedTimer *timer);
+
+    static constexpr int RUNS = 20;
+    static constexpr int TIMEOUT_MS = 3000;
+};
+
+qint64 BenchDuplexSession::firstAudioMs(NetworkManager *network, QElapsedTimer *timer)
+{
+    QSignalSpy audioSpy(network, &NetworkManager::speechAudioReceived);
+    const quint32 stream = network->requestSpeech("Your table is ready.");
+    if (stream == 0 || !audioSpy.wait(TIMEOUT_MS)) {
+        return -1;
+    }
+    const qint64 elapsed = timer->elapsed();
+    network->cancelSpeech(stream);
+    return elapsed;
+}
+
+void BenchDuplexSession::benchmarkFirstSpeechAudio_data()
+{
+    QTest::addColumn<bool>("sharedSession");
+
+    QTest::newRow("shared session") << true;
+    QTest::newRow("fresh connection") << false;
+}
+
+void BenchDuplexSession::benchmarkFirstSpeechAudio()
+{
+    QFETCH(bool, sharedSession);
+
+    StandInBackend backend;
+    QVERIFY2(backend.listen(), qPrintable(backend.errorString()));
+    backend.setSpeechDurationMs(1000);
+
+    std::unique_ptr<NetworkManager> session;
+    if (sharedSession) {
+        session.reset(new NetworkManager);
+        session->setBackendUrl(backend.url());
+        session->connectWebSocket();
+        QTRY_VERIFY_WITH_TIMEOUT(session->isMultiplexed(), TIMEOUT_MS);
+    }
+
+    QList<qint64> samples;
+    for (int run = 0; run < RUNS; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        if (sharedSession) {
+            samples << firstAudioMs(session.get(), &timer);
+        } else {
+            NetworkManager network;
+            network.setBackendUrl(backend.url());
+            network.connectWebSocket();
+            QTRY_VERIFY_WITH_TIMEOUT(network.isMultiplexed(), TIMEOUT_MS);
+            samples << firstAudioMs(&network, &timer);
+            network.disconnectWebSocket();
+        }
+        QVERIFY(samples.last() >= 0);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const qint64 median = samples.at(RUNS / 2);
+    qInfo().noquote() << QString("%1: first speech audio after %2 ms median, %3 ms worst over %4 requests")
+                         .arg(QTest::currentDataTag())
+                         .arg(median)
+                         .arg(samples.last())
+                         .arg(RUNS);
+
+    QTest::setBenchmarkResult(median, QTest::WalltimeMilliseconds);
+    if (sharedSession) {
+        QCOMPARE(backend.requestCount("/stream"), 1);
+    }
+}
+
+QTEST_MAIN(BenchDuplexSession)
+#include "bench_duplexsession.moc"
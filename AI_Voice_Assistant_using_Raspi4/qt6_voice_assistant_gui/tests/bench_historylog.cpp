@@ -0,0 +1,100 @@
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include "../src/historylog.h"
+#include "../src/transcriptionmodel.h"
+
+/**
+ * Startup with a long history on disk: opening it in TranscriptionModel and
+ * loading the first screen, against loading all of it up front the way the
+ * model would have to without paging
+ *
+ * Runs at 10k, 100k and 500k stored transcriptions (500k is about a year of
+ * a busy driver). The paged numbers, time and resident memory, should stay
+ * flat from one size to the next; the eager ones grow with the history.
+ */
+class BenchHistoryLog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkOpen_data();
+    void benchmarkOpen();
+
+private:
+    static qint64 residentKb();
+};
+
+qint64 BenchHistoryLog::residentKb()
+{
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    for (const QByteArray &line : status.readAll().split('\n')) {
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+}
+
+void BenchHistoryLog::benchmarkOpen_data()
+{
+    QTest::addColumn<int>("records");
+    QTest::addColumn<bool>("eager");
+
+    for (int records : {10000, 100000, 500000}) {
+        QTest::newRow(qPrintable(QString("paged %1").arg(records))) << records << false;
+        QTest::newRow(qPrintable(QString("eager %1").arg(records))) << records << true;
+    }
+}
+
+void BenchHistoryLog::benchmarkOpen()
+{
+    QFETCH(int, records);
+    QFETCH(bool, eager);
+    QtMessageHandler previous = qInstallMessageHandler([](QtMsgType, const QMessageLogContext &, const QString &) {});
+
+    QTemporaryDir dir;
+    {
+        HistoryLog log(dir.path());
+        const QDateTime start = QDateTime::currentDateTime().addDays(-365);
+        for (int id = 1; id <= records; ++id) {
+            log.append({QString("In two hundred metres, take exit %1 at the roundabout").arg(id),
+                        start.addSecs(id * 60), id});
+        }
+    }
+
+    const qint64 rssBeforeKb = residentKb();
+    QElapsedTimer timer;
+    timer.start();
+
+    // Until the rows are in the model, not just until the read is posted
+    TranscriptionModel model;
+    QVERIFY(model.openHistory(dir.path()));
+    do {
+        model.fetchMore(QModelIndex());
+        while (model.isFetching()) {
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        }
+    } while (eager && model.canFetchMore(QModelIndex()));
+
+    const qint64 elapsedMs = timer.elapsed();
+    const qint64 rssKb = residentKb() - rssBeforeKb;
+    qInstallMessageHandler(previous);
+
+    qInfo().noquote() << QString("%1 %2: %3 rows loaded in %4 ms, RSS +%5 KB")
+                         .arg(eager ? "eager" : "paged")
+                         .arg(records)
+                         .arg(model.count())
+                         .arg(elapsedMs)
+                         .arg(rssKb);
+
+    QTest::setBenchmarkResult(elapsedMs, QTest::WalltimeMilliseconds);
+    QCOMPARE(model.totalCount(), records);
+    QCOMPARE(model.count(), eager ? records : TranscriptionModel::PAGE_SIZE);
+}
+
+QTEST_MAIN(BenchHistoryLog)
+#include "bench_historylog.moc"
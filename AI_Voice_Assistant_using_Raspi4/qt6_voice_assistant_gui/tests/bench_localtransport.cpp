@@ -0,0 +1,223 @@
+#include <QtTest/QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QNetworkReply>
+#include <QTemporaryDir>
+#include <memory>
+#include <sys/resource.h>
+#include "../src/localnetworkaccessmanager.h"
+
+/**
+ * Benchmarks one /transcribe/raw round trip over loopback TCP and over a Unix
+ * domain socket
+ *
+ * Both paths go through LocalNetworkAccessManager against an in-process HTTP
+ * stub that answers with a small JSON body, so the numbers isolate transport
+ * and framing cost, not inference. CPU time is getrusage() for the whole
+ * process and therefore covers client and server side of each exchange.
+ */
+class BenchLocalTransport : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void benchmarkLatency_data();
+    void benchmarkLatency();
+    void benchmarkCpuPerRequest_data();
+    void benchmarkCpuPerRequest();
+    void testLocalReplyMatchesTcp();
+    void testLocalConnectFailure();
+
+private:
+    void serve(QIODevice *connection);
+    QUrl urlFor(const QString &transport) const;
+    QNetworkReply *post(const QString &transport);
+    static qint64 cpuTimeUs();
+
+    QTemporaryDir m_dir;
+    QTcpServer m_tcpServer;
+    QLocalServer m_localServer;
+    LocalNetworkAccessManager m_manager;
+    QByteArray m_audio;
+
+    static constexpr int CPU_SAMPLE_REQUESTS = 200;
+};
+
+void BenchLocalTransport::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QVERIFY(m_tcpServer.listen(QHostAddress::LocalHost));
+    QVERIFY(m_localServer.listen(m_dir.filePath("whisper.sock")));
+
+    connect(&m_tcpServer, &QTcpServer::newConnection, this, [this]() {
+        while (QTcpSocket *socket = m_tcpServer.nextPendingConnection()) {
+            serve(socket);
+        }
+    });
+    connect(&m_localServer, &QLocalServer::newConnection, this, [this]() {
+        while (QLocalSocket *socket = m_localServer.nextPendingConnection()) {
+            serve(socket);
+        }
+    });
+
+    // One second of 16 kHz mono s16le audio
+    m_audio = QByteArray(32000, '\x11');
+}
+
+void BenchLocalTransport::serve(QIODevice *connection)
+{
+    auto buffer = std::make_shared<QByteArray>();
+
+    connect(connection, &QIODevice::readyRead, connection, [connection, buffer]() {
+        buffer->append(connection->readAll());
+
+        int headEnd = buffer->indexOf("\r\n\r\n");
+        if (headEnd < 0) {
+            return;
+        }
+
+        qint64 contentLength = 0;
+        const QList<QByteArray> lines = buffer->left(headEnd).split('\n');
+        for (const QByteArray &line : lines) {
+            if (line.toLower().startsWith("content-length:")) {
+                contentLength = line.mid(15).trimmed().toLongLong();
+            }
+        }
+        if (buffer->size() < headEnd + 4 + contentLength) {
+            return;
+        }
+
+        const QByteArray body = "{\"text\":\"ok\",\"duration\":1.0}";
+        connection->write("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: "
+                          + QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+        buffer->clear();
+
+        if (auto *socket = qobject_cast<QLocalSocket*>(connection)) {
+            socket->disconnectFromServer();
+        } else {
+            static_cast<QTcpSocket*>(connection)->disconnectFromHost();
+        }
+    });
+
+    if (auto *socket = qobject_cast<QLocalSocket*>(connection)) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    } else {
+        connect(static_cast<QTcpSocket*>(connection), &QTcpSocket::disconnected, connection, &QObject::deleteLater);
+    }
+}
+
+QUrl BenchLocalTransport::urlFor(const QString &transport) const
+{
+    if (transport == "unix") {
+        return QUrl("unix://" + m_localServer.fullServerName() + "/transcribe/raw");
+    }
+    return QUrl(QString("http://127.0.0.1:%1/transcribe/raw").arg(m_tcpServer.serverPort()));
+}
+
+QNetworkReply *BenchLocalTransport::post(const QString &transport)
+{
+    QNetworkRequest request(urlFor(transport));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    request.setRawHeader("X-Request-Id", "bench-1");
+
+    QNetworkReply *reply = m_manager.post(request, m_audio);
+    if (!reply->isFinished()) {
+        QSignalSpy spy(reply, &QNetworkReply::finished);
+        spy.wait(5000);
+    }
+    return reply;
+}
+
+qint64 BenchLocalTransport::cpuTimeUs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+         + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void BenchLocalTransport::benchmarkLatency_data()
+{
+    QTest::addColumn<QString>("transport");
+
+    QTest::newRow("tcp") << QString("tcp");
+    QTest::newRow("unix") << QString("unix");
+}
+
+void BenchLocalTransport::benchmarkLatency()
+{
+    QFETCH(QString, transport);
+
+    QBENCHMARK {
+        QNetworkReply *reply = post(transport);
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        reply->deleteLater();
+    }
+}
+
+void BenchLocalTransport::benchmarkCpuPerRequest_data()
+{
+    benchmarkLatency_data();
+}
+
+void BenchLocalTransport::benchmarkCpuPerRequest()
+{
+    QFETCH(QString, transport);
+
+    // Warm up connection setup paths and allocator
+    delete post(transport);
+
+    QElapsedTimer wall;
+    wall.start();
+    const qint64 cpuStart = cpuTimeUs();
+
+    for (int i = 0; i < CPU_SAMPLE_REQUESTS; ++i) {
+        QNetworkReply *reply = post(transport);
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        delete reply;
+    }
+
+    const qint64 cpuUs = (cpuTimeUs() - cpuStart) / CPU_SAMPLE_REQUESTS;
+    const qint64 wallUs = wall.nsecsElapsed() / 1000 / CPU_SAMPLE_REQUESTS;
+
+    qInfo().noquote() << QString("%1: %2 us CPU, %3 us wall per request (%4 requests)")
+                         .arg(transport)
+                         .arg(cpuUs)
+                         .arg(wallUs)
+                         .arg(CPU_SAMPLE_REQUESTS);
+
+    QTest::setBenchmarkResult(cpuUs, QTest::CPUTicks);
+}
+
+void BenchLocalTransport::testLocalReplyMatchesTcp()
+{
+    QNetworkReply *tcp = post("tcp");
+    QNetworkReply *local = post("unix");
+
+    QCOMPARE(local->error(), tcp->error());
+    QCOMPARE(local->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(local->rawHeader("Content-Type"), tcp->rawHeader("Content-Type"));
+    QCOMPARE(local->readAll(), tcp->readAll());
+
+    delete tcp;
+    delete local;
+}
+
+void BenchLocalTransport::testLocalConnectFailure()
+{
+    // Failover relies on connect failures looking the same as on TCP
+    QNetworkRequest request(QUrl("unix://" + m_dir.filePath("missing.sock") + "/health"));
+    QNetworkReply *reply = m_manager.get(request);
+
+    QSignalSpy spy(reply, &QNetworkReply::finished);
+    QVERIFY(spy.wait(2000));
+    QCOMPARE(reply->error(), QNetworkReply::ConnectionRefusedError);
+
+    delete reply;
+}
+
+QTEST_MAIN(BenchLocalTransport)
+#include "bench_localtransport.moc"
@@ -0,0 +1,180 @@
+#include <QtTest/QtTest>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QWebSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <sys/resource.h>
+#include "../src/shmaudiotransport.h"
+
+/**
+ * Benchmarks streaming audio frames to a co-located consumer over the
+ * shared-memory ring and over the WebSocket path
+ *
+ * Both sessions go to shm_reference_consumer, a separate process, which
+ * measures capture-to-read latency per frame on the same monotonic clock
+ * and its own CPU time. Client CPU is measured here around the send loop.
+ * Frames are paced like captured audio rather than sent back to back, so
+ * latency reflects wakeup cost, not queueing.
+ */
+class BenchShmTransport : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkFrameLatency_data();
+    void benchmarkFrameLatency();
+    void testShmSessionDeliversEveryFrame();
+
+private:
+    QJsonObject runShm(int frameBytes, int frames);
+    QJsonObject runWebSocket(int frameBytes, int frames);
+    static qint64 processCpuUs();
+
+    QTemporaryDir m_dir;
+    QProcess m_consumer;
+    QString m_controlPath;
+    quint16 m_webSocketPort = 0;
+
+    static constexpr int FRAMES = 500;
+    static constexpr int FRAME_INTERVAL_MS = 2;
+};
+
+qint64 BenchShmTransport::processCpuUs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+         + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void BenchShmTransport::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_controlPath = m_dir.filePath("consumer.sock");
+
+    m_consumer.start(SHM_CONSUMER_PATH, {"--control", m_controlPath, "--websocket-port", "0"});
+    QVERIFY(m_consumer.waitForStarted(5000));
+    QVERIFY(m_consumer.waitForReadyRead(5000));
+
+    const QByteArray line = m_consumer.readLine().trimmed();
+    QVERIFY(line.startsWith("PORT "));
+    m_webSocketPort = line.mid(5).toUShort();
+    QVERIFY(m_webSocketPort > 0);
+}
+
+void BenchShmTransport::cleanupTestCase()
+{
+    m_consumer.kill();
+    m_consumer.waitForFinished(2000);
+}
+
+QJsonObject BenchShmTransport::runShm(int frameBytes, int frames)
+{
+    ShmAudioTransport transport;
+    QSignalSpy connectedSpy(&transport, &ShmAudioTransport::connected);
+    QSignalSpy messageSpy(&transport, &ShmAudioTransport::utf8MessageReceived);
+
+    transport.open(m_controlPath);
+    if (!connectedSpy.wait(5000)) {
+        return QJsonObject();
+    }
+
+    const QByteArray frame(frameBytes, '\x11');
+    const qint64 cpuStart = processCpuUs();
+    for (int i = 0; i < frames; ++i) {
+        transport.sendBinaryMessage(frame);
+        QTest::qWait(FRAME_INTERVAL_MS);
+    }
+    const qint64 cpuUs = processCpuUs() - cpuStart;
+
+    transport.sendTextMessage(QStringLiteral("{\"type\":\"end\"}"));
+    if (!messageSpy.wait(5000)) {
+        return QJsonObject();
+    }
+
+    QJsonObject result = QJsonDocument::fromJson(messageSpy.last().at(0).toByteArray()).object();
+    result["client_cpu_us"] = cpuUs;
+    transport.close();
+    return result;
+}
+
+QJsonObject BenchShmTransport::runWebSocket(int frameBytes, int frames)
+{
+    QWebSocket socket;
+    QSignalSpy connectedSpy(&socket, &QWebSocket::connected);
+    QSignalSpy messageSpy(&socket, &QWebSocket::textMessageReceived);
+
+    socket.open(QUrl(QString("ws://127.0.0.1:%1/stream").arg(m_webSocketPort)));
+    if (!connectedSpy.wait(5000)) {
+        return QJsonObject();
+    }
+
+    // Capture timestamp in front of the PCM, as the consumer expects
+    QByteArray message(8 + frameBytes, '\x11');
+    const qint64 cpuStart = processCpuUs();
+    for (int i = 0; i < frames; ++i) {
+        qToBigEndian<qint64>(PcmRing::monotonicNs(), message.data());
+        socket.sendBinaryMessage(message);
+        QTest::qWait(FRAME_INTERVAL_MS);
+    }
+    const qint64 cpuUs = processCpuUs() - cpuStart;
+
+    socket.sendTextMessage(QStringLiteral("{\"type\":\"end\"}"));
+    if (!messageSpy.wait(5000)) {
+        return QJsonObject();
+    }
+
+    QJsonObject result = QJsonDocument::fromJson(messageSpy.last().at(0).toString().toUtf8()).object();
+    result["client_cpu_us"] = cpuUs;
+    socket.close();
+    return result;
+}
+
+void BenchShmTransport::benchmarkFrameLatency_data()
+{
+    QTest::addColumn<QString>("transport");
+    QTest::addColumn<int>("frameBytes");
+
+    // 20 ms capture blocks, and the 100 ms blocks AudioEngine reads per tick
+    for (const char *transport : {"shm", "websocket"}) {
+        for (int frameBytes : {640, 3200}) {
+            QTest::newRow(QString("%1/%2B").arg(transport).arg(frameBytes).toLatin1()) << QString(transport) << frameBytes;
+        }
+    }
+}
+
+void BenchShmTransport::benchmarkFrameLatency()
+{
+    QFETCH(QString, transport);
+    QFETCH(int, frameBytes);
+
+    const QJsonObject stats = transport == "shm" ? runShm(frameBytes, FRAMES) : runWebSocket(frameBytes, FRAMES);
+    QVERIFY(!stats.isEmpty());
+    QCOMPARE(stats["frames"].toInt(), FRAMES);
+
+    qInfo().noquote() << QString("%1: latency p50 %2 us, p99 %3 us, max %4 us; CPU per frame %5 us client, %6 us consumer")
+                         .arg(QTest::currentDataTag())
+                         .arg(stats["latency_p50_us"].toInteger())
+                         .arg(stats["latency_p99_us"].toInteger())
+                         .arg(stats["latency_max_us"].toInteger())
+                         .arg(double(stats["client_cpu_us"].toInteger()) / FRAMES, 0, 'f', 1)
+                         .arg(double(stats["cpu_us"].toInteger()) / FRAMES, 0, 'f', 1);
+
+    QTest::setBenchmarkResult(stats["latency_p50_us"].toInteger() * 1000, QTest::WalltimeNanoseconds);
+}
+
+void BenchShmTransport::testShmSessionDeliversEveryFrame()
+{
+    const QJsonObject stats = runShm(3200, 100);
+    QVERIFY(!stats.isEmpty());
+    QCOMPARE(stats["type"].toString(), QString("final"));
+    QCOMPARE(stats["frames"].toInt(), 100);
+    QCOMPARE(stats["bytes"].toInteger(), qint64(100 * 3200));
+}
+
+QTEST_MAIN(BenchShmTransport)
+#include "bench_shmtransport.moc"
@@ -0,0 +1,326 @@
+#include <QtTest/QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <atomic>
+#include <cstdlib>
+#include "../src/streammessageparser.h"
+
+#if defined(__GLIBC__)
+
+// ============================================================================
+// Allocation counting
+//
+// QString/QByteArray allocate through malloc(), so the allocator itself is
+// interposed. Only calls between startCounting() and stopCounting() count.
+// ============================================================================
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<bool> g_counting(false);
+static std::atomic<long long> g_allocations(0);
+
+extern "C" void *malloc(size_t size) noexcept
+{
+    if (g_counting.load(std::memory_order_relaxed))
+        ++g_allocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) noexcept
+{
+    if (g_counting.load(std::memory_order_relaxed))
+        ++g_allocations;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) noexcept
+{
+    if (g_counting.load(std::memory_order_relaxed))
+        ++g_allocations;
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr) noexcept
+{
+    __libc_free(ptr);
+}
+
+static void startCounting()
+{
+    g_allocations = 0;
+    g_counting = true;
+}
+
+static qint64 stopCounting()
+{
+    g_counting = false;
+    return g_allocations.load();
+}
+
+#define HAVE_ALLOCATION_COUNTING 1
+#endif
+
+/**
+ * Benchmarks decoding of /stream result messages
+ *
+ * "legacy" is what onWebSocketTextMessageReceived() did before:
+ * toUtf8() -> QJsonDocument::fromJson() -> three QJsonObject lookups.
+ * "utf16" parses the QString QWebSocket delivers, "utf8" the raw bytes
+ * from the local transports. Each row decodes the same partial repeatedly.
+ */
+class BenchStreamMessage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkDecode_data();
+    void benchmarkDecode();
+    void benchmarkMessagesPerSecond();
+    void benchmarkAllocations();
+    void testMatchesQJsonDocument_data();
+    void testMatchesQJsonDocument();
+    void testRejectsMalformed_data();
+    void testRejectsMalformed();
+    void testInternsKnownTypes();
+    void testStableLength();
+    void testMultiplexFields();
+
+private:
+    static QByteArray makePartial(int words);
+    static bool decode(const QString &path, const QString &message, const QByteArray &utf8,
+                       StreamMessageParser &parser);
+};
+
+QByteArray BenchStreamMessage::makePartial(int words)
+{
+    QByteArray text;
+    for (int i = 0; i < words; ++i) {
+        text += (i % 7 == 6) ? "caf\\u00e9 " : "word ";
+    }
+    return "{\"type\":\"partial\",\"text\":\"" + text.trimmed()
+           + "\",\"timestamp\":1718035200.125,\"segment\":3,\"words\":[{\"w\":\"x\",\"p\":0.9}]}";
+}
+
+bool BenchStreamMessage::decode(const QString &path, const QString &message, const QByteArray &utf8,
+                                StreamMessageParser &parser)
+{
+    if (path == "legacy") {
+        QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
+        if (!jsonDoc.isObject())
+            return false;
+        QJsonObject jsonObj = jsonDoc.object();
+        QString type = jsonObj["type"].toString();
+        QString text = jsonObj["text"].toString();
+        double timestamp = jsonObj["timestamp"].toDouble();
+        return type == "partial" && !text.isEmpty() && timestamp > 0;
+    }
+
+    if (path == "utf16")
+        return parser.parse(QStringView(message)) && parser.type() == StreamMessageParser::Partial;
+
+    return parser.parse(QByteArrayView(utf8)) && parser.type() == StreamMessageParser::Partial;
+}
+
+void BenchStreamMessage::benchmarkDecode_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<int>("words");
+
+    for (const char *path : {"legacy", "utf16", "utf8"}) {
+        for (int words : {4, 32, 128}) {
+            QTest::newRow(QString("%1/%2w").arg(path).arg(words).toLatin1()) << QString(path) << words;
+        }
+    }
+}
+
+void BenchStreamMessage::benchmarkDecode()
+{
+    QFETCH(QString, path);
+    QFETCH(int, words);
+
+    const QByteArray utf8 = makePartial(words);
+    const QString message = QString::fromUtf8(utf8);
+    StreamMessageParser parser;
+
+    QBENCHMARK {
+        QVERIFY(decode(path, message, utf8, parser));
+    }
+}
+
+void BenchStreamMessage::benchmarkMessagesPerSecond()
+{
+    static constexpr int MESSAGES = 200000;
+
+    const QByteArray utf8 = makePartial(32);
+    const QString message = QString::fromUtf8(utf8);
+
+    for (const char *path : {"legacy", "utf16", "utf8"}) {
+        StreamMessageParser parser;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < MESSAGES; ++i) {
+            QVERIFY(decode(path, message, utf8, parser));
+        }
+        const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+        qInfo().noquote() << QString("%1: %2 messages/s")
+                             .arg(path, 6)
+                             .arg(qint64(MESSAGES * 1e9 / elapsedNs));
+    }
+}
+
+void BenchStreamMessage::benchmarkAllocations()
+{
+#ifdef HAVE_ALLOCATION_COUNTING
+    static constexpr int MESSAGES = 1000;
+
+    const QByteArray utf8 = makePartial(32);
+    const QString message = QString::fromUtf8(utf8);
+
+    for (const char *path : {"legacy", "utf16", "utf8"}) {
+        StreamMessageParser parser;
+        QVERIFY(decode(path, message, utf8, parser)); // warm the reused buffer
+
+        startCounting();
+        for (int i = 0; i < MESSAGES; ++i) {
+            decode(path, message, utf8, parser);
+        }
+        const qint64 allocations = stopCounting();
+
+        qInfo().noquote() << QString("%1: %2 allocations per message")
+                             .arg(path, 6)
+                             .arg(double(allocations) / MESSAGES, 0, 'f', 2);
+
+        if (path != QLatin1String("legacy"))
+            QCOMPARE(allocations, qint64(0));
+    }
+#else
+    QSKIP("Allocation counting requires glibc");
+#endif
+}
+
+void BenchStreamMessage::testMatchesQJsonDocument_data()
+{
+    QTest::addColumn<QByteArray>("message");
+
+    QTest::newRow("partial") << QByteArray(R"({"type":"partial","text":"hello wor","timestamp":12.5})");
+    QTest::newRow("final") << QByteArray(R"({"type":"final","text":"hello world","timestamp":1718035200.125})");
+    QTest::newRow("whitespace") << QByteArray(" {\n  \"timestamp\" : 3e2 ,\"text\":\"a\" , \"type\" : \"final\" }\n");
+    QTest::newRow("escapes") << QByteArray(R"({"type":"partial","text":"line\nnext \"q\" \\ \/ \t","timestamp":1})");
+    QTest::newRow("unicode escape") << QByteArray(R"({"type":"partial","text":"caf\u00e9 \ud83d\ude00","timestamp":1})");
+    QTest::newRow("raw utf8") << QByteArray("{\"type\":\"partial\",\"text\":\"Gr\xc3\xbc\xc3\x9f \xf0\x9f\x8e\xa4\",\"timestamp\":1}");
+    QTest::newRow("extra fields") << QByteArray(R"({"seq":4,"type":"final","meta":{"a":[1,{"b":"}"}]},"text":"x","ok":true,"timestamp":-0.5})");
+    QTest::newRow("null text") << QByteArray(R"({"type":"partial","text":null,"timestamp":null})");
+    QTest::newRow("missing fields") << QByteArray(R"({"type":"cancelled"})");
+    QTest::newRow("unknown type") << QByteArray(R"({"type":"diagnostic","text":"x"})");
+    QTest::newRow("empty object") << QByteArray("{}");
+}
+
+void BenchStreamMessage::testMatchesQJsonDocument()
+{
+    QFETCH(QByteArray, message);
+
+    QJsonObject expected = QJsonDocument::fromJson(message).object();
+    QVERIFY(!expected.isEmpty() || message == "{}");
+
+    StreamMessageParser parser;
+
+    QVERIFY(parser.parse(QByteArrayView(message)));
+    QCOMPARE(parser.typeName(), expected["type"].toString());
+    QCOMPARE(parser.text(), expected["text"].toString());
+    QCOMPARE(parser.timestamp(), expected["timestamp"].toDouble());
+    QCOMPARE(parser.hasTimestamp(), expected["timestamp"].isDouble());
+
+    const QString utf16 = QString::fromUtf8(message);
+    QVERIFY(parser.parse(QStringView(utf16)));
+    QCOMPARE(parser.typeName(), expected["type"].toString());
+    QCOMPARE(parser.text(), expected["text"].toString());
+    QCOMPARE(parser.timestamp(), expected["timestamp"].toDouble());
+}
+
+void BenchStreamMessage::testRejectsMalformed_data()
+{
+    QTest::addColumn<QByteArray>("message");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("array") << QByteArray(R"(["partial"])");
+    QTest::newRow("truncated") << QByteArray(R"({"type":"partial","text":"hel)");
+    QTest::newRow("missing colon") << QByteArray(R"({"type" "partial"})");
+    QTest::newRow("trailing comma") << QByteArray(R"({"type":"partial",})");
+    QTest::newRow("trailing garbage") << QByteArray(R"({"type":"partial"} x)");
+    QTest::newRow("bad escape") << QByteArray(R"({"type":"partial","text":"\q"})");
+    QTest::newRow("bad number") << QByteArray(R"({"type":"partial","timestamp":1.2.3})");
+}
+
+void BenchStreamMessage::testRejectsMalformed()
+{
+    QFETCH(QByteArray, message);
+
+    StreamMessageParser parser;
+    QVERIFY(!parser.parse(QByteArrayView(message)));
+
+    const QString utf16 = QString::fromUtf8(message);
+    QVERIFY(!parser.parse(QStringView(utf16)));
+}
+
+void BenchStreamMessage::testInternsKnownTypes()
+{
+    StreamMessageParser parser;
+
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"partial"})")));
+    QCOMPARE(parser.type(), StreamMessageParser::Partial);
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"final"})")));
+    QCOMPARE(parser.type(), StreamMessageParser::Final);
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"cancelled"})")));
+    QCOMPARE(parser.type(), StreamMessageParser::Cancelled);
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"final"})")));
+    QCOMPARE(parser.type(), StreamMessageParser::Final);
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"partials"})")));
+    QCOMPARE(parser.type(), StreamMessageParser::Unknown);
+    QCOMPARE(parser.typeName(), QString("partials"));
+}
+
+void BenchStreamMessage::testStableLength()
+{
+    StreamMessageParser parser;
+
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"partial","stable":42,"text":" tail","timestamp":1})")));
+    QCOMPARE(parser.stableLength(), 42);
+    QCOMPARE(parser.text(), QString(" tail"));
+
+    // Full-text partials don't carry it
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"partial","text":"whole"})")));
+    QCOMPARE(parser.stableLength(), -1);
+
+    QVERIFY(!parser.parse(QByteArrayView(R"({"type":"partial","stable":1.5})")));
+    QVERIFY(!parser.parse(QByteArrayView(R"({"type":"partial","stable":99999999999})")));
+}
+
+void BenchStreamMessage::testMultiplexFields()
+{
+    StreamMessageParser parser;
+
+    QVERIFY(parser.parse(QStringView(uR"({"type":"ready","mux":1})")));
+    QCOMPARE(parser.type(), StreamMessageParser::Ready);
+    QCOMPARE(parser.muxVersion(), 1);
+    QCOMPARE(parser.channel(), -1);
+
+    // Speech control messages are recognised by channel, whatever their type
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"tts_started","channel":2,"stream":9,"sampleRate":16000})")));
+    QCOMPARE(parser.type(), StreamMessageParser::Unknown);
+    QCOMPARE(parser.channel(), 2);
+    QCOMPARE(parser.muxVersion(), 0);
+
+    // Reset by the next message
+    QVERIFY(parser.parse(QByteArrayView(R"({"type":"partial","text":"x"})")));
+    QCOMPARE(parser.channel(), -1);
+}
+
+QTEST_MAIN(BenchStreamMessage)
+#include "bench_streammessage.moc"
@@ -0,0 +1,218 @@
+#include <QtTest/QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <atomic>
+#include <cstdlib>
+#include "../src/networkmanager.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+// ============================================================================
+// Allocation tracking
+//
+// QByteArray/QString allocate through malloc(), not operator new, so the
+// allocator itself is interposed. Only the window between startTracking()
+// and stopTracking() is measured.
+// ============================================================================
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<bool> g_tracking(false);
+static std::atomic<long long> g_currentBytes(0);
+static std::atomic<long long> g_peakBytes(0);
+
+static void trackAllocation(void *ptr)
+{
+    if (!ptr || !g_tracking.load(std::memory_order_relaxed))
+        return;
+
+    long long current = g_currentBytes.fetch_add(malloc_usable_size(ptr)) + malloc_usable_size(ptr);
+    long long peak = g_peakBytes.load();
+    while (current > peak && !g_peakBytes.compare_exchange_weak(peak, current)) {
+    }
+}
+
+static void trackRelease(void *ptr)
+{
+    if (ptr && g_tracking.load(std::memory_order_relaxed))
+        g_currentBytes.fetch_sub(malloc_usable_size(ptr));
+}
+
+extern "C" void *malloc(size_t size) noexcept
+{
+    void *ptr = __libc_malloc(size);
+    trackAllocation(ptr);
+    return ptr;
+}
+
+extern "C" void *calloc(size_t count, size_t size) noexcept
+{
+    void *ptr = __libc_calloc(count, size);
+    trackAllocation(ptr);
+    return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size) noexcept
+{
+    trackRelease(ptr);
+    void *result = __libc_realloc(ptr, size);
+    trackAllocation(result);
+    return result;
+}
+
+extern "C" void free(void *ptr) noexcept
+{
+    trackRelease(ptr);
+    __libc_free(ptr);
+}
+
+static void startTracking()
+{
+    g_currentBytes = 0;
+    g_peakBytes = 0;
+    g_tracking = true;
+}
+
+static qint64 stopTracking()
+{
+    g_tracking = false;
+    return g_peakBytes.load();
+}
+
+#define HAVE_ALLOCATION_TRACKING 1
+#endif
+
+/**
+ * Benchmarks request body construction for /transcribe/base64 and /transcribe/raw
+ *
+ * "legacy" is the encoding transcribeBase64() used before: toBase64() ->
+ * QString -> QJsonObject -> QJsonDocument::toJson(). Rows are seconds of
+ * 16 kHz mono s16le audio, so divide by the row label for per-second figures.
+ */
+class BenchTranscribePayload : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkWallTime_data();
+    void benchmarkWallTime();
+    void benchmarkPeakAllocation_data();
+    void benchmarkPeakAllocation();
+    void testPayloadMatchesLegacy();
+
+private:
+    static QByteArray makeAudio(int seconds);
+    static QByteArray legacyPayload(const QByteArray &audioData, const QString &language);
+    static QByteArray encode(const QString &path, const QByteArray &audio);
+};
+
+QByteArray BenchTranscribePayload::makeAudio(int seconds)
+{
+    QByteArray audio(seconds * 16000 * 2, Qt::Uninitialized);
+    qint16 *samples = reinterpret_cast<qint16*>(audio.data());
+    for (int i = 0; i < seconds * 16000; ++i) {
+        samples[i] = qint16((i * 7919) & 0x7FFF);
+    }
+    return audio;
+}
+
+QByteArray BenchTranscribePayload::legacyPayload(const QByteArray &audioData, const QString &language)
+{
+    QString base64Audio = QString::fromLatin1(audioData.toBase64());
+
+    QJsonObject json;
+    json["audio_base64"] = base64Audio;
+    json["language"] = language;
+    json["task"] = "transcribe";
+
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+QByteArray BenchTranscribePayload::encode(const QString &path, const QByteArray &audio)
+{
+    if (path == "legacy")
+        return legacyPayload(audio, "en");
+    if (path == "streaming-json")
+        return NetworkManager::buildBase64JsonPayload(audio, "en");
+
+    // Raw path posts the caller's buffer; sharing it is the whole cost
+    return audio;
+}
+
+void BenchTranscribePayload::benchmarkWallTime_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<int>("seconds");
+
+    for (const char *path : {"legacy", "streaming-json", "raw"}) {
+        for (int seconds : {1, 10, 60}) {
+            QTest::newRow(QString("%1/%2s").arg(path).arg(seconds).toLatin1()) << QString(path) << seconds;
+        }
+    }
+}
+
+void BenchTranscribePayload::benchmarkWallTime()
+{
+    QFETCH(QString, path);
+    QFETCH(int, seconds);
+
+    const QByteArray audio = makeAudio(seconds);
+
+    QBENCHMARK {
+        QByteArray payload = encode(path, audio);
+        Q_UNUSED(payload);
+    }
+}
+
+void BenchTranscribePayload::benchmarkPeakAllocation_data()
+{
+    benchmarkWallTime_data();
+}
+
+void BenchTranscribePayload::benchmarkPeakAllocation()
+{
+#ifdef HAVE_ALLOCATION_TRACKING
+    QFETCH(QString, path);
+    QFETCH(int, seconds);
+
+    const QByteArray audio = makeAudio(seconds);
+
+    startTracking();
+    {
+        QByteArray payload = encode(path, audio);
+        Q_UNUSED(payload);
+    }
+    const qint64 peak = stopTracking();
+
+    qInfo().noquote() << QString("%1: peak %2 bytes (%3x audio, %4 bytes per second of audio)")
+                         .arg(QTest::currentDataTag())
+                         .arg(peak)
+                         .arg(double(peak) / audio.size(), 0, 'f', 2)
+                         .arg(peak / seconds);
+
+    QTest::setBenchmarkResult(peak, QTest::BytesAllocated);
+#else
+    QSKIP("Allocation tracking requires glibc");
+#endif
+}
+
+void BenchTranscribePayload::testPayloadMatchesLegacy()
+{
+    for (int size : {0, 1, 2, 3, 4, 31999, 32000}) {
+        QByteArray audio = makeAudio(1).left(size);
+
+        QJsonObject expected = QJsonDocument::fromJson(legacyPayload(audio, "en")).object();
+        QJsonObject actual = QJsonDocument::fromJson(NetworkManager::buildBase64JsonPayload(audio, "en")).object();
+
+        QCOMPARE(actual, expected);
+    }
+}
+
+QTEST_MAIN(BenchTranscribePayload)
+#include "bench_transcribepayload.moc"
@@ -0,0 +1,123 @@
+#include <QtTest/QtTest>
+#include <QVector>
+#include "../src/transcriptionmodel.h"
+
+/**
+ * Cost of a new transcription and of deleting one by id with a long
+ * history: TranscriptionModel against the QVector it used to keep, which
+ * prepended and scanned
+ *
+ * Each benchmark runs at 10k and 100k rows. What matters on the Pi is that
+ * the model's numbers stay flat from one size to the other; the vector's
+ * grow with it.
+ */
+class BenchTranscriptionModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkAdd_data();
+    void benchmarkAdd();
+    void benchmarkRemoveById_data();
+    void benchmarkRemoveById();
+
+private:
+    static void addRows();
+    static TranscriptionModel *filledModel(int rows);
+    static QVector<TranscriptionItem> filledVector(int rows);
+};
+
+void BenchTranscriptionModel::addRows()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<bool>("vector");
+
+    for (int rows : {10000, 100000}) {
+        QTest::newRow(qPrintable(QString("model %1").arg(rows))) << rows << false;
+        QTest::newRow(qPrintable(QString("vector %1").arg(rows))) << rows << true;
+    }
+}
+
+TranscriptionModel *BenchTranscriptionModel::filledModel(int rows)
+{
+    auto *model = new TranscriptionModel;
+    for (int i = 0; i < rows; ++i) {
+        model->addTranscription(QString("Transcription %1").arg(i), QDateTime::currentDateTime());
+    }
+    return model;
+}
+
+QVector<TranscriptionItem> BenchTranscriptionModel::filledVector(int rows)
+{
+    QVector<TranscriptionItem> items;
+    for (int i = 0; i < rows; ++i) {
+        items.prepend({QString("Transcription %1").arg(i), QDateTime::currentDateTime(), i + 1});
+    }
+    return items;
+}
+
+void BenchTranscriptionModel::benchmarkAdd_data()
+{
+    addRows();
+}
+
+void BenchTranscriptionModel::benchmarkAdd()
+{
+    QFETCH(int, rows);
+    QFETCH(bool, vector);
+    QtMessageHandler previous = qInstallMessageHandler([](QtMsgType, const QMessageLogContext &, const QString &) {});
+
+    const QDateTime now = QDateTime::currentDateTime();
+    if (vector) {
+        QVector<TranscriptionItem> items = filledVector(rows);
+        int id = rows;
+        QBENCHMARK {
+            items.prepend({"Turn left at the next junction", now, ++id});
+        }
+    } else {
+        QScopedPointer<TranscriptionModel> model(filledModel(rows));
+        QBENCHMARK {
+            model->addTranscription("Turn left at the next junction", now);
+        }
+    }
+
+    qInstallMessageHandler(previous);
+}
+
+void BenchTranscriptionModel::benchmarkRemoveById_data()
+{
+    addRows();
+}
+
+void BenchTranscriptionModel::benchmarkRemoveById()
+{
+    QFETCH(int, rows);
+    QFETCH(bool, vector);
+    QtMessageHandler previous = qInstallMessageHandler([](QtMsgType, const QMessageLogContext &, const QString &) {});
+
+    // From the middle of the history, a different one each time
+    int id = rows / 2;
+    if (vector) {
+        QVector<TranscriptionItem> items = filledVector(rows);
+        QBENCHMARK {
+            const int target = id--;
+            for (int i = 0; i < items.count(); ++i) {
+                if (items[i].id == target) {
+                    items.removeAt(i);
+                    break;
+                }
+            }
+        }
+    } else {
+        QScopedPointer<TranscriptionModel> model(filledModel(rows));
+        QBENCHMARK {
+            model->removeTranscription(id--);
+        }
+        QVERIFY(model->count() < rows);
+    }
+
+    qInstallMessageHandler(previous);
+}
+
+QTEST_MAIN(BenchTranscriptionModel)
+#include "bench_transcriptionmodel.moc"
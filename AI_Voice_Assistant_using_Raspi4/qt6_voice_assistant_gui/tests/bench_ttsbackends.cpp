@@ -0,0 +1,113 @@
+#include <QtTest/QtTest>
+#include <QFile>
+#include <memory>
+#include "../src/ttsworker.h"
+#include "../src/nativettsbackend.h"
+
+/**
+ * Compares the TTS backends on what the Pi notices: startup to ready,
+ * resident memory once ready, and time from SYNTHESIZE to the first audio
+ *
+ * The process backend is tts_backend.py from this tree; its RSS is the
+ * interpreter's. The native backend runs here, so its RSS is what this
+ * process grew by. Without pyttsx3 the Python backend still starts but
+ * can't synthesize, and its time to first audio is reported as n/a.
+ */
+class BenchTTSBackends : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkBackend_data();
+    void benchmarkBackend();
+
+private:
+    static qint64 residentKb(qint64 pid);
+
+    static constexpr int TIMEOUT_MS = 30000;
+};
+
+qint64 BenchTTSBackends::residentKb(qint64 pid)
+{
+    QFile status(QString("/proc/%1/status").arg(pid));
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    for (const QByteArray &line : status.readAll().split('\n')) {
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+}
+
+void BenchTTSBackends::benchmarkBackend_data()
+{
+    QTest::addColumn<QString>("backend");
+
+    QTest::newRow("native") << QString("native");
+    QTest::newRow("process") << QString("process");
+}
+
+void BenchTTSBackends::benchmarkBackend()
+{
+    QFETCH(QString, backend);
+    const bool native = backend == "native";
+    if (!native && QStandardPaths::findExecutable("python3").isEmpty()) {
+        QSKIP("python3 is needed for the process backend");
+    }
+
+    const qint64 rssBeforeKb = residentKb(QCoreApplication::applicationPid());
+    std::unique_ptr<TTSBackend> worker;
+    if (native) {
+        worker.reset(new NativeTTSBackend);
+    } else {
+        worker.reset(new TTSWorker("python3", {TTS_BACKEND_SCRIPT}));
+    }
+
+    QSignalSpy readySpy(worker.get(), &TTSBackend::ready);
+    worker->start();
+    QVERIFY(readySpy.wait(TIMEOUT_MS));
+
+    // A first sentence, the way the engine sends one
+    QElapsedTimer timer;
+    qint64 firstAudioMs = -1;
+    bool answered = false;
+    connect(worker.get(), &TTSBackend::audioSynthesized, this, [&]() {
+        firstAudioMs = firstAudioMs < 0 ? timer.elapsed() : firstAudioMs;
+        answered = true;
+    });
+    connect(worker.get(), &TTSBackend::messageReceived, this, [&](const QJsonObject &message) {
+        const QString type = message["type"].toString();
+        if (type == "audio" && firstAudioMs < 0) {
+            firstAudioMs = timer.elapsed();
+        }
+        answered = answered || type == "audio" || type == "synthesis_failed";
+    });
+
+    QVariantMap params;
+    params["request"] = 1;
+    params["text"] = "In two hundred metres, take the second exit at the roundabout.";
+    timer.start();
+    worker->send("SYNTHESIZE", params);
+    QTRY_VERIFY_WITH_TIMEOUT(answered, TIMEOUT_MS);
+
+    const qint64 rssKb = native ? residentKb(QCoreApplication::applicationPid()) - rssBeforeKb
+                                : residentKb(static_cast<TTSWorker *>(worker.get())->processId());
+
+    qInfo().noquote() << QString("%1: ready after %2 ms, RSS %3 KB, first audio after %4")
+                         .arg(backend)
+                         .arg(worker->startupMs())
+                         .arg(rssKb)
+                         .arg(firstAudioMs < 0 ? QString("n/a") : QString("%1 ms").arg(firstAudioMs));
+
+    worker->disconnect(this);
+    QTest::setBenchmarkResult(worker->startupMs(), QTest::WalltimeMilliseconds);
+    if (native) {
+        QVERIFY(firstAudioMs >= 0);
+        QVERIFY(worker->startupMs() < 100);
+    }
+}
+
+QTEST_MAIN(BenchTTSBackends)
+#include "bench_ttsbackends.moc"
@@ -0,0 +1,281 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include "../src/pcmring.h"
+
+/**
+ * Reference consumer for the shared-memory audio transport
+ *
+ * Stands in for a co-located inference process: attaches to the PCM ring
+ * named by the client, reads frames in place on its own thread and answers
+ * on the control socket with the same messages the /stream WebSocket uses.
+ * Instead of transcribing it records, per frame, the time from capture to
+ * being read, and reports those figures in the final message.
+ *
+ * With --websocket-port it also accepts /stream-style WebSocket sessions
+ * whose binary frames start with an 8-byte big-endian capture timestamp, so
+ * benchmarks can compare both paths against the same consumer. The chosen
+ * port is printed on stdout as "PORT <n>".
+ */
+
+static qint64 processCpuUs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+         + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+// ============================================================================
+// Session statistics
+// ============================================================================
+
+class SessionStats
+{
+public:
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latenciesUs.clear();
+        m_bytes = 0;
+        m_cpuStartUs = processCpuUs();
+    }
+    
+    void record(qint64 captureNs, qint64 bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latenciesUs.push_back((PcmRing::monotonicNs() - captureNs) / 1000);
+        m_bytes += bytes;
+    }
+    
+    QJsonObject finish(const QString &transport)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<qint64> sorted = m_latenciesUs;
+        std::sort(sorted.begin(), sorted.end());
+        
+        auto percentile = [&sorted](double p) -> qint64 {
+            return sorted.empty() ? 0 : sorted[qMin(sorted.size() - 1, size_t(p * sorted.size()))];
+        };
+        
+        QJsonObject result;
+        result["type"] = "final";
+        result["text"] = QString("[%1] %2 frames, %3 bytes").arg(transport).arg(sorted.size()).arg(m_bytes);
+        result["timestamp"] = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+        result["frames"] = qint64(sorted.size());
+        result["bytes"] = m_bytes;
+        result["latency_p50_us"] = percentile(0.5);
+        result["latency_p99_us"] = percentile(0.99);
+        result["latency_max_us"] = sorted.empty() ? 0 : sorted.back();
+        result["cpu_us"] = processCpuUs() - m_cpuStartUs;
+        return result;
+    }
+    
+private:
+    std::mutex m_mutex;
+    std::vector<qint64> m_latenciesUs;
+    qint64 m_bytes = 0;
+    qint64 m_cpuStartUs = 0;
+};
+
+static QByteArray line(const QJsonObject &object)
+{
+    return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+// ============================================================================
+// Shared-memory session
+// ============================================================================
+
+class ShmSession : public QObject
+{
+public:
+    explicit ShmSession(QLocalSocket *control)
+        : QObject(control)
+        , m_control(control)
+        , m_running(false)
+    {
+        connect(control, &QLocalSocket::readyRead, this, [this]() { onReadyRead(); });
+        connect(control, &QLocalSocket::disconnected, this, [this]() {
+            stopReader();
+            m_control->deleteLater();
+        });
+    }
+    
+    ~ShmSession()
+    {
+        stopReader();
+    }
+    
+private:
+    void onReadyRead()
+    {
+        m_buffer.append(m_control->readAll());
+        
+        int lineEnd;
+        while ((lineEnd = m_buffer.indexOf('\n')) >= 0) {
+            const QJsonObject message = QJsonDocument::fromJson(m_buffer.left(lineEnd)).object();
+            m_buffer.remove(0, lineEnd + 1);
+            handle(message);
+        }
+    }
+    
+    void handle(const QJsonObject &message)
+    {
+        const QString type = message.value("type").toString();
+        
+        if (type == "start") {
+            stopReader();
+            if (!m_ring.attach(message.value("shm").toString())) {
+                qWarning() << "❌" << m_ring.errorString();
+                m_control->write(line({{"type", "error"}, {"text", m_ring.errorString()}}));
+                return;
+            }
+            m_stats.start();
+            m_running = true;
+            m_reader = std::thread([this]() { readFrames(); });
+            m_control->write(line({{"type", "ready"}}));
+        } else if (type == "ping") {
+            m_control->write(line({{"type", "pong"}}));
+        } else if (type == "cancel") {
+            m_control->write(line({{"type", "cancelled"}, {"timestamp", QDateTime::currentMSecsSinceEpoch() / 1000.0}}));
+        } else if (type == "end") {
+            // Let the reader drain what the producer wrote before "end"
+            stopReader();
+            m_control->write(line(m_stats.finish("shm")));
+            m_control->flush();
+        }
+    }
+    
+    void readFrames()
+    {
+        PcmRing::Frame frame;
+        
+        while (m_running.load()) {
+            if (m_ring.peek(&frame)) {
+                // In place: the audio is consumed straight from shared memory
+                m_stats.record(frame.captureNs, frame.size);
+                m_ring.release();
+                continue;
+            }
+            if (m_ring.isClosed()) {
+                break;
+            }
+            m_ring.wait(50);
+        }
+    }
+    
+    void stopReader()
+    {
+        if (!m_reader.joinable()) {
+            return;
+        }
+        
+        // Drain before stopping so "end" reports every frame written before it
+        PcmRing::Frame frame;
+        m_running = false;
+        m_reader.join();
+        while (m_ring.peek(&frame)) {
+            m_stats.record(frame.captureNs, frame.size);
+            m_ring.release();
+        }
+        m_ring.close();
+    }
+    
+    QLocalSocket *m_control;
+    QByteArray m_buffer;
+    PcmRing m_ring;
+    SessionStats m_stats;
+    std::thread m_reader;
+    std::atomic<bool> m_running;
+};
+
+// ============================================================================
+// WebSocket session
+// ============================================================================
+
+static void serveWebSocket(QWebSocket *socket)
+{
+    auto stats = std::make_shared<SessionStats>();
+    stats->start();
+    
+    QObject::connect(socket, &QWebSocket::binaryMessageReceived, socket, [stats](const QByteArray &message) {
+        if (message.size() < 8) {
+            return;
+        }
+        const qint64 captureNs = qFromBigEndian<qint64>(message.constData());
+        stats->record(captureNs, message.size() - 8);
+    });
+    
+    QObject::connect(socket, &QWebSocket::textMessageReceived, socket, [socket, stats](const QString &text) {
+        const QString type = QJsonDocument::fromJson(text.toUtf8()).object().value("type").toString();
+        if (type == "end") {
+            socket->sendTextMessage(QString::fromUtf8(line(stats->finish("websocket")).trimmed()));
+            stats->start();
+        } else if (type == "cancel") {
+            socket->sendTextMessage(QStringLiteral("{\"type\":\"cancelled\"}"));
+        }
+    });
+    
+    QObject::connect(socket, &QWebSocket::disconnected, socket, &QObject::deleteLater);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Reference consumer for the shared-memory PCM transport");
+    parser.addHelpOption();
+    parser.addOption({"control", "Control socket path to listen on.", "path"});
+    parser.addOption({"websocket-port", "Also accept WebSocket sessions on this port (0 = any).", "port"});
+    parser.process(app);
+    
+    QLocalServer controlServer;
+    if (parser.isSet("control")) {
+        QLocalServer::removeServer(parser.value("control"));
+        if (!controlServer.listen(parser.value("control"))) {
+            qCritical() << "❌ Cannot listen on" << parser.value("control") << controlServer.errorString();
+            return 1;
+        }
+        QObject::connect(&controlServer, &QLocalServer::newConnection, [&controlServer]() {
+            while (QLocalSocket *socket = controlServer.nextPendingConnection()) {
+                new ShmSession(socket);
+            }
+        });
+    }
+    
+    QWebSocketServer webSocketServer("shm_reference_consumer", QWebSocketServer::NonSecureMode);
+    if (parser.isSet("websocket-port")) {
+        if (!webSocketServer.listen(QHostAddress::LocalHost, parser.value("websocket-port").toUShort())) {
+            qCritical() << "❌ Cannot listen for WebSockets:" << webSocketServer.errorString();
+            return 1;
+        }
+        QObject::connect(&webSocketServer, &QWebSocketServer::newConnection, [&webSocketServer]() {
+            while (QWebSocket *socket = webSocketServer.nextPendingConnection()) {
+                serveWebSocket(socket);
+            }
+        });
+    }
+    
+    printf("PORT %d\n", int(webSocketServer.serverPort()));
+    fflush(stdout);
+    
+    return app.exec();
+}
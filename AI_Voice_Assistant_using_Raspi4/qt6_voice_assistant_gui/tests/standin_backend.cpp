@@ -0,0 +1,66 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QDebug>
+#include <cstdio>
+#include "standinbackend.h"
+
+/**
+ * Stand-alone stand-in backend
+ *
+ * Runs StandInBackend as a server so the GUI, the load generator or a
+ * benchmark in another process can be pointed at it. The chosen port is
+ * printed on stdout as "PORT <n>".
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Deterministic stand-in for the Whisper backend");
+    parser.addHelpOption();
+    parser.addOption({"port", "Port to listen on (0 = any).", "port", "0"});
+    parser.addOption({"listen", "Address to listen on.", "address", "127.0.0.1"});
+    parser.addOption({"delay", "Inference delay per transcription and per partial, ms.", "ms", "0"});
+    parser.addOption({"health-delay", "Delay for /health and /model/info, ms.", "ms", "0"});
+    parser.addOption({"jitter", "Uniform random jitter added to every delay, ms.", "ms", "0"});
+    parser.addOption({"seed", "Seed for jitter and error injection.", "seed", "1"});
+    parser.addOption({"error-rate", "Fraction of transcriptions answered with HTTP 500.", "rate", "0"});
+    parser.addOption({"transcripts", "File with one scripted transcript per line.", "file"});
+    parser.addOption({"partial-bytes", "Audio bytes per /stream partial.", "bytes", "16000"});
+    parser.process(app);
+
+    StandInBackend backend;
+    backend.setInferenceDelay(parser.value("delay").toInt());
+    backend.setHealthDelay(parser.value("health-delay").toInt());
+    backend.setJitter(parser.value("jitter").toInt());
+    backend.setSeed(parser.value("seed").toUInt());
+    backend.setErrorRate(parser.value("error-rate").toDouble());
+    backend.setPartialBytes(parser.value("partial-bytes").toInt());
+
+    if (parser.isSet("transcripts")) {
+        QFile file(parser.value("transcripts"));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qCritical() << "❌ Cannot read transcripts:" << file.errorString();
+            return 1;
+        }
+        QStringList transcripts;
+        while (!file.atEnd()) {
+            const QString line = QString::fromUtf8(file.readLine()).trimmed();
+            if (!line.isEmpty()) {
+                transcripts << line;
+            }
+        }
+        backend.setTranscripts(transcripts);
+    }
+
+    if (!backend.listen(QHostAddress(parser.value("listen")), parser.value("port").toUShort())) {
+        qCritical() << "❌ Cannot listen:" << backend.errorString();
+        return 1;
+    }
+
+    printf("PORT %d\n", int(backend.port()));
+    fflush(stdout);
+
+    return app.exec();
+}
@@ -0,0 +1,563 @@
+#include "standinbackend.h"
+#include "../src/streammux.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QDateTime>
+#include <QTimer>
+#include <QDebug>
+#include <QtEndian>
+#include <cmath>
+
+StandInBackend::StandInBackend(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_webSocketServer(new QWebSocketServer("StandInBackend", QWebSocketServer::NonSecureMode, this))
+    , m_inferenceDelayMs(0)
+    , m_healthDelayMs(0)
+    , m_jitterMs(0)
+    , m_random(1)
+    , m_errorRate(0.0)
+    , m_failNextCount(0)
+    , m_failNextStatus(500)
+    , m_healthy(true)
+    , m_transcripts({"stand-in transcription"})
+    , m_nextTranscript(0)
+    , m_partialBytes(16000)
+    , m_multiplexing(true)
+    , m_speechDurationMs(400)
+    , m_speechFrameIntervalMs(FRAME_MS)
+    , m_speechJitterMs(0)
+    , m_lastRequestTimeoutMs(-1)
+    , m_speechRequests(0)
+{
+    m_clock.start();
+
+    connect(m_server, &QTcpServer::newConnection, this, &StandInBackend::onNewConnection);
+    connect(m_webSocketServer, &QWebSocketServer::newConnection, this, &StandInBackend::onNewWebSocket);
+}
+
+StandInBackend::~StandInBackend()
+{
+    m_webSocketServer->close();
+    m_server->close();
+}
+
+bool StandInBackend::listen(const QHostAddress &address, quint16 port)
+{
+    return m_server->listen(address, port);
+}
+
+quint16 StandInBackend::port() const
+{
+    return m_server->serverPort();
+}
+
+QString StandInBackend::url() const
+{
+    return QString("http://%1:%2").arg(m_server->serverAddress().toString()).arg(port());
+}
+
+QString StandInBackend::errorString() const
+{
+    return m_server->errorString();
+}
+
+void StandInBackend::failNextRequests(int count, int statusCode)
+{
+    m_failNextCount = count;
+    m_failNextStatus = statusCode;
+}
+
+void StandInBackend::dropConnections()
+{
+    const QList<QTcpSocket*> sockets = m_connections.keys();
+    for (QTcpSocket *socket : sockets) {
+        socket->abort();
+    }
+}
+
+void StandInBackend::setTranscripts(const QStringList &transcripts)
+{
+    m_transcripts = transcripts.isEmpty() ? QStringList({QString()}) : transcripts;
+    m_nextTranscript = 0;
+}
+
+QString StandInBackend::nextTranscript()
+{
+    const QString text = m_transcripts.at(m_nextTranscript);
+    m_nextTranscript = (m_nextTranscript + 1) % m_transcripts.size();
+    return text;
+}
+
+int StandInBackend::delayMs(int base)
+{
+    return base + (m_jitterMs > 0 ? int(m_random.bounded(m_jitterMs + 1)) : 0);
+}
+
+bool StandInBackend::injectFailure()
+{
+    if (m_failNextCount > 0) {
+        --m_failNextCount;
+        return true;
+    }
+    return m_errorRate > 0.0 && m_random.generateDouble() < m_errorRate;
+}
+
+// ============================================================================
+// HTTP
+// ============================================================================
+
+void StandInBackend::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        m_connections.insert(socket, Connection());
+        connect(socket, &QTcpSocket::readyRead, this, &StandInBackend::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &StandInBackend::onDisconnected);
+    }
+}
+
+void StandInBackend::onDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    m_connections.remove(socket);
+    socket->deleteLater();
+}
+
+void StandInBackend::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+
+    // A fresh connection asking for /stream goes to the WebSocket server
+    // with its handshake still unread
+    if (it->buffer.isEmpty() && !it->busy) {
+        const QByteArray head = socket->peek(12);
+        if (head.size() < 12 && QByteArray("GET /stream ").startsWith(head)) {
+            return;
+        }
+        if (head.startsWith("GET /stream ") || head.startsWith("GET /stream?")) {
+            m_connections.erase(it);
+            disconnect(socket, nullptr, this, nullptr);
+            m_webSocketServer->handleConnection(socket);
+            return;
+        }
+    }
+
+    it->buffer += socket->readAll();
+    if (it->buffer.size() > MAX_HEADER_BYTES && !it->buffer.contains("\r\n\r\n")) {
+        socket->abort();
+        return;
+    }
+    processBuffer(socket);
+}
+
+void StandInBackend::processBuffer(QTcpSocket *socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end() || it->busy) {
+        return;
+    }
+
+    Request request;
+    if (takeRequest(it->buffer, &request)) {
+        it->busy = true;
+        handleRequest(socket, request);
+    }
+}
+
+bool StandInBackend::takeRequest(QByteArray &buffer, Request *request) const
+{
+    const qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return false;
+    }
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() < 2) {
+        return false;
+    }
+    request->method = requestLine.at(0);
+    request->target = requestLine.at(1);
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        const qsizetype colon = lines.at(i).indexOf(':');
+        if (colon > 0) {
+            request->headers.insert(lines.at(i).left(colon).trimmed().toLower(),
+                                    lines.at(i).mid(colon + 1).trimmed());
+        }
+    }
+
+    const qsizetype bodyStart = headerEnd + 4;
+    qsizetype end;
+    if (request->headers.value("transfer-encoding").toLower() == "chunked") {
+        if (!decodeChunked(buffer, bodyStart, &end, &request->body)) {
+            return false;
+        }
+    } else {
+        const qsizetype length = request->headers.value("content-length", "0").toLongLong();
+        if (buffer.size() - bodyStart < length) {
+            return false;
+        }
+        request->body = buffer.mid(bodyStart, length);
+        end = bodyStart + length;
+    }
+
+    buffer.remove(0, end);
+    return true;
+}
+
+bool StandInBackend::decodeChunked(const QByteArray &data, qsizetype offset, qsizetype *end, QByteArray *body)
+{
+    body->clear();
+    qsizetype pos = offset;
+    forever {
+        const qsizetype lineEnd = data.indexOf("\r\n", pos);
+        if (lineEnd < 0) {
+            return false;
+        }
+        bool ok;
+        // Chunk extensions after ';' are allowed and ignored
+        const qsizetype size = data.mid(pos, lineEnd - pos).split(';').first().trimmed().toLongLong(&ok, 16);
+        if (!ok) {
+            return false;
+        }
+        pos = lineEnd + 2;
+
+        if (size == 0) {
+            // Skip trailers up to the empty line
+            const qsizetype trailerEnd = data.indexOf("\r\n", pos);
+            if (trailerEnd < 0) {
+                return false;
+            }
+            if (trailerEnd == pos) {
+                *end = pos + 2;
+                return true;
+            }
+            const qsizetype blank = data.indexOf("\r\n\r\n", pos);
+            if (blank < 0) {
+                return false;
+            }
+            *end = blank + 4;
+            return true;
+        }
+
+        if (data.size() < pos + size + 2) {
+            return false;
+        }
+        body->append(data.constData() + pos, size);
+        pos += size + 2;
+    }
+}
+
+void StandInBackend::handleRequest(QTcpSocket *socket, const Request &request)
+{
+    const QUrl target(QString::fromLatin1(request.target));
+    const QString path = target.path();
+    const bool keepAlive = request.headers.value("connection").toLower() != "close";
+    const QByteArray requestId = request.headers.value("x-request-id");
+
+    m_requestCounts[path]++;
+    emit requestReceived(QString::fromLatin1(request.method), path, requestId);
+
+    if (path == "/health") {
+        if (!m_healthy) {
+            respond(socket, 503, R"({"detail":"Stand-in backend marked unhealthy"})", keepAlive, delayMs(m_healthDelayMs));
+            return;
+        }
+        QJsonObject json;
+        json["status"] = "healthy";
+        json["model_loaded"] = true;
+        json["timestamp"] = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+        json["model_name"] = "stand-in";
+        respond(socket, 200, QJsonDocument(json).toJson(QJsonDocument::Compact), keepAlive, delayMs(m_healthDelayMs));
+        return;
+    }
+
+    if (path == "/model/info") {
+        QJsonObject json;
+        json["model_name"] = "stand-in";
+        json["model_path"] = "";
+        json["sample_rate"] = 16000;
+        json["onnx_runtime_version"] = "none";
+        json["num_threads"] = 1;
+        respond(socket, 200, QJsonDocument(json).toJson(QJsonDocument::Compact), keepAlive, delayMs(m_healthDelayMs));
+        return;
+    }
+
+    if (path.startsWith("/cancel/") && request.method == "POST") {
+        const QString id = path.mid(8);
+        m_cancelledRequestIds << id;
+        QJsonObject json;
+        json["request_id"] = id;
+        json["cancelled"] = true;
+        respond(socket, 200, QJsonDocument(json).toJson(QJsonDocument::Compact), keepAlive, 0);
+        return;
+    }
+
+    if (path.startsWith("/transcribe") && request.method == "POST") {
+        qint64 audioBytes = request.body.size();
+        QString language = QString::fromUtf8(request.headers.value("x-language", "en"));
+        m_lastRequestTimeoutMs = request.headers.value("x-request-timeout-ms", "-1").toLongLong();
+
+        if (path == "/transcribe/base64") {
+            const QJsonObject json = QJsonDocument::fromJson(request.body).object();
+            if (!json.contains("audio_base64")) {
+                respond(socket, 422, R"({"detail":"audio_base64 is required"})", keepAlive, 0);
+                return;
+            }
+            audioBytes = QByteArray::fromBase64(json["audio_base64"].toString().toLatin1()).size();
+            language = json["language"].toString("en");
+        } else if (path == "/transcribe") {
+            language = QUrlQuery(target).queryItemValue("language");
+            if (language.isEmpty()) {
+                language = "en";
+            }
+        } else if (path != "/transcribe/raw" && path != "/transcribe/stream") {
+            respond(socket, 404, R"({"detail":"Not Found"})", keepAlive, 0);
+            return;
+        }
+
+        const int delay = delayMs(m_inferenceDelayMs);
+        if (injectFailure()) {
+            respond(socket, m_failNextStatus, R"({"detail":"Injected failure"})", keepAlive, delay);
+            return;
+        }
+        respond(socket, 200, transcriptionResponse(audioBytes, language, delay), keepAlive, delay);
+        return;
+    }
+
+    respond(socket, 404, R"({"detail":"Not Found"})", keepAlive, 0);
+}
+
+QByteArray StandInBackend::transcriptionResponse(qint64 audioBytes, const QString &language, int delayMs)
+{
+    // 16 kHz mono s16le, like the client sends
+    const double duration = audioBytes / 32000.0;
+    const double inferenceTime = delayMs / 1000.0;
+
+    QJsonObject json;
+    json["text"] = nextTranscript();
+    json["language"] = language;
+    json["duration"] = duration;
+    json["inference_time"] = inferenceTime;
+    json["total_time"] = inferenceTime;
+    json["rtf"] = duration > 0 ? inferenceTime / duration : 0.0;
+    json["timestamp"] = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+void StandInBackend::respond(QTcpSocket *socket, int statusCode, const QByteArray &json, bool keepAlive, int delayMs)
+{
+    QTimer::singleShot(delayMs, socket, [this, socket, statusCode, json, keepAlive]() {
+        static const QHash<int, QByteArray> reasons = {
+            {200, "OK"}, {404, "Not Found"}, {415, "Unsupported Media Type"},
+            {422, "Unprocessable Entity"}, {500, "Internal Server Error"},
+            {502, "Bad Gateway"}, {503, "Service Unavailable"}
+        };
+
+        QByteArray response = "HTTP/1.1 " + QByteArray::number(statusCode) + ' '
+                            + reasons.value(statusCode, "Error") + "\r\n";
+        response += "Content-Type: application/json\r\n";
+        response += "Content-Length: " + QByteArray::number(json.size()) + "\r\n";
+        response += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+        response += json;
+        socket->write(response);
+
+        if (!keepAlive) {
+            socket->disconnectFromHost();
+            return;
+        }
+
+        auto it = m_connections.find(socket);
+        if (it != m_connections.end()) {
+            it->busy = false;
+            processBuffer(socket);
+        }
+    });
+}
+
+// ============================================================================
+// /stream WebSocket
+// ============================================================================
+
+void StandInBackend::onNewWebSocket()
+{
+    while (QWebSocket *socket = m_webSocketServer->nextPendingConnection()) {
+        StreamSession session;
+        const QUrlQuery query(socket->requestUrl());
+        session.deltaPartials = query.queryItemValue("partials") == "delta";
+        session.multiplexed = m_multiplexing && query.queryItemValue("mux") == "1";
+        session.words = nextTranscript().split(' ', Qt::SkipEmptyParts);
+        session.nextPartialAt = m_partialBytes;
+        m_streams.insert(socket, session);
+        m_requestCounts["/stream"]++;
+        emit streamOpened(session.deltaPartials);
+
+        if (session.multiplexed) {
+            socket->sendTextMessage(QString(R"({"type":"ready","mux":%1})").arg(StreamMux::VERSION));
+        }
+
+        connect(socket, &QWebSocket::binaryMessageReceived, this, [this, socket](const QByteArray &data) {
+            onStreamBinary(socket, data);
+        });
+        connect(socket, &QWebSocket::textMessageReceived, this, [this, socket](const QString &message) {
+            onStreamText(socket, message);
+        });
+        connect(socket, &QWebSocket::disconnected, this, [this, socket]() {
+            m_streams.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void StandInBackend::onStreamBinary(QWebSocket *socket, const QByteArray &data)
+{
+    auto it = m_streams.find(socket);
+    if (it == m_streams.end()) {
+        return;
+    }
+
+    if (it->multiplexed) {
+        StreamMux::Frame frame;
+        if (!StreamMux::decode(data, &frame) || frame.channel != StreamMux::SpeechToText) {
+            return;
+        }
+        it->bytes += frame.payload.size();
+    } else {
+        it->bytes += data.size();
+    }
+    emit streamAudioReceived(it->bytes);
+
+    while (it->bytes >= it->nextPartialAt) {
+        it->nextPartialAt += m_partialBytes;
+
+        // Keep results in order even when jitter would reorder the timers
+        const qint64 now = m_clock.elapsed();
+        const qint64 sendAt = qMax(now + delayMs(m_inferenceDelayMs), it->lastSendMs);
+        it->lastSendMs = sendAt;
+
+        const int generation = it->generation;
+        QTimer::singleShot(int(sendAt - now), socket, [this, socket, generation]() {
+            auto session = m_streams.find(socket);
+            if (session != m_streams.end() && session->generation == generation) {
+                sendPartial(socket);
+            }
+        });
+    }
+}
+
+void StandInBackend::onStreamText(QWebSocket *socket, const QString &message)
+{
+    auto it = m_streams.find(socket);
+    if (it == m_streams.end()) {
+        return;
+    }
+
+    const QJsonObject json = QJsonDocument::fromJson(message.toUtf8()).object();
+    const QString type = json.value("type").toString();
+    if (it->multiplexed && type == "tts") {
+        startSpeech(socket, quint32(json.value("stream").toDouble()), json.value("text").toString());
+    } else if (it->multiplexed && type == "tts_cancel") {
+        const quint32 stream = quint32(json.value("stream").toDouble());
+        m_cancelledSpeech << stream;
+        it->speech.remove(stream);
+    } else if (type == "cancel") {
+        it->generation++;
+        it->revealed = 0;
+        it->bytes = 0;
+        it->nextPartialAt = m_partialBytes;
+        it->lastSendMs = 0;
+        socket->sendTextMessage(QString(R"({"type":"cancelled","timestamp":%1})")
+                                .arg(QDateTime::currentMSecsSinceEpoch() / 1000.0, 0, 'f', 3));
+    }
+}
+
+void StandInBackend::sendPartial(QWebSocket *socket)
+{
+    StreamSession &session = m_streams[socket];
+    const double timestamp = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+
+    if (session.revealed >= session.words.size()) {
+        // Utterance complete: final, then the next scripted transcript
+        QJsonObject json;
+        json["type"] = "final";
+        json["text"] = session.words.join(' ');
+        json["timestamp"] = timestamp;
+        socket->sendTextMessage(QString::fromUtf8(QJsonDocument(json).toJson(QJsonDocument::Compact)));
+
+        session.words = nextTranscript().split(' ', Qt::SkipEmptyParts);
+        session.revealed = 0;
+        return;
+    }
+
+    // Everything but the newest word is committed
+    session.revealed++;
+    const QString hypothesis = session.words.mid(0, session.revealed).join(' ');
+    const int stable = session.revealed > 1 ? int(session.words.mid(0, session.revealed - 1).join(' ').size()) : 0;
+
+    QJsonObject json;
+    json["type"] = "partial";
+    if (session.deltaPartials) {
+        json["stable"] = stable;
+        json["text"] = hypothesis.mid(stable);
+    } else {
+        json["text"] = hypothesis;
+    }
+    json["timestamp"] = timestamp;
+    socket->sendTextMessage(QString::fromUtf8(QJsonDocument(json).toJson(QJsonDocument::Compact)));
+}
+
+void StandInBackend::startSpeech(QWebSocket *socket, quint32 stream, const QString &text)
+{
+    ++m_speechRequests;
+    if (text.trimmed().isEmpty()) {
+        socket->sendTextMessage(QString(R"({"type":"tts_failed","channel":2,"stream":%1,"message":"empty text"})")
+                                .arg(stream));
+        return;
+    }
+
+    m_streams[socket].speech.insert(stream, 0);
+    socket->sendTextMessage(QString(R"({"type":"tts_started","channel":2,"stream":%1,"sampleRate":%2,"channels":1})")
+                            .arg(stream).arg(SPEECH_SAMPLE_RATE));
+    sendSpeechFrame(socket, stream, qMax(1, m_speechDurationMs / FRAME_MS));
+}
+
+void StandInBackend::sendSpeechFrame(QWebSocket *socket, quint32 stream, int frames)
+{
+    auto session = m_streams.find(socket);
+    if (session == m_streams.end() || !session->speech.contains(stream)) {
+        return; // cancelled
+    }
+
+    // A 220 Hz tone, continuous across frames
+    const int sent = session->speech.value(stream);
+    const int samples = SPEECH_SAMPLE_RATE * FRAME_MS / 1000;
+    QByteArray pcm(samples * 2, Qt::Uninitialized);
+    for (int i = 0; i < samples; ++i) {
+        const double t = double(sent * samples + i) / SPEECH_SAMPLE_RATE;
+        qToLittleEndian<qint16>(qint16(8000 * std::sin(2 * M_PI * 220 * t)), pcm.data() + i * 2);
+    }
+
+    const bool last = sent + 1 == frames;
+    socket->sendBinaryMessage(StreamMux::encode(StreamMux::TextToSpeech, stream, quint16(sent), pcm,
+                                                last ? StreamMux::End : 0));
+    if (last) {
+        session->speech.remove(stream);
+        return;
+    }
+    session->speech[stream] = sent + 1;
+
+    const int interval = m_speechFrameIntervalMs
+                       + (m_speechJitterMs > 0 ? int(m_random.bounded(m_speechJitterMs + 1)) : 0);
+    QTimer::singleShot(interval, socket, [this, socket, stream, frames]() {
+        sendSpeechFrame(socket, stream, frames);
+    });
+}
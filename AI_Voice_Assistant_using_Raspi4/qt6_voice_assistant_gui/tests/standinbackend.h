@@ -0,0 +1,165 @@
+#ifndef STANDINBACKEND_H
+#define STANDINBACKEND_H
+
+#include <QObject>
+#include <QHash>
+#include <QHostAddress>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QElapsedTimer>
+
+class QTcpServer;
+class QTcpSocket;
+class QWebSocketServer;
+class QWebSocket;
+
+/**
+ * @brief Deterministic stand-in for the Whisper backend, for end-to-end tests
+ *
+ * Serves /health, /model/info, /transcribe, /transcribe/base64,
+ * /transcribe/raw, /transcribe/stream, /cancel/{id} and the /stream
+ * WebSocket with the same JSON the FastAPI backend returns, but without a
+ * model. Transcripts come from a script, every response waits a configured
+ * delay plus seeded jitter, and failures are injected on request, so client
+ * latency can be measured and regression-tested on a box with no model and
+ * no network.
+ *
+ * /stream reveals the current transcript one word per partialBytes() of
+ * audio (as deltas when the client asks for ?partials=delta), sends a final
+ * once every word is out and moves on to the next transcript.
+ *
+ * A client that asks for ?mux=1 is told the session is multiplexed (unless
+ * setMultiplexing(false) plays an older server): its audio then comes in
+ * StreamMux frames, and "tts" requests are answered on the speech channel
+ * with a tone, paced out in FRAME_MS frames every speechFrameIntervalMs()
+ * plus seeded jitter.
+ */
+class StandInBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StandInBackend(QObject *parent = nullptr);
+    ~StandInBackend();
+
+    bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 0);
+    quint16 port() const;
+    QString url() const;
+    QString errorString() const;
+
+    // Timing: every response waits delay + uniform [0, jitter] ms
+    void setInferenceDelay(int ms) { m_inferenceDelayMs = ms; }
+    void setHealthDelay(int ms) { m_healthDelayMs = ms; }
+    void setJitter(int ms) { m_jitterMs = ms; }
+    void setSeed(quint32 seed) { m_random.seed(seed); }
+
+    // Failure injection (transcription endpoints only)
+    void setErrorRate(double rate) { m_errorRate = rate; }
+    void failNextRequests(int count, int statusCode = 500);
+    void setHealthy(bool healthy) { m_healthy = healthy; }
+    void dropConnections(); // aborts every open HTTP connection, uploads in flight included
+
+    // Scripted output, returned in order and cycled
+    void setTranscripts(const QStringList &transcripts);
+    void setPartialBytes(int bytes) { m_partialBytes = qMax(1, bytes); }
+    int partialBytes() const { return m_partialBytes; }
+
+    // Speech over a multiplexed /stream session
+    void setMultiplexing(bool enabled) { m_multiplexing = enabled; }
+    void setSpeechDurationMs(int ms) { m_speechDurationMs = ms; }
+    void setSpeechFrameInterval(int ms) { m_speechFrameIntervalMs = ms; }
+    void setSpeechJitter(int ms) { m_speechJitterMs = ms; }
+
+    // Observations
+    int requestCount(const QString &path) const { return m_requestCounts.value(path); }
+    QStringList cancelledRequestIds() const { return m_cancelledRequestIds; }
+    qint64 lastRequestTimeoutMs() const { return m_lastRequestTimeoutMs; } // X-Request-Timeout-Ms, -1 if absent
+    int speechRequestCount() const { return m_speechRequests; }
+    QList<quint32> cancelledSpeechStreams() const { return m_cancelledSpeech; }
+
+signals:
+    void requestReceived(const QString &method, const QString &path, const QByteArray &requestId);
+    void streamOpened(bool deltaPartials);
+    void streamAudioReceived(qint64 totalBytes);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void onNewWebSocket();
+
+private:
+    struct Request {
+        QByteArray method;
+        QByteArray target;
+        QHash<QByteArray, QByteArray> headers; // lower-case names
+        QByteArray body;
+    };
+
+    struct Connection {
+        QByteArray buffer;
+        bool busy = false; // response scheduled; later requests wait in buffer
+    };
+
+    struct StreamSession {
+        bool deltaPartials = false;
+        QStringList words;
+        int revealed = 0;
+        qint64 bytes = 0;
+        qint64 nextPartialAt = 0;
+        qint64 lastSendMs = 0;
+        int generation = 0; // bumped on cancel so scheduled partials are dropped
+        bool multiplexed = false;
+        QHash<quint32, int> speech; // stream -> frames sent
+    };
+
+    void processBuffer(QTcpSocket *socket);
+    bool takeRequest(QByteArray &buffer, Request *request) const;
+    static bool decodeChunked(const QByteArray &data, qsizetype offset, qsizetype *end, QByteArray *body);
+    void handleRequest(QTcpSocket *socket, const Request &request);
+    QByteArray transcriptionResponse(qint64 audioBytes, const QString &language, int delayMs);
+    void respond(QTcpSocket *socket, int statusCode, const QByteArray &json, bool keepAlive, int delayMs);
+    bool injectFailure();
+    int delayMs(int base);
+    QString nextTranscript();
+
+    void onStreamBinary(QWebSocket *socket, const QByteArray &data);
+    void onStreamText(QWebSocket *socket, const QString &message);
+    void sendPartial(QWebSocket *socket);
+    void startSpeech(QWebSocket *socket, quint32 stream, const QString &text);
+    void sendSpeechFrame(QWebSocket *socket, quint32 stream, int frames);
+
+    QTcpServer *m_server;
+    QWebSocketServer *m_webSocketServer;
+    QHash<QTcpSocket*, Connection> m_connections;
+    QHash<QWebSocket*, StreamSession> m_streams;
+    QElapsedTimer m_clock;
+
+    int m_inferenceDelayMs;
+    int m_healthDelayMs;
+    int m_jitterMs;
+    QRandomGenerator m_random;
+    double m_errorRate;
+    int m_failNextCount;
+    int m_failNextStatus;
+    bool m_healthy;
+    QStringList m_transcripts;
+    int m_nextTranscript;
+    int m_partialBytes;
+    bool m_multiplexing;
+    int m_speechDurationMs;
+    int m_speechFrameIntervalMs;
+    int m_speechJitterMs;
+
+    QHash<QString, int> m_requestCounts;
+    QStringList m_cancelledRequestIds;
+    qint64 m_lastRequestTimeoutMs;
+    int m_speechRequests;
+    QList<quint32> m_cancelledSpeech;
+
+    static constexpr qsizetype MAX_HEADER_BYTES = 64 * 1024;
+    static constexpr int SPEECH_SAMPLE_RATE = 16000;
+    static constexpr int FRAME_MS = 20;
+};
+
+#endif // STANDINBACKEND_H
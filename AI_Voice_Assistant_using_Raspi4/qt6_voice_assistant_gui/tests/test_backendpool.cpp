@@ -0,0 +1,205 @@
+#include <QtTest/QtTest>
+#include "../src/backendpool.h"
+
+class TestBackendPool : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void init();
+    void cleanup();
+    
+    // Test cases
+    void testSetUrls();
+    void testKeepsStatisticsAcrossUpdates();
+    void testPrefersFasterBackend();
+    void testInFlightShiftsLoad();
+    void testLeastLoadedPolicy();
+    void testConnectFailureFailsOver();
+    void testProbeRestoresBackend();
+    void testAllDownStillReturnsBackend();
+    void testExcludeList();
+    void testBreakerOpensAfterFailureStreak();
+    void testHalfOpenRequestsProbe();
+    void testFailedTrialBacksOff();
+    void testSnapshot();
+    
+private:
+    BackendPool *pool;
+};
+
+void TestBackendPool::init()
+{
+    pool = new BackendPool(this);
+    pool->setUrls({"http://edge:8000", "https://remote.example.com/"});
+}
+
+void TestBackendPool::cleanup()
+{
+    delete pool;
+    pool = nullptr;
+}
+
+void TestBackendPool::testSetUrls()
+{
+    QCOMPARE(pool->size(), 2);
+    QCOMPARE(pool->urls(), QStringList({"http://edge:8000", "https://remote.example.com"}));
+    
+    QSignalSpy spy(pool, &BackendPool::backendsChanged);
+    pool->setUrls({"http://edge:8000", "  ", ""});
+    
+    QCOMPARE(pool->size(), 1);
+    QCOMPARE(spy.count(), 1);
+    
+    QCOMPARE(BackendPool::normalize({" http://edge:8000// ", "", "http://other:8000"}),
+             QStringList({"http://edge:8000", "http://other:8000"}));
+}
+
+void TestBackendPool::testKeepsStatisticsAcrossUpdates()
+{
+    pool->recordProbe("http://edge:8000", true, 12);
+    pool->setUrls({"http://other:8000", "http://edge:8000"});
+    
+    QVariantMap edge = pool->backends().at(1).toMap();
+    QCOMPARE(edge["url"].toString(), QString("http://edge:8000"));
+    QCOMPARE(edge["latencyMs"].toDouble(), 12.0);
+}
+
+void TestBackendPool::testPrefersFasterBackend()
+{
+    pool->recordProbe("http://edge:8000", true, 5);
+    pool->recordProbe("https://remote.example.com", true, 80);
+    QCOMPARE(pool->select(), QString("http://edge:8000"));
+    
+    // Slow inference on the edge outweighs its short network path
+    pool->requestStarted("http://edge:8000");
+    pool->requestFinished("http://edge:8000", true, 6000, 3000);
+    pool->requestStarted("https://remote.example.com");
+    pool->requestFinished("https://remote.example.com", true, 900, 3000);
+    
+    QCOMPARE(pool->select(), QString("https://remote.example.com"));
+}
+
+void TestBackendPool::testInFlightShiftsLoad()
+{
+    pool->recordProbe("http://edge:8000", true, 20);
+    pool->recordProbe("https://remote.example.com", true, 30);
+    QCOMPARE(pool->select(), QString("http://edge:8000"));
+    
+    pool->requestStarted("http://edge:8000");
+    QCOMPARE(pool->select(), QString("https://remote.example.com"));
+    
+    pool->requestCancelled("http://edge:8000");
+    QCOMPARE(pool->select(), QString("http://edge:8000"));
+}
+
+void TestBackendPool::testLeastLoadedPolicy()
+{
+    pool->setRoutingPolicy(BackendPool::LeastLoaded);
+    pool->recordProbe("http://edge:8000", true, 5);
+    pool->recordProbe("https://remote.example.com", true, 500);
+    
+    pool->requestStarted("http://edge:8000");
+    QCOMPARE(pool->select(), QString("https://remote.example.com"));
+    
+    pool->requestStarted("https://remote.example.com");
+    QCOMPARE(pool->select(), QString("http://edge:8000"));
+}
+
+void TestBackendPool::testConnectFailureFailsOver()
+{
+    pool->recordProbe("http://edge:8000", true, 5);
+    pool->recordProbe("https://remote.example.com", true, 80);
+    
+    pool->connectFailed("http://edge:8000");
+    
+    QCOMPARE(pool->select(), QString("https://remote.example.com"));
+    QVERIFY(pool->hasHealthyBackend());
+}
+
+void TestBackendPool::testProbeRestoresBackend()
+{
+    pool->connectFailed("http://edge:8000");
+    pool->recordProbe("http://edge:8000", true, 5);
+    pool->recordProbe("https://remote.example.com", true, 80);
+    
+    QCOMPARE(pool->select(), QString("http://edge:8000"));
+}
+
+void TestBackendPool::testAllDownStillReturnsBackend()
+{
+    pool->connectFailed("http://edge:8000");
+    pool->connectFailed("https://remote.example.com");
+    
+    QVERIFY(!pool->hasHealthyBackend());
+    QCOMPARE(pool->select(), QString("http://edge:8000"));
+}
+
+void TestBackendPool::testExcludeList()
+{
+    QCOMPARE(pool->select({"http://edge:8000"}), QString("https://remote.example.com"));
+    QVERIFY(pool->select(pool->urls()).isEmpty());
+}
+
+void TestBackendPool::testBreakerOpensAfterFailureStreak()
+{
+    pool->requestFinished("http://edge:8000", false, 100, 0);
+    pool->requestFinished("http://edge:8000", false, 100, 0);
+    QCOMPARE(pool->breakerState("http://edge:8000"), BackendPool::Closed);
+    
+    pool->requestFinished("http://edge:8000", false, 100, 0);
+    QCOMPARE(pool->breakerState("http://edge:8000"), BackendPool::Open);
+    QCOMPARE(pool->select(), QString("https://remote.example.com"));
+}
+
+void TestBackendPool::testHalfOpenRequestsProbe()
+{
+    QSignalSpy spy(pool, &BackendPool::probeRequested);
+    
+    pool->connectFailed("http://edge:8000");
+    QCOMPARE(pool->breakerState("http://edge:8000"), BackendPool::Open);
+    
+    QVERIFY(spy.wait(2000));
+    QCOMPARE(spy.at(0).at(0).toString(), QString("http://edge:8000"));
+    QCOMPARE(pool->breakerState("http://edge:8000"), BackendPool::HalfOpen);
+    
+    // Half-open backends get no regular traffic
+    QCOMPARE(pool->select(), QString("https://remote.example.com"));
+    
+    pool->recordProbe("http://edge:8000", true, 5);
+    QCOMPARE(pool->breakerState("http://edge:8000"), BackendPool::Closed);
+}
+
+void TestBackendPool::testFailedTrialBacksOff()
+{
+    QSignalSpy spy(pool, &BackendPool::probeRequested);
+    QElapsedTimer timer;
+    
+    pool->connectFailed("http://edge:8000");
+    QVERIFY(spy.wait(2000));
+    
+    // Failed trial: the next probe comes after twice the cooldown
+    timer.start();
+    pool->recordProbe("http://edge:8000", false, 0);
+    QCOMPARE(pool->breakerState("http://edge:8000"), BackendPool::Open);
+    QVERIFY(spy.wait(3000));
+    QVERIFY(timer.elapsed() >= 900);
+}
+
+void TestBackendPool::testSnapshot()
+{
+    pool->requestStarted("http://edge:8000");
+    pool->requestFinished("http://edge:8000", false, 100, 0);
+    
+    QVariantMap edge = pool->backends().at(0).toMap();
+    QCOMPARE(edge["requests"].toInt(), 1);
+    QCOMPARE(edge["errors"].toInt(), 1);
+    QCOMPARE(edge["inFlight"].toInt(), 0);
+    QVERIFY(edge["errorRate"].toDouble() > 0.0);
+    
+    QVariantMap remote = pool->backends().at(1).toMap();
+    QVERIFY(remote["preferred"].toBool());
+}
+
+QTEST_MAIN(TestBackendPool)
+#include "test_backendpool.moc"
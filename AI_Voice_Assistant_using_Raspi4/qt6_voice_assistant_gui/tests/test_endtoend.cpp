@@ -0,0 +1,485 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include "../src/networkmanager.h"
+#include "standinbackend.h"
+
+/**
+ * End-to-end tests: NetworkManager against an in-process StandInBackend
+ *
+ * Everything runs over loopback with scripted transcripts and fixed delays,
+ * so timings are the client's own overhead plus the configured delay.
+ */
+class TestEndToEnd : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    // Test cases
+    void testHealthCheck();
+    void testRawTranscriptionLatency();
+    void testBase64TranscriptionScript();
+    void testInjectedFailureReported();
+    void testFailoverToSecondBackend();
+    void testBackendUrlsComparedNormalized();
+    void testDeadlineHeaderSent();
+    void testDeadlineRetriesOnAnotherBackend();
+    void testDeadlineExceededReported();
+    void testLocalConnectErrorAfterBegin();
+    void testStreamingFailoverAcrossDeadLocalBackends();
+    void testStreamingDeadlineExceeded();
+    void testProgressiveUploadKilledMidCapture();
+    void testStreamingDeltaPartials();
+    void testStreamCancel();
+    void testDuplexSession();
+    void testLegacyServerNotMultiplexed();
+    void benchmarkRawRoundTrip();
+
+private:
+    static QByteArray makePcm(int ms);
+
+    StandInBackend *backend;
+    NetworkManager *network;
+};
+
+QByteArray TestEndToEnd::makePcm(int ms)
+{
+    // 16 kHz mono s16le
+    return QByteArray(ms * 32, '\0');
+}
+
+void TestEndToEnd::init()
+{
+    backend = new StandInBackend(this);
+    QVERIFY2(backend->listen(), qPrintable(backend->errorString()));
+
+    network = new NetworkManager(this);
+    network->setBackendUrl(backend->url());
+}
+
+void TestEndToEnd::cleanup()
+{
+    delete network;
+    network = nullptr;
+    delete backend;
+    backend = nullptr;
+}
+
+void TestEndToEnd::testHealthCheck()
+{
+    backend->setHealthDelay(50);
+    QSignalSpy spy(network, &NetworkManager::healthCheckResult);
+
+    network->checkHealth();
+    QVERIFY(spy.wait(2000));
+
+    QVERIFY(spy.last().at(0).toBool());
+    QVERIFY(network->isHealthy());
+    QVERIFY(backend->requestCount("/health") >= 1);
+
+    backend->setHealthy(false);
+    network->checkHealth();
+    QVERIFY(spy.wait(2000));
+    QVERIFY(!spy.last().at(0).toBool());
+}
+
+void TestEndToEnd::testRawTranscriptionLatency()
+{
+    backend->setInferenceDelay(150);
+    backend->setTranscripts({"turn on the lights"});
+    QSignalSpy spy(network, &NetworkManager::transcriptionReceived);
+    QElapsedTimer timer;
+
+    timer.start();
+    quint64 requestId = network->transcribeRaw(makePcm(1000));
+    QVERIFY(spy.wait(3000));
+
+    QCOMPARE(spy.at(0).at(0).toString(), QString("turn on the lights"));
+    QCOMPARE(spy.at(0).at(1).toDouble(), 1.0);
+    QCOMPARE(spy.at(0).at(4).toULongLong(), requestId);
+    QVERIFY(timer.elapsed() >= 150);
+    QCOMPARE(backend->requestCount("/transcribe/raw"), 1);
+}
+
+void TestEndToEnd::testBase64TranscriptionScript()
+{
+    backend->setTranscripts({"first", "second"});
+    QSignalSpy spy(network, &NetworkManager::transcriptionReceived);
+
+    network->transcribeBase64(makePcm(500));
+    QVERIFY(spy.wait(3000));
+    network->transcribeBase64(makePcm(500));
+    QVERIFY(spy.wait(3000));
+
+    QCOMPARE(spy.at(0).at(0).toString(), QString("first"));
+    QCOMPARE(spy.at(1).at(0).toString(), QString("second"));
+    QCOMPARE(spy.at(0).at(1).toDouble(), 0.5);
+}
+
+void TestEndToEnd::testInjectedFailureReported()
+{
+    backend->failNextRequests(1);
+    QSignalSpy errorSpy(network, &NetworkManager::errorOccurred);
+    QSignalSpy resultSpy(network, &NetworkManager::transcriptionReceived);
+
+    quint64 requestId = network->transcribeRaw(makePcm(200));
+    QTRY_VERIFY_WITH_TIMEOUT(!errorSpy.isEmpty(), 3000);
+
+    QCOMPARE(errorSpy.last().at(2).toULongLong(), requestId);
+    QVERIFY(resultSpy.isEmpty());
+
+    // Only the next request was failed
+    network->transcribeRaw(makePcm(200));
+    QVERIFY(resultSpy.wait(3000));
+}
+
+void TestEndToEnd::testFailoverToSecondBackend()
+{
+    // A port nothing listens on any more refuses the connection
+    StandInBackend *gone = new StandInBackend;
+    QVERIFY(gone->listen());
+    const QString deadUrl = gone->url();
+    delete gone;
+
+    network->setBackendUrls({deadUrl, backend->url()});
+    QSignalSpy spy(network, &NetworkManager::transcriptionReceived);
+
+    network->transcribeRaw(makePcm(200));
+    QVERIFY(spy.wait(5000));
+
+    QCOMPARE(backend->requestCount("/transcribe/raw"), 1);
+    QCOMPARE(network->backendPool()->breakerState(deadUrl), BackendPool::Open);
+}
+
+void TestEndToEnd::testBackendUrlsComparedNormalized()
+{
+    QSignalSpy urlsSpy(network, &NetworkManager::backendUrlsChanged);
+
+    // The URL the pool already holds, spelt differently, is no change
+    network->setBackendUrls({" " + backend->url() + "/ "});
+    QCOMPARE(urlsSpy.count(), 0);
+    QCOMPARE(network->backendUrls(), QStringList({backend->url()}));
+
+    // Nothing usable leaves the pool as it was
+    network->setBackendUrls({"", "  /"});
+    QCOMPARE(urlsSpy.count(), 0);
+    QCOMPARE(network->backendUrls(), QStringList({backend->url()}));
+}
+
+void TestEndToEnd::testDeadlineHeaderSent()
+{
+    QSignalSpy spy(network, &NetworkManager::transcriptionReceived);
+
+    // No speed observed yet: real time, doubled, plus slack, raised to the floor
+    network->transcribeRaw(makePcm(1000));
+    QVERIFY(spy.wait(3000));
+    QCOMPARE(backend->lastRequestTimeoutMs(), qint64(network->deadlineFloorMs()));
+
+    // Once the backend has answered, its observed speed sets the budget
+    network->setDeadlineFloorMs(0);
+    network->transcribeRaw(makePcm(1000));
+    QVERIFY(spy.wait(3000));
+    QVERIFY(backend->lastRequestTimeoutMs() >= 500);
+    QVERIFY(backend->lastRequestTimeoutMs() < 2500);
+}
+
+void TestEndToEnd::testDeadlineRetriesOnAnotherBackend()
+{
+    StandInBackend *slow = new StandInBackend(this);
+    QVERIFY(slow->listen());
+    slow->setInferenceDelay(3000);
+    slow->setTranscripts({"too late"});
+    backend->setTranscripts({"in time"});
+
+    network->setDeadlineFloorMs(300);
+    network->setBackendUrls({slow->url(), backend->url()});
+    QSignalSpy resultSpy(network, &NetworkManager::transcriptionReceived);
+    QSignalSpy errorSpy(network, &NetworkManager::errorOccurred);
+    QElapsedTimer timer;
+
+    timer.start();
+    network->transcribeRaw(makePcm(100));
+    QVERIFY(resultSpy.wait(3000));
+
+    QCOMPARE(resultSpy.at(0).at(0).toString(), QString("in time"));
+    QVERIFY(timer.elapsed() < 2000);
+    QVERIFY(errorSpy.isEmpty());
+    QCOMPARE(slow->requestCount("/transcribe/raw"), 1);
+    QCOMPARE(backend->requestCount("/transcribe/raw"), 1);
+
+    delete slow;
+}
+
+void TestEndToEnd::testDeadlineExceededReported()
+{
+    backend->setInferenceDelay(3000);
+    network->setDeadlineFloorMs(300);
+    QSignalSpy errorSpy(network, &NetworkManager::errorOccurred);
+    QSignalSpy resultSpy(network, &NetworkManager::transcriptionReceived);
+    QElapsedTimer timer;
+
+    timer.start();
+    quint64 requestId = network->transcribeRaw(makePcm(100));
+    QTRY_VERIFY_WITH_TIMEOUT(!errorSpy.isEmpty(), 3000);
+
+    // Reported once, as a missed deadline, long before the backend would answer
+    QVERIFY(timer.elapsed() < 2000);
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(errorSpy.at(0).at(0).toString(), QString("Deadline Exceeded"));
+    QCOMPARE(errorSpy.at(0).at(2).toULongLong(), requestId);
+    QVERIFY(resultSpy.isEmpty());
+}
+
+void TestEndToEnd::testLocalConnectErrorAfterBegin()
+{
+    QTemporaryDir dir;
+    network->setBackendUrls({"unix://" + dir.filePath("missing.sock")});
+    QSignalSpy errorSpy(network, &NetworkManager::errorOccurred);
+
+    // QLocalSocket finds no server inside connectToServer(); the error must
+    // still come after the caller has the request id to match it against
+    const quint64 requestId = network->beginStreamingTranscription();
+    QVERIFY(errorSpy.isEmpty());
+
+    QTRY_COMPARE_WITH_TIMEOUT(errorSpy.count(), 1, 3000);
+    QCOMPARE(errorSpy.at(0).at(2).toULongLong(), requestId);
+}
+
+void TestEndToEnd::testStreamingFailoverAcrossDeadLocalBackends()
+{
+    QTemporaryDir dir;
+    const QString first = "unix://" + dir.filePath("first.sock");
+    const QString second = "unix://" + dir.filePath("second.sock");
+    QSignalSpy errorSpy(network, &NetworkManager::errorOccurred);
+    QSignalSpy resultSpy(network, &NetworkManager::transcriptionReceived);
+
+    // Two hops, each failing inside start(); the audio survives both
+    network->setBackendUrls({first, second, backend->url()});
+    network->beginStreamingTranscription();
+    network->appendStreamingAudio(makePcm(300));
+    network->appendStreamingAudio(makePcm(200));
+    network->finishStreamingTranscription();
+    QVERIFY(resultSpy.wait(3000));
+    QCOMPARE(resultSpy.at(0).at(1).toDouble(), 0.5);
+    QCOMPARE(backend->requestCount("/transcribe/stream"), 1);
+    QVERIFY(errorSpy.isEmpty());
+
+    // Nowhere left to go: one error, for this request
+    network->setBackendUrls({first, second});
+    const quint64 requestId = network->beginStreamingTranscription();
+    network->appendStreamingAudio(makePcm(100));
+    network->finishStreamingTranscription();
+    QTRY_COMPARE_WITH_TIMEOUT(errorSpy.count(), 1, 3000);
+    QCOMPARE(errorSpy.at(0).at(2).toULongLong(), requestId);
+    QTest::qWait(100);
+    QCOMPARE(errorSpy.count(), 1);
+}
+
+void TestEndToEnd::testStreamingDeadlineExceeded()
+{
+    // Accepts the upload, then sits on it
+    backend->setInferenceDelay(3000);
+    network->setDeadlineFloorMs(300);
+    QSignalSpy errorSpy(network, &NetworkManager::errorOccurred);
+    QSignalSpy resultSpy(network, &NetworkManager::transcriptionReceived);
+    QElapsedTimer timer;
+
+    const quint64 requestId = network->beginStreamingTranscription();
+    network->appendStreamingAudio(makePcm(100));
+    QTest::qWait(200);
+    timer.start();
+    network->finishStreamingTranscription();
+    QTRY_VERIFY_WITH_TIMEOUT(!errorSpy.isEmpty(), 3000);
+
+    // Counted from the end of the body, once its length is known
+    QVERIFY(timer.elapsed() < 2000);
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(errorSpy.at(0).at(0).toString(), QString("Deadline Exceeded"));
+    QCOMPARE(errorSpy.at(0).at(2).toULongLong(), requestId);
+    QVERIFY(backend->lastRequestTimeoutMs() > 0);
+    QVERIFY(resultSpy.isEmpty());
+}
+
+void TestEndToEnd::testProgressiveUploadKilledMidCapture()
+{
+    backend->setTranscripts({"open the window"});
+    QSignalSpy errorSpy(network, &NetworkManager::errorOccurred);
+    QSignalSpy resultSpy(network, &NetworkManager::transcriptionReceived);
+
+    // Half the utterance is on its way when the connection dies
+    const QByteArray captured = makePcm(600);
+    const quint64 progressiveId = network->beginStreamingTranscription();
+    network->appendStreamingAudio(captured.left(captured.size() / 2));
+    QTest::qWait(200);
+    backend->dropConnections();
+
+    // Reported against the upload's id while the user is still speaking
+    QTRY_COMPARE_WITH_TIMEOUT(errorSpy.count(), 1, 3000);
+    QCOMPARE(errorSpy.at(0).at(2).toULongLong(), progressiveId);
+    QVERIFY(resultSpy.isEmpty());
+
+    // What AudioEngine falls back to: the whole capture in one request
+    const quint64 fallbackId = network->enqueueTranscription(captured);
+    QVERIFY(resultSpy.wait(3000));
+    QCOMPARE(resultSpy.at(0).at(0).toString(), QString("open the window"));
+    QCOMPARE(resultSpy.at(0).at(4).toULongLong(), fallbackId);
+    QCOMPARE(errorSpy.count(), 1);
+}
+
+void TestEndToEnd::testStreamingDeltaPartials()
+{
+    backend->setTranscripts({"set temperature to twenty one degrees"});
+    backend->setPartialBytes(3200);
+    QSignalSpy openedSpy(backend, &StandInBackend::streamOpened);
+    QSignalSpy connectedSpy(network, &NetworkManager::webSocketConnected);
+    QSignalSpy deltaSpy(network, &NetworkManager::partialTranscriptionDelta);
+    QSignalSpy finalSpy(network, &NetworkManager::finalTranscription);
+
+    network->connectWebSocket();
+    QVERIFY(connectedSpy.wait(3000));
+    QCOMPARE(openedSpy.count(), 1);
+    QVERIFY(openedSpy.at(0).at(0).toBool());
+
+    // Six words, then the final
+    for (int i = 0; i < 7; ++i) {
+        network->sendAudioChunk(makePcm(100));
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(finalSpy.count(), 1, 3000);
+    QCOMPARE(deltaSpy.count(), 6);
+
+    QString hypothesis;
+    for (const QList<QVariant> &delta : deltaSpy) {
+        const int stable = delta.at(0).toInt();
+        QVERIFY(stable <= hypothesis.size());
+        hypothesis.truncate(stable);
+        hypothesis += delta.at(1).toString();
+    }
+    QCOMPARE(hypothesis, QString("set temperature to twenty one degrees"));
+    QCOMPARE(finalSpy.at(0).at(0).toString(), hypothesis);
+
+    network->disconnectWebSocket();
+}
+
+void TestEndToEnd::testStreamCancel()
+{
+    backend->setTranscripts({"open the window please"});
+    backend->setPartialBytes(3200);
+    backend->setInferenceDelay(200);
+    QSignalSpy connectedSpy(network, &NetworkManager::webSocketConnected);
+    QSignalSpy deltaSpy(network, &NetworkManager::partialTranscriptionDelta);
+
+    network->connectWebSocket();
+    QVERIFY(connectedSpy.wait(3000));
+
+    // Partials are still being "inferred" when the cancel arrives
+    network->sendAudioChunk(makePcm(200));
+    network->cancelStream();
+    QTest::qWait(400);
+    QVERIFY(deltaSpy.isEmpty());
+
+    // The next utterance starts from scratch
+    network->sendAudioChunk(makePcm(100));
+    QVERIFY(deltaSpy.wait(2000));
+    QCOMPARE(deltaSpy.last().at(0).toInt(), 0);
+    QCOMPARE(deltaSpy.last().at(1).toString(), QString("open"));
+
+    network->disconnectWebSocket();
+}
+
+void TestEndToEnd::testDuplexSession()
+{
+    backend->setTranscripts({"what is the weather"});
+    backend->setPartialBytes(3200);
+    backend->setSpeechDurationMs(200);
+    QSignalSpy deltaSpy(network, &NetworkManager::partialTranscriptionDelta);
+    QSignalSpy finalSpy(network, &NetworkManager::finalTranscription);
+    QSignalSpy startedSpy(network, &NetworkManager::speechStreamStarted);
+    QSignalSpy audioSpy(network, &NetworkManager::speechAudioReceived);
+
+    network->connectWebSocket();
+    QTRY_VERIFY_WITH_TIMEOUT(network->isMultiplexed(), 3000);
+
+    // Speech comes down while the microphone still goes up
+    const quint32 stream = network->requestSpeech("It is sunny.");
+    QVERIFY(stream != 0);
+    for (int i = 0; i < 5; ++i) {
+        network->sendAudioChunk(makePcm(100));
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(finalSpy.count(), 1, 3000);
+    QCOMPARE(deltaSpy.count(), 4);
+    QCOMPARE(finalSpy.at(0).at(0).toString(), QString("what is the weather"));
+
+    QTRY_VERIFY_WITH_TIMEOUT(!audioSpy.isEmpty() && audioSpy.last().at(3).toBool(), 3000);
+    QCOMPARE(startedSpy.count(), 1);
+    QCOMPARE(startedSpy.at(0).at(0).toUInt(), stream);
+    QCOMPARE(startedSpy.at(0).at(1).toInt(), 16000);
+    qint64 bytes = 0;
+    for (int i = 0; i < audioSpy.count(); ++i) {
+        QCOMPARE(audioSpy.at(i).at(0).toUInt(), stream);
+        QCOMPARE(audioSpy.at(i).at(1).toUInt(), uint(i));
+        bytes += audioSpy.at(i).at(2).toByteArray().size();
+    }
+    QCOMPARE(bytes, qint64(200 * 32));
+
+    // All of it on the one connection
+    QCOMPARE(backend->requestCount("/stream"), 1);
+    QCOMPARE(backend->speechRequestCount(), 1);
+
+    // A cancelled stream stops
+    backend->setSpeechDurationMs(2000);
+    const quint32 cancelled = network->requestSpeech("This will be cut short.");
+    QVERIFY(audioSpy.wait(2000));
+    network->cancelSpeech(cancelled);
+    QTRY_COMPARE_WITH_TIMEOUT(backend->cancelledSpeechStreams(), QList<quint32>({cancelled}), 2000);
+    const int received = audioSpy.count();
+    QTest::qWait(200);
+    QCOMPARE(audioSpy.count(), received);
+
+    // Streams still open fail when the session goes
+    QSignalSpy failedSpy(network, &NetworkManager::speechStreamFailed);
+    const quint32 open = network->requestSpeech("Interrupted.");
+    network->disconnectWebSocket();
+    QTRY_COMPARE_WITH_TIMEOUT(failedSpy.count(), 1, 2000);
+    QCOMPARE(failedSpy.at(0).at(0).toUInt(), open);
+    QVERIFY(!network->isMultiplexed());
+}
+
+void TestEndToEnd::testLegacyServerNotMultiplexed()
+{
+    // A server that ignores ?mux=1 gets plain PCM and no speech requests
+    backend->setMultiplexing(false);
+    backend->setTranscripts({"plain audio"});
+    backend->setPartialBytes(3200);
+    QSignalSpy connectedSpy(network, &NetworkManager::webSocketConnected);
+    QSignalSpy audioSpy(backend, &StandInBackend::streamAudioReceived);
+
+    network->connectWebSocket();
+    QVERIFY(connectedSpy.wait(3000));
+    QTest::qWait(100);
+    QVERIFY(!network->isMultiplexed());
+    QCOMPARE(network->requestSpeech("Hello."), quint32(0));
+
+    network->sendAudioChunk(makePcm(100));
+    QVERIFY(audioSpy.wait(2000));
+    QCOMPARE(audioSpy.last().at(0).toLongLong(), qint64(3200));
+
+    network->disconnectWebSocket();
+}
+
+void TestEndToEnd::benchmarkRawRoundTrip()
+{
+    // Zero server delay: what is left is client and loopback overhead
+    const QByteArray pcm = makePcm(1000);
+    QSignalSpy spy(network, &NetworkManager::transcriptionReceived);
+
+    QBENCHMARK {
+        spy.clear();
+        network->transcribeRaw(pcm);
+        QVERIFY(spy.wait(3000));
+    }
+}
+
+QTEST_MAIN(TestEndToEnd)
+#include "test_endtoend.moc"
@@ -0,0 +1,92 @@
+#include <QtTest/QtTest>
+#include "../src/formantsynth.h"
+
+class TestFormantSynth : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testRendersSpeech();
+    void testBlankTextIsSilent();
+    void testDeterministic();
+    void testRateScalesDuration();
+    void testPunctuationPauses();
+    void testDigitsSpelledOut();
+
+private:
+    static qint64 durationMs(const QByteArray &pcm, int sampleRate = FormantSynth::DEFAULT_SAMPLE_RATE);
+};
+
+qint64 TestFormantSynth::durationMs(const QByteArray &pcm, int sampleRate)
+{
+    return qint64(pcm.size() / 2) * 1000 / sampleRate;
+}
+
+void TestFormantSynth::testRendersSpeech()
+{
+    FormantSynth synth;
+    const QByteArray pcm = synth.render("Turn left onto Main Street.");
+    QVERIFY(!pcm.isEmpty());
+    QCOMPARE(pcm.size() % 2, 0);
+
+    // About a second and a half of audio, normalized below full scale
+    const qint64 ms = durationMs(pcm);
+    QVERIFY2(ms > 800 && ms < 4000, qPrintable(QString::number(ms)));
+
+    const qint16 *samples = reinterpret_cast<const qint16 *>(pcm.constData());
+    int peak = 0;
+    double energy = 0;
+    for (int i = 0; i < pcm.size() / 2; ++i) {
+        peak = qMax(peak, qAbs(int(samples[i])));
+        energy += double(samples[i]) * samples[i];
+    }
+    QVERIFY(peak > 16000 && peak < 32767);
+    QVERIFY(qSqrt(energy / (pcm.size() / 2)) > 1000);
+}
+
+void TestFormantSynth::testBlankTextIsSilent()
+{
+    FormantSynth synth;
+    QVERIFY(synth.render(QString()).isEmpty());
+    QVERIFY(synth.render("   ").isEmpty());
+    QVERIFY(synth.render("...").isEmpty());
+}
+
+void TestFormantSynth::testDeterministic()
+{
+    // The cache relies on the same text and settings giving the same audio
+    FormantSynth synth;
+    QCOMPARE(synth.render("Slow down, ice ahead."), synth.render("Slow down, ice ahead."));
+
+    FormantSynth other;
+    other.setPitch(FormantSynth::pitchForVoice("female-en-gb"));
+    QVERIFY(other.render("Slow down, ice ahead.") != synth.render("Slow down, ice ahead."));
+}
+
+void TestFormantSynth::testRateScalesDuration()
+{
+    FormantSynth normal;
+    FormantSynth fast;
+    fast.setRate(2.0f);
+    const QString text = "Continue for two kilometres, then keep right.";
+
+    const double ratio = double(fast.render(text).size()) / normal.render(text).size();
+    QVERIFY2(ratio > 0.45 && ratio < 0.55, qPrintable(QString::number(ratio)));
+}
+
+void TestFormantSynth::testPunctuationPauses()
+{
+    FormantSynth synth;
+    QVERIFY(durationMs(synth.render("Stop. Go.")) > durationMs(synth.render("Stop go")) + 300);
+}
+
+void TestFormantSynth::testDigitsSpelledOut()
+{
+    FormantSynth synth;
+    QCOMPARE(synth.render("Exit 9"), synth.render("Exit nine"));
+    QCOMPARE(synth.render("3.5"), synth.render("three point five"));
+}
+
+QTEST_MAIN(TestFormantSynth)
+#include "test_formantsynth.moc"
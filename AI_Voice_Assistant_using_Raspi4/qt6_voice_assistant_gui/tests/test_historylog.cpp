@@ -0,0 +1,212 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include "../src/historylog.h"
+
+class TestHistoryLog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testSurvivesRestart();
+    void testPagesAcrossBlocks();
+    void testDeletedSkipped();
+    void testTruncatedTailDropped();
+    void testLostIndexRebuilt();
+    void testClear();
+
+private:
+    static TranscriptionItem item(int id);
+    static void fill(HistoryLog &log, int from, int to);
+    static QList<int> allIds(HistoryLog &log, int pageSize);
+};
+
+TranscriptionItem TestHistoryLog::item(int id)
+{
+    return {QString("Transcription %1").arg(id), QDateTime::fromMSecsSinceEpoch(1700000000000LL + id * 1000LL), id};
+}
+
+void TestHistoryLog::fill(HistoryLog &log, int from, int to)
+{
+    for (int id = from; id <= to; ++id) {
+        log.append(item(id));
+    }
+    log.flush();
+}
+
+QList<int> TestHistoryLog::allIds(HistoryLog &log, int pageSize)
+{
+    QList<int> ids;
+    int before = log.lastId() + 1;
+    while (before > log.firstId()) {
+        int reached = before;
+        const QList<TranscriptionItem> page = log.readBefore(before, pageSize, &reached);
+        for (const TranscriptionItem &read : page) {
+            ids.append(read.id);
+        }
+        if (reached >= before) {
+            break;
+        }
+        before = reached;
+    }
+    return ids;
+}
+
+void TestHistoryLog::testSurvivesRestart()
+{
+    QTemporaryDir dir;
+    {
+        HistoryLog log(dir.path());
+        QVERIFY(log.isOpen());
+        QCOMPARE(log.count(), qint64(0));
+        QCOMPARE(log.firstId(), 0);
+        fill(log, 1, 3);
+    }
+
+    HistoryLog log(dir.path());
+    QCOMPARE(log.count(), qint64(3));
+    QCOMPARE(log.firstId(), 1);
+    QCOMPARE(log.lastId(), 3);
+
+    int reached = 0;
+    const QList<TranscriptionItem> page = log.readBefore(4, 10, &reached);
+    QCOMPARE(page.size(), 3);
+    QCOMPARE(page[0].id, 3);
+    QCOMPARE(page[0].text, QString("Transcription 3"));
+    QCOMPARE(page[0].timestamp, item(3).timestamp);
+    QCOMPARE(page[2].id, 1);
+    QCOMPARE(reached, 1);
+}
+
+void TestHistoryLog::testPagesAcrossBlocks()
+{
+    QTemporaryDir dir;
+    const int total = 3 * HistoryLog::INDEX_INTERVAL + 17;
+    {
+        HistoryLog log(dir.path());
+        fill(log, 1, total);
+    }
+
+    HistoryLog log(dir.path());
+    QCOMPARE(log.count(), qint64(total));
+
+    // Newest first, each id once, whatever the page size
+    for (int pageSize : {1, 37, HistoryLog::INDEX_INTERVAL, 1000}) {
+        const QList<int> ids = allIds(log, pageSize);
+        QCOMPARE(ids.size(), total);
+        QCOMPARE(ids.first(), total);
+        QCOMPARE(ids.last(), 1);
+        for (int i = 1; i < ids.size(); ++i) {
+            QCOMPARE(ids[i], ids[i - 1] - 1);
+        }
+    }
+
+    // From the middle of a block
+    int reached = 0;
+    const QList<TranscriptionItem> page = log.readBefore(HistoryLog::INDEX_INTERVAL + 3, 5, &reached);
+    QCOMPARE(page.size(), 5);
+    QCOMPARE(page.first().id, HistoryLog::INDEX_INTERVAL + 2);
+    QCOMPARE(page.last().id, HistoryLog::INDEX_INTERVAL - 2);
+    QCOMPARE(reached, HistoryLog::INDEX_INTERVAL - 2);
+}
+
+void TestHistoryLog::testDeletedSkipped()
+{
+    QTemporaryDir dir;
+    {
+        HistoryLog log(dir.path());
+        fill(log, 1, 10);
+        log.remove(10);
+        log.remove(5);
+        log.remove(5);
+        QCOMPARE(log.count(), qint64(8));
+    }
+
+    HistoryLog log(dir.path());
+    QCOMPARE(log.count(), qint64(8));
+    QCOMPARE(log.lastId(), 10);
+
+    // Deleted ids are stepped over, not returned
+    int reached = 0;
+    const QList<TranscriptionItem> page = log.readBefore(11, 3, &reached);
+    QCOMPARE(page.size(), 3);
+    QCOMPARE(page[0].id, 9);
+    QCOMPARE(page[2].id, 7);
+    QCOMPARE(allIds(log, 4), QList<int>({9, 8, 7, 6, 4, 3, 2, 1}));
+}
+
+void TestHistoryLog::testTruncatedTailDropped()
+{
+    QTemporaryDir dir;
+    {
+        HistoryLog log(dir.path());
+        fill(log, 1, HistoryLog::INDEX_INTERVAL + 1);
+    }
+
+    // A crash part way through the last record
+    QFile file(dir.filePath("history.log"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 3));
+    file.close();
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("History log cut short"));
+    {
+        HistoryLog log(dir.path());
+        QCOMPARE(log.count(), qint64(HistoryLog::INDEX_INTERVAL));
+        QCOMPARE(log.lastId(), HistoryLog::INDEX_INTERVAL);
+
+        // Appends go where the lost record was
+        fill(log, HistoryLog::INDEX_INTERVAL + 1, HistoryLog::INDEX_INTERVAL + 2);
+    }
+
+    HistoryLog log(dir.path());
+    QCOMPARE(log.count(), qint64(HistoryLog::INDEX_INTERVAL + 2));
+    const QList<int> ids = allIds(log, 100);
+    QCOMPARE(ids.size(), HistoryLog::INDEX_INTERVAL + 2);
+    QCOMPARE(ids.first(), HistoryLog::INDEX_INTERVAL + 2);
+}
+
+void TestHistoryLog::testLostIndexRebuilt()
+{
+    QTemporaryDir dir;
+    const int total = 2 * HistoryLog::INDEX_INTERVAL + 5;
+    {
+        HistoryLog log(dir.path());
+        fill(log, 1, total);
+    }
+    QVERIFY(QFile::remove(dir.filePath("history.idx")));
+
+    HistoryLog log(dir.path());
+    QCOMPARE(log.count(), qint64(total));
+    QCOMPARE(log.firstId(), 1);
+    QCOMPARE(allIds(log, 50).size(), total);
+
+    int reached = 0;
+    const QList<TranscriptionItem> page = log.readBefore(300, 1, &reached);
+    QCOMPARE(page.size(), 1);
+    QCOMPARE(page[0].id, 299);
+}
+
+void TestHistoryLog::testClear()
+{
+    QTemporaryDir dir;
+    {
+        HistoryLog log(dir.path());
+        fill(log, 1, 20);
+        log.remove(3);
+        log.clear();
+        QCOMPARE(log.count(), qint64(0));
+        QCOMPARE(log.firstId(), 0);
+
+        // Ids carry on from where they were
+        fill(log, 21, 22);
+    }
+
+    HistoryLog log(dir.path());
+    QCOMPARE(log.count(), qint64(2));
+    QCOMPARE(log.firstId(), 21);
+    QCOMPARE(allIds(log, 10), QList<int>({22, 21}));
+}
+
+QTEST_MAIN(TestHistoryLog)
+#include "test_historylog.moc"
@@ -0,0 +1,171 @@
+#include <QtTest/QtTest>
+#include "../src/jitterbuffer.h"
+
+/**
+ * JitterBuffer tests: 16 kHz mono s16le in 20 ms frames, with arrival
+ * times given explicitly so every case is deterministic
+ */
+class TestJitterBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testHoldsUntilTargetDelay();
+    void testReordersFrames();
+    void testDropsDuplicateAndLateFrames();
+    void testFinishReleasesRest();
+    void testUnderrunRebuffers();
+    void testTargetFollowsJitter();
+    void testSequenceWraps();
+    void testInitialJitterCarriedOver();
+
+private:
+    static QByteArray frame(char fill) { return QByteArray(FRAME_BYTES, fill); }
+
+    static constexpr int BYTES_PER_SECOND = 32000;
+    static constexpr int FRAME_MS = 20;
+    static constexpr int FRAME_BYTES = BYTES_PER_SECOND * FRAME_MS / 1000;
+};
+
+void TestJitterBuffer::testHoldsUntilTargetDelay()
+{
+    JitterBuffer buffer(BYTES_PER_SECOND);
+    QCOMPARE(buffer.targetDelayMs(), int(JitterBuffer::DEFAULT_DELAY_MS));
+
+    // Arriving in one burst: the default 80 ms is four frames
+    for (int i = 0; i < 3; ++i) {
+        buffer.push(i, frame('a' + i), 0);
+        QVERIFY(buffer.take(0).isEmpty());
+    }
+    buffer.push(3, frame('d'), 0);
+    QCOMPARE(buffer.take(0), frame('a') + frame('b') + frame('c') + frame('d'));
+
+    // Playing: later frames pass straight through
+    buffer.push(4, frame('e'), 20);
+    QCOMPARE(buffer.take(20), frame('e'));
+    QCOMPARE(buffer.bufferedMs(), 0);
+    QCOMPARE(buffer.underruns(), 0);
+}
+
+void TestJitterBuffer::testReordersFrames()
+{
+    JitterBuffer buffer(BYTES_PER_SECOND);
+    buffer.push(1, frame('b'), 0);
+    buffer.push(0, frame('a'), 0);
+    buffer.push(3, frame('d'), 0);
+    buffer.push(2, frame('c'), 0);
+
+    QCOMPARE(buffer.take(0), frame('a') + frame('b') + frame('c') + frame('d'));
+}
+
+void TestJitterBuffer::testDropsDuplicateAndLateFrames()
+{
+    JitterBuffer buffer(BYTES_PER_SECOND);
+    for (int i = 0; i < 4; ++i) {
+        buffer.push(i, frame('a' + i), 0);
+    }
+    buffer.push(3, frame('x'), 0);
+    QCOMPARE(buffer.droppedFrames(), 1);
+    QCOMPARE(buffer.take(0).size(), 4 * FRAME_BYTES);
+
+    // Already released
+    buffer.push(2, frame('x'), 10);
+    QCOMPARE(buffer.droppedFrames(), 2);
+    buffer.push(4, frame('e'), 10);
+    QCOMPARE(buffer.take(10), frame('e'));
+}
+
+void TestJitterBuffer::testFinishReleasesRest()
+{
+    JitterBuffer buffer(BYTES_PER_SECOND);
+    buffer.push(0, frame('a'), 0);
+    QVERIFY(buffer.take(0).isEmpty());
+    QVERIFY(!buffer.isDrained());
+
+    // A short stream doesn't wait for a target it will never reach
+    buffer.finish();
+    QCOMPARE(buffer.take(0), frame('a'));
+    QVERIFY(buffer.isDrained());
+
+    buffer.push(1, frame('b'), 0);
+    QCOMPARE(buffer.droppedFrames(), 1);
+}
+
+void TestJitterBuffer::testUnderrunRebuffers()
+{
+    JitterBuffer buffer(BYTES_PER_SECOND);
+    for (int i = 0; i < 4; ++i) {
+        buffer.push(i, frame('a'), 0);
+    }
+    QCOMPARE(buffer.take(0).size(), 4 * FRAME_BYTES);
+    const int target = buffer.targetDelayMs();
+
+    // 80 ms released at 0; the next frame comes 200 ms later
+    buffer.push(4, frame('b'), 200);
+    QCOMPARE(buffer.underruns(), 1);
+    QVERIFY(buffer.targetDelayMs() >= target);
+    QVERIFY(buffer.take(200).isEmpty());
+
+    // Fills to the new target before playing again
+    int sequence = 5;
+    qint64 now = 200;
+    QByteArray released;
+    while (released.isEmpty()) {
+        QVERIFY(buffer.bufferedMs() < buffer.targetDelayMs());
+        buffer.push(sequence++, frame('c'), now);
+        released = buffer.take(now);
+    }
+    QVERIFY(released.size() >= buffer.targetDelayMs() * BYTES_PER_SECOND / 1000);
+    QCOMPARE(released.left(FRAME_BYTES), frame('b'));
+}
+
+void TestJitterBuffer::testTargetFollowsJitter()
+{
+    // Paced exactly: transit never changes, the target drops to the floor
+    JitterBuffer steady(BYTES_PER_SECOND);
+    for (int i = 0; i < 50; ++i) {
+        steady.push(i, frame('a'), 100 + i * FRAME_MS);
+        steady.take(100 + i * FRAME_MS);
+    }
+    QVERIFY(steady.jitterMs() < 1.0);
+    QCOMPARE(steady.targetDelayMs(), int(JitterBuffer::MIN_DELAY_MS));
+    QCOMPARE(steady.underruns(), 0);
+
+    // Alternately 40 ms early and late
+    JitterBuffer jittery(BYTES_PER_SECOND);
+    for (int i = 0; i < 50; ++i) {
+        jittery.push(i, frame('a'), 1000 + i * FRAME_MS + (i % 2 ? 40 : -40));
+    }
+    QVERIFY(jittery.jitterMs() > 40.0);
+    QVERIFY(jittery.targetDelayMs() > JitterBuffer::DEFAULT_DELAY_MS);
+    QVERIFY(jittery.targetDelayMs() <= JitterBuffer::MAX_DELAY_MS);
+}
+
+void TestJitterBuffer::testSequenceWraps()
+{
+    JitterBuffer buffer(BYTES_PER_SECOND);
+    buffer.push(65534, frame('a'), 0);
+    buffer.push(0, frame('c'), 0);
+    buffer.push(65535, frame('b'), 0);
+    buffer.push(1, frame('d'), 0);
+
+    QCOMPARE(buffer.take(0), frame('a') + frame('b') + frame('c') + frame('d'));
+    QCOMPARE(buffer.droppedFrames(), 0);
+}
+
+void TestJitterBuffer::testInitialJitterCarriedOver()
+{
+    // What an earlier stream learnt applies from this one's first frame
+    JitterBuffer buffer(BYTES_PER_SECOND, 50.0);
+    QCOMPARE(buffer.targetDelayMs(), 150);
+
+    JitterBuffer calm(BYTES_PER_SECOND, 2.0);
+    QCOMPARE(calm.targetDelayMs(), int(JitterBuffer::MIN_DELAY_MS));
+    calm.push(0, frame('a'), 0);
+    calm.push(1, frame('b'), 0);
+    QCOMPARE(calm.take(0), frame('a') + frame('b'));
+}
+
+QTEST_MAIN(TestJitterBuffer)
+#include "test_jitterbuffer.moc"
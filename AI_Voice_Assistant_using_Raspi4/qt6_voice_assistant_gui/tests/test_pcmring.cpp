@@ -0,0 +1,176 @@
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <thread>
+#include "../src/pcmring.h"
+
+class TestPcmRing : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void init();
+    void cleanup();
+    
+    // Test cases
+    void testAttachSeesProducerFrames();
+    void testAttachRejectsMissingSegment();
+    void testFramesWrapContiguously();
+    void testFullRingDropsFrames();
+    void testWaitWakesOnWrite();
+    void testCloseWakesConsumer();
+    void testCrossThreadOrdering();
+    
+private:
+    static QByteArray block(int size, char fill) { return QByteArray(size, fill); }
+    
+    QString name;
+    PcmRing *producer;
+    PcmRing *consumer;
+};
+
+void TestPcmRing::init()
+{
+    name = QString("/test-pcmring-%1").arg(QCoreApplication::applicationPid());
+    producer = new PcmRing;
+    consumer = new PcmRing;
+    QVERIFY(producer->create(name, 1024));
+    QVERIFY(consumer->attach(name));
+}
+
+void TestPcmRing::cleanup()
+{
+    delete consumer;
+    delete producer;
+    consumer = nullptr;
+    producer = nullptr;
+}
+
+void TestPcmRing::testAttachSeesProducerFrames()
+{
+    QVERIFY(producer->write("abcd", 4, 42));
+    
+    PcmRing::Frame frame;
+    QVERIFY(consumer->peek(&frame));
+    QCOMPARE(QByteArray(frame.data, frame.size), QByteArray("abcd"));
+    QCOMPARE(frame.captureNs, qint64(42));
+    QCOMPARE(frame.sequence, quint64(0));
+    
+    consumer->release();
+    QVERIFY(!consumer->peek(&frame));
+}
+
+void TestPcmRing::testAttachRejectsMissingSegment()
+{
+    PcmRing ring;
+    QVERIFY(!ring.attach("/test-pcmring-missing"));
+    QVERIFY(!ring.errorString().isEmpty());
+}
+
+void TestPcmRing::testFramesWrapContiguously()
+{
+    PcmRing::Frame frame;
+    
+    // 300-byte frames don't divide 1024, so some writes have to skip the tail
+    for (int i = 0; i < 20; ++i) {
+        const QByteArray data = block(300, char('a' + i));
+        QVERIFY(producer->write(data.constData(), data.size(), i));
+        
+        QVERIFY(consumer->peek(&frame));
+        QCOMPARE(QByteArray(frame.data, frame.size), data);
+        QCOMPARE(frame.sequence, quint64(i));
+        consumer->release();
+    }
+    
+    QCOMPARE(producer->droppedFrames(), quint64(0));
+}
+
+void TestPcmRing::testFullRingDropsFrames()
+{
+    const QByteArray data = block(200, 'x');
+    int written = 0;
+    while (producer->write(data.constData(), data.size(), 0)) {
+        ++written;
+    }
+    
+    QVERIFY(written > 0);
+    QCOMPARE(producer->droppedFrames(), quint64(1));
+    
+    // Reading frees space again
+    PcmRing::Frame frame;
+    QVERIFY(consumer->peek(&frame));
+    consumer->release();
+    QVERIFY(producer->write(data.constData(), data.size(), 0));
+}
+
+void TestPcmRing::testWaitWakesOnWrite()
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    std::thread writer([this]() {
+        QThread::msleep(20);
+        producer->write("x", 1, PcmRing::monotonicNs());
+    });
+    
+    QVERIFY(consumer->wait(2000));
+    writer.join();
+    
+    QVERIFY(timer.elapsed() < 1000);
+    PcmRing::Frame frame;
+    QVERIFY(consumer->peek(&frame));
+}
+
+void TestPcmRing::testCloseWakesConsumer()
+{
+    std::thread closer([this]() {
+        QThread::msleep(20);
+        producer->markClosed();
+    });
+    
+    QVERIFY(consumer->wait(2000));
+    closer.join();
+    QVERIFY(consumer->isClosed());
+}
+
+void TestPcmRing::testCrossThreadOrdering()
+{
+    constexpr int frames = 20000;
+    quint64 received = 0;
+    bool ordered = true;
+    
+    std::thread reader([this, &received, &ordered]() {
+        PcmRing::Frame frame;
+        quint64 expected = 0;
+        forever {
+            if (consumer->peek(&frame)) {
+                ordered = ordered && frame.sequence == expected && frame.data[0] == char(frame.sequence & 0x7F);
+                expected = frame.sequence + 1;
+                ++received;
+                consumer->release();
+                continue;
+            }
+            if (consumer->isClosed()) {
+                break;
+            }
+            consumer->wait(100);
+        }
+    });
+    
+    // Sequence numbers are only assigned to frames that fit
+    quint64 sequence = 0;
+    for (int i = 0; i < frames; ++i) {
+        const QByteArray data = block(1 + i % 200, char(sequence & 0x7F));
+        if (producer->write(data.constData(), data.size(), 0)) {
+            ++sequence;
+        }
+    }
+    producer->markClosed();
+    reader.join();
+    
+    QVERIFY(ordered);
+    QCOMPARE(received, sequence);
+    QCOMPARE(received + producer->droppedFrames(), quint64(frames));
+}
+
+QTEST_MAIN(TestPcmRing)
+#include "test_pcmring.moc"
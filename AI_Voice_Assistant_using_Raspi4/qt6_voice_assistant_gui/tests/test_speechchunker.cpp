@@ -0,0 +1,95 @@
+#include <QtTest/QtTest>
+#include "../src/speechchunker.h"
+
+class TestSpeechChunker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testSplitsSentences();
+    void testLongFirstSentenceCutAtClause();
+    void testNoChunkExceedsLimit();
+    void testPunctuationOnlyKeptWithPrevious();
+    void testBlankText();
+
+private:
+    static void verifyOffsets(const QString &text, const QList<SpeechChunker::Chunk> &chunks);
+};
+
+void TestSpeechChunker::verifyOffsets(const QString &text, const QList<SpeechChunker::Chunk> &chunks)
+{
+    // Word positions are mapped back through the offsets, so they must be exact
+    int previousEnd = 0;
+    for (const SpeechChunker::Chunk &chunk : chunks) {
+        QVERIFY(chunk.offset >= previousEnd);
+        QCOMPARE(text.mid(chunk.offset, chunk.text.size()), chunk.text);
+        previousEnd = chunk.offset + chunk.text.size();
+    }
+}
+
+void TestSpeechChunker::testSplitsSentences()
+{
+    const QString text = "Turn left onto Main Street. Continue for 2.5 kilometres! Is that okay?";
+    const QList<SpeechChunker::Chunk> chunks = SpeechChunker::split(text);
+
+    QCOMPARE(chunks.size(), 3);
+    QCOMPARE(chunks[0].text, QString("Turn left onto Main Street."));
+    QCOMPARE(chunks[1].text, QString("Continue for 2.5 kilometres!"));
+    QCOMPARE(chunks[2].text, QString("Is that okay?"));
+    verifyOffsets(text, chunks);
+}
+
+void TestSpeechChunker::testLongFirstSentenceCutAtClause()
+{
+    const QString text = "In two hundred metres, take the second exit at the roundabout, "
+                         "then keep left towards the motorway. Your destination is on the right.";
+    const QList<SpeechChunker::Chunk> chunks = SpeechChunker::split(text);
+
+    // The listener waits for the first chunk only
+    QCOMPARE(chunks[0].text, QString("In two hundred metres,"));
+    QCOMPARE(chunks.size(), 3);
+    QCOMPARE(chunks[2].text, QString("Your destination is on the right."));
+    verifyOffsets(text, chunks);
+}
+
+void TestSpeechChunker::testNoChunkExceedsLimit()
+{
+    QStringList words;
+    for (int i = 0; i < 300; ++i) {
+        words << QString("word%1").arg(i);
+    }
+    const QString text = words.join(' ');
+    const QList<SpeechChunker::Chunk> chunks = SpeechChunker::split(text);
+
+    QVERIFY(chunks.size() > 1);
+    QVERIFY(chunks[0].text.size() <= SpeechChunker::FIRST_CHUNK_CHARS);
+    QStringList rejoined;
+    for (const SpeechChunker::Chunk &chunk : chunks) {
+        QVERIFY(chunk.text.size() <= SpeechChunker::MAX_CHUNK_CHARS);
+        rejoined << chunk.text;
+    }
+
+    // Cuts fall between words
+    QCOMPARE(rejoined.join(' '), text);
+    verifyOffsets(text, chunks);
+}
+
+void TestSpeechChunker::testPunctuationOnlyKeptWithPrevious()
+{
+    const QString text = "Hello there. ... ";
+    const QList<SpeechChunker::Chunk> chunks = SpeechChunker::split(text);
+
+    QCOMPARE(chunks.size(), 1);
+    QVERIFY(chunks[0].text.startsWith("Hello there."));
+    verifyOffsets(text, chunks);
+}
+
+void TestSpeechChunker::testBlankText()
+{
+    QVERIFY(SpeechChunker::split(QString()).isEmpty());
+    QVERIFY(SpeechChunker::split("   \n ").isEmpty());
+}
+
+QTEST_MAIN(TestSpeechChunker)
+#include "test_speechchunker.moc"
@@ -0,0 +1,146 @@
+#include <QtTest/QtTest>
+#include "../src/speechscheduler.h"
+
+class TestSpeechScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testHigherClassFirst();
+    void testFifoWithinClass();
+    void testDuplicatesMerged();
+    void testMergeRaisesClass();
+    void testExpiredDropped();
+    void testRequeueAtHead();
+    void testFrontOfClass();
+    void testLatencyPerClass();
+};
+
+void TestSpeechScheduler::testHigherClassFirst()
+{
+    SpeechScheduler scheduler;
+    scheduler.enqueue("The weather is mild today.", SpeechScheduler::Conversational);
+    scheduler.enqueue("Turn left in 200 metres.", SpeechScheduler::Navigation);
+    scheduler.enqueue("Pedestrian ahead.", SpeechScheduler::SafetyAlert);
+    QCOMPARE(scheduler.highestPending(), int(SpeechScheduler::SafetyAlert));
+
+    SpeechScheduler::Utterance next;
+    QVERIFY(scheduler.takeNext(next));
+    QCOMPARE(next.priority, SpeechScheduler::SafetyAlert);
+    QVERIFY(scheduler.takeNext(next));
+    QCOMPARE(next.priority, SpeechScheduler::Navigation);
+    QVERIFY(scheduler.takeNext(next));
+    QCOMPARE(next.priority, SpeechScheduler::Conversational);
+    QVERIFY(!scheduler.takeNext(next));
+    QCOMPARE(scheduler.highestPending(), -1);
+}
+
+void TestSpeechScheduler::testFifoWithinClass()
+{
+    SpeechScheduler scheduler;
+    scheduler.enqueue("First.", SpeechScheduler::Navigation);
+    scheduler.enqueue("Second.", SpeechScheduler::Navigation);
+    scheduler.enqueue("Third.", SpeechScheduler::Navigation);
+
+    SpeechScheduler::Utterance next;
+    for (const QString &expected : {QString("First."), QString("Second."), QString("Third.")}) {
+        QVERIFY(scheduler.takeNext(next));
+        QCOMPARE(next.text, expected);
+    }
+}
+
+void TestSpeechScheduler::testDuplicatesMerged()
+{
+    SpeechScheduler scheduler;
+    const quint64 id = scheduler.enqueue("Speed camera ahead.", SpeechScheduler::Navigation, 1000);
+    scheduler.enqueue("Keep right.", SpeechScheduler::Navigation);
+    QCOMPARE(scheduler.enqueue("speed  camera ahead.", SpeechScheduler::Navigation, 5000), id);
+
+    // Said once, in its original place, with the later deadline
+    QCOMPARE(scheduler.pendingCount(), 2);
+    QCOMPARE(scheduler.mergedCount(), quint64(1));
+    SpeechScheduler::Utterance next;
+    QVERIFY(scheduler.takeNext(next));
+    QCOMPARE(next.id, id);
+    QVERIFY(next.deadlineMs >= next.enqueuedMs + 5000);
+}
+
+void TestSpeechScheduler::testMergeRaisesClass()
+{
+    SpeechScheduler scheduler;
+    scheduler.enqueue("Road closed ahead.", SpeechScheduler::Navigation);
+    scheduler.enqueue("Road closed ahead.", SpeechScheduler::SafetyAlert);
+
+    QCOMPARE(scheduler.pendingCount(), 1);
+    QCOMPARE(scheduler.pendingCount(SpeechScheduler::SafetyAlert), 1);
+    QCOMPARE(scheduler.pendingCount(SpeechScheduler::Navigation), 0);
+}
+
+void TestSpeechScheduler::testExpiredDropped()
+{
+    SpeechScheduler scheduler;
+    scheduler.enqueue("Turn right now.", SpeechScheduler::Navigation, 20);
+    scheduler.enqueue("Tell me a joke.", SpeechScheduler::Conversational);
+    QTest::qWait(50);
+
+    // The late prompt is skipped, not said
+    QList<SpeechScheduler::Utterance> dropped;
+    SpeechScheduler::Utterance next;
+    QVERIFY(scheduler.takeNext(next, &dropped));
+    QCOMPARE(next.text, QString("Tell me a joke."));
+    QCOMPARE(dropped.size(), 1);
+    QCOMPARE(dropped[0].text, QString("Turn right now."));
+    QCOMPARE(scheduler.droppedCount(), quint64(1));
+}
+
+void TestSpeechScheduler::testRequeueAtHead()
+{
+    SpeechScheduler scheduler;
+    scheduler.enqueue("A long answer. With two sentences.", SpeechScheduler::Conversational);
+    scheduler.enqueue("Another answer.", SpeechScheduler::Conversational);
+
+    SpeechScheduler::Utterance interrupted;
+    QVERIFY(scheduler.takeNext(interrupted));
+    interrupted.resumeOffset = 15;
+    scheduler.requeue(interrupted);
+
+    // Picked up where it was, and its wait isn't counted twice
+    SpeechScheduler::Utterance next;
+    QVERIFY(scheduler.takeNext(next));
+    QCOMPARE(next.id, interrupted.id);
+    QCOMPARE(next.resumeOffset, 15);
+    QCOMPARE(scheduler.startedCount(SpeechScheduler::Conversational), quint64(1));
+}
+
+void TestSpeechScheduler::testFrontOfClass()
+{
+    SpeechScheduler scheduler;
+    scheduler.enqueue("Queued answer.", SpeechScheduler::Conversational);
+    scheduler.enqueue("Replacement answer.", SpeechScheduler::Conversational, -1, true);
+
+    SpeechScheduler::Utterance next;
+    QVERIFY(scheduler.takeNext(next));
+    QCOMPARE(next.text, QString("Replacement answer."));
+}
+
+void TestSpeechScheduler::testLatencyPerClass()
+{
+    SpeechScheduler scheduler;
+    scheduler.enqueue("Chat.", SpeechScheduler::Conversational);
+    QTest::qWait(40);
+    scheduler.enqueue("Brake now.", SpeechScheduler::SafetyAlert);
+
+    SpeechScheduler::Utterance next;
+    QVERIFY(scheduler.takeNext(next));
+    QVERIFY(scheduler.takeNext(next));
+
+    QCOMPARE(scheduler.startedCount(SpeechScheduler::SafetyAlert), quint64(1));
+    QVERIFY(scheduler.averageLatencyMs(SpeechScheduler::SafetyAlert) < 40);
+    QVERIFY(scheduler.maxLatencyMs(SpeechScheduler::Conversational) >= 40);
+    QCOMPARE(scheduler.startedCount(SpeechScheduler::Navigation), quint64(0));
+    QCOMPARE(scheduler.averageLatencyMs(SpeechScheduler::Navigation), qint64(0));
+}
+
+QTEST_MAIN(TestSpeechScheduler)
+#include "test_speechscheduler.moc"
@@ -0,0 +1,55 @@
+#include <QtTest/QtTest>
+#include "../src/streammux.h"
+
+class TestStreamMux : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testRoundTrip();
+    void testHeaderLayout();
+    void testEmptyEndFrame();
+    void testShortMessageRejected();
+};
+
+void TestStreamMux::testRoundTrip()
+{
+    const QByteArray pcm(640, '\x7f');
+    const QByteArray message = StreamMux::encode(StreamMux::TextToSpeech, 42, 65535, pcm);
+    QCOMPARE(message.size(), StreamMux::HEADER_BYTES + pcm.size());
+
+    StreamMux::Frame frame;
+    QVERIFY(StreamMux::decode(message, &frame));
+    QCOMPARE(int(frame.channel), int(StreamMux::TextToSpeech));
+    QCOMPARE(frame.stream, quint32(42));
+    QCOMPARE(frame.sequence, quint16(65535));
+    QVERIFY(!frame.isEnd());
+    QCOMPARE(frame.payload, pcm);
+}
+
+void TestStreamMux::testHeaderLayout()
+{
+    // What the Python backend unpacks with struct ">BBHI"
+    const QByteArray message = StreamMux::encode(StreamMux::SpeechToText, 0x01020304, 0x0506, "xy", StreamMux::End);
+    QCOMPARE(message, QByteArray("\x01\x01\x05\x06\x01\x02\x03\x04xy", 10));
+}
+
+void TestStreamMux::testEmptyEndFrame()
+{
+    StreamMux::Frame frame;
+    QVERIFY(StreamMux::decode(StreamMux::encode(StreamMux::TextToSpeech, 7, 3, QByteArray(), StreamMux::End), &frame));
+    QVERIFY(frame.isEnd());
+    QCOMPARE(frame.stream, quint32(7));
+    QVERIFY(frame.payload.isEmpty());
+}
+
+void TestStreamMux::testShortMessageRejected()
+{
+    StreamMux::Frame frame;
+    QVERIFY(!StreamMux::decode(QByteArray(StreamMux::HEADER_BYTES - 1, '\0'), &frame));
+    QVERIFY(!StreamMux::decode(QByteArray(), &frame));
+}
+
+QTEST_MAIN(TestStreamMux)
+#include "test_streammux.moc"
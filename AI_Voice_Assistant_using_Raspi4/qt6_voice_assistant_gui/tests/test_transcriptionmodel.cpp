@@ -1,4 +1,5 @@
 #include <QtTest/QtTest>
+#include <QTemporaryDir>
 #include "../src/transcriptionmodel.h"
 
 class TestTranscriptionModel : public QObject
@@ -18,6 +19,10 @@ private slots:
     void testClear();
     void testModelData();
     void testExportToFile();
+    void testOrderAcrossChunks();
+    void testRemoveByIdAcrossChunks();
+    void testCapacityEvictsInBatches();
+    void testHistoryPagedIn();
 
 private:
     TranscriptionModel *model;
@@ -119,6 +124,154 @@ void TestTranscriptionModel::testExportToFile()
     QFile::remove(tempFile);
 }
 
+void TestTranscriptionModel::testOrderAcrossChunks()
+{
+    const int total = TranscriptionStore::CHUNK_SIZE * 3 + 10;
+    for (int i = 0; i < total; ++i) {
+        model->addTranscription(QString("Item %1").arg(i), QDateTime::currentDateTime());
+    }
+    
+    QCOMPARE(model->count(), total);
+    QCOMPARE(model->data(model->index(0), TranscriptionModel::TextRole).toString(), QString("Item %1").arg(total - 1));
+    QCOMPARE(model->data(model->index(total - 1), TranscriptionModel::TextRole).toString(), QString("Item 0"));
+    QCOMPARE(model->data(model->index(300), TranscriptionModel::TextRole).toString(), QString("Item %1").arg(total - 301));
+    QVERIFY(!model->data(model->index(total), TranscriptionModel::TextRole).isValid());
+}
+
+void TestTranscriptionModel::testRemoveByIdAcrossChunks()
+{
+    const int total = TranscriptionStore::CHUNK_SIZE * 2 + 5;
+    for (int i = 0; i < total; ++i) {
+        model->addTranscription(QString("Item %1").arg(i), QDateTime::currentDateTime());
+    }
+    
+    // Ids start at 1, so item i has id i + 1 and is in row total - 1 - i
+    QSignalSpy removedSpy(model, &QAbstractItemModel::rowsRemoved);
+    model->removeTranscription(11);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(1).toInt(), total - 11);
+    
+    // Rows of later chunks moved up by one
+    QCOMPARE(model->rowOf(11), -1);
+    QCOMPARE(model->rowOf(1), total - 2);
+    QCOMPARE(model->rowOf(total), 0);
+    QCOMPARE(model->data(model->index(total - 2), TranscriptionModel::IdRole).toInt(), 1);
+    
+    // A whole chunk emptied
+    for (int id = 1; id <= TranscriptionStore::CHUNK_SIZE; ++id) {
+        model->removeTranscription(id);
+    }
+    QCOMPARE(model->count(), total - TranscriptionStore::CHUNK_SIZE);
+    QCOMPARE(model->data(model->index(model->count() - 1), TranscriptionModel::IdRole).toInt(),
+             TranscriptionStore::CHUNK_SIZE + 1);
+    
+    // Unknown ids are ignored
+    removedSpy.clear();
+    model->removeTranscription(11);
+    QCOMPARE(removedSpy.count(), 0);
+}
+
+void TestTranscriptionModel::testCapacityEvictsInBatches()
+{
+    model->setCapacity(100);
+    model->setEvictionBatch(10);
+    QSignalSpy removedSpy(model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy evictedSpy(model, &TranscriptionModel::transcriptionsEvicted);
+    
+    for (int i = 0; i < 100; ++i) {
+        model->addTranscription(QString("Item %1").arg(i), QDateTime::currentDateTime());
+    }
+    QCOMPARE(model->count(), 100);
+    QCOMPARE(removedSpy.count(), 0);
+    
+    // The 101st evicts the ten oldest in one go, the next nine fit
+    for (int i = 100; i < 110; ++i) {
+        model->addTranscription(QString("Item %1").arg(i), QDateTime::currentDateTime());
+    }
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(1).toInt(), 90);
+    QCOMPARE(removedSpy.at(0).at(2).toInt(), 99);
+    QCOMPARE(evictedSpy.at(0).at(0).toInt(), 10);
+    QCOMPARE(model->count(), 100);
+    QCOMPARE(model->data(model->index(99), TranscriptionModel::TextRole).toString(), QString("Item 10"));
+    
+    // Lowering the capacity evicts down to it at once
+    model->setCapacity(40);
+    QCOMPARE(model->count(), 40);
+    QCOMPARE(model->data(model->index(39), TranscriptionModel::TextRole).toString(), QString("Item 70"));
+}
+
+void TestTranscriptionModel::testHistoryPagedIn()
+{
+    QTemporaryDir dir;
+    {
+        TranscriptionModel previous;
+        QVERIFY(previous.openHistory(dir.path()));
+        for (int i = 1; i <= 250; ++i) {
+            previous.addTranscription(QString("Item %1").arg(i), QDateTime::currentDateTime());
+        }
+        previous.removeTranscription(5);
+        QCOMPARE(previous.totalCount(), 249);
+    }
+    
+    // Nothing is read until the view asks for it
+    TranscriptionModel history;
+    QVERIFY(history.openHistory(dir.path()));
+    QCOMPARE(history.count(), 0);
+    QCOMPARE(history.totalCount(), 249);
+    QVERIFY(history.canFetchMore(QModelIndex()));
+    
+    // Read off the GUI thread; the page lands from the event loop
+    QSignalSpy insertedSpy(&history, &QAbstractItemModel::rowsInserted);
+    history.fetchMore(QModelIndex());
+    QVERIFY(history.isFetching());
+    QVERIFY(!history.canFetchMore(QModelIndex()));
+    QCOMPARE(history.count(), 0);
+    QTRY_VERIFY(!history.isFetching());
+    QCOMPARE(history.count(), TranscriptionModel::PAGE_SIZE);
+    QCOMPARE(insertedSpy.at(0).at(1).toInt(), 0);
+    QCOMPARE(insertedSpy.at(0).at(2).toInt(), TranscriptionModel::PAGE_SIZE - 1);
+    QCOMPARE(history.data(history.index(0), TranscriptionModel::TextRole).toString(), QString("Item 250"));
+    
+    // Older pages go below, skipping the deleted one
+    while (history.canFetchMore(QModelIndex())) {
+        history.fetchMore(QModelIndex());
+        QTRY_VERIFY(!history.isFetching());
+    }
+    QCOMPARE(history.count(), 249);
+    QCOMPARE(insertedSpy.last().at(1).toInt(), 2 * TranscriptionModel::PAGE_SIZE);
+    QCOMPARE(history.data(history.index(248), TranscriptionModel::TextRole).toString(), QString("Item 1"));
+    QCOMPARE(history.rowOf(5), -1);
+    
+    // New ids carry on from the stored ones
+    history.addTranscription("Item 251", QDateTime::currentDateTime());
+    QCOMPARE(history.data(history.index(0), TranscriptionModel::IdRole).toInt(), 251);
+    QCOMPARE(history.totalCount(), 250);
+    
+    // An export reads all of it, the one still being written included
+    QTemporaryDir exportDir;
+    QSignalSpy exportSpy(&history, &TranscriptionModel::exportCompleted);
+    history.exportToFile(exportDir.filePath("history.txt"));
+    QVERIFY(exportSpy.wait(3000));
+    QVERIFY(exportSpy.at(0).at(0).toBool());
+    QCOMPARE(exportSpy.at(0).at(1).toString(), QString("Successfully exported 250 transcriptions"));
+    
+    // Evicted rows stay on disk and can be paged back in
+    history.setCapacity(50);
+    QCOMPARE(history.count(), 50);
+    QVERIFY(!history.canFetchMore(QModelIndex()));
+    history.setCapacity(0);
+    QVERIFY(history.canFetchMore(QModelIndex()));
+    history.fetchMore(QModelIndex());
+    QTRY_VERIFY(!history.isFetching());
+    QCOMPARE(history.count(), 50 + TranscriptionModel::PAGE_SIZE);
+    QCOMPARE(history.data(history.index(50), TranscriptionModel::IdRole).toInt(), 201);
+    
+    history.clear();
+    QCOMPARE(history.totalCount(), 0);
+    QVERIFY(!history.canFetchMore(QModelIndex()));
+}
+
 QTEST_MAIN(TestTranscriptionModel)
 #include "test_transcriptionmodel.moc"
 
@@ -0,0 +1,161 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include "../src/ttscache.h"
+
+class TestTTSCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testKeyNormalization();
+    void testMemoryTierEvictsLeastRecent();
+    void testDiskTierSurvivesRestart();
+    void testDiskBudgetTrimsLeastRecent();
+    void testUnreadableFileDiscarded();
+    void testHitRate();
+
+private:
+    static TTSAudio tone(int milliseconds, char fill);
+};
+
+TTSAudio TestTTSCache::tone(int milliseconds, char fill)
+{
+    TTSAudio audio;
+    audio.sampleRate = 16000;
+    audio.channels = 1;
+    audio.pcm = QByteArray(milliseconds * 16 * 2, fill);
+    return audio;
+}
+
+void TestTTSCache::testKeyNormalization()
+{
+    const QString key = TTSCache::key("Turn left.", "default", 1.0f);
+
+    QCOMPARE(TTSCache::key("  Turn   left.\n", "default", 1.0f), key);
+    QCOMPARE(TTSCache::key("Turn left.", "default", 1.004f), key);
+
+    // Composed and decomposed forms are the same text
+    QCOMPARE(TTSCache::key(QString::fromUtf8("Caf\xC3\xA9"), "default", 1.0f),
+             TTSCache::key(QString::fromUtf8("Cafe\xCC\x81"), "default", 1.0f));
+
+    QVERIFY(TTSCache::key("turn left.", "default", 1.0f) != key);
+    QVERIFY(TTSCache::key("Turn left.", "female-en-gb", 1.0f) != key);
+    QVERIFY(TTSCache::key("Turn left.", "default", 1.1f) != key);
+}
+
+void TestTTSCache::testMemoryTierEvictsLeastRecent()
+{
+    TTSCache cache;
+    const TTSAudio audio = tone(100, 1);
+    cache.setMemoryBudget(3 * audio.pcm.size());
+
+    cache.insert("a", audio);
+    cache.insert("b", audio);
+    cache.insert("c", audio);
+    QVERIFY(!cache.lookup("a").isNull());
+
+    // "b" is now the least recently used
+    cache.insert("d", audio);
+    QVERIFY(cache.contains("a"));
+    QVERIFY(!cache.contains("b"));
+    QVERIFY(cache.contains("c"));
+    QCOMPARE(cache.memoryBytes(), qint64(3 * audio.pcm.size()));
+}
+
+void TestTTSCache::testDiskTierSurvivesRestart()
+{
+    QTemporaryDir dir;
+    const TTSAudio audio = tone(500, 7);
+    const QString key = TTSCache::key("Listening.", "default", 1.0f);
+
+    {
+        TTSCache cache(dir.path());
+        cache.insert(key, audio);
+    }
+
+    TTSCache cache(dir.path());
+    QCOMPARE(cache.diskBytes(), qint64(TTSCache::HEADER_BYTES + audio.pcm.size()));
+    QVERIFY(cache.contains(key));
+
+    const TTSAudio cached = cache.lookup(key);
+    QCOMPARE(cached.sampleRate, audio.sampleRate);
+    QCOMPARE(cached.channels, audio.channels);
+    QCOMPARE(cached.pcm, audio.pcm);
+    QCOMPARE(cached.durationMs(), qint64(500));
+
+    // Played straight from the mapping, not from a copy
+    QVERIFY(!cached.mapping.isNull());
+    QCOMPARE(cache.diskHits(), quint64(1));
+
+    // Promoted to memory for the next time
+    cache.lookup(key);
+    QCOMPARE(cache.memoryHits(), quint64(1));
+}
+
+void TestTTSCache::testDiskBudgetTrimsLeastRecent()
+{
+    QTemporaryDir dir;
+    TTSCache cache(dir.path());
+    const TTSAudio audio = tone(100, 3);
+    const qint64 fileBytes = TTSCache::HEADER_BYTES + audio.pcm.size();
+
+    const QStringList keys = {"oldest", "middle", "newest"};
+    for (const QString &key : keys) {
+        cache.insert(key, audio);
+    }
+    cache.flush();
+    QCOMPARE(cache.diskBytes(), 3 * fileBytes);
+
+    // Recency is the modification time; set it rather than wait for the clock
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (int i = 0; i < keys.size(); ++i) {
+        QFile file(dir.filePath(keys[i] + ".pcm"));
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(now.addSecs(i - 10), QFileDevice::FileModificationTime));
+    }
+
+    cache.setDiskBudget(2 * fileBytes);
+    cache.flush();
+    QCOMPARE(cache.diskBytes(), 2 * fileBytes);
+    QVERIFY(!QFile::exists(dir.filePath("oldest.pcm")));
+    QVERIFY(QFile::exists(dir.filePath("middle.pcm")));
+    QVERIFY(QFile::exists(dir.filePath("newest.pcm")));
+}
+
+void TestTTSCache::testUnreadableFileDiscarded()
+{
+    QTemporaryDir dir;
+    QFile file(dir.filePath("broken.pcm"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(64, 'x'));
+    file.close();
+
+    TTSCache cache(dir.path());
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Discarding unreadable TTS cache file"));
+    QVERIFY(cache.lookup("broken").isNull());
+    QVERIFY(!file.exists());
+    QCOMPARE(cache.diskBytes(), qint64(0));
+    QCOMPARE(cache.misses(), quint64(1));
+}
+
+void TestTTSCache::testHitRate()
+{
+    TTSCache cache;
+    QSignalSpy statsSpy(&cache, &TTSCache::statsChanged);
+    QCOMPARE(cache.hitRate(), 0.0);
+
+    cache.insert("okay", tone(200, 2));
+    QVERIFY(cache.lookup("done").isNull());
+    QVERIFY(!cache.lookup("okay").isNull());
+    QVERIFY(!cache.lookup("okay").isNull());
+    QVERIFY(cache.lookup("sorry").isNull());
+
+    QCOMPARE(cache.hits(), quint64(2));
+    QCOMPARE(cache.misses(), quint64(2));
+    QCOMPARE(cache.hitRate(), 0.5);
+    QVERIFY(statsSpy.count() >= 5);
+}
+
+QTEST_MAIN(TestTTSCache)
+#include "test_ttscache.moc"
@@ -0,0 +1,200 @@
+#include <QtTest/QtTest>
+#include <QProcess>
+#include "../src/ttschannel.h"
+
+/**
+ * TTSChannel against real pipes: `cat` echoes every command back as a
+ * message, and `sleep` never reads its stdin
+ */
+class TestTTSChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    // Test cases
+    void testCommandEchoed();
+    void testManyMessagesPerRead();
+    void testMessageSplitAcrossReads();
+    void testInvalidLineSkipped();
+    void testOversizedLineSkipped();
+    void testSettingsCoalesced();
+    void testBarrierKeepsOrder();
+    void testStalledReaderDoesNotBlock();
+
+private:
+    void startPeer(const QString &program, const QStringList &arguments = QStringList());
+
+    QProcess *process;
+    TTSChannel *channel;
+    QList<QJsonObject> messages;
+};
+
+void TestTTSChannel::init()
+{
+    process = new QProcess(this);
+    channel = new TTSChannel(process, this);
+    messages.clear();
+    connect(channel, &TTSChannel::messageReceived, this, [this](const QJsonObject &message) {
+        messages << message;
+    });
+}
+
+void TestTTSChannel::cleanup()
+{
+    process->kill();
+    process->waitForFinished();
+    delete channel;
+    delete process;
+    channel = nullptr;
+    process = nullptr;
+}
+
+void TestTTSChannel::startPeer(const QString &program, const QStringList &arguments)
+{
+    process->start(program, arguments);
+    QVERIFY(process->waitForStarted(3000));
+}
+
+void TestTTSChannel::testCommandEchoed()
+{
+    startPeer("cat");
+
+    QVariantMap params;
+    params["text"] = "Turning on the lights";
+    channel->send("SPEAK", params);
+
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 1, 3000);
+    QCOMPARE(messages[0]["command"].toString(), QString("SPEAK"));
+    QCOMPARE(messages[0]["text"].toString(), QString("Turning on the lights"));
+}
+
+void TestTTSChannel::testManyMessagesPerRead()
+{
+    startPeer("cat");
+
+    // Word boundaries arrive faster than the GUI reads; one read holds them all
+    QByteArray burst;
+    for (int i = 0; i < 50; ++i) {
+        burst += QString("{\"type\":\"word_boundary\",\"word\":\"w%1\",\"position\":%1}\n").arg(i).toUtf8();
+    }
+    process->write(burst);
+
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 50, 3000);
+    for (int i = 0; i < 50; ++i) {
+        QCOMPARE(messages[i]["position"].toInt(), i);
+    }
+}
+
+void TestTTSChannel::testMessageSplitAcrossReads()
+{
+    startPeer("cat");
+
+    process->write("{\"type\":\"speech_started\"}\n{\"type\":\"word_bou");
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 1, 3000);
+    QTest::qWait(50);
+    QCOMPARE(messages.size(), 1);
+
+    process->write("ndary\",\"word\":\"hello\"}\r\n");
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 2, 3000);
+    QCOMPARE(messages[1]["word"].toString(), QString("hello"));
+}
+
+void TestTTSChannel::testInvalidLineSkipped()
+{
+    startPeer("cat");
+    QSignalSpy errorSpy(channel, &TTSChannel::protocolError);
+
+    process->write("{\"type\":\"log\"}\nnot json\n[1,2]\n\n{\"type\":\"speech_finished\"}\n");
+
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 2, 3000);
+    QCOMPARE(messages[1]["type"].toString(), QString("speech_finished"));
+    QCOMPARE(errorSpy.count(), 2);
+}
+
+void TestTTSChannel::testOversizedLineSkipped()
+{
+    startPeer("cat");
+    QSignalSpy errorSpy(channel, &TTSChannel::protocolError);
+
+    process->write("{\"text\":\"" + QByteArray(TTSChannel::MAX_LINE_BYTES + 1024, 'a') + "\"}\n");
+    process->write("{\"type\":\"speech_finished\"}\n");
+
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 1, 3000);
+    QCOMPARE(messages[0]["type"].toString(), QString("speech_finished"));
+    QCOMPARE(errorSpy.count(), 1);
+}
+
+void TestTTSChannel::testSettingsCoalesced()
+{
+    startPeer("cat");
+
+    // A slider drag: one event loop pass, many values
+    for (int i = 0; i <= 100; ++i) {
+        QVariantMap volume, rate;
+        volume["volume"] = i / 100.0;
+        rate["rate"] = 0.5 + i / 100.0;
+        channel->sendLatest("SET_VOLUME", volume);
+        channel->sendLatest("SET_RATE", rate);
+    }
+    QCOMPARE(channel->pendingCount(), 2);
+
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 2, 3000);
+    QTest::qWait(50);
+    QCOMPARE(messages.size(), 2);
+    QCOMPARE(messages[0]["command"].toString(), QString("SET_VOLUME"));
+    QCOMPARE(messages[0]["volume"].toDouble(), 1.0);
+    QCOMPARE(messages[1]["command"].toString(), QString("SET_RATE"));
+    QCOMPARE(messages[1]["rate"].toDouble(), 1.5);
+}
+
+void TestTTSChannel::testBarrierKeepsOrder()
+{
+    startPeer("cat");
+
+    QVariantMap quiet, loud, text;
+    quiet["volume"] = 0.2;
+    loud["volume"] = 0.9;
+    text["text"] = "hello";
+    channel->sendLatest("SET_VOLUME", quiet);
+    channel->send("SPEAK", text);
+    channel->sendLatest("SET_VOLUME", quiet);
+    channel->sendLatest("SET_VOLUME", loud);
+    QCOMPARE(channel->pendingCount(), 3);
+
+    // The utterance is spoken quietly; only the later changes merge
+    QTRY_COMPARE_WITH_TIMEOUT(messages.size(), 3, 3000);
+    QCOMPARE(messages[0]["volume"].toDouble(), 0.2);
+    QCOMPARE(messages[1]["command"].toString(), QString("SPEAK"));
+    QCOMPARE(messages[2]["volume"].toDouble(), 0.9);
+}
+
+void TestTTSChannel::testStalledReaderDoesNotBlock()
+{
+    // sleep never reads, so the pipe fills and stays full
+    startPeer("sleep", {"30"});
+
+    QVariantMap text;
+    text["text"] = QString(1024 * 1024, 'x');
+    channel->send("SPEAK", text);
+    QTest::qWait(50);
+    QVERIFY(process->bytesToWrite() > 0);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < 10000; ++i) {
+        QVariantMap volume;
+        volume["volume"] = (i % 100) / 100.0;
+        channel->sendLatest("SET_VOLUME", volume);
+        QCoreApplication::processEvents();
+    }
+
+    // Nothing waited on the pipe, and the backlog is one command, not ten thousand
+    QVERIFY2(timer.elapsed() < 2000, qPrintable(QString::number(timer.elapsed())));
+    QCOMPARE(channel->pendingCount(), 1);
+}
+
+QTEST_MAIN(TestTTSChannel)
+#include "test_ttschannel.moc"
@@ -0,0 +1,518 @@
+#include <QtTest/QtTest>
+#include "../src/ttsengine.h"
+#include "../src/networkmanager.h"
+#include "standinbackend.h"
+
+/**
+ * TTSEngine against stand-ins for the TTS backend
+ *
+ * The shell stand-in says it is ready after a given startup time, answers
+ * every SPEAK with speech_finished and exits with status 3 when asked to say
+ * "crash". The Python one speaks SPEAK_CHUNK the way tts_backend.py does, with
+ * synthesis taking 2 ms per character. The synthesizing one answers
+ * SYNTHESIZE with 100 ms of PCM after 300 ms. The failing one rejects any
+ * voice but the default and fails every chunk that says "fails". The native backend needs no
+ * stand-in, and the remote one talks to a StandInBackend over a multiplexed
+ * /stream session that tests open and close themselves. Tests of the backend-played
+ * path turn local playback off, which is on wherever there is an output.
+ */
+class TestTTSEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    // Test cases
+    void testConstructionDoesNotWait();
+    void testStandbyWarmsUp();
+    void testCrashPromotesStandby();
+    void testColdStartWhenStandbyNotReady();
+    void testMissingBackendReported();
+    void testBackendWithoutEngineNotReady();
+    void testSentencePipelineFirstAudio();
+    void testRepeatedPhraseServedFromCache();
+    void testQueuedSpeechDrains();
+    void testSafetyAlertPreemptsConversation();
+    void testOnlyUtteranceErrorsEndSpeech();
+    void testNativeBackendSpeaksWithoutProcess();
+    void testRemoteBackendStreamsSpeech();
+    void testRemoteSessionClosedBeforeSpeak();
+
+private:
+    static QStringList standIn(double startupSeconds);
+    static QStringList chunkedStandIn();
+    static QStringList synthesizingStandIn();
+    static QStringList failingStandIn();
+
+    TTSEngine *engine = nullptr;
+};
+
+QStringList TestTTSEngine::standIn(double startupSeconds)
+{
+    const QString script = QString(
+        "sleep %1\n"
+        "echo '{\"type\":\"ready\"}'\n"
+        "while IFS= read -r line; do\n"
+        "  case \"$line\" in\n"
+        "    *'\"crash\"'*) exit 3 ;;\n"
+        "    *QUIT*) exit 0 ;;\n"
+        "    *SPEAK*) echo '{\"type\":\"speech_finished\"}' ;;\n"
+        "  esac\n"
+        "done\n").arg(startupSeconds);
+    return {"-c", script};
+}
+
+QStringList TestTTSEngine::chunkedStandIn()
+{
+    const QString script =
+        "import sys, json, time\n"
+        "def send(message):\n"
+        "    sys.stdout.write(json.dumps(message) + '\\n')\n"
+        "    sys.stdout.flush()\n"
+        "send({'type': 'ready'})\n"
+        "for line in sys.stdin:\n"
+        "    command = json.loads(line)\n"
+        "    if command.get('command') != 'SPEAK_CHUNK':\n"
+        "        continue\n"
+        "    text = command['text']\n"
+        "    ids = {'utterance': command['utterance'], 'index': command['index']}\n"
+        "    time.sleep(len(text) * 0.002)\n"
+        "    send(dict(ids, type='chunk_started'))\n"
+        "    position = 0\n"
+        "    for word in text.split():\n"
+        "        position = text.index(word, position)\n"
+        "        send(dict(ids, type='word_boundary', word=word, position=position))\n"
+        "        position += len(word)\n"
+        "    time.sleep(0.02)\n"
+        "    send(dict(ids, type='chunk_finished'))\n";
+    return {"-c", script};
+}
+
+QStringList TestTTSEngine::synthesizingStandIn()
+{
+    const QString script =
+        "import sys, json, time, base64\n"
+        "def send(message):\n"
+        "    sys.stdout.write(json.dumps(message) + '\\n')\n"
+        "    sys.stdout.flush()\n"
+        "send({'type': 'ready'})\n"
+        "for line in sys.stdin:\n"
+        "    command = json.loads(line)\n"
+        "    if command.get('command') != 'SYNTHESIZE':\n"
+        "        continue\n"
+        "    time.sleep(0.3)\n"
+        "    pcm = base64.b64encode(bytes(3200)).decode('ascii')\n"
+        "    send({'type': 'audio', 'request': command['request'], 'sampleRate': 16000,\n"
+        "          'channels': 1, 'data': pcm, 'final': True})\n";
+    return {"-c", script};
+}
+
+QStringList TestTTSEngine::failingStandIn()
+{
+    const QString script =
+        "import sys, json, time\n"
+        "def send(message):\n"
+        "    sys.stdout.write(json.dumps(message) + '\\n')\n"
+        "    sys.stdout.flush()\n"
+        "send({'type': 'ready'})\n"
+        "for line in sys.stdin:\n"
+        "    command = json.loads(line)\n"
+        "    if command.get('command') == 'SET_VOICE' and command['voice'] != 'default':\n"
+        "        send({'type': 'error', 'message': 'Voice setting error'})\n"
+        "    if command.get('command') != 'SPEAK_CHUNK':\n"
+        "        continue\n"
+        "    ids = {'utterance': command['utterance'], 'index': command['index']}\n"
+        "    if 'fails' in command['text']:\n"
+        "        send(dict(ids, type='error', message='Speech error'))\n"
+        "        continue\n"
+        "    send(dict(ids, type='chunk_started'))\n"
+        "    time.sleep(0.1)\n"
+        "    send(dict(ids, type='chunk_finished'))\n";
+    return {"-c", script};
+}
+
+void TestTTSEngine::initTestCase()
+{
+    // The speech cache goes to a test location, not the user's
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestTTSEngine::cleanup()
+{
+    delete engine;
+    engine = nullptr;
+}
+
+void TestTTSEngine::testConstructionDoesNotWait()
+{
+    QElapsedTimer timer;
+    timer.start();
+    engine = new TTSEngine("sh", standIn(1.0));
+
+    // Two backends are starting, and both take a second to get ready
+    QVERIFY(timer.elapsed() < 500);
+    QVERIFY(!engine->standbyReady());
+}
+
+void TestTTSEngine::testStandbyWarmsUp()
+{
+    engine = new TTSEngine("sh", standIn(0.1));
+    engine->setLocalPlayback(false);
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 3000);
+    QCOMPARE(engine->lastFailoverMs(), qint64(-1));
+
+    engine->speak("hello");
+    QVERIFY(finishedSpy.wait(3000));
+}
+
+void TestTTSEngine::testCrashPromotesStandby()
+{
+    engine = new TTSEngine("sh", standIn(0.3));
+    engine->setLocalPlayback(false);
+    QSignalSpy failoverSpy(engine, &TTSEngine::failoverCompleted);
+    QSignalSpy errorSpy(engine, &TTSEngine::speechError);
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 3000);
+
+    engine->speak("crash");
+    QVERIFY(failoverSpy.wait(3000));
+
+    // The warm standby takes over without a startup
+    QVERIFY(failoverSpy.at(0).at(0).toLongLong() < 100);
+    QCOMPARE(engine->lastFailoverMs(), failoverSpy.at(0).at(0).toLongLong());
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(finishedSpy.count(), 1);
+    QVERIFY(!engine->isSpeaking());
+
+    // It speaks at once, while a new standby warms up behind it
+    QVERIFY(!engine->standbyReady());
+    engine->speak("hello");
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, 200);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 3000);
+}
+
+void TestTTSEngine::testColdStartWhenStandbyNotReady()
+{
+    engine = new TTSEngine("sh", standIn(0.5));
+    engine->setLocalPlayback(false);
+    QSignalSpy failoverSpy(engine, &TTSEngine::failoverCompleted);
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 3000);
+
+    // The second crash comes before the replacement standby is ready
+    engine->speak("crash");
+    QVERIFY(failoverSpy.wait(3000));
+    engine->speak("crash");
+    QVERIFY(failoverSpy.wait(3000));
+
+    // The gap is what was left of its startup, and speech queued meanwhile still plays
+    const qint64 gapMs = failoverSpy.at(1).at(0).toLongLong();
+    QVERIFY2(gapMs >= 300 && gapMs < 1500, qPrintable(QString::number(gapMs)));
+    engine->speakAsync("hello");
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 3000);
+}
+
+void TestTTSEngine::testMissingBackendReported()
+{
+    QElapsedTimer timer;
+    timer.start();
+    engine = new TTSEngine("/nonexistent/tts_backend", {});
+    QVERIFY(timer.elapsed() < 500);
+
+    QSignalSpy errorSpy(engine, &TTSEngine::speechError);
+    QVERIFY(errorSpy.wait(3000));
+    QVERIFY(!engine->standbyReady());
+}
+
+void TestTTSEngine::testBackendWithoutEngineNotReady()
+{
+    // Started, but pyttsx3 failed to initialise
+    const QString script =
+        "echo '{\"type\":\"ready\",\"engine\":false}'\n"
+        "while IFS= read -r line; do :; done\n";
+    engine = new TTSEngine("sh", {"-c", script});
+
+    // A failed start, not a backend that takes commands and never speaks
+    QSignalSpy errorSpy(engine, &TTSEngine::speechError);
+    QVERIFY(errorSpy.wait(3000));
+    QVERIFY(!engine->backendReady());
+    QVERIFY(!engine->standbyReady());
+}
+
+void TestTTSEngine::testSentencePipelineFirstAudio()
+{
+    if (QStandardPaths::findExecutable("python3").isEmpty()) {
+        QSKIP("python3 is needed for the chunked stand-in");
+    }
+
+    engine = new TTSEngine("python3", chunkedStandIn());
+    engine->setLocalPlayback(false);
+    QSignalSpy firstAudioSpy(engine, &TTSEngine::firstAudioStarted);
+    QSignalSpy wordSpy(engine, &TTSEngine::wordSpoken);
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 5000);
+
+    // About 700 ms of synthesis as one command; the first chunk needs a fraction
+    const QString directions =
+        "In two hundred metres, take the second exit at the roundabout onto the A40. "
+        "Continue for 3.5 kilometres, then keep left to join the motorway towards Oxford. "
+        "After eight kilometres, take exit 9 and turn right at the end of the slip road. "
+        "Your destination is on the left, next to the petrol station.";
+    engine->speak(directions);
+    QVERIFY(firstAudioSpy.wait(3000));
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 5000);
+
+    const qint64 firstAudioMs = firstAudioSpy.at(0).at(0).toLongLong();
+    const qint64 wholeTextMs = directions.size() * 2;
+    qDebug() << "time to first audio:" << firstAudioMs << "ms, whole text would take" << wholeTextMs << "ms";
+    QVERIFY2(firstAudioMs < wholeTextMs / 2, qPrintable(QString::number(firstAudioMs)));
+    QCOMPARE(engine->lastTimeToFirstAudioMs(), firstAudioMs);
+
+    // Positions are in the whole response, not in the chunk
+    QCOMPARE(wordSpy.count(), directions.split(' ', Qt::SkipEmptyParts).size());
+    int previous = -1;
+    for (const QList<QVariant> &word : wordSpy) {
+        const QString spoken = word.at(0).toString();
+        const int position = word.at(1).toInt();
+        QVERIFY(position > previous);
+        QCOMPARE(directions.mid(position, spoken.size()), spoken);
+        previous = position;
+    }
+}
+
+void TestTTSEngine::testRepeatedPhraseServedFromCache()
+{
+    if (QStandardPaths::findExecutable("python3").isEmpty()) {
+        QSKIP("python3 is needed for the synthesizing stand-in");
+    }
+
+    // Without an output device the player drops audio at once, which is enough here
+    engine = new TTSEngine("python3", synthesizingStandIn());
+    engine->setLocalPlayback(true);
+    engine->setPrefetchPhrases({});
+    engine->cache()->clear();
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 5000);
+
+    engine->speak("Temperature set to twenty one degrees.");
+    QVERIFY(finishedSpy.wait(3000));
+    QCOMPARE(engine->cacheHitRate(), 0.0);
+
+    // The second time goes nowhere near the backend's 300 ms
+    QElapsedTimer timer;
+    timer.start();
+    engine->speak("Temperature   set to twenty one degrees.");
+    QVERIFY(finishedSpy.wait(3000));
+    QVERIFY2(timer.elapsed() < 250, qPrintable(QString::number(timer.elapsed())));
+    QCOMPARE(engine->cacheHitRate(), 0.5);
+    QVERIFY(engine->cacheMemoryBytes() >= 3200);
+}
+
+void TestTTSEngine::testQueuedSpeechDrains()
+{
+    engine = new TTSEngine("sh", standIn(0.0));
+    engine->setLocalPlayback(false);
+    QSignalSpy startedSpy(engine, &TTSEngine::speechStarted);
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 5000);
+
+    // Each finishes before the next starts, and none are left behind
+    engine->speakAsync("One.");
+    engine->speakAsync("Two.");
+    engine->speakAsync("Three.");
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 3000);
+    QCOMPARE(startedSpy.count(), 3);
+    QCOMPARE(startedSpy.at(2).at(0).toString(), QString("Three."));
+    QCOMPARE(engine->queuedCount(), 0);
+}
+
+void TestTTSEngine::testSafetyAlertPreemptsConversation()
+{
+    if (QStandardPaths::findExecutable("python3").isEmpty()) {
+        QSKIP("python3 is needed for the chunked stand-in");
+    }
+
+    engine = new TTSEngine("python3", chunkedStandIn());
+    engine->setLocalPlayback(false);
+    QSignalSpy startedSpy(engine, &TTSEngine::speechStarted);
+    QSignalSpy preemptedSpy(engine, &TTSEngine::speechPreempted);
+    QSignalSpy wordSpy(engine, &TTSEngine::wordSpoken);
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->standbyReady(), 5000);
+
+    const QString answer =
+        "The museum opens at ten in the morning. "
+        "Tickets are cheaper if you book them online the day before. "
+        "The cafe on the top floor has a view over the whole river. "
+        "Parking is free after six in the evening.";
+    engine->speak(answer);
+    QVERIFY(wordSpy.wait(3000));
+
+    const QString alert = "Cyclist on your left.";
+    engine->announce(alert, TTSEngine::SafetyAlert);
+    QCOMPARE(preemptedSpy.count(), 1);
+    QCOMPARE(engine->currentPriority(), int(TTSEngine::SafetyAlert));
+
+    // The alert, then the rest of the answer; every start has its finish, the preempted one's included
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 5000);
+    QCOMPARE(startedSpy.count(), 3);
+    QCOMPARE(startedSpy.at(1).at(0).toString(), alert);
+    QCOMPARE(startedSpy.at(2).at(0).toString(), answer);
+    QCOMPARE(engine->queuedCount(), 0);
+
+    // Resumed words are still placed in the whole answer, and it ends where it should
+    const QList<QVariant> last = wordSpy.last();
+    QCOMPARE(last.at(0).toString(), QString("evening."));
+    QCOMPARE(answer.mid(last.at(1).toInt()), QString("evening."));
+
+    const QVariantMap safety = engine->queueLatencyMs()["safety"].toMap();
+    QCOMPARE(safety["count"].toULongLong(), quint64(1));
+    QVERIFY(safety["max"].toLongLong() < 100);
+}
+
+void TestTTSEngine::testOnlyUtteranceErrorsEndSpeech()
+{
+    if (QStandardPaths::findExecutable("python3").isEmpty()) {
+        QSKIP("python3 is needed for the failing stand-in");
+    }
+
+    engine = new TTSEngine("python3", failingStandIn());
+    engine->setLocalPlayback(false);
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QSignalSpy errorSpy(engine, &TTSEngine::speechError);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->backendReady(), 5000);
+
+    // A rejected setting is reported, and what is being said carries on
+    engine->setVoice("no-such-voice");
+    engine->speak("Turn left now.");
+    QVERIFY(errorSpy.wait(3000));
+    QVERIFY(engine->isSpeaking());
+    QVERIFY(finishedSpy.wait(3000));
+    QCOMPARE(errorSpy.count(), 1);
+
+    // An error naming the utterance ends it the way finishing does
+    QSignalSpy textSpy(engine, &TTSEngine::currentTextChanged);
+    engine->speak("This one fails.");
+    QVERIFY(finishedSpy.wait(3000));
+    QCOMPARE(errorSpy.count(), 2);
+    QVERIFY(!engine->isSpeaking());
+    QVERIFY(engine->currentText().isEmpty());
+    QCOMPARE(textSpy.count(), 2);
+}
+
+void TestTTSEngine::testNativeBackendSpeaksWithoutProcess()
+{
+    QElapsedTimer timer;
+    timer.start();
+    engine = new TTSEngine(TTSEngine::NativeBackend);
+    engine->setPrefetchPhrases({});
+    engine->cache()->clear();
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QSignalSpy errorSpy(engine, &TTSEngine::speechError);
+
+    // Nothing to start but the event loop, and nothing a standby would save
+    QTRY_VERIFY_WITH_TIMEOUT(engine->backendReady(), 1000);
+    QVERIFY2(timer.elapsed() < 500, qPrintable(QString::number(timer.elapsed())));
+    QVERIFY(!engine->standbyReady());
+
+    // Played here even with local playback off, since the backend can't play
+    engine->setLocalPlayback(false);
+    engine->speak("Turn left. Then keep right.");
+    QVERIFY(finishedSpy.wait(3000));
+    QCOMPARE(errorSpy.count(), 0);
+    QVERIFY(engine->cacheMemoryBytes() > 0);
+}
+
+void TestTTSEngine::testRemoteBackendStreamsSpeech()
+{
+    StandInBackend server;
+    QVERIFY2(server.listen(), qPrintable(server.errorString()));
+    server.setSpeechDurationMs(600);
+    server.setSpeechJitter(15);
+    NetworkManager network;
+    network.setBackendUrl(server.url());
+
+    engine = new TTSEngine(&network);
+    engine->setPrefetchPhrases({});
+    engine->cache()->clear();
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QSignalSpy errorSpy(engine, &TTSEngine::speechError);
+    QSignalSpy firstAudioSpy(engine, &TTSEngine::firstAudioStarted);
+
+    // Not ready until the session is up and multiplexed
+    QTest::qWait(100);
+    QVERIFY(!engine->backendReady());
+    network.connectWebSocket();
+    QTRY_VERIFY_WITH_TIMEOUT(network.isMultiplexed(), 3000);
+    QTRY_VERIFY_WITH_TIMEOUT(engine->backendReady(), 1000);
+
+    // A second backend would only wait on the same session
+    QVERIFY(!engine->standbyReady());
+
+    // Playback starts on the first blocks, long before 600 ms of speech is in
+    engine->speak("Your table is ready.");
+    QVERIFY(firstAudioSpy.wait(3000));
+    QVERIFY2(engine->lastTimeToFirstAudioMs() < 400, qPrintable(QString::number(engine->lastTimeToFirstAudioMs())));
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(errorSpy.count(), 0);
+    QCOMPARE(server.speechRequestCount(), 1);
+    QCOMPARE(server.requestCount("/stream"), 1);
+
+    // Said again, it comes from the cache without a request
+    engine->speak("Your table is ready.");
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(server.speechRequestCount(), 1);
+
+    delete engine;
+    engine = nullptr;
+}
+
+void TestTTSEngine::testRemoteSessionClosedBeforeSpeak()
+{
+    StandInBackend server;
+    QVERIFY2(server.listen(), qPrintable(server.errorString()));
+    server.setSpeechDurationMs(200);
+    NetworkManager network;
+    network.setBackendUrl(server.url());
+
+    engine = new TTSEngine(&network);
+    engine->setPrefetchPhrases({});
+    engine->cache()->clear();
+    QSignalSpy finishedSpy(engine, &TTSEngine::speechFinished);
+    QSignalSpy errorSpy(engine, &TTSEngine::speechError);
+
+    network.connectWebSocket();
+    QTRY_VERIFY_WITH_TIMEOUT(engine->backendReady(), 3000);
+
+    // The session ending between utterances is not a crash
+    network.disconnectWebSocket();
+    QTRY_VERIFY_WITH_TIMEOUT(!engine->backendReady(), 3000);
+    QCOMPARE(errorSpy.count(), 0);
+
+    // Speech asked for meanwhile waits for the next session
+    engine->speak("Your table is ready.");
+    QTest::qWait(300);
+    network.connectWebSocket();
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(errorSpy.count(), 0);
+    QCOMPARE(server.speechRequestCount(), 1);
+
+    // With no session coming, it fails in bounded time instead of waiting forever
+    network.disconnectWebSocket();
+    QTRY_VERIFY_WITH_TIMEOUT(!engine->backendReady(), 3000);
+    engine->speak("Your car is here.");
+    QVERIFY(finishedSpy.wait(6000));
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(errorSpy.at(0).at(0).toString(), QString("no multiplexed session"));
+    QCOMPARE(server.speechRequestCount(), 1);
+
+    delete engine;
+    engine = nullptr;
+}
+
+QTEST_MAIN(TestTTSEngine)
+#include "test_ttsengine.moc"
@@ -0,0 +1,225 @@
+#include <QtTest/QtTest>
+#include "../src/ttsmixer.h"
+
+/**
+ * TTSMixer at 8 kHz mono, so frame counts are easy to follow
+ */
+class TestTTSMixer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Test cases
+    void testSegmentsBackToBackWithFrameEvents();
+    void testOpenSegmentWaitsForMore();
+    void testStopFadesOut();
+    void testStopCrossfadesIntoNextSpeech();
+    void testMixIsClipped();
+    void testConvertRateAndChannels();
+    void testDucking();
+
+private:
+    static TTSAudio constant(int frames, qint16 value, int sampleRate = 8000, int channels = 1);
+    static QList<qint16> renderAll(TTSMixer &mixer, int blockFrames);
+};
+
+TTSAudio TestTTSMixer::constant(int frames, qint16 value, int sampleRate, int channels)
+{
+    TTSAudio audio;
+    audio.sampleRate = sampleRate;
+    audio.channels = channels;
+    audio.pcm.resize(frames * channels * 2);
+    qint16 *samples = reinterpret_cast<qint16 *>(audio.pcm.data());
+    for (int i = 0; i < frames * channels; ++i) {
+        samples[i] = value;
+    }
+    return audio;
+}
+
+QList<qint16> TestTTSMixer::renderAll(TTSMixer &mixer, int blockFrames)
+{
+    QList<qint16> samples;
+    QList<qint16> block(blockFrames);
+    qint64 rendered;
+    while ((rendered = mixer.render(block.data(), blockFrames)) > 0) {
+        samples += block.mid(0, rendered);
+    }
+    return samples;
+}
+
+void TestTTSMixer::testSegmentsBackToBackWithFrameEvents()
+{
+    TTSMixer mixer(8000, 1);
+    mixer.enqueue(0, constant(250, 1000));
+    mixer.enqueue(1, constant(130, 2000));
+
+    // Block boundaries don't line up with segments on purpose
+    const QList<qint16> samples = renderAll(mixer, 64);
+    QCOMPARE(samples.size(), 380);
+    QCOMPARE(samples[249], qint16(1000));
+    QCOMPARE(samples[250], qint16(2000));
+    QCOMPARE(mixer.renderedFrames(), qint64(380));
+
+    const QList<TTSMixer::Event> events = mixer.takeEvents();
+    QCOMPARE(events.size(), 4);
+    QCOMPARE(events[0].tag, 0);
+    QCOMPARE(events[0].finished, false);
+    QCOMPARE(events[0].frame, qint64(0));
+    QCOMPARE(events[1].finished, true);
+    QCOMPARE(events[1].frame, qint64(250));
+    QCOMPARE(events[2].tag, 1);
+    QCOMPARE(events[2].frame, qint64(250));
+    QCOMPARE(events[2].frames, qint64(130));
+    QCOMPARE(events[3].frame, qint64(380));
+    QVERIFY(!mixer.isActive());
+}
+
+void TestTTSMixer::testOpenSegmentWaitsForMore()
+{
+    TTSMixer mixer(8000, 1);
+    mixer.enqueue(0, constant(100, 1000), true);
+    mixer.enqueue(1, constant(50, 2000));
+
+    // Only what has arrived plays; the next segment doesn't start early
+    QCOMPARE(renderAll(mixer, 64).size(), 100);
+    QVERIFY(mixer.isSpeaking());
+    QList<TTSMixer::Event> events = mixer.takeEvents();
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events[0].finished, false);
+    QCOMPARE(events[0].frames, qint64(-1));
+
+    // Converted on the way in, like a whole segment
+    mixer.append(0, constant(40, 3000, 16000));
+    mixer.close(0);
+    const QList<qint16> samples = renderAll(mixer, 64);
+    QCOMPARE(samples.size(), 20 + 50);
+    QCOMPARE(samples[0], qint16(3000));
+    QCOMPARE(samples[20], qint16(2000));
+
+    events = mixer.takeEvents();
+    QCOMPARE(events.size(), 3);
+    QCOMPARE(events[0].finished, true);
+    QCOMPARE(events[0].frame, qint64(120));
+    QCOMPARE(events[0].frames, qint64(120));
+    QCOMPARE(events[1].tag, 1);
+    QVERIFY(!mixer.isActive());
+
+    // Appending to a segment that is gone does nothing
+    mixer.append(0, constant(10, 1000));
+    QVERIFY(!mixer.isSpeaking());
+}
+
+void TestTTSMixer::testStopFadesOut()
+{
+    TTSMixer mixer(8000, 1);
+    mixer.enqueue(0, constant(8000, 10000));
+    mixer.enqueue(1, constant(8000, 10000));
+
+    QList<qint16> block(100);
+    QCOMPARE(mixer.render(block.data(), 100), qint64(100));
+    mixer.takeEvents();
+
+    mixer.stop();
+    QVERIFY(!mixer.isSpeaking());
+    QVERIFY(mixer.isActive());
+
+    // FADE_MS of a falling ramp, then nothing
+    const QList<qint16> fade = renderAll(mixer, 32);
+    QCOMPARE(fade.size(), 8000 * TTSMixer::FADE_MS / 1000);
+    QCOMPARE(fade.first(), qint16(10000));
+    QVERIFY(fade.last() < 100);
+    for (int i = 1; i < fade.size(); ++i) {
+        QVERIFY(fade[i] <= fade[i - 1]);
+    }
+
+    // Neither the stopped segment nor the dropped one reports
+    QVERIFY(mixer.takeEvents().isEmpty());
+    QVERIFY(!mixer.isActive());
+}
+
+void TestTTSMixer::testStopCrossfadesIntoNextSpeech()
+{
+    TTSMixer mixer(8000, 1);
+    mixer.enqueue(0, constant(8000, 4000));
+    QList<qint16> block(100);
+    mixer.render(block.data(), 100);
+
+    mixer.stop();
+    mixer.enqueue(7, constant(400, 1000));
+    const QList<qint16> samples = renderAll(mixer, 50);
+
+    // The new response starts at once, over the old one fading out
+    QCOMPARE(samples.size(), 400);
+    QCOMPARE(samples[0], qint16(5000));
+    QVERIFY(samples[60] > 1000 && samples[60] < 5000);
+    QCOMPARE(samples[399], qint16(1000));
+
+    const QList<TTSMixer::Event> events = mixer.takeEvents();
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events[0].tag, 7);
+    QCOMPARE(events[0].frame, qint64(100));
+}
+
+void TestTTSMixer::testMixIsClipped()
+{
+    TTSMixer mixer(8000, 1);
+    mixer.enqueue(0, constant(800, 30000));
+    QList<qint16> block(10);
+    mixer.render(block.data(), 10);
+
+    mixer.stop();
+    mixer.enqueue(1, constant(800, 30000));
+    mixer.render(block.data(), 10);
+    QCOMPARE(block[0], qint16(32767));
+
+    // Gain applies to what is played, so the echo reference matches the output
+    TTSMixer quiet(8000, 1);
+    quiet.setGain(0.5f);
+    quiet.enqueue(0, constant(10, -30000));
+    quiet.render(block.data(), 10);
+    QCOMPARE(block[0], qint16(-15000));
+}
+
+void TestTTSMixer::testConvertRateAndChannels()
+{
+    const TTSAudio mono = constant(1600, 1234, 16000, 1);
+    const TTSAudio stereo = TTSMixer::convert(mono, 48000, 2);
+
+    QCOMPARE(stereo.sampleRate, 48000);
+    QCOMPARE(stereo.channels, 2);
+    QCOMPARE(stereo.durationMs(), mono.durationMs());
+    const qint16 *samples = reinterpret_cast<const qint16 *>(stereo.pcm.constData());
+    QCOMPARE(samples[0], qint16(1234));
+    QCOMPARE(samples[1], qint16(1234));
+    QCOMPARE(samples[1001], qint16(1234));
+
+    // Already in the output format: shared, not copied
+    const TTSAudio same = TTSMixer::convert(stereo, 48000, 2);
+    QCOMPARE(same.pcm.constData(), stereo.pcm.constData());
+}
+
+void TestTTSMixer::testDucking()
+{
+    TTSMixer mixer(8000, 1);
+    QCOMPARE(mixer.mediaGain(), 1.0f);
+
+    mixer.enqueue(0, constant(80, 1000));
+    mixer.updateDucking(TTSMixer::DUCK_ATTACK_MS / 2);
+    QVERIFY(mixer.mediaGain() < 1.0f && mixer.mediaGain() > TTSMixer::DUCK_GAIN);
+    mixer.updateDucking(TTSMixer::DUCK_ATTACK_MS);
+    QCOMPARE(mixer.mediaGain(), TTSMixer::DUCK_GAIN);
+
+    // Held down through a gap between sentences, then released
+    QList<qint16> block(80);
+    mixer.render(block.data(), 80);
+    QVERIFY(!mixer.isSpeaking());
+    mixer.updateDucking(TTSMixer::DUCK_HOLD_MS - 50);
+    QCOMPARE(mixer.mediaGain(), TTSMixer::DUCK_GAIN);
+    mixer.updateDucking(100);
+    QVERIFY(mixer.mediaGain() > TTSMixer::DUCK_GAIN);
+    mixer.updateDucking(TTSMixer::DUCK_RELEASE_MS);
+    QCOMPARE(mixer.mediaGain(), 1.0f);
+}
+
+QTEST_MAIN(TestTTSMixer)
+#include "test_ttsmixer.moc"
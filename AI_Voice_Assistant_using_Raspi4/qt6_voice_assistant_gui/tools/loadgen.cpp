@@ -0,0 +1,637 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QTimer>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include "../src/networkmanager.h"
+
+/**
+ * Load generator: N simulated clients replaying a WAV corpus against a backend
+ *
+ * Each client owns a NetworkManager, so connection reuse, backend pool
+ * routing and failover behave as they do in a cabin. Sessions arrive as a
+ * Poisson process at --rate per second (or back to back with --rate 0) and
+ * run on the first idle client; arrivals that find every client busy wait
+ * and the wait is reported as queue delay.
+ *
+ * Modes:
+ *   rest    - POST /transcribe/raw once the utterance is over
+ *   upload  - progressive POST /transcribe/stream fed in real time
+ *   stream  - /stream WebSocket fed in real time
+ *
+ * Final latency is measured from the end of the audio. The report is JSON
+ * on stdout (or --output).
+ */
+
+static constexpr int SAMPLE_RATE = 16000;
+static constexpr int BYTES_PER_MS = SAMPLE_RATE * 2 / 1000;
+
+// ============================================================================
+// Corpus
+// ============================================================================
+
+struct Utterance {
+    QString name;
+    QByteArray pcm; // 16 kHz mono s16le
+    qint64 audioMs = 0;
+};
+
+static bool readWav(const QString &path, Utterance *utterance, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if (data.size() < 12 || !data.startsWith("RIFF") || data.mid(8, 4) != "WAVE") {
+        *error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    quint16 format = 0, channels = 0, bits = 0;
+    quint32 rate = 0;
+    qsizetype pos = 12;
+    while (pos + 8 <= data.size()) {
+        const QByteArray id = data.mid(pos, 4);
+        const quint32 size = qFromLittleEndian<quint32>(data.constData() + pos + 4);
+        const qsizetype body = pos + 8;
+
+        if (id == "fmt " && size >= 16 && body + 16 <= data.size()) {
+            format = qFromLittleEndian<quint16>(data.constData() + body);
+            channels = qFromLittleEndian<quint16>(data.constData() + body + 2);
+            rate = qFromLittleEndian<quint32>(data.constData() + body + 4);
+            bits = qFromLittleEndian<quint16>(data.constData() + body + 14);
+        } else if (id == "data") {
+            if (format != 1 || bits != 16 || channels == 0) {
+                *error = QString("unsupported format %1, %2-bit").arg(format).arg(bits);
+                return false;
+            }
+            if (rate != SAMPLE_RATE) {
+                *error = QString("sample rate %1 Hz, expected %2 Hz").arg(rate).arg(SAMPLE_RATE);
+                return false;
+            }
+
+            const QByteArray samples = data.mid(body, qMin<qsizetype>(size, data.size() - body));
+            if (channels == 1) {
+                utterance->pcm = samples;
+            } else {
+                // Keep the first channel
+                const qsizetype frames = samples.size() / (2 * channels);
+                utterance->pcm.resize(frames * 2);
+                for (qsizetype i = 0; i < frames; ++i) {
+                    memcpy(utterance->pcm.data() + i * 2, samples.constData() + i * 2 * channels, 2);
+                }
+            }
+            utterance->name = QFileInfo(path).fileName();
+            utterance->audioMs = utterance->pcm.size() / BYTES_PER_MS;
+            return true;
+        }
+
+        pos = body + size + (size & 1);
+    }
+
+    *error = "no data chunk";
+    return false;
+}
+
+static QList<Utterance> loadCorpus(const QStringList &paths)
+{
+    QStringList files;
+    for (const QString &path : paths) {
+        if (QFileInfo(path).isDir()) {
+            const QStringList names = QDir(path).entryList({"*.wav", "*.WAV"}, QDir::Files, QDir::Name);
+            for (const QString &name : names) {
+                files << QDir(path).filePath(name);
+            }
+        } else {
+            files << path;
+        }
+    }
+
+    QList<Utterance> corpus;
+    for (const QString &file : files) {
+        Utterance utterance;
+        QString error;
+        if (readWav(file, &utterance, &error)) {
+            corpus << utterance;
+        } else {
+            qWarning() << "⚠️ Skipping" << file << "-" << error;
+        }
+    }
+    return corpus;
+}
+
+// ============================================================================
+// Simulated client
+// ============================================================================
+
+enum class Mode { Rest, Upload, Stream };
+
+struct SessionResult {
+    bool succeeded = false;
+    bool gotFinal = false;
+    QString error;
+    qint64 queueMs = 0;
+    qint64 firstPartialMs = -1; // from the first audio sent
+    qint64 finalLatencyMs = -1; // from the end of the audio
+    qint64 audioMs = 0;
+};
+
+class SimulatedClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    SimulatedClient(const QStringList &backends, Mode mode, int chunkMs, int finalTimeoutMs,
+                    const QString &language, QObject *parent = nullptr)
+        : QObject(parent)
+        , m_network(new NetworkManager(this))
+        , m_mode(mode)
+        , m_chunkMs(chunkMs)
+        , m_language(language)
+        , m_chunkTimer(new QTimer(this))
+        , m_finalTimer(new QTimer(this))
+        , m_busy(false)
+        , m_closing(false)
+        , m_requestId(0)
+        , m_offset(0)
+        , m_firstAudioMs(-1)
+        , m_audioEndMs(-1)
+    {
+        m_network->setBackendUrls(backends);
+
+        m_chunkTimer->setInterval(chunkMs);
+        connect(m_chunkTimer, &QTimer::timeout, this, &SimulatedClient::sendNextChunk);
+
+        // Backends that never send a final (the Python /stream) end here
+        m_finalTimer->setSingleShot(true);
+        m_finalTimer->setInterval(finalTimeoutMs);
+        connect(m_finalTimer, &QTimer::timeout, this, [this]() {
+            if (m_mode == Mode::Stream) {
+                m_result.succeeded = m_result.firstPartialMs >= 0;
+                finish();
+            } else {
+                fail("Timed out waiting for the transcription");
+            }
+        });
+
+        connect(m_network, &NetworkManager::transcriptionReceived, this,
+                [this](const QString &, double, double, double, quint64 requestId) {
+            if (m_busy && requestId == m_requestId) {
+                m_result.succeeded = true;
+                m_result.gotFinal = true;
+                m_result.finalLatencyMs = m_clock.elapsed() - m_audioEndMs;
+                finish();
+            }
+        });
+        connect(m_network, &NetworkManager::errorOccurred, this,
+                [this](const QString &error, const QString &, quint64 requestId) {
+            if (m_busy && requestId != 0 && requestId == m_requestId) {
+                fail(error);
+            }
+        });
+        connect(m_network, &NetworkManager::webSocketError, this, [this](const QString &error) {
+            if (m_busy && m_mode == Mode::Stream) {
+                fail("WebSocket Error: " + error);
+            }
+        });
+        connect(m_network, &NetworkManager::webSocketDisconnected, this, [this]() {
+            if (m_closing) {
+                m_closing = false;
+                emit sessionFinished(m_result);
+            } else if (m_busy && m_mode == Mode::Stream) {
+                fail("WebSocket disconnected");
+            }
+        });
+
+        connect(m_network, &NetworkManager::webSocketConnected, this, [this]() {
+            if (m_busy && m_mode == Mode::Stream) {
+                m_chunkTimer->start();
+                sendNextChunk();
+            }
+        });
+        connect(m_network, &NetworkManager::partialTranscription, this, &SimulatedClient::onPartial);
+        connect(m_network, &NetworkManager::partialTranscriptionDelta, this, &SimulatedClient::onPartial);
+        connect(m_network, &NetworkManager::finalTranscription, this, [this]() {
+            if (m_busy && m_audioEndMs >= 0) {
+                m_result.succeeded = true;
+                m_result.gotFinal = true;
+                m_result.finalLatencyMs = m_clock.elapsed() - m_audioEndMs;
+                finish();
+            }
+        });
+    }
+
+    bool isBusy() const { return m_busy || m_closing; }
+
+    void start(const Utterance &utterance, qint64 queueMs)
+    {
+        m_busy = true;
+        m_utterance = utterance;
+        m_offset = 0;
+        m_firstAudioMs = -1;
+        m_audioEndMs = -1;
+        m_result = SessionResult();
+        m_result.queueMs = queueMs;
+        m_result.audioMs = utterance.audioMs;
+        m_clock.start();
+
+        switch (m_mode) {
+            case Mode::Rest:
+                // The cabin uploads once the speaker stops
+                m_audioEndMs = 0;
+                m_requestId = m_network->transcribeRaw(utterance.pcm, m_language);
+                m_finalTimer->start();
+                break;
+            case Mode::Upload:
+                m_requestId = m_network->beginStreamingTranscription(m_language);
+                m_chunkTimer->start();
+                sendNextChunk();
+                break;
+            case Mode::Stream:
+                m_requestId = 0;
+                m_network->connectWebSocket();
+                break;
+        }
+    }
+
+signals:
+    void sessionFinished(const SessionResult &result);
+
+private slots:
+    void sendNextChunk()
+    {
+        if (!m_busy || m_audioEndMs >= 0) {
+            return;
+        }
+
+        if (m_firstAudioMs < 0) {
+            m_firstAudioMs = m_clock.elapsed();
+        }
+
+        const QByteArray chunk = m_utterance.pcm.mid(m_offset, m_chunkMs * BYTES_PER_MS);
+        m_offset += chunk.size();
+        if (!chunk.isEmpty()) {
+            if (m_mode == Mode::Stream) {
+                m_network->sendAudioChunk(chunk);
+            } else {
+                m_network->appendStreamingAudio(chunk);
+            }
+        }
+
+        if (m_offset >= m_utterance.pcm.size()) {
+            m_chunkTimer->stop();
+            m_audioEndMs = m_clock.elapsed();
+            if (m_mode == Mode::Upload) {
+                m_network->finishStreamingTranscription();
+            }
+            m_finalTimer->start();
+        }
+    }
+
+    void onPartial()
+    {
+        if (m_busy && m_result.firstPartialMs < 0 && m_firstAudioMs >= 0) {
+            m_result.firstPartialMs = m_clock.elapsed() - m_firstAudioMs;
+        }
+    }
+
+private:
+    void fail(const QString &error)
+    {
+        m_result.succeeded = false;
+        m_result.error = error;
+        finish();
+    }
+
+    void finish()
+    {
+        m_chunkTimer->stop();
+        m_finalTimer->stop();
+        m_busy = false;
+
+        if (m_mode == Mode::Upload && !m_result.gotFinal) {
+            m_network->abortStreamingTranscription();
+        }
+
+        // Like AudioEngine, one WebSocket session per utterance; the client
+        // is reused only once the old session is fully closed
+        if (m_mode == Mode::Stream && m_network->isConnected()) {
+            m_closing = true;
+            m_network->disconnectWebSocket();
+            return;
+        }
+
+        emit sessionFinished(m_result);
+    }
+
+    NetworkManager *m_network;
+    Mode m_mode;
+    int m_chunkMs;
+    QString m_language;
+    QTimer *m_chunkTimer;
+    QTimer *m_finalTimer;
+    bool m_busy;
+    bool m_closing; // stream session closing, result not reported yet
+    quint64 m_requestId;
+    Utterance m_utterance;
+    qsizetype m_offset;
+    QElapsedTimer m_clock;
+    qint64 m_firstAudioMs;
+    qint64 m_audioEndMs;
+    SessionResult m_result;
+};
+
+// ============================================================================
+// Load generator
+// ============================================================================
+
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    LoadGenerator(const QList<Utterance> &corpus, int sessions, double rate, quint32 seed, QObject *parent = nullptr)
+        : QObject(parent)
+        , m_corpus(corpus)
+        , m_sessions(sessions)
+        , m_rate(rate)
+        , m_random(seed)
+        , m_arrived(0)
+        , m_nextUtterance(0)
+    {
+    }
+
+    void addClient(SimulatedClient *client)
+    {
+        m_clients << client;
+        connect(client, &SimulatedClient::sessionFinished, this, [this](const SessionResult &result) {
+            m_results << result;
+            if (m_rate <= 0.0 && m_arrived < m_sessions) {
+                arrive();
+            }
+            dispatch();
+            if (m_results.size() == m_sessions) {
+                emit done();
+            }
+        });
+    }
+
+    void start()
+    {
+        m_clock.start();
+        if (m_rate > 0.0) {
+            arrive();
+        } else {
+            // Closed loop: every client starts at once and goes again when done
+            for (int i = 0; i < m_clients.size() && m_arrived < m_sessions; ++i) {
+                arrive();
+            }
+        }
+    }
+
+    QJsonObject report(const QJsonObject &config) const;
+
+signals:
+    void done();
+
+private:
+    void arrive()
+    {
+        m_waiting.enqueue(m_clock.elapsed());
+        ++m_arrived;
+        dispatch();
+
+        if (m_rate > 0.0 && m_arrived < m_sessions) {
+            // Exponential inter-arrival times: a Poisson process at m_rate
+            const double gapMs = -std::log(1.0 - m_random.generateDouble()) / m_rate * 1000.0;
+            QTimer::singleShot(qRound(gapMs), this, &LoadGenerator::arrive);
+        }
+    }
+
+    void dispatch()
+    {
+        for (SimulatedClient *client : std::as_const(m_clients)) {
+            if (m_waiting.isEmpty()) {
+                return;
+            }
+            if (!client->isBusy()) {
+                const qint64 queueMs = m_clock.elapsed() - m_waiting.dequeue();
+                client->start(m_corpus.at(m_nextUtterance), queueMs);
+                m_nextUtterance = (m_nextUtterance + 1) % m_corpus.size();
+            }
+        }
+    }
+
+    QList<Utterance> m_corpus;
+    QList<SimulatedClient*> m_clients;
+    int m_sessions;
+    double m_rate;
+    QRandomGenerator m_random;
+    int m_arrived;
+    int m_nextUtterance;
+    QQueue<qint64> m_waiting; // arrival times of sessions without a client yet
+    QElapsedTimer m_clock;
+    QList<SessionResult> m_results;
+};
+
+static QJsonObject distribution(QList<qint64> values)
+{
+    QJsonObject json;
+    json["count"] = int(values.size());
+    if (values.isEmpty()) {
+        return json;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](double p) {
+        // Nearest rank
+        const qsizetype rank = qsizetype(std::ceil(p * values.size()));
+        return values.at(qBound<qsizetype>(0, rank - 1, values.size() - 1));
+    };
+
+    double sum = 0;
+    for (qint64 value : values) {
+        sum += value;
+    }
+    json["mean"] = sum / values.size();
+    json["p50"] = percentile(0.50);
+    json["p90"] = percentile(0.90);
+    json["p95"] = percentile(0.95);
+    json["p99"] = percentile(0.99);
+    json["max"] = values.last();
+    return json;
+}
+
+QJsonObject LoadGenerator::report(const QJsonObject &config) const
+{
+    const double wallS = m_clock.elapsed() / 1000.0;
+
+    QList<qint64> queue, firstPartial, finalLatency;
+    QHash<QString, int> errors;
+    int succeeded = 0, withFinal = 0;
+    qint64 audioMs = 0;
+
+    for (const SessionResult &result : m_results) {
+        queue << result.queueMs;
+        if (result.firstPartialMs >= 0) {
+            firstPartial << result.firstPartialMs;
+        }
+        if (result.finalLatencyMs >= 0) {
+            finalLatency << result.finalLatencyMs;
+        }
+        if (result.succeeded) {
+            ++succeeded;
+            audioMs += result.audioMs;
+        } else {
+            errors[result.error.isEmpty() ? QString("No result") : result.error]++;
+        }
+        if (result.gotFinal) {
+            ++withFinal;
+        }
+    }
+
+    QJsonObject errorCounts;
+    for (auto it = errors.constBegin(); it != errors.constEnd(); ++it) {
+        errorCounts[it.key()] = it.value();
+    }
+
+    QJsonObject sessions;
+    sessions["total"] = int(m_results.size());
+    sessions["succeeded"] = succeeded;
+    sessions["failed"] = int(m_results.size()) - succeeded;
+    sessions["with_final"] = withFinal;
+
+    QJsonObject throughput;
+    throughput["sessions_per_s"] = wallS > 0 ? succeeded / wallS : 0.0;
+    // Seconds of audio transcribed per wall-clock second: concurrent real-time speakers served
+    throughput["audio_s_per_s"] = wallS > 0 ? audioMs / 1000.0 / wallS : 0.0;
+
+    QJsonObject json;
+    json["config"] = config;
+    json["wall_s"] = wallS;
+    json["sessions"] = sessions;
+    json["throughput"] = throughput;
+    json["error_rate"] = m_results.isEmpty() ? 0.0 : double(m_results.size() - succeeded) / m_results.size();
+    json["errors"] = errorCounts;
+    json["queue_delay_ms"] = distribution(queue);
+    json["time_to_first_partial_ms"] = distribution(firstPartial);
+    json["final_latency_ms"] = distribution(finalLatency);
+    return json;
+}
+
+// ============================================================================
+// main
+// ============================================================================
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay a WAV corpus against a Whisper backend as N concurrent clients");
+    parser.addHelpOption();
+    parser.addOption({"backend", "Backend URL; repeat for a pool.", "url", "http://localhost:8000"});
+    parser.addOption({"corpus", "WAV file or directory (16 kHz, 16-bit); repeatable. Default: 3 s of silence.", "path"});
+    parser.addOption({"clients", "Number of simulated clients.", "n", "4"});
+    parser.addOption({"sessions", "Total utterances to send.", "n", "100"});
+    parser.addOption({"rate", "Session arrivals per second (0 = back to back).", "per-s", "0"});
+    parser.addOption({"mode", "rest, upload or stream.", "mode", "rest"});
+    parser.addOption({"chunk-ms", "Audio per chunk in upload and stream modes.", "ms", "100"});
+    parser.addOption({"final-timeout", "Wait for a result after the audio ends, ms.", "ms", "30000"});
+    parser.addOption({"language", "Language code.", "code", "en"});
+    parser.addOption({"seed", "Seed for the arrival process.", "seed", "1"});
+    parser.addOption({"output", "Write the JSON report here instead of stdout.", "file"});
+    parser.addOption({"verbose", "Keep NetworkManager debug output."});
+    parser.process(app);
+
+    if (!parser.isSet("verbose")) {
+        QLoggingCategory::setFilterRules("default.debug=false");
+    }
+
+    const QString modeName = parser.value("mode");
+    Mode mode;
+    if (modeName == "rest") {
+        mode = Mode::Rest;
+    } else if (modeName == "upload") {
+        mode = Mode::Upload;
+    } else if (modeName == "stream") {
+        mode = Mode::Stream;
+    } else {
+        qCritical() << "❌ Unknown mode:" << modeName;
+        return 1;
+    }
+
+    QList<Utterance> corpus = loadCorpus(parser.values("corpus"));
+    if (corpus.isEmpty()) {
+        if (parser.isSet("corpus")) {
+            qCritical() << "❌ No usable WAV files in the corpus";
+            return 1;
+        }
+        Utterance silence;
+        silence.name = "silence";
+        silence.pcm = QByteArray(3000 * BYTES_PER_MS, '\0');
+        silence.audioMs = 3000;
+        corpus << silence;
+    }
+
+    const int clients = qMax(1, parser.value("clients").toInt());
+    const int sessions = qMax(1, parser.value("sessions").toInt());
+    const double rate = parser.value("rate").toDouble();
+    const int chunkMs = qMax(10, parser.value("chunk-ms").toInt());
+
+    LoadGenerator generator(corpus, sessions, rate, parser.value("seed").toUInt());
+    for (int i = 0; i < clients; ++i) {
+        generator.addClient(new SimulatedClient(parser.values("backend"), mode, chunkMs,
+                                                parser.value("final-timeout").toInt(),
+                                                parser.value("language"), &generator));
+    }
+
+    QJsonObject config;
+    config["backends"] = QJsonArray::fromStringList(parser.values("backend"));
+    config["mode"] = modeName;
+    config["clients"] = clients;
+    config["sessions"] = sessions;
+    config["rate"] = rate;
+    config["chunk_ms"] = chunkMs;
+    config["corpus_files"] = int(corpus.size());
+
+    QObject::connect(&generator, &LoadGenerator::done, &app, [&]() {
+        const QByteArray json = QJsonDocument(generator.report(config)).toJson(QJsonDocument::Indented);
+        if (parser.isSet("output")) {
+            QFile file(parser.value("output"));
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+                qCritical() << "❌ Cannot write report:" << file.errorString();
+                app.exit(1);
+                return;
+            }
+        } else {
+            fwrite(json.constData(), 1, json.size(), stdout);
+            fflush(stdout);
+        }
+        app.quit();
+    });
+
+    // Let the clients' initial health checks settle before the first arrival
+    QTimer::singleShot(1000, &generator, &LoadGenerator::start);
+
+    return app.exec();
+}
+
+#include "loadgen.moc"
@@ -13,6 +13,7 @@ class Settings(BaseSettings):
     HOST: str = "0.0.0.0"
     PORT: int = 8000
     WORKERS: int = 1
+    UDS: str = os.getenv("UDS", "")  # Unix socket path; replaces HOST/PORT when set
     
     # Model settings
     MODEL_NAME: str = os.getenv("MODEL_NAME", "whisper-base-onnx")
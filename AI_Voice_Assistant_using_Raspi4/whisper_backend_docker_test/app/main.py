@@ -1,11 +1,17 @@
 """FastAPI application for Whisper ONNX transcription backend"""
+import asyncio
 import logging
+import json
+import struct
 import time
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+from functools import partial
 from pathlib import Path
 from typing import Optional
 import io
 
-from fastapi import FastAPI, File, UploadFile, HTTPException, WebSocket, WebSocketDisconnect
+from fastapi import FastAPI, File, UploadFile, HTTPException, Request, WebSocket, WebSocketDisconnect
 from fastapi.middleware.cors import CORSMiddleware
 from fastapi.responses import JSONResponse
 import numpy as np
@@ -45,6 +51,63 @@ app.add_middleware(
 whisper_engine = None
 model_loaded = False
 
+# Request IDs the client has abandoned (X-Request-Id -> time cancelled).
+# Handlers check this before inference so cancelled work never reaches the model.
+cancelled_requests: "OrderedDict[str, float]" = OrderedDict()
+MAX_CANCELLED_REQUESTS = 1024
+
+# Inference runs off the event loop so /health and WebSocket pings are answered
+# while the model is busy. One worker keeps inference serialized as before.
+inference_executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix="whisper")
+
+# Speech for multiplexed /stream sessions is synthesized on its own thread,
+# so a reply being voiced never waits behind a transcription
+tts_executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix="tts")
+
+class DeadlineExceeded(Exception):
+    """The client's deadline passed before inference started"""
+
+def _transcribe_before(deadline: Optional[float], audio: np.ndarray, **kwargs) -> dict:
+    # Checked on the inference thread, so time spent queued behind other
+    # requests counts against the deadline
+    if deadline is not None and time.monotonic() > deadline:
+        raise DeadlineExceeded()
+    return whisper_engine.transcribe(audio, **kwargs)
+
+async def run_inference(audio: np.ndarray, deadline: Optional[float] = None, **kwargs) -> dict:
+    """Run Whisper on the inference thread without blocking the event loop"""
+    loop = asyncio.get_running_loop()
+    try:
+        return await loop.run_in_executor(inference_executor, partial(_transcribe_before, deadline, audio, **kwargs))
+    except DeadlineExceeded:
+        logger.info("⏰ Deadline passed while queued, skipping inference")
+        raise HTTPException(status_code=504, detail="Request deadline exceeded")
+
+@app.middleware("http")
+async def stamp_deadline(request: Request, call_next):
+    """Turn X-Request-Timeout-Ms (ms remaining when sent) into a monotonic deadline on arrival"""
+    request.state.deadline = None
+    timeout_ms = request.headers.get("x-request-timeout-ms")
+    if timeout_ms:
+        try:
+            request.state.deadline = time.monotonic() + max(0, int(timeout_ms)) / 1000.0
+        except ValueError:
+            logger.warning(f"⚠️ Ignoring malformed X-Request-Timeout-Ms: {timeout_ms}")
+    return await call_next(request)
+
+async def abandon_if_cancelled(http_request: Request) -> None:
+    """Raise 499 if the client cancelled this request or already went away"""
+    request_id = http_request.headers.get("x-request-id")
+    
+    if request_id and request_id in cancelled_requests:
+        cancelled_requests.pop(request_id, None)
+        logger.info(f"🛑 Skipping inference for cancelled request {request_id}")
+        raise HTTPException(status_code=499, detail="Request cancelled by client")
+    
+    if await http_request.is_disconnected():
+        logger.info(f"🛑 Client disconnected, skipping inference for {request_id or 'request'}")
+        raise HTTPException(status_code=499, detail="Client disconnected")
+
 @app.on_event("startup")
 async def startup_event():
     """Initialize Whisper engine on startup"""
@@ -113,8 +176,19 @@ async def model_info():
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
+@app.post("/cancel/{request_id}")
+async def cancel_request(request_id: str):
+    """Mark a request as abandoned by the client"""
+    cancelled_requests[request_id] = time.time()
+    while len(cancelled_requests) > MAX_CANCELLED_REQUESTS:
+        cancelled_requests.popitem(last=False)
+    
+    logger.info(f"🛑 Cancel received for request {request_id}")
+    return {"request_id": request_id, "cancelled": True}
+
 @app.post("/transcribe", response_model=TranscribeResponse)
 async def transcribe_audio(
+    http_request: Request,
     audio_file: UploadFile = File(...),
     language: str = "en",
     normalize: bool = True,
@@ -178,7 +252,8 @@ async def transcribe_audio(
             )
         
         # Transcribe
-        result = whisper_engine.transcribe(audio, language=language)
+        await abandon_if_cancelled(http_request)
+        result = await run_inference(audio, deadline=http_request.state.deadline, language=language)
         
         logger.info(f"✅ Transcription: '{result['text'][:50]}...'")
         
@@ -191,7 +266,7 @@ async def transcribe_audio(
         raise HTTPException(status_code=500, detail=f"Transcription failed: {e}")
 
 @app.post("/transcribe/base64", response_model=TranscribeResponse)
-async def transcribe_base64(request: TranscribeRequest):
+async def transcribe_base64(request: TranscribeRequest, http_request: Request):
     """
     Transcribe audio from base64-encoded string
     """
@@ -231,28 +306,322 @@ async def transcribe_base64(request: TranscribeRequest):
         audio_processor = AudioProcessor()
         audio, sample_rate = audio_processor.preprocess(audio, sample_rate)
         
-        result = whisper_engine.transcribe(audio, language=request.language)
+        await abandon_if_cancelled(http_request)
+        result = await run_inference(audio, deadline=http_request.state.deadline, language=request.language)
         
         return TranscribeResponse(**result)
         
+    except HTTPException:
+        raise
     except Exception as e:
         logger.error(f"❌ Base64 transcription error: {e}")
         raise HTTPException(status_code=500, detail=str(e))
 
+def _decode_pcm_s16le(pcm: bytes, channels: int) -> np.ndarray:
+    """Convert little-endian 16-bit PCM to float32 in [-1, 1]"""
+    # Drop a trailing partial frame rather than failing the whole request
+    usable = len(pcm) - (len(pcm) % (2 * channels))
+    audio = np.frombuffer(pcm[:usable], dtype=np.int16).astype(np.float32) / 32768.0
+    if channels > 1:
+        audio = audio.reshape(-1, channels)
+    return audio
+
+@app.post("/transcribe/raw", response_model=TranscribeResponse)
+async def transcribe_raw(request: Request):
+    """
+    Transcribe raw PCM sent as application/octet-stream.
+
+    Unlike /transcribe/base64 the body is the audio itself, so there is no
+    33% base64 inflation and no JSON parsing of a multi-megabyte string.
+    Metadata travels in X-Sample-Rate, X-Channels, X-Language and
+    X-Audio-Format headers.
+    """
+    start_time = time.time()
+    
+    audio_format = request.headers.get("x-audio-format", "pcm_s16le")
+    if audio_format != "pcm_s16le":
+        raise HTTPException(status_code=415, detail=f"Unsupported audio format: {audio_format}")
+    
+    sample_rate = int(request.headers.get("x-sample-rate", settings.SAMPLE_RATE))
+    channels = int(request.headers.get("x-channels", 1))
+    language = request.headers.get("x-language", "en")
+    
+    pcm = await request.body()
+    logger.info(f"📥 Received raw PCM: {len(pcm)} bytes, language: {language}")
+    
+    try:
+        audio = _decode_pcm_s16le(pcm, channels)
+        
+        if not model_loaded or whisper_engine is None:
+            # MOCK MODE
+            logger.warning("⚠️ MOCK MODE: Returning simulated transcription")
+            
+            duration = len(audio) / sample_rate if sample_rate > 0 else 0
+            inference_time = duration * 0.5
+            
+            return TranscribeResponse(
+                text=f"[MOCK TRANSCRIPTION] Raw PCM transcribed. Language: {language}",
+                language=language,
+                duration=duration,
+                inference_time=inference_time,
+                total_time=time.time() - start_time,
+                rtf=0.5,
+                timestamp=time.time()
+            )
+        
+        # PRODUCTION MODE
+        from .audio_processor import AudioProcessor
+        audio_processor = AudioProcessor()
+        audio, sample_rate = audio_processor.preprocess(audio, sample_rate)
+        
+        await abandon_if_cancelled(request)
+        result = await run_inference(audio, deadline=request.state.deadline, language=language)
+        
+        return TranscribeResponse(**result)
+        
+    except HTTPException:
+        raise
+    except Exception as e:
+        logger.error(f"❌ Raw transcription error: {e}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Transcription failed: {e}")
+
+@app.post("/transcribe/stream", response_model=TranscribeResponse)
+async def transcribe_stream(request: Request):
+    """
+    Transcribe raw PCM uploaded progressively with chunked transfer encoding.
+
+    The Qt client opens this request when listening starts and writes audio
+    as it is captured, so by the time the user stops only the tail is left.
+    Metadata travels in headers: X-Sample-Rate, X-Channels, X-Language and
+    X-Audio-Format (only pcm_s16le is supported).
+    """
+    start_time = time.time()
+    
+    audio_format = request.headers.get("x-audio-format", "pcm_s16le")
+    if audio_format != "pcm_s16le":
+        raise HTTPException(status_code=415, detail=f"Unsupported audio format: {audio_format}")
+    
+    sample_rate = int(request.headers.get("x-sample-rate", settings.SAMPLE_RATE))
+    channels = int(request.headers.get("x-channels", 1))
+    language = request.headers.get("x-language", "en")
+    
+    # Accumulate the body as it arrives; chunks are already decoded by the server
+    pcm = bytearray()
+    chunk_count = 0
+    async for chunk in request.stream():
+        pcm.extend(chunk)
+        chunk_count += 1
+    
+    upload_done = time.time()
+    logger.info(f"📥 Progressive upload complete: {len(pcm)} bytes in {chunk_count} chunks, language: {language}")
+    
+    try:
+        audio = _decode_pcm_s16le(bytes(pcm), channels)
+        
+        if not model_loaded or whisper_engine is None:
+            # MOCK MODE
+            logger.warning("⚠️ MOCK MODE: Returning simulated transcription")
+            
+            duration = len(audio) / sample_rate if sample_rate > 0 else 0
+            inference_time = duration * 0.5
+            
+            return TranscribeResponse(
+                text=f"[MOCK TRANSCRIPTION] Progressive upload transcribed. Language: {language}",
+                language=language,
+                duration=duration,
+                inference_time=inference_time,
+                total_time=time.time() - start_time,
+                rtf=0.5,
+                timestamp=time.time()
+            )
+        
+        # PRODUCTION MODE
+        from .audio_processor import AudioProcessor
+        audio_processor = AudioProcessor()
+        audio, sample_rate = audio_processor.preprocess(audio, sample_rate)
+        
+        await abandon_if_cancelled(request)
+        result = await run_inference(audio, deadline=request.state.deadline, language=language)
+        logger.info(f"✅ Transcription: '{result['text'][:50]}...' "
+                    f"(tail latency {time.time() - upload_done:.3f}s)")
+        
+        return TranscribeResponse(**result)
+        
+    except HTTPException:
+        raise
+    except Exception as e:
+        logger.error(f"❌ Progressive transcription error: {e}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Transcription failed: {e}")
+
+def _utf16_len(text: str) -> int:
+    """Length in UTF-16 code units, the unit the Qt client indexes text in"""
+    return len(text.encode("utf-16-le")) // 2
+
+class PartialHypothesis:
+    """
+    Running /stream hypothesis, sent as a committed length plus tentative tail
+    
+    Each window is decoded once, so the previous window's text is final as
+    soon as the next one arrives. The client keeps the first `stable` UTF-16
+    units of what it shows and replaces the rest with `text`, so committed
+    text is never resent.
+    """
+    
+    def __init__(self):
+        self.reset()
+    
+    def reset(self) -> None:
+        self.committed = ""
+        self.tentative = ""
+    
+    def advance(self, window_text: str) -> dict:
+        if self.tentative:
+            self.committed = f"{self.committed} {self.tentative}" if self.committed else self.tentative
+        self.tentative = window_text.strip()
+        tail = f" {self.tentative}" if self.committed and self.tentative else self.tentative
+        return {"stable": _utf16_len(self.committed), "text": tail}
+
+# Multiplexed /stream (?mux=1): binary frames carry an 8-byte big-endian
+# header: channel, flags, sequence, stream id. Matches StreamMux in the client.
+MUX_VERSION = 1
+MUX_HEADER = struct.Struct(">BBHI")
+MUX_CHANNEL_STT = 1
+MUX_CHANNEL_TTS = 2
+MUX_FLAG_END = 0x01
+TTS_FRAME_MS = 20
+
+def _synthesize_speech(text: str, rate: float) -> tuple:
+    """16-bit mono PCM and its sample rate; a tone when pyttsx3 isn't installed"""
+    try:
+        import pyttsx3
+        import tempfile
+        import wave
+    except ImportError:
+        # MOCK MODE: a tone as long as the text would take to say
+        sample_rate = settings.SAMPLE_RATE
+        seconds = max(0.2, len(text) * 0.065 / max(rate, 0.1))
+        t = np.arange(int(sample_rate * seconds)) / sample_rate
+        return (0.25 * np.sin(2 * np.pi * 220 * t) * 32767).astype("<i2").tobytes(), sample_rate
+    
+    with tempfile.NamedTemporaryFile(suffix=".wav") as output:
+        engine = pyttsx3.init()
+        engine.setProperty("rate", int(engine.getProperty("rate") * rate))
+        engine.save_to_file(text, output.name)
+        engine.runAndWait()
+        with wave.open(output.name, "rb") as wav:
+            if wav.getsampwidth() != 2 or wav.getnchannels() != 1:
+                raise ValueError("pyttsx3 wrote audio that is not 16-bit mono")
+            return wav.readframes(wav.getnframes()), wav.getframerate()
+
+async def stream_speech(websocket: WebSocket, send_lock: asyncio.Lock, stream: int, text: str, rate: float) -> None:
+    """Synthesize text and send it down the speech channel in TTS_FRAME_MS frames"""
+    try:
+        loop = asyncio.get_running_loop()
+        pcm, sample_rate = await loop.run_in_executor(tts_executor, partial(_synthesize_speech, text, rate))
+    except asyncio.CancelledError:
+        raise
+    except Exception as e:
+        logger.error(f"❌ Speech stream {stream} failed: {e}")
+        async with send_lock:
+            await websocket.send_json({"type": "tts_failed", "channel": MUX_CHANNEL_TTS, "stream": stream,
+                                       "message": str(e)})
+        return
+    
+    async with send_lock:
+        await websocket.send_json({"type": "tts_started", "channel": MUX_CHANNEL_TTS, "stream": stream,
+                                   "sampleRate": sample_rate, "channels": 1})
+    
+    frame_bytes = sample_rate * TTS_FRAME_MS // 1000 * 2
+    frames = [pcm[i:i + frame_bytes] for i in range(0, len(pcm), frame_bytes)] or [b""]
+    for sequence, payload in enumerate(frames):
+        flags = MUX_FLAG_END if sequence == len(frames) - 1 else 0
+        header = MUX_HEADER.pack(MUX_CHANNEL_TTS, flags, sequence & 0xFFFF, stream)
+        async with send_lock:
+            await websocket.send_bytes(header + payload)
+        # Let partials and other streams interleave rather than queue behind a whole reply
+        await asyncio.sleep(0)
+    logger.info(f"🗣️ Speech stream {stream} sent: {len(pcm)} bytes in {len(frames)} frames")
+
 @app.websocket("/stream")
 async def websocket_stream(websocket: WebSocket):
     """
     WebSocket endpoint for real-time streaming transcription
+    
+    Clients connecting with ?partials=delta get partials as
+    {"stable": n, "text": tail} deltas; others get each window's text.
+    
+    Clients connecting with ?mux=1 are told {"type": "ready", "mux": 1}; their
+    audio then comes in MUX_HEADER frames on channel 1, and they may ask for
+    speech ({"type": "tts", "stream": n, ...}), which comes back on channel 2
+    of the same connection.
     """
     await websocket.accept()
-    logger.info("🔌 WebSocket connection established")
+    delta_partials = websocket.query_params.get("partials") == "delta"
+    multiplexed = websocket.query_params.get("mux") == "1"
+    logger.info(f"🔌 WebSocket connection established ({'delta' if delta_partials else 'full'} partials"
+                f"{', multiplexed' if multiplexed else ''})")
     
     audio_buffer = []
+    hypothesis = PartialHypothesis()
+    # Speech streams and partials share the socket; a frame is never split by another
+    send_lock = asyncio.Lock()
+    speech_tasks = {}
+    
+    def partial_message(text: str) -> dict:
+        fields = hypothesis.advance(text) if delta_partials else {"text": text}
+        return {"type": "partial", **fields, "timestamp": time.time()}
+    
+    async def send_json(message: dict) -> None:
+        async with send_lock:
+            await websocket.send_json(message)
+    
+    if multiplexed:
+        await send_json({"type": "ready", "mux": MUX_VERSION})
     
     try:
         while True:
-            # Receive audio chunk
-            data = await websocket.receive_bytes()
+            message = await websocket.receive()
+            
+            if message["type"] == "websocket.disconnect":
+                raise WebSocketDisconnect(message.get("code", 1000))
+            
+            # Control messages arrive as text frames
+            if message.get("text") is not None:
+                try:
+                    control = json.loads(message["text"])
+                except json.JSONDecodeError:
+                    logger.warning(f"⚠️ Invalid control message: {message['text'][:100]}")
+                    continue
+                
+                if multiplexed and control.get("type") == "tts":
+                    stream = int(control.get("stream", 0))
+                    task = asyncio.create_task(stream_speech(websocket, send_lock, stream, control.get("text", ""),
+                                                             float(control.get("rate", 1.0))))
+                    speech_tasks[stream] = task
+                    task.add_done_callback(lambda _, stream=stream: speech_tasks.pop(stream, None))
+                elif multiplexed and control.get("type") == "tts_cancel":
+                    task = speech_tasks.pop(int(control.get("stream", 0)), None)
+                    if task:
+                        task.cancel()
+                elif control.get("type") == "cancel":
+                    # Client abandoned the utterance: drop buffered audio, skip inference
+                    logger.info(f"🛑 Stream cancelled, discarding {len(audio_buffer)} buffered samples")
+                    audio_buffer.clear()
+                    hypothesis.reset()
+                    await send_json({"type": "cancelled", "timestamp": time.time()})
+                continue
+            
+            data = message.get("bytes")
+            if not data:
+                continue
+            
+            if multiplexed:
+                if len(data) < MUX_HEADER.size:
+                    continue
+                channel, _, _, _ = MUX_HEADER.unpack_from(data)
+                if channel != MUX_CHANNEL_STT:
+                    continue
+                data = data[MUX_HEADER.size:]
             
             logger.debug(f"📦 Received audio chunk: {len(data)} bytes")
             
@@ -266,24 +635,18 @@ async def websocket_stream(websocket: WebSocket):
                 
                 if not model_loaded or whisper_engine is None:
                     # MOCK MODE
-                    await websocket.send_json({
-                        "type": "partial",
-                        "text": f"[MOCK] Processing {len(audio)/settings.SAMPLE_RATE:.1f}s of audio...",
-                        "timestamp": time.time(),
-                    })
+                    await send_json(
+                        partial_message(f"[MOCK] Processing {len(audio)/settings.SAMPLE_RATE:.1f}s of audio...")
+                    )
                 else:
                     # PRODUCTION MODE
                     from .audio_processor import AudioProcessor
                     audio_processor = AudioProcessor()
                     
                     if audio_processor.detect_voice_activity(audio):
-                        result = whisper_engine.transcribe(audio)
+                        result = await run_inference(audio)
                         
-                        await websocket.send_json({
-                            "type": "partial",
-                            "text": result["text"],
-                            "timestamp": time.time(),
-                        })
+                        await send_json(partial_message(result["text"]))
                 
                 # Clear buffer
                 audio_buffer.clear()
@@ -293,6 +656,9 @@ async def websocket_stream(websocket: WebSocket):
     except Exception as e:
         logger.error(f"❌ WebSocket error: {e}")
         await websocket.close()
+    finally:
+        for task in list(speech_tasks.values()):
+            task.cancel()
 
 @app.get("/status/detailed")
 async def detailed_status():
@@ -326,5 +692,9 @@ async def detailed_status():
 
 if __name__ == "__main__":
     import uvicorn
-    uvicorn.run(app, host=settings.HOST, port=settings.PORT)
+    if settings.UDS:
+        # Same-board GUI: skip the loopback TCP stack
+        uvicorn.run(app, uds=settings.UDS)
+    else:
+        uvicorn.run(app, host=settings.HOST, port=settings.PORT)
 